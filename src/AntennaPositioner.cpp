@@ -7,30 +7,33 @@
 
 //#/////////////////////////////INTERRUPCIONES//////////////////////////
 
-volatile float AntennaPositioner::cuenta=0;
+EncoderCounter AntennaPositioner::encoder;
 
+//EL SENTIDO DE CADA FLANCO DEPENDE DEL NIVEL DEL OTRO CANAL; LA CUENTA ES ATOMICA, ASI QUE LAS DOS INTERRUPCIONES NO PIERDEN FLANCOS
 void canalA()
 {
 #ifdef RASPBERRY_PI
-    if(digitalRead(piPins.FASE_B) == pinsValues.FASE_B_OFF){
-        AntennaPositioner::cuenta++;
-    }else{
-        AntennaPositioner::cuenta--;
-    }
+    AntennaPositioner::encoder.AddEdgeA( digitalRead(piPins.FASE_B) != pinsValues.FASE_B_OFF );
 #endif
 }
 
 void canalB()
 {
 #ifdef RASPBERRY_PI
-    if(digitalRead(piPins.FASE_A) == pinsValues.FASE_A_OFF){
-        AntennaPositioner::cuenta--;
-    }else{
-        AntennaPositioner::cuenta++;
-    }
+    AntennaPositioner::encoder.AddEdgeB( digitalRead(piPins.FASE_A) != pinsValues.FASE_A_OFF );
 #endif
 }
 
+/*!	\param [in] arg A pointer to the _AntennaPositioner_ object. */
+void *MoveThreadFunc(void * arg)
+{
+	auto * antPositionerPtr = (AntennaPositioner*) arg;
+
+	antPositionerPtr->ProcessMoves();
+
+	return NULL;
+}
+
 
 ////////////////////////////////////////////////////////////////////
 
@@ -38,12 +41,12 @@ void AntennaPositioner::inicia_variables()
 {
 	pos_actual = {0.0, 0.0, 0};
 	pos_anterior = {0.0, 0.0, 0};
-	cuenta = 0.0;
+	encoder.Reset();
 	yaw = 0.0;
-	n = 2.0;
 	cantPosiciones = 6;
 	polar = 0; //POLAR = 0 (HORIZONTAL) ; POLAR = 1 (VERTICAL)
 	anguloInicial=0.0;
+	lastRotation = {};
 	band_mueve_inicial = 0;
 	band_norte = 0;
 	band_salta = 0;
@@ -114,8 +117,9 @@ bool AntennaPositioner::Initialize()
             //SE EMPIEZA EN UNA DIRECCION(DIR,HIGH) (IZQUIERDA) sentido anti-horario
             digitalWrite(piPins.DIRECCION, pinsValues.DIR_ANTIHOR);
 
-            cuenta=0;
-            while( ((cuenta/n) > -360 && cuenta <= 0) && band_mueve_inicial==0)
+            const std::int64_t cuentaInicial = encoder.GetCount();
+            double grados;
+            while( ((grados=encoder.GetDegreesSince(cuentaInicial)) > -360 && grados <= 0) && band_mueve_inicial==0)
             {
                 if (pinsValues.SENS_NOR_ON == digitalRead(piPins.SENSOR_NORTE)) //A TRAVES DE UNA SEÑAL (0 O 1) SE VERA DONDE ESTA EL NORTE
                 {
@@ -125,9 +129,7 @@ bool AntennaPositioner::Initialize()
                 {
                     if(band_salta)
                     {
-                        sleep(2);   //DELAY(2 segundos)
-                        gpsInterface.UpdateYaw();
-                        aux = gpsInterface.GetYaw();//PIDO ANGULO
+                        aux = gpsInterface.WaitForSteadyYaw();//PIDO ANGULO FILTRADO, ESPERANDO QUE SE ESTABILICE (MAXIMO 2 segundos)
                         if((aux >= 355.0) || (aux <= 5.0)) //CORROBORO ANGULO NORTE ( 0° )
                         {
                             band_norte = 0;
@@ -137,9 +139,7 @@ bool AntennaPositioner::Initialize()
                             {
                                 un_paso();
                             }
-                            sleep(2);   //DELAY(2 segundos)
-                            gpsInterface.UpdateYaw();
-                            aux = gpsInterface.GetYaw();//PIDO ANGULO
+                            aux = gpsInterface.WaitForSteadyYaw();//PIDO ANGULO FILTRADO, ESPERANDO QUE SE ESTABILICE (MAXIMO 2 segundos)
                             if((aux >= 85.0) || (aux <= 95.0)) //CORROBORO ANGULO 90°
                             {
                                 band_gps_ok=1;// EL GPS ESTA FUNCIONANDO BIEN
@@ -390,24 +390,35 @@ bool AntennaPositioner::ChangePolarization()
 //DA UN PASO
 void AntennaPositioner::un_paso()
 {
-#ifdef RASPBERRY_PI
-	const unsigned int RETARDO = 5;//MILISEGUNDOS
-    digitalWrite(piPins.PUL, pinsValues.PUL_ON); // SE ENVIA UN PULSO EN ALTO(PUL,HIGH)
-    delay(RETARDO);  // SE ESPERA UN TIEMPO(RETARDO)
-    digitalWrite(piPins.PUL, pinsValues.PUL_OFF); // SE ENVIA UN PULSO EN BAJO(PUL,LOW)
-    delay(RETARDO);
-#endif
+    stepper.Step(); // SE ENVIA UN PULSO A LA TASA INICIAL DEL PERFIL DE MOVIMIENTO
 }
 
-//MUEVE X GRADOS Y RETORNA LOS PASOS DADOS
+//MUEVE X GRADOS SIGUIENDO EL PERFIL DE MOVIMIENTO Y RETORNA LOS GRADOS ROTADOS
 float AntennaPositioner::mover()
 {
-    cuenta=0;
-    float aux = ( 360.0 / cantPosiciones );
-    while(((cuenta/n) < aux) && (cuenta >= 0)) {
-        un_paso();
-    }
-    return((cuenta/n));
+    const std::uint64_t repetidosIniciales = encoder.GetStatistics().numOfRepeatedEdges;
+    lastRotation = stepper.Move( 360.0 / cantPosiciones );
+    verificaFlancos(repetidosIniciales);
+    verificaPasos(lastRotation);
+    return(lastRotation.degrees);
+}
+
+//AVISA SI EL ENCODER PUDO HABER PERDIDO FLANCOS DURANTE EL ULTIMO MOVIMIENTO
+void AntennaPositioner::verificaFlancos(const std::uint64_t repetidosIniciales)
+{
+    const std::uint64_t repetidos = encoder.GetStatistics().numOfRepeatedEdges - repetidosIniciales;
+    if(repetidos > 0)
+        cerr << "\nWarning: the encoder of the azimuth rotator may have missed " << repetidos << " edge(s) during the rotation, so the azimuth angle may be wrong." << endl;
+}
+
+//AVISA SI LOS PASOS DADOS NO COINCIDEN CON LAS CUENTAS DEL ENCODER (EL MOTOR PERDIO PASOS O EL ENCODER PERDIO FLANCOS)
+void AntennaPositioner::verificaPasos(const MoveStatistics & giro)
+{
+    if( std::llabs( giro.GetCountError() ) > StepperDriver::MAX_COUNT_ERROR )
+    {
+        cerr << "\nWarning: " << giro.numOfSteps << " steps were given during the rotation (" << giro.expectedCounts << " counts) but the encoder counted ";
+        cerr << giro.counts << " counts, so the motor may have lost steps or the encoder may have missed edges." << endl;
+    }
 }
 
 //ACTUALIZA LOS DATOS ACTUALES
@@ -445,24 +456,22 @@ bool AntennaPositioner::poneEnCero()
 
 bool AntennaPositioner::regresar()
 {
-#ifdef RASPBERRY_PI
-	digitalWrite(piPins.DIRECCION, pinsValues.DIR_ANTIHOR);// REGRESO POR LA IZQUIERDA ANTI HORARIO
-#endif
-	cuenta=0;
+	//EL GIRO ES NEGATIVO, ASI QUE REGRESO POR LA IZQUIERDA ANTI HORARIO
+	const std::uint64_t repetidosIniciales = encoder.GetStatistics().numOfRepeatedEdges;
 	float aux = -((360.0 / cantPosiciones) * (cantPosiciones-1));
-    while(((cuenta/n) >= aux) && (cuenta<=0))
-    {
-        un_paso();
-            if( ( (cuenta/n) > (aux-1) && (cuenta/n) < (aux+2) ) )
-                return true;
-    }
-    return(false);
+	lastRotation = stepper.Move(aux);
+	verificaFlancos(repetidosIniciales);
+	verificaPasos(lastRotation);
+	return( lastRotation.degrees > (aux-1) && lastRotation.degrees < (aux+2) );
 }
 
 //#///////////////////////////////////////////
 
-/*! \param gpsInterf A reference to the object which is responsible for the communication with the Aaronia GPS receiver. */
-AntennaPositioner::AntennaPositioner(GPSInterface & gpsInterf) : gpsInterface(gpsInterf)
+/*! The constructor also creates the move thread, which does the movements started with StartNextPosition(). In the
+ * manual mode the thread is not created, so the messages to the operator are not mixed with the ones of the processing.
+ * \param gpsInterf A reference to the object which is responsible for the communication with the Aaronia GPS receiver.
+ */
+AntennaPositioner::AntennaPositioner(GPSInterface & gpsInterf) : gpsInterface(gpsInterf), stepper(stepperOutput, encoder)
 {
 	inicia_variables();
 
@@ -522,6 +531,41 @@ AntennaPositioner::AntennaPositioner(GPSInterface & gpsInterf) : gpsInterface(gp
 	while( !ifs.eof() );
 
 	ifs.close();
+
+	//The move thread is created at the end, so it is not left running if the reading of the file fails
+	moveThread=0;
+	flagMoveThread=false;
+	flagStopMoving=false;
+	flagMoveRequested=false;
+	flagMoving=false;
+	lastMoveTime=0.0;
+	pthread_mutex_init(&moveMutex, NULL);
+	pthread_cond_init(&moveCond, NULL);
+#ifndef MANUAL
+	if( pthread_create(&moveThread, NULL, MoveThreadFunc, (void*)this)==0 )
+		flagMoveThread=true;
+	else
+		cerr << "\nWarning: the move thread of the antenna positioner could not be created, so the antenna will be moved synchronously." << endl;
+#endif
+}
+
+/*!	The move thread finishes once the current movement, if any, has finished. A movement which was requested but not
+ * started yet is discarded, so its future gets a `std::future_error` exception (broken promise).
+ */
+AntennaPositioner::~AntennaPositioner()
+{
+	if(flagMoveThread)
+	{
+		pthread_mutex_lock(&moveMutex);
+		flagStopMoving=true;
+		pthread_cond_signal(&moveCond);
+		pthread_mutex_unlock(&moveMutex);
+
+		pthread_join(moveThread, NULL);
+		flagMoveThread=false;
+	}
+	pthread_mutex_destroy(&moveMutex);
+	pthread_cond_destroy(&moveCond);
 }
 
 /*! \return A value of the enumeration 'Polarization'. 	*/
@@ -551,3 +595,117 @@ std::string AntennaPositioner::GetPolarizationString() const
 		return "unknown";
 	}
 }
+
+/*!	The LEDs of the polarization and of the next position are turned on while the corresponding movement is done. The
+ * statistics of the azimuth rotation are cleared first, so they are empty if the antenna was not rotated.
+ * \return A `true` if the operations were successful or a `false` otherwise.
+ */
+bool AntennaPositioner::MoveToNextPosition()
+{
+	const auto startTime = std::chrono::steady_clock::now();
+	lastRotation = {};
+
+#ifdef RASPBERRY_PI
+	digitalWrite(piPins.LED_POLARIZ, pinsValues.LED_POL_ON);
+#endif
+	bool flagSuccess = ChangePolarization();
+#ifdef RASPBERRY_PI
+	digitalWrite(piPins.LED_POLARIZ, pinsValues.LED_POL_OFF);
+#endif
+
+	if( GetPolarization()==Polarization::HORIZONTAL )
+	{
+#ifdef RASPBERRY_PI
+		digitalWrite(piPins.LED_NEXT_POS, pinsValues.LED_NEXT_POS_ON);
+#endif
+		flagSuccess = NextAzimPosition() && flagSuccess;
+#ifdef RASPBERRY_PI
+		digitalWrite(piPins.LED_NEXT_POS, pinsValues.LED_NEXT_POS_OFF);
+#endif
+	}
+
+	lastMoveTime = std::chrono::duration<double>( std::chrono::steady_clock::now() - startTime ).count();
+	return flagSuccess;
+}
+
+/*!	The thread waits for a requested movement, does it and satisfies its promise with the result or with the exception
+ * which was thrown, so the error is received by the thread which waits for the future.
+ */
+void AntennaPositioner::ProcessMoves()
+{
+	pthread_mutex_lock(&moveMutex);
+	while(!flagStopMoving)
+	{
+		if(!flagMoveRequested)
+		{
+			pthread_cond_wait(&moveCond, &moveMutex);
+			continue;
+		}
+		flagMoveRequested=false;
+		std::promise<bool> promise( std::move(movePromise) );
+		pthread_mutex_unlock(&moveMutex);
+
+		bool flagSuccess=false;
+		std::exception_ptr excPtr;
+		try
+		{
+			flagSuccess = MoveToNextPosition();
+		}
+		catch(...)
+		{
+			excPtr = std::current_exception();
+		}
+
+		//The flag is cleared before the promise is satisfied, so a new movement can be started as soon as the future is ready
+		pthread_mutex_lock(&moveMutex);
+		flagMoving=false;
+		pthread_mutex_unlock(&moveMutex);
+
+		if(excPtr)
+			promise.set_exception(excPtr);
+		else
+			promise.set_value(flagSuccess);
+
+		pthread_mutex_lock(&moveMutex);
+	}
+	pthread_mutex_unlock(&moveMutex);
+}
+
+/*!	The movement is the one which follows the capture of each sweep: the polarization is changed and, if it becomes
+ * horizontal, the antenna is moved to the next azimuth position. It is done by the move thread, so it overlaps the
+ * processing, the logging and the archiving of the last sweep, and the future must be waited before the next sweep is
+ * captured. The position and the polarization must not be queried until the future is ready. If there is no move
+ * thread, the movement is done in the calling thread and the returned future is already ready.
+ * \return A future which gets the result of the movement, `true` if it was successful, or the exception which was thrown.
+ */
+std::future<bool> AntennaPositioner::StartNextPosition()
+{
+	if(!flagMoveThread)
+	{
+		std::promise<bool> promise;
+		try
+		{
+			promise.set_value( MoveToNextPosition() );
+		}
+		catch(...)
+		{
+			promise.set_exception( std::current_exception() );
+		}
+		return promise.get_future();
+	}
+
+	pthread_mutex_lock(&moveMutex);
+	if(flagMoving)
+	{
+		pthread_mutex_unlock(&moveMutex);
+		throw rfims_exception("a movement of the antenna was started before the previous one finished.");
+	}
+	movePromise = std::promise<bool>();
+	std::future<bool> future = movePromise.get_future();
+	flagMoveRequested=true;
+	flagMoving=true;
+	pthread_cond_signal(&moveCond);
+	pthread_mutex_unlock(&moveMutex);
+
+	return future;
+}
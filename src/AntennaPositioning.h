@@ -6,7 +6,7 @@
  */
 
 /*! \file AntennaPositioning.h
- * 	\brief This file contains the declarations of classes AntennaPositioner and GPSInterface.
+ * 	\brief This file contains the declarations of classes AntennaPositioner, StepperDriver, StepperOutput, GPIOStepperOutput, SimulatedStepperOutput, MotionProfile, EncoderCounter, SimulatedEncoder, GPSInterface, GPSRecorder, GPSTransport, FTDITransport, EmulatedGPSTransport, GPSClock, AttitudeFilter, SentenceBuffer, SentenceParser and SeqLock.
  *
  *	These classes are responsible for the positioning of the antenna, which can rotate its azimuth
  *	angle and its polarization. To model these rotations it were used the Cardan angles (or nautical angles):
@@ -27,11 +27,15 @@
 
 #include "Basics.h"
 
-#include <nmea.h> //Library "libnmea", which simplify the parsing of the GPS data which follows the NMEA 0180 syntax.
-#include <nmea/gprmc.h> //Parser of GPRMC sentences.
-#include <nmea/gpgga.h> //Parser of GPGGA sentences.
 #include <ftd2xx.h> //FTDI library, for the communication with the GPS receiver
+#include <atomic> //std::atomic, to share the GPS data between threads without locks
+#include <type_traits> //std::is_trivially_copyable
+#include <ctime> //clock_gettime(), to read the monotonic clock which is disciplined with the GPS time
 #include <dirent.h> //To get filenames
+#include <random> //std::mt19937, for the delays and the noise of the emulated GPS receiver
+#include <deque> //std::deque, for the replies which are transmitted by the emulated GPS receiver
+#include <memory> //std::unique_ptr, for the transport which is created by the class GPSInterface
+#include <future> //std::promise and std::future, for the movements of the antenna which are done by the move thread
 
 //! A structure intended to save the the values of the 3d sensors which are integrated in the GPS receiver.
 typedef struct
@@ -52,9 +56,514 @@ typedef struct
 	double longitude; //!< The longitude angle represented in decimal degrees. This angle becomes negative in the western hemisphere.
 } GPSCoordinates;
 
+//! The class _SentenceBuffer_ accumulates the bytes which are received from the GPS receiver and splits them in sentences.
+/*!	The reading function writes the received bytes directly in the buffer, using the methods GetWriteBuffer() and
+ * Commit(), so all the available bytes can be read with just one call to the D2XX function FT_Read(). Then, each
+ * complete sentence (NMEA or PAAG), which ends with the character '\n', is given by the method NextSentence() as a
+ * pointer to the buffer and a length, without copying it. The incomplete sentence at the end of the buffer is kept for
+ * the next reading, and it is moved to the start of the buffer when the free space at the end becomes small, so only
+ * the bytes of one partial sentence are copied and the sentences are always contiguous in memory, what would not
+ * happen with a circular buffer.
+ */
+class SentenceBuffer
+{
+	//Attributes//
+	std::vector<char> buffer; //!< The memory where the received bytes are written.
+	std::size_t readPos; //!< The position of the first byte which has not been given as part of a sentence yet.
+	std::size_t scanPos; //!< The position from which the character '\n' must be searched, so the partial sentences are not searched again.
+	std::size_t writePos; //!< The position where the next received bytes must be written.
+public:
+	//Class Interface//
+	//! The constructor of the class _SentenceBuffer_, which receives the size of the buffer, in bytes.
+	SentenceBuffer(const std::size_t size=4096) : buffer(size), readPos(0), scanPos(0), writePos(0) {}
+	//! This method returns a pointer to the position where the received bytes must be written and the free space there.
+	char * GetWriteBuffer(std::size_t & freeSpace);
+	//! This method states the given number of bytes were written at the position returned by the method GetWriteBuffer().
+	void Commit(const std::size_t numOfBytes) {	writePos += std::min( numOfBytes, buffer.size() - writePos );	}
+	//! This method gives the next complete sentence, including the final characters "\r\n", if there is one.
+	bool NextSentence(const char * & sentence, std::size_t & length);
+	//! This method discards all the bytes of the buffer, for example when the input buffer of the USB interface is purged.
+	void Clear() {	readPos=scanPos=writePos=0;	}
+	//! This method returns the number of bytes which have been received but have not been given as part of a sentence yet.
+	std::size_t Size() const {	return( writePos - readPos );	}
+};
 
-//! The class _GPSInterace_ is intended to establish the communication with the Aaronia GPS receiver, to request and capture messages from this one and extract useful data from the messages.
-class GPSInterface
+
+//! A structure which saves the fields of a sentence of the GPS receiver, which are extracted by the class _SentenceParser_.
+struct GPSSentence
+{
+	//! An enumeration with the types of sentences which are interpreted: GPRMC, GPGGA and PAAG,DATA,{G,C,T,B}.
+	enum SentenceType : char { GPRMC, GPGGA, PAAG_GYRO, PAAG_COMPASS, PAAG_ACCELER, PAAG_BAROM, UNKNOWN };
+	SentenceType type; //!< The type of the sentence.
+	char status; //!< The last character before the asterisk, which is 'A' or 'a' when the data are valid.
+	const char * time; //!< A pointer to the time field (HHMMSS.NNN) inside the sentence, which is not copied.
+	std::size_t timeLength; //!< The number of characters of the time field.
+	unsigned int hour; //!< The UTC hour of a GPRMC or GPGGA sentence.
+	unsigned int minute; //!< The UTC minute of a GPRMC or GPGGA sentence.
+	unsigned int second; //!< The UTC second of a GPRMC or GPGGA sentence.
+	unsigned int nanosecond; //!< The fraction of the UTC second of a GPRMC or GPGGA sentence, in nanoseconds.
+	unsigned int day; //!< The UTC day of a GPRMC sentence.
+	unsigned int month; //!< The UTC month, from 1 to 12, of a GPRMC sentence.
+	unsigned int year; //!< The UTC year, with four digits, of a GPRMC sentence.
+	double latitude; //!< The latitude in decimal degrees of a GPRMC or GPGGA sentence, which is negative in the southern hemisphere.
+	double longitude; //!< The longitude in decimal degrees of a GPRMC or GPGGA sentence, which is negative in the western hemisphere.
+	unsigned int numOfSatellites; //!< The number of satellites of a GPGGA sentence.
+	double altitude; //!< The altitude over the sea level of a GPGGA sentence, in meters.
+	double x; //!< The raw x-axis value of a PAAG,DATA,{G,C,T} sentence.
+	double y; //!< The raw y-axis value of a PAAG,DATA,{G,C,T} sentence.
+	double z; //!< The raw z-axis value of a PAAG,DATA,{G,C,T} sentence.
+	double pressure; //!< The pressure of a PAAG,DATA,B sentence, in hPa.
+};
+
+
+//! The class _SentenceParser_ interprets the sentences of the GPS receiver without copying them and without allocating memory.
+/*!	The sentence is scanned just once: while the checksum is calculated, each field is interpreted as soon as its
+ * delimiter is found, depending on the type of the sentence, which is identified by its first characters. The numbers
+ * are converted with integer arithmetic, so the decimal values with up to 15 significant digits are rounded exactly
+ * as the streams do.
+ */
+class SentenceParser
+{
+	//! This method interprets an unsigned integer. An empty field gives zero.
+	static bool ParseUnsigned(const char * begin, const char * end, unsigned int & value);
+	//! This method interprets a decimal number, with an optional sign. An empty field gives zero.
+	static bool ParseDecimal(const char * begin, const char * end, double & value);
+	//! This method interprets a field with two-digit numbers (HHMMSS or DDMMYY), followed by an optional fractional part.
+	static bool ParseTriplet(const char * begin, const char * end, unsigned int & first, unsigned int & second, unsigned int & third,
+			unsigned int * nanosecond=nullptr);
+	//! This method interprets a latitude (DDMM.MMMM) or a longitude (DDDMM.MMMM), giving the angle in decimal degrees.
+	static bool ParseCoordinate(const char * begin, const char * end, double & angle);
+	//! This method interprets a field of a sentence, depending on the type of the sentence and the position of the field.
+	static bool ParseField(GPSSentence & fields, const unsigned int fieldIndex, const char * begin, const char * end);
+	//! This method returns the value of a hexadecimal digit, or a negative value if the character is not one.
+	static int HexValue(const char c);
+public:
+	//! This method checks the checksum of a sentence and extracts all its fields.
+	static bool Parse(const char * sentence, const std::size_t length, GPSSentence & fields);
+	//! This method just checks the checksum of a sentence, whatever its type is.
+	static bool ControlChecksum(const char * sentence, const std::size_t length);
+};
+
+
+//! The class template _SeqLock_ shares a value between one writer thread and several reader threads without locks.
+/*!	The writer increments a sequence counter before and after modifying the value, so the counter is odd while the value
+ * is being modified. A reader copies the value and then checks the counter was even and it did not change; otherwise the
+ * copy could be torn and it is repeated. The writer never waits for the readers, and the readers only retry while a
+ * write is in progress. The value is kept as an array of atomic words which are accessed with relaxed operations, so
+ * the concurrent copies are not data races; that is why the type must be trivially copyable.
+ */
+template<class T>
+class SeqLock
+{
+	static_assert( std::is_trivially_copyable<T>::value, "The type shared by a SeqLock must be trivially copyable." );
+
+	//Constants
+	static const std::size_t NUM_OF_WORDS = ( sizeof(T) + sizeof(std::uint64_t) - 1 ) / sizeof(std::uint64_t); //!< The number of words which are needed to save the value.
+	//Variables
+	std::atomic<std::uint64_t> sequence; //!< The sequence counter, which is odd while the value is being modified.
+	std::atomic<std::uint64_t> words[NUM_OF_WORDS]; //!< The words where the value is saved.
+public:
+	//! The default constructor, which saves a value-initialized object.
+	SeqLock() : sequence(0) {	Store( T() );	}
+	//! This method saves a new value. Only one thread may call this method at a time.
+	void Store(const T & value)
+	{
+		std::uint64_t buffer[NUM_OF_WORDS] = {};
+		std::memcpy(buffer, &value, sizeof(T));
+
+		const std::uint64_t seq = sequence.load(std::memory_order_relaxed);
+		sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for(std::size_t i=0; i<NUM_OF_WORDS; i++)
+			words[i].store(buffer[i], std::memory_order_relaxed);
+		sequence.store(seq + 2, std::memory_order_release);
+	}
+	//! This method returns a coherent copy of the last saved value.
+	T Load() const
+	{
+		std::uint64_t buffer[NUM_OF_WORDS];
+		std::uint64_t seqBefore, seqAfter;
+		do
+		{
+			seqBefore = sequence.load(std::memory_order_acquire);
+			for(std::size_t i=0; i<NUM_OF_WORDS; i++)
+				buffer[i] = words[i].load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			seqAfter = sequence.load(std::memory_order_relaxed);
+		}while( (seqBefore & 1) || seqBefore!=seqAfter );
+
+		T value;
+		std::memcpy(&value, buffer, sizeof(T));
+		return value;
+	}
+};
+
+
+//! A structure with the attitude angles which are estimated by the class _AttitudeFilter_ and their uncertainties.
+struct AttitudeEstimate
+{
+	double yaw; //!< The estimated yaw angle, measured in degrees and whose range is 0 to 359.
+	double pitch; //!< The estimated pitch angle, measured in degrees and whose range is -180 to 180.
+	double roll; //!< The estimated roll angle, measured in degrees and whose range is -180 to 180.
+	double yawDeviation; //!< The standard deviation of the yaw angle, in degrees, which states the confidence of the estimate.
+	double pitchDeviation; //!< The standard deviation of the pitch angle, in degrees.
+	double rollDeviation; //!< The standard deviation of the roll angle, in degrees.
+	bool flagValid; //!< A flag which states if the three angles have been measured at least once.
+};
+
+
+//! The class _AttitudeFilter_ fuses the data of the gyroscope, the compass and the accelerometer in a low-noise estimate of the attitude angles.
+/*!	Each angle has a one-dimensional Kalman filter, whose state is the angle and its variance. The samples of the
+ * gyroscope predict the change of the angles and increase their variance, and the angles which are calculated from
+ * each compass sample (yaw) and each accelerometer sample (pitch and roll) correct them. The variance of the
+ * accelerometer angles grows when the measured acceleration differs from 1 g, since the device is not still then.
+ *
+ * The axes and the signs of the gyroscope with respect to the angles depend on how the GPS receiver is mounted, so
+ * they are learned: the change of each measured angle is correlated with the rotation given by each axis of the
+ * gyroscope, and the axis with the largest correlation is used once it clearly dominates. Until then, the rotation
+ * rates just increase the variance, so a moving antenna is followed faster. Besides, an innovation larger than three
+ * standard deviations is considered a movement which was not predicted, and the variance is increased accordingly,
+ * so the estimate jumps to the new angle instead of approaching it slowly.
+ */
+class AttitudeFilter
+{
+	//Attributes//
+	//Constants
+	//! The indexes of the filtered angles.
+	enum Angle : unsigned int { YAW, PITCH, ROLL, NUM_OF_ANGLES };
+	static const std::int64_t MAX_GYRO_INTERVAL = 1000000000; //!< The maximum interval between two gyroscope samples which are integrated, in nanoseconds.
+	const double YAW_DEVIATION = 2.0; //!< The standard deviation of the yaw angle which is calculated from one compass sample, in degrees.
+	const double TILT_DEVIATION = 1.0; //!< The standard deviation of the pitch and roll angles which are calculated from one accelerometer sample, in degrees.
+	const double ACCELER_DEVIATION_GAIN = 100.0; //!< The standard deviation which is added to the pitch and roll angles per g of difference with the gravity, in degrees.
+	const double GYRO_DEVIATION = 1.0; //!< The uncertainty of the rates of the gyroscope, in degrees/s.
+	const double RANDOM_WALK = 1.0; //!< The uncertainty which is added to the angles as time goes by, in degrees per square root of second.
+	const double MIN_CORRELATION = 200.0; //!< The minimum correlation between an angle and an axis of the gyroscope to use this one, in square degrees.
+	const double GATE = 3.0; //!< The number of standard deviations beyond which an innovation is considered an unpredicted movement.
+	//! The state of the filter of one angle.
+	struct AngleState
+	{
+		double angle; //!< The estimated angle, in degrees.
+		double variance; //!< The variance of the estimated angle, in square degrees.
+		std::int64_t lastUpdateTime; //!< The instant of the last prediction or correction, in nanoseconds.
+		double lastMeasurement; //!< The last measured angle, in degrees.
+		double rotations[3]; //!< The rotations given by each axis of the gyroscope since the last measurement, in degrees.
+		double correlations[3]; //!< The correlations between the changes of the measured angle and the rotations of each axis, in square degrees.
+		bool flagInitialized; //!< A flag which states if the angle has been measured at least once.
+	};
+	//Variables
+	AngleState states[NUM_OF_ANGLES]; //!< The states of the filters of the yaw, pitch and roll angles.
+	double lastRates[3]; //!< The rates of the last gyroscope sample, in degrees/s.
+	std::int64_t lastGyroTime; //!< The instant of the last gyroscope sample, in nanoseconds.
+	bool flagGyroData; //!< A flag which states if a gyroscope sample has been received.
+
+	//Private methods//
+	//! This method increases the variance of an angle with the time since its last update.
+	void AddRandomWalk(AngleState & state, const std::int64_t time);
+	//! This method corrects an angle with a measurement, whose standard deviation is given.
+	void Correct(const Angle angleIndex, const std::int64_t time, const double measurement, const double deviation);
+	//! This method gives the axis of the gyroscope which corresponds to an angle, and its sign, or a negative value if it is not known yet.
+	int GetGyroAxis(const AngleState & state, double & sign) const;
+	//! This method takes an angle to the range of the given angle: 0 to 360 for the yaw and -180 to 180 for the others.
+	static double WrapAngle(const double angle, const Angle angleIndex);
+
+public:
+	//Class Interface//
+	//! The default constructor of the class _AttitudeFilter_.
+	AttitudeFilter() {	Reset();	}
+	//! This method predicts the angles with a gyroscope sample, whose rates are given in degrees/s.
+	void AddGyroData(const std::int64_t time, const double x, const double y, const double z);
+	//! This method corrects the yaw angle with the one which was calculated from a compass sample.
+	void AddYaw(const std::int64_t time, const double yaw);
+	//! This method corrects the pitch and roll angles with the ones which were calculated from an accelerometer sample.
+	void AddTilt(const std::int64_t time, const double pitch, const double roll, const double accelMagnitude);
+	//! This method returns the current estimate of the angles.
+	AttitudeEstimate GetEstimate() const;
+	//! This method discards the state of the filter.
+	void Reset();
+};
+
+
+//! A structure with a coherent set of the data of the GPS receiver: time, position and attitude, among others.
+/*!	The class _GPSInterface_ publishes a whole snapshot after each interpreted data reply, so a reader gets all the
+ * values of the same instant with just one call. The numbers of replies allow to know which data are new: a reader
+ * keeps the numbers of the last snapshot it used and compares them with the ones of a new snapshot. There is no dynamic
+ * memory in the structure, so it can be shared with the class _SeqLock_.
+ */
+struct GPSSnapshot
+{
+	//! The values of a 3D sensor, as they are saved in the structure _Data3D_.
+	struct Values3D
+	{
+		double x; //!< The x-axis value.
+		double y; //!< The y-axis value.
+		double z; //!< The z-axis value.
+		char time[16]; //!< The time of the measurement, HHMMSS.NNN, ended by a null character.
+	};
+
+	std::uint64_t generation; //!< The number of snapshots which have been published before this one, including it.
+	std::uint64_t numOfReplies[GPSSentence::UNKNOWN]; //!< The number of data replies of each type (indexed by _GPSSentence::SentenceType_) whose data were extracted.
+	unsigned int year, month, day, hour, minute, second; //!< The time data which were received from the GPS satellites.
+	GPSCoordinates coordinates; //!< The GPS coordinates which were received from the GPS satellites.
+	unsigned int numOfSatellites; //!< The number of satellites which the GPS receiver is connected with.
+	unsigned int gpsElevation; //!< The elevation of the GPS receiver over the sea level, measured in meters (m) and based on GPS data.
+	Values3D gyroData; //!< The processed 3D values of the gyroscope, measured in degrees/s.
+	Values3D compassData; //!< The processed 3D values of the compass, measured in Gauss.
+	Values3D accelData; //!< The processed 3D values of the accelerometer.
+	double yaw; //!< The yaw angle, measured in degrees and whose range is 0 to 359.
+	double pitch; //!< The pitch angle, measured in degrees and whose range is -180 to 180.
+	double roll; //!< The roll angle, measured in degrees and whose range is -180 to 180.
+	float pressure; //!< The ambient pressure, measured in hectopascal (hPa).
+	float presElevation; //!< The elevation of the GPS receiver over the sea level, measured in meters (m) and based on the ambient pressure.
+	AttitudeEstimate attitude; //!< The attitude angles which are estimated by fusing the data of the three sensors.
+
+	//! This method returns the time data of the snapshot as a _TimeData_ object.
+	TimeData GetTimeData() const
+	{
+		TimeData timeData;
+		timeData.year=year; timeData.month=month; timeData.day=day;
+		timeData.hour=hour; timeData.minute=minute; timeData.second=second;
+		return timeData;
+	}
+	//! This method returns the values of one of the 3D sensors as a _Data3D_ structure.
+	Data3D GetData3D(const Data3D::SensorType sensor) const
+	{
+		const Values3D & values = ( sensor==Data3D::GYROSCOPE ? gyroData : ( sensor==Data3D::COMPASS ? compassData : accelData ) );
+		return Data3D{ sensor, values.time, values.x, values.y, values.z };
+	}
+};
+
+
+//! A structure with a time point given by the class _GPSClock_ and its estimated error.
+struct GPSTimestamp
+{
+	//! The offset of the local time of the timestamps with respect to UTC (UTC-3), the same one which is applied to the time data of the GPRMC replies.
+	static const std::int64_t LOCAL_TIME_OFFSET = -3LL*3600*1000000000;
+
+	std::int64_t utcTime; //!< The UTC time, in nanoseconds since 01-01-1970T00:00:00.
+	std::int64_t estimatedError; //!< The estimated maximum error of the UTC time, in nanoseconds.
+	bool flagSynchronized; //!< A flag which states if the clock had received GPS time recently, so the time and its error are meaningful.
+
+	//! This method returns the local time of the timestamp as a _TimeData_ object, with the fraction of the second.
+	TimeData GetTimeData() const;
+};
+
+
+//! The class _GPSClock_ gives the GPS time (UTC) of any instant of the monotonic clock of the system, without waiting for the GPS receiver.
+/*!	Each GPRMC reply which is received while the streaming is enabled gives a sample: the UTC time of the reply and the
+ * instant, measured with the clock `CLOCK_MONOTONIC`, when the reply started to be received. The difference between
+ * both is the offset of the monotonic clock, but a sample is delayed by the output of the reply, the USB latency and the
+ * scheduling of the streaming thread, so the offset is always underestimated by a variable amount. That is why the
+ * offset is estimated as the largest one of the last samples (the least delayed), after correcting them with the drift
+ * of the monotonic clock. The drift is estimated with a linear regression of anchors, which are the least delayed samples
+ * of each block of samples, so it uses a long baseline with little delay jitter; until there are enough anchors, the
+ * regression uses all the last samples. The estimated error is the gap
+ * between that offset and the median one, plus the uncertainty of the drift multiplied by the time since the last
+ * sample. The clock model is shared through a seqlock, so a timestamp just takes one reading of the monotonic clock
+ * and a few arithmetic operations, from any thread.
+ */
+class GPSClock
+{
+	//Attributes//
+	//Constants
+	static const unsigned int NUM_OF_SAMPLES = 32; //!< The number of last samples which are used to estimate the offset.
+	static const unsigned int SAMPLES_PER_ANCHOR = 16; //!< The number of samples of each block from which an anchor is taken.
+	static const unsigned int NUM_OF_ANCHORS = 64; //!< The number of last anchors which are used to estimate the drift.
+	static const std::int64_t MAX_STEP = 1000000000; //!< The maximum difference between a sample and the prediction of the model, in nanoseconds, before the samples are discarded.
+	static const std::int64_t HOLDOVER_TIME = 600LL*1000000000; //!< The time after the last sample during which the clock is still considered synchronized, in nanoseconds.
+	static const std::int64_t INITIAL_ERROR = 50000000; //!< The minimum error of the offset while there are fewer than four samples, in nanoseconds.
+	const double MAX_DRIFT = 500e-6; //!< The maximum drift of the monotonic clock which is accepted, in seconds per second.
+	//! A sample of the offset between the UTC time and the monotonic clock.
+	struct SyncSample
+	{
+		std::int64_t monotonicTime; //!< The instant of the monotonic clock when the reply started to be received, in nanoseconds.
+		std::int64_t utcTime; //!< The UTC time of the reply, in nanoseconds since 01-01-1970T00:00:00.
+	};
+	//! The model of the monotonic clock which is estimated from the samples and used to give the timestamps.
+	struct ClockModel
+	{
+		std::uint64_t numOfSamples; //!< The total number of samples which were used, which is zero when the clock was never synchronized.
+		std::int64_t refMonotonicTime; //!< The instant of the monotonic clock of the last sample, in nanoseconds.
+		std::int64_t refOffset; //!< The offset (UTC time minus monotonic time) at the reference instant, in nanoseconds.
+		double drift; //!< The drift of the monotonic clock with respect to the UTC time, in seconds per second.
+		double driftError; //!< The uncertainty of the drift, in seconds per second.
+		std::int64_t offsetError; //!< The estimated error of the offset at the reference instant, in nanoseconds.
+	};
+	//Variables
+	SyncSample samples[NUM_OF_SAMPLES]; //!< The last samples, in a circular buffer, which are only used by the thread which adds them.
+	unsigned int numOfStoredSamples; //!< The number of valid samples in the circular buffer.
+	unsigned int nextSample; //!< The position of the circular buffer where the next sample will be saved.
+	SyncSample anchors[NUM_OF_ANCHORS]; //!< The last anchors, in a circular buffer.
+	unsigned int numOfStoredAnchors; //!< The number of valid anchors in the circular buffer.
+	unsigned int nextAnchor; //!< The position of the circular buffer where the next anchor will be saved.
+	SyncSample blockBestSample; //!< The least delayed sample of the current block, which will be the next anchor.
+	unsigned int numOfBlockSamples; //!< The number of samples of the current block.
+	ClockModel lastModel; //!< The last estimated model, which is only used by the thread which adds the samples.
+	SeqLock<ClockModel> sharedModel; //!< The published model, which is read by any thread without locks.
+
+	//Private methods//
+	//! This method estimates the drift, and its uncertainty, with a linear regression of the offsets of the given samples.
+	static bool EstimateDrift(const SyncSample * syncSamples, const unsigned int numOfSyncSamples, const std::int64_t refMonotonicTime,
+			double & drift, double & driftError);
+
+public:
+	//Class Interface//
+	//! The default constructor of the class _GPSClock_, which starts without any sample.
+	GPSClock() {	Reset();	}
+	//! This method adds a sample, given by the instant when a GPRMC reply started to be received and its UTC time.
+	void AddSample(const std::int64_t monotonicTime, const std::int64_t utcTime);
+	//! This method returns the timestamp of the given instant of the monotonic clock.
+	GPSTimestamp GetTimestamp(const std::int64_t monotonicTime) const;
+	//! This method returns the timestamp of the current instant.
+	GPSTimestamp Now() const {	return GetTimestamp( MonotonicTime() );	}
+	//! This method states if the clock has received GPS time recently.
+	bool IsSynchronized() const {	return Now().flagSynchronized;	}
+	//! This method discards all the samples, for example when the GPS receiver is reinitialized.
+	void Reset();
+	//! This method returns the current instant of the monotonic clock of the system, in nanoseconds.
+	static std::int64_t MonotonicTime();
+	//! This method converts a date and a time, in UTC, to nanoseconds since 01-01-1970T00:00:00.
+	static std::int64_t ToUTCTime(const unsigned int year, const unsigned int month, const unsigned int day, const unsigned int hour,
+			const unsigned int minute, const unsigned int second, const unsigned int nanosecond);
+	//! This method converts a time given in nanoseconds since 01-01-1970T00:00:00 to a _TimeData_ object.
+	static TimeData ToTimeData(const std::int64_t time);
+};
+
+
+//! A record of the GPS recorder, with the position and the attitude of the GPS receiver at an instant.
+/*!	Each record has the whole state after the interpretation of a streamed reply, so any record gives the position and
+ * the attitude at its instant. The records have a fixed size of 64 bytes, which is a divisor of the page size, so a
+ * record is never split between two pages of the file. */
+struct GPSRecord
+{
+	std::int64_t utcTime; //!< The UTC time of the reception of the reply, given by the GPS clock, in nanoseconds since 01-01-1970T00:00:00.
+	std::int32_t latitude; //!< The latitude, in units of 1e-7 degrees, which is negative in the southern hemisphere.
+	std::int32_t longitude; //!< The longitude, in units of 1e-7 degrees, which is negative in the western hemisphere.
+	float gpsElevation; //!< The elevation over the sea level, based on GPS data, in meters.
+	float pressure; //!< The ambient pressure, in hPa.
+	float presElevation; //!< The elevation over the sea level, based on the ambient pressure, in meters.
+	float yaw; //!< The yaw angle estimated by the attitude filter, in degrees.
+	float pitch; //!< The pitch angle estimated by the attitude filter, in degrees.
+	float roll; //!< The roll angle estimated by the attitude filter, in degrees.
+	float yawDeviation; //!< The standard deviation of the yaw angle, in degrees.
+	float pitchDeviation; //!< The standard deviation of the pitch angle, in degrees.
+	float rollDeviation; //!< The standard deviation of the roll angle, in degrees.
+	std::uint8_t replyType; //!< The type of the reply (a value of `GPSSentence::SentenceType`) after which the record was appended.
+	std::uint8_t numOfSatellites; //!< The number of satellites which the GPS receiver is connected with.
+	std::uint8_t flagAttitudeValid; //!< A flag which states if the three attitude angles were estimated.
+	std::uint8_t reserved; //!< A byte which is reserved for future versions.
+	std::uint64_t sequence; //!< The number of the record since the file was created, starting from 1, which is written the last.
+};
+
+static_assert( sizeof(GPSRecord)==64, "The records of the GPS recorder must have 64 bytes." );
+
+
+//! The class _GPSRecorder_ records the position and the attitude of the GPS receiver in a binary ring file, so they can be looked up by time afterwards.
+/*!	The file has a header of 64 bytes followed by a fixed number of records, so its size, which is reserved when it is
+ * created, is the disk budget: when the file is full, each record overwrites the oldest one. The file is mapped into
+ * memory, so the method Append(), which is called by the streaming thread of the class _GPSInterface_, just copies the
+ * record to the mapped pages, without system calls, and the kernel writes them back to the storage device.
+ *
+ * Each record is written as with a seqlock: its sequence number is cleared, the other fields are written and then the
+ * sequence number is set, so a reader, in this process or in other one, detects a record which is being overwritten.
+ * The times of the records never decrease, so the record of an instant is found with a binary search over the ring,
+ * whose cost only depends on the logarithm of the number of records. When the file is opened again, the records which
+ * follow the number of records of the header, which is updated after each record, are recovered.
+ */
+class GPSRecorder
+{
+	//Attributes//
+	//Constants
+	static const char MAGIC[8]; //!< The characters which identify the files of the GPS recorder.
+	static const std::uint32_t VERSION = 1; //!< The version of the format of the file.
+	static const std::uint64_t MIN_NUM_OF_RECORDS = 64; //!< The minimum number of records of the file.
+	//! The header of the file.
+	struct FileHeader
+	{
+		char magic[8]; //!< The characters "RFIMSGPS".
+		std::uint32_t version; //!< The version of the format of the file.
+		std::uint32_t recordSize; //!< The size of each record, in bytes.
+		std::uint64_t capacity; //!< The number of records of the ring.
+		std::uint64_t numOfRecords; //!< The number of records which were appended since the file was created.
+		char reserved[32]; //!< Bytes which are reserved for future versions.
+	};
+	//Variables
+	std::string filePath; //!< The path of the file.
+	int fileDescriptor; //!< The file descriptor of the file.
+	bool flagReadOnly; //!< A flag which states if the file was opened just to look up the records.
+	void * mapAddr; //!< The address where the file is mapped.
+	std::size_t mapSize; //!< The size of the mapping, which is the size of the file.
+	FileHeader * header; //!< The header of the file, in the mapping.
+	GPSRecord * records; //!< The ring of records, in the mapping.
+	std::uint64_t capacity; //!< The number of records of the ring.
+	std::atomic<std::uint64_t> numOfRecords; //!< The number of records which were appended since the file was created.
+	std::int64_t lastTime; //!< The time of the last record, in nanoseconds, which is only used by the thread which appends the records.
+
+	//Private methods//
+	//! This method creates a new file with the given number of records.
+	void CreateFile(const std::uint64_t numOfRecs);
+	//! This method maps the file into memory and checks its header.
+	bool MapFile(const std::uint64_t expectedCapacity);
+	//! This method unmaps and closes the file.
+	void CloseFile();
+	//! This method copies the record with the given sequence number, returning `false` if it was overwritten or it is being written.
+	bool ReadRecord(const std::uint64_t sequence, GPSRecord & record) const;
+	//! This method returns the number of records of the file, which is read from the header when the file is opened just to look up the records.
+	std::uint64_t LoadNumOfRecords() const;
+	//! This method returns the sequence number of the oldest record which can be looked up, given the number of records.
+	std::uint64_t GetFirstSequence(const std::uint64_t numOfRecs) const {	return( numOfRecs > capacity ? numOfRecs - capacity + 2 : 1 );	}
+	//! This method finds the last record whose time is not later than the given one and returns its sequence number, or zero if there is not one.
+	std::uint64_t FindSequence(const std::int64_t utcTime, GPSRecord & record) const;
+public:
+	//Class Interface//
+	//! The constructor of the class _GPSRecorder_, which opens or creates the file with the given disk budget.
+	GPSRecorder(const std::string & path, const std::uint64_t maxSize);
+	//! The constructor of the class _GPSRecorder_ which opens an existing file just to look up its records.
+	explicit GPSRecorder(const std::string & path);
+	//! The destructor of the class _GPSRecorder_.
+	~GPSRecorder() {	CloseFile();	}
+	//! This method appends a record, overwriting the oldest one if the file is full. Only one thread may call this method.
+	void Append(const GPSRecord & record);
+	//! This method finds the last record whose time is not later than the given one.
+	bool Find(const std::int64_t utcTime, GPSRecord & record) const;
+	//! This method copies the records whose times are in the given interval, in order.
+	std::size_t GetRecords(const std::int64_t startTime, const std::int64_t stopTime, std::vector<GPSRecord> & recs) const;
+	//! This method copies the oldest record which can be looked up.
+	bool GetOldestRecord(GPSRecord & record) const;
+	//! This method returns the number of records which can be looked up.
+	std::uint64_t GetNumOfStoredRecords() const {	return std::min( LoadNumOfRecords(), capacity );	}
+	//! This method returns the number of records of the ring.
+	std::uint64_t GetCapacity() const {	return capacity;	}
+	//! This method returns the path of the file.
+	const std::string & GetPath() const {	return filePath;	}
+};
+
+
+//! The class _GPSTransport_ is the interface of the byte streams through which the class _GPSInterface_ communicates with the GPS receiver.
+/*!	The class _GPSInterface_ only sends commands and receives replies through these methods, so the USB interface of the
+ * Aaronia GPS Logger (the class _FTDITransport_) can be replaced by an emulated one (the class _EmulatedGPSTransport_),
+ * which allows to run and benchmark the interpretation of the replies without the device. The methods throw an
+ * _rfims_exception_ when the operation fails.
+ */
+class GPSTransport
+{
+public:
+	//! The virtual destructor of the class _GPSTransport_.
+	virtual ~GPSTransport() {}
+	//! This method sends the given bytes and returns the number of written bytes.
+	virtual std::size_t Write(const char * data, const std::size_t numOfBytes) = 0;
+	//! This method receives up to the given number of bytes, waiting for at least one until the read timeout expires, and returns the number of received bytes.
+	virtual std::size_t Read(char * buffer, const std::size_t numOfBytes) = 0;
+	//! This method returns the number of bytes which were received and can be read without waiting.
+	virtual std::size_t Available() = 0;
+	//! This method discards the bytes of the input and output buffers.
+	virtual void Purge() = 0;
+	//! This method returns the baud rate of the serial line, which determines the transmission time of each reply.
+	virtual unsigned long GetBaudRate() const = 0;
+};
+
+
+//! The class _FTDITransport_ communicates with the Aaronia GPS Logger through its FTDI chip, using the D2XX library.
+class FTDITransport : public GPSTransport
 {
 	//Attributes//
 	//Constants
@@ -63,14 +572,131 @@ class GPSInterface
 	const std::string DEVICE_DESCRIPTION = "Aaronia GPS Logger A"; //!< The "USB Device Description" of the Aaronia GPS receiver.
 	const DWORD RD_TIMEOUT_MS = 500; //!< The timeout of the reading operations, in milliseconds (ms).
 	const DWORD WR_TIMEOUT_MS = 1000; //!< The timeout of the writing operations, in milliseconds (ms).
+	const ULONG BAUD_RATE = 625000; //!< The baud rate of the UART port of the FTDI chip, with 8 data bits and 2 stop bits.
+	const UCHAR LATENCY_TIMER_MS = 2; //!< The latency timer of the FTDI chip, in milliseconds, which bounds the delay of the received bytes.
+	//Variables
+	FT_HANDLE ftHandle; //!< The handler of the communication with the Aaronia GPS receiver.
+	FT_STATUS ftStatus; //!< A variable which is used to store the returned values of the D2XX functions.
+public:
+	//Class Interface//
+	//! The default constructor of the class _FTDITransport_, which opens the communication with the GPS receiver and sets up the UART port.
+	FTDITransport();
+	//! The destructor of the class _FTDITransport_, which closes the communication with the GPS receiver.
+	~FTDITransport();
+	std::size_t Write(const char * data, const std::size_t numOfBytes);
+	std::size_t Read(char * buffer, const std::size_t numOfBytes);
+	std::size_t Available();
+	void Purge();
+	unsigned long GetBaudRate() const {	return BAUD_RATE;	}
+};
+
+
+//! The class _EmulatedGPSTransport_ emulates the Aaronia GPS Logger, so the class _GPSInterface_ can be used and benchmarked on any Linux machine.
+/*!	The emulated logger answers the commands which are used by the class _GPSInterface_: `$PAAG,ID`, `$PAAG,VAR,...`,
+ * `$PAAG,MODE,READONE`, `$PAAG,MODE,START` and `$PAAG,MODE,STOP`. With the streaming enabled, it sends one epoch of
+ * replies per second, which starts at each UTC second: a GPRMC and a GPGGA reply followed by the sets of sensor replies
+ * (PAAG,DATA,G, C and T, and B once per epoch) at the configured data rate. The replies are synthetic or they are
+ * replayed from a recorded output of the logger, split in epochs by its GPRMC replies, whose replies are spread over
+ * the second.
+ *
+ * Nothing runs in the background: the replies are scheduled when the transport is read, each group of replies with a
+ * random delay up to the configured jitter, and each byte is received after its transmission time at the baud rate
+ * of the logger, as it would be with the serial line. The UTC time of each epoch is known, so the error of the
+ * timestamps and the latency of the interpretation of the replies can be measured.
+ */
+class EmulatedGPSTransport : public GPSTransport
+{
+	//Attributes//
+	//Constants
+	static const unsigned long BAUD_RATE = 625000; //!< The baud rate of the emulated serial line, as the one of the logger.
+	static const std::int64_t READ_TIMEOUT = 500000000; //!< The timeout of the reading operations, in nanoseconds.
+	static const unsigned int NUM_OF_GPRMC_TIMES = 8; //!< The number of last GPRMC replies whose reception instants are remembered.
+	//! A reply which is being transmitted through the emulated serial line.
+	struct PendingReply
+	{
+		std::int64_t receptionTime; //!< The instant of the monotonic clock when the last byte of the reply is received, in nanoseconds.
+		std::string text; //!< The reply, with its final characters "\r\n".
+	};
+	//! The replies of one second of a recording, which are replayed in one epoch.
+	struct RecordedEpoch
+	{
+		std::int64_t utcTime; //!< The UTC time of the GPRMC reply of the epoch, in nanoseconds since 01-01-1970T00:00:00.
+		std::vector<std::string> replies; //!< The replies of the epoch, starting with the GPRMC reply.
+	};
+	//Variables
+	unsigned int dataRate; //!< The number of sets of sensor replies per second, or zero if the variable DATARATE of the logger is used.
+	unsigned int variableDataRate; //!< The value of the variable DATARATE, which is set with the command `$PAAG,VAR,DATARATE,...`.
+	std::int64_t maxJitter; //!< The maximum random delay of each group of replies, in nanoseconds.
+	std::mt19937 randomGenerator; //!< The generator of the delays and of the noise of the synthetic sensor data.
+	std::vector<RecordedEpoch> recording; //!< The epochs of the recording which is replayed, which is empty if the replies are synthetic.
+	std::size_t nextRecordedEpoch; //!< The position of the next epoch of the recording which will be replayed.
+	std::int64_t utcOffset; //!< The difference between the UTC time and the monotonic clock of the synthetic replies, in nanoseconds.
+	bool flagStreaming; //!< A flag which states if the streaming is enabled.
+	std::int64_t nextEpochTime; //!< The instant of the monotonic clock when the next epoch starts, in nanoseconds.
+	std::int64_t epochStartTime; //!< The instant of the monotonic clock when the last epoch started, in nanoseconds.
+	std::int64_t epochUTCTime; //!< The UTC time of the last epoch, in nanoseconds since 01-01-1970T00:00:00.
+	std::int64_t lineFreeTime; //!< The instant of the monotonic clock when the serial line finishes the transmission of the scheduled replies, in nanoseconds.
+	std::deque<PendingReply> pendingReplies; //!< The replies which are being transmitted, in order of reception.
+	std::string rxBytes; //!< The bytes which were received and were not read yet.
+	std::size_t rxPos; //!< The position of the first byte of _rxBytes_ which was not read yet.
+	std::string commandBuffer; //!< The bytes of the command which is being received.
+	std::int64_t gprmcTimes[NUM_OF_GPRMC_TIMES]; //!< The reception instants of the last GPRMC replies, in a circular buffer.
+	std::uint64_t numOfGPRMCReplies; //!< The number of GPRMC replies which were scheduled.
+	std::uint64_t numOfReplies; //!< The number of replies which were received.
+	mutable pthread_mutex_t mutex; //!< The mutex which protects the emulated logger from the concurrent access of the streaming thread and the other threads.
+
+	//Private methods//
+	//! This method interprets a command which was received and schedules its reply, if it has one.
+	void ProcessCommand(const std::string & command, const std::int64_t time);
+	//! This method schedules the replies of the epochs which start before the given instant and moves the received bytes to the input buffer.
+	void Update(const std::int64_t time);
+	//! This method schedules a group of replies which are sent at the given instant, after a random delay.
+	void ScheduleReplies(const std::vector<std::string> & replies, const std::int64_t time);
+	//! This method schedules the replies of one epoch, synthetic or recorded, which starts at the given instant.
+	void ScheduleEpoch(const std::int64_t time);
+	//! This method builds the set of seven replies which is sent as the answer of the command `$PAAG,MODE,READONE`.
+	void BuildDataSet(const std::int64_t time, std::vector<std::string> & replies);
+	//! This method builds a synthetic reply of the given type, with the given UTC time.
+	std::string BuildSyntheticReply(const GPSSentence::SentenceType type, const std::int64_t utcTime);
+	//! This method returns the data rate which is used with the streaming.
+	unsigned int GetDataRate() const {	return( dataRate!=0 ? dataRate : std::max(variableDataRate, 1U) );	}
+	//! This method adds the delimiters and the checksum to the body of a reply.
+	static std::string FormatReply(const std::string & body);
+	//! This method loads a recorded output of the logger and splits it in epochs.
+	void LoadRecording(const std::string & recordingPath);
+public:
+	//Class Interface//
+	//! The constructor of the class _EmulatedGPSTransport_.
+	EmulatedGPSTransport(const unsigned int dataRt=0, const double jitter=0.0, const std::string & recordingPath="");
+	//! The destructor of the class _EmulatedGPSTransport_.
+	~EmulatedGPSTransport() {	pthread_mutex_destroy(&mutex);	}
+	std::size_t Write(const char * data, const std::size_t numOfBytes);
+	std::size_t Read(char * buffer, const std::size_t numOfBytes);
+	std::size_t Available();
+	void Purge();
+	unsigned long GetBaudRate() const {	return BAUD_RATE;	}
+	//! This method returns the true UTC time of the given instant of the monotonic clock, according to the epochs which were sent.
+	std::int64_t GetUTCTime(const std::int64_t monotonicTime) const;
+	//! This method returns the instant of the monotonic clock when the last GPRMC reply was received, before the given instant.
+	std::int64_t GetLastGPRMCTime(const std::int64_t monotonicTime) const;
+	//! This method returns the number of replies which were received.
+	std::uint64_t GetNumOfReplies() const;
+};
+
+
+//! The class _GPSInterace_ is intended to establish the communication with the Aaronia GPS receiver, to request and capture messages from this one and extract useful data from the messages.
+class GPSInterface
+{
+	//Attributes//
+	//Constants
 	const unsigned int ACCELER_RANGE = 2; //!< The maximum range of the accelerometer measured in g (gravitational acceleration). It can be 2g, 4g or 8g.
 	const unsigned int GYRO_FILTERFREQ = 4; //!< It is a number ranging from 0-7 to select the frequency of the average filter of the gyroscope sensor.
 	const unsigned int GYRO_FILTERDIV = 1; //!< This number represents the divisor of the average filter for the gyroscope sensor, ranging from 0-255.
 	const unsigned int DATARATE = 4; //!< The data rate of the GPS sensors data, measured in Hz. f=4 Hz, T=250ms.
 	const unsigned int MIN_NUM_OF_SATELLITES = 3; //!< The minimum number of satellites the GPS receiver must connect with, at initialization.
 	//Variables
-	FT_HANDLE ftHandle; //!< The handler of the communication with the Aaronia GPS receiver.
-	FT_STATUS ftStatus; //!< A variable which is used to store the returned values of the D2XX functions.
+	std::unique_ptr<GPSTransport> ownedTransport; //!< The transport which was created by the default constructor, or a null pointer if the transport was given.
+	GPSTransport & transport; //!< The transport through which the commands are sent and the replies are received.
 	bool flagConnected; //!< A flag which states if the communication with the GPS receiver has been initialized.
 	TimeData timeData; //!< The time data (date and time) which were received from the GPS satellites.
 	GPSCoordinates coordinates; //!< The GPS coordinates which were received from the GPS satellites.
@@ -87,41 +713,61 @@ class GPSInterface
 	double roll;
 	float pressure; //!< The ambient pressure, measured in hectopascal (hPa).
 	float presElevation; //!< The elevation of the GPS receiver over the sea level, measured in meters (m) and based on the ambient pressure.
-	bool flagNewGPRMCData, flagNewGPGGAData;
-	bool flagNewGyroData, flagNewCompassData, flagNewAccelerData,flagNewBaromData;
-	bool flagNewTimeData, flagNewCoordinates, flagNewNumOfSatellites, flagNewGPSElevation;
-	bool flagNewYaw, flagNewRoll, flagNewPitch;
+	SentenceBuffer rxBuffer; //!< The buffer where the bytes received from the GPS receiver are split in sentences.
+	std::int64_t lastReceptionTime; //!< The instant of the monotonic clock when the last bytes were received, in nanoseconds.
+	GPSClock clock; //!< The clock which is disciplined with the time of the GPRMC replies received with the streaming.
+	AttitudeFilter attitudeFilter; //!< The filter which fuses the data of the three sensors in an estimate of the attitude angles.
+	GPSSnapshot lastSnapshot; //!< The last published snapshot, which is only used by the thread which extracts the data.
+	SeqLock<GPSSnapshot> sharedSnapshot; //!< The published snapshot, which is read by the other threads without locks.
+	GPSRecorder * recorder; //!< The recorder where the position and the attitude are appended after each streamed reply, or a null pointer.
+	//! The kinds of data which are got with the methods Get*(), to know if they are new.
+	enum DataItem : unsigned int { TIME_DATA, COORDINATES, NUM_OF_SATELLITES, GPS_ELEVATION, GYRO_DATA, COMPASS_DATA, ACCELER_DATA,
+		BAROM_DATA, YAW, ROLL, PITCH, NUM_OF_ITEMS };
+	static const GPSSentence::SentenceType ITEM_REPLIES[NUM_OF_ITEMS]; //!< The type of reply which updates each kind of data.
+	std::uint64_t readCounts[NUM_OF_ITEMS]; //!< The number of replies of the snapshot from which each kind of data was got last time.
 	pthread_t threadID;
-	bool flagStreamingEnabled;
+	std::atomic<bool> flagStreamingEnabled; //!< A flag which states if the streaming is enabled, which is cleared by the streaming thread if it fails.
 	int streamingRetVal;
 
 	//Private Methods//
 	//! This method performs the writing operations.
 	void Write(const std::string& command);
+	//! This method performs the reading operations, giving the next sentence as a pointer to the reception buffer.
+	void Read(const char * & reply, std::size_t & length, const unsigned int numOfBytes=0);
 	//! This method performs the reading operations.
 	void Read(std::string& reply, const unsigned int numOfBytes=0);
 	//! This method returns the number of bytes in the input buffer.
 	unsigned int Available();
 	//! This method performs the checking of each reply, taking into account the checksum.
 	bool ControlChecksum(const std::string& reply);
-	//! This method checks if the status of a PAAG,DATA reply or a GPRMC reply is ok.
-	bool ControlStatus(const std::string & reply);
+	//! This method interprets a data reply and, if it is valid, extracts the corresponding data and publishes them.
+	GPSSentence::SentenceType ProcessDataReply(const char * reply, const std::size_t length, const std::int64_t receptionTime=0);
+	//! This method waits until the streaming thread extracts the data of a new reply of the given type.
+	void WaitForStreamedReply(const GPSSentence::SentenceType replyType, const std::string & dataName);
+	//! This method publishes a snapshot with the current data, after the extraction of the data of a reply of the given type.
+	void PublishSnapshot(const GPSSentence::SentenceType replyType);
+	//! This method appends the position and the attitude of the last published snapshot to the recorder, with the GPS time of the given instant.
+	void RecordSnapshot(const GPSSentence::SentenceType replyType, const std::int64_t receptionTime);
+	//! This method states if a kind of data of the given snapshot was not got yet with the corresponding method Get*().
+	bool IsNew(const DataItem item, const GPSSnapshot & snapshot) const {	return( snapshot.numOfReplies[ ITEM_REPLIES[item] ] != readCounts[item] );	}
+	//! This method states the given kind of data was got from the given snapshot.
+	void MarkAsRead(const DataItem item, const GPSSnapshot & snapshot) {	readCounts[item] = snapshot.numOfReplies[ ITEM_REPLIES[item] ];	}
 	//! This method is intended to set an internal variable of the GPS receiver.
 	void ConfigureVariable(const std::string& variable, const unsigned int value);
 	//! This method sends a command to get just one set of data replies (GPS and sensors data) which are put in the vector received as an argument.
 	void ReadOneDataSet(std::vector<std::string> & dataReplies);
 	//! This method extracts the corresponding GPS data from a GPRMC reply.
-	void ExtractGPRMCData(const std::string & reply);
+	void ExtractGPRMCData(const GPSSentence & reply);
 	//! This method extracts the corresponding GPS data from a GPGAA reply.
-	void ExtractGPGGAData(const std::string & reply);
+	void ExtractGPGGAData(const GPSSentence & reply);
 	//! This method extracts the gyroscope data from the corresponding GPS Logger reply.
-	void ExtractGyroData(const std::string & reply);
+	void ExtractGyroData(const GPSSentence & reply);
 	//! This method extracts the 3D compass data from the corresponding GPS Logger reply.
-	void ExtractCompassData(const std::string & reply);
+	void ExtractCompassData(const GPSSentence & reply);
 	//! This method extracts the 3D accelerometer data from the corresponding GPS Logger reply.
-	void ExtractAccelerData(const std::string & reply);
+	void ExtractAccelerData(const GPSSentence & reply);
 	//! This method extracts the barometer data from the corresponding GPS Logger reply.
-	void ExtractBarometerData(const std::string & reply);
+	void ExtractBarometerData(const GPSSentence & reply);
 	//! The aim of this method is to calculate the yaw angle (one of the Cardan angles) from the 3D compass data.
 	void CalculateYaw();
 	//! The aim of this method is to calculate the pitch angle (one of the Cardan angles) from the 3D accelerometer data.
@@ -130,8 +776,10 @@ class GPSInterface
 	void CalculateRoll();
 public:
 	//Class Interface//
-	//! The default constructor of class GPSInterface.
+	//! The default constructor of class GPSInterface, which communicates with the Aaronia GPS receiver through its FTDI chip.
 	GPSInterface();
+	//! A constructor of class GPSInterface which communicates through the given transport, for example an emulated GPS receiver.
+	GPSInterface(GPSTransport & transp);
 	//!The GPSInterface class' destructor.
 	~GPSInterface();
 	//! This method is intended to try the communication with the Aaronia GPS receiver and configure the device.
@@ -162,96 +810,115 @@ public:
 	unsigned int UpdateNumOfSatellites();
 	//! A method which reads all data replies to update all attributes.
 	void UpdateAll();
+	//! A method which waits until the yaw angle estimated by the attitude filter is steady and returns it.
+	double WaitForSteadyYaw(const double maxDeviation=1.5, const unsigned int timeout=2000);
 	//! A method which allows to know if there are new time data.
 	/*!	This method is mainly intended to be used with the streaming option. When a GPRMC reply is received and the
 	 * 	time data are extracted from it, it is considered the time data are new data. Once the time data are got with
-	 * 	the method GetTimeData(), then they are considered old data. */
-	bool NewTimeData() const {	return flagNewTimeData;	}
+	 * 	the method GetTimeData(), then they are considered old data. The methods New*() and Get*() read the published
+	 * 	snapshot, so they do not block the streaming thread, but the methods Get*() remember which data were got, so
+	 * 	they must be called by just one thread; the other threads should use the method GetSnapshot(). */
+	bool NewTimeData() const {	return IsNew( TIME_DATA, GetSnapshot() );	}
 	//! A method which allows to know if there are new GPS coordinates.
 	/*!	This method is mainly intended to be used with the streaming option. When a GPRMC reply is received and the
 	 * 	coordinates are extracted from it, it is considered the coordinates are new data. Once the GPS coordinates are
 	 * 	got with the method GetCoordinates(), then they are considered old data. */
-	bool NewCoordinates() const { return flagNewCoordinates;	}
+	bool NewCoordinates() const {	return IsNew( COORDINATES, GetSnapshot() );	}
 	//! A method which allows to know if there is a new value of the number of satellites.
 	/*!	This method is mainly intended to be used with the streaming option. When a GPGGA reply is received and the
 	 * 	number of satellites is extracted from it, it is considered this number as a new data. Once the number of
 	 * 	satellites is got with the method GetNumOfSatellites(), then it is considered old data.	 */
-	bool NewNumOfSatellites() const {	return flagNewNumOfSatellites;	}
+	bool NewNumOfSatellites() const {	return IsNew( NUM_OF_SATELLITES, GetSnapshot() );	}
 	//! A method which allows to know if there is a new value of the GPS-based elevation.
 	/*!	This method is mainly intended to be used with the streaming option. When a GPGGA reply is received and the
 	 * 	elevation is extracted from it, it is considered this number as a new data. Once the GPS-based elevation
 	 * 	is got with the method GetGPSElevation(), then it is considered old data. */
-	bool NewGPSElevation() const {	return flagNewGPSElevation;	}
+	bool NewGPSElevation() const {	return IsNew( GPS_ELEVATION, GetSnapshot() );	}
 	//! A method which allows to know if there are new gyroscope data.
 	/*!	This method is mainly intended to be used with the streaming option. When a PAAG,DATA,G reply is received
 	 * 	and the	gyroscope data are extracted from it, it is considered these data are new. Once the gyroscope
 	 * 	data are got with the method GetGyroData(), then they are considered old data. */
-	bool NewGyroData() const {	return flagNewGyroData;	}
+	bool NewGyroData() const {	return IsNew( GYRO_DATA, GetSnapshot() );	}
 	//! A method which allows to know if there are new compass data.
 	/*!	This method is mainly intended to be used with the streaming option. When a PAAG,DATA,C reply is received
 	 * 	and the compass data are extracted from it, it is considered these data are new. Once the compass data
 	 * 	are got with the method GetCompassData(), then they are considered old data. */
-	bool NewCompassData() const {	return flagNewCompassData;	}
+	bool NewCompassData() const {	return IsNew( COMPASS_DATA, GetSnapshot() );	}
 	//! A method which allows to know if there are new accelerometer data.
 	/*!	This method is mainly intended to be used with the streaming option. When a PAAG,DATA,T reply is received
 	 * 	and the	accelerometer data are extracted from it, it is considered these data are new. Once the accelerometer
 	 * 	data are got with the method GetAccelerData(), then they are considered old data. */
-	bool NewAccelerData() const {	return flagNewAccelerData;	}
+	bool NewAccelerData() const {	return IsNew( ACCELER_DATA, GetSnapshot() );	}
 	//! A method which allows to know if there is a new value of pressure.
 	/*!	This method is mainly intended to be used with the streaming option. When a PAAG,DATA,B reply is received
 	 * 	and the	pressure is extracted from it, it is considered this data is new. Once the pressure value (or the
 	 * 	pressure-based elevation) is got with the method GetPressure(), then it is considered old data. */
-	bool NewPressure() const {	return flagNewBaromData;	}
+	bool NewPressure() const {	return IsNew( BAROM_DATA, GetSnapshot() );	}
 	//! A method which allows to know if there is a new value of pressure.
 	/*!	This method is mainly intended to be used with the streaming option. When a PAAG,DATA,B reply is received
 	 * 	and the	pressure is extracted from it, it is considered this data is new. Once the pressure value (or the
 	 * 	pressure-based elevation) is got with the method GetPressure(), then it is considered old data. */
-	bool NewYaw() const {	return flagNewYaw;	}
+	bool NewYaw() const {	return IsNew( YAW, GetSnapshot() );	}
 	//! A method which allows to know if there is a new value of the roll angle.
 	/*!	This method is mainly intended to be used with the streaming option. When the corresponding replies are
 	 * 	received and the roll angle is calculated from their data, it is considered this value is new. Once this value
 	 * 	is got with the method GetRoll(), then it is considered old data. */
-	bool NewRoll() const {	return flagNewRoll;	}
+	bool NewRoll() const {	return IsNew( ROLL, GetSnapshot() );	}
 	//! A method which allows to know if there is a new value of the pitch angle.
 	/*!	This method is mainly intended to be used with the streaming option. When the corresponding replies are
 	 * 	received and the pitch angle is calculated from their data, it is considered this value is new. Once this value
 	 * 	is got with the method GetPitch(), then it is considered old data. */
-	bool NewPitch() const {	return flagNewPitch;	}
+	bool NewPitch() const {	return IsNew( PITCH, GetSnapshot() );	}
 	//! A method which allows to know if there are new GPS data.
 	/*!	This method is mainly intended to be used with the streaming option. When the corresponding replies, GPRMC and GPGGA, are
 	 * 	received and the GPS data (time, coordinates, etc.) are extracted from them, it is considered these data are new. Once these
 	 * 	data are got with the corresponding methods, then they are considered old data. */
-	bool NewGPSData() const {	return(flagNewGPRMCData && flagNewGPGGAData);	}
+	bool NewGPSData() const
+	{
+		const GPSSnapshot snapshot = GetSnapshot();
+		return( ( IsNew(TIME_DATA, snapshot) || IsNew(COORDINATES, snapshot) ) && ( IsNew(NUM_OF_SATELLITES, snapshot) || IsNew(GPS_ELEVATION, snapshot) ) );
+	}
+	//! This method returns a coherent copy of all the data (time, position, attitude, etc.), without blocking the streaming thread.
+	/*!	Unlike the methods Get*(), this method does not modify the object, so it can be called by any thread. The data
+	 * 	which are new for a reader can be known comparing the numbers of replies of two snapshots. */
+	GPSSnapshot GetSnapshot() const {	return sharedSnapshot.Load();	}
 	//! This method returns the time data (date and time) which was received from the GPS satellites.
-	const TimeData & GetTimeData() {	flagNewTimeData=false; if(!flagNewCoordinates) flagNewGPRMCData=false; return timeData;	}
+	TimeData GetTimeData() {	const GPSSnapshot snapshot = GetSnapshot(); MarkAsRead(TIME_DATA, snapshot); return snapshot.GetTimeData();	}
 	//! This method returns the GPS coordinates.
-	const GPSCoordinates & GetCoordinates() {	flagNewCoordinates=false; if(!flagNewTimeData) flagNewGPRMCData=false; return coordinates;	}
+	GPSCoordinates GetCoordinates() {	const GPSSnapshot snapshot = GetSnapshot(); MarkAsRead(COORDINATES, snapshot); return snapshot.coordinates;	}
 	//! This method returns the current number of satellites which the GPS receiver is connected with.
-	unsigned int GetNumOfSatellites() {	flagNewNumOfSatellites=false; if(!flagNewGPSElevation) flagNewGPGGAData=false;	return numOfSatellites;	}
+	unsigned int GetNumOfSatellites() {	const GPSSnapshot snapshot = GetSnapshot(); MarkAsRead(NUM_OF_SATELLITES, snapshot); return snapshot.numOfSatellites;	}
 	//! This method returns the elevation of the GPS receiver over the sea level, measured in meters (m) and based on GPS data.
-	float GetGPSElevation() {	flagNewGPSElevation=false; if(!flagNewNumOfSatellites) flagNewGPGGAData=false; return gpsElevation;	}
+	float GetGPSElevation() {	const GPSSnapshot snapshot = GetSnapshot(); MarkAsRead(GPS_ELEVATION, snapshot); return snapshot.gpsElevation;	}
 	//! This method returns the 3D gyroscope data.
-	const Data3D & GetGyroData() {	flagNewGyroData=false; return gyroData;	}
+	Data3D GetGyroData() {	const GPSSnapshot snapshot = GetSnapshot(); MarkAsRead(GYRO_DATA, snapshot); return snapshot.GetData3D(Data3D::GYROSCOPE);	}
 	//! This method returns the 3D compass data.
-	const Data3D & GetCompassData() {	flagNewCompassData=false; return compassData;	}
+	Data3D GetCompassData() {	const GPSSnapshot snapshot = GetSnapshot(); MarkAsRead(COMPASS_DATA, snapshot); return snapshot.GetData3D(Data3D::COMPASS);	}
 	//! This method returns the 3D accelerometer data.
-	const Data3D & GetAccelerData() {	flagNewAccelerData=false; return accelData; }
+	Data3D GetAccelerData() {	const GPSSnapshot snapshot = GetSnapshot(); MarkAsRead(ACCELER_DATA, snapshot); return snapshot.GetData3D(Data3D::ACCELEROMETER);	}
 	//! This method returns the ambient temperature, measured in hectopascal (hPa).
-	float GetPressure() {	flagNewBaromData=false; return pressure;	}
+	float GetPressure() {	const GPSSnapshot snapshot = GetSnapshot(); MarkAsRead(BAROM_DATA, snapshot); return snapshot.pressure;	}
 	//! This method returns the elevation of the GPS receiver over the sea level, measured in meters (m) and based on the ambient pressure.
-	float GetPressElevation() {	flagNewBaromData=false; return presElevation; }
+	float GetPressElevation() {	const GPSSnapshot snapshot = GetSnapshot(); MarkAsRead(BAROM_DATA, snapshot); return snapshot.presElevation;	}
 	//! This method returns the yaw angle, measured in degrees and whose range is 0 to 359. North corresponds to 0°, east to 90°, south to 180° and west to 270°.
-	double GetYaw() {	flagNewYaw=false; return yaw;	}
+	double GetYaw() {	const GPSSnapshot snapshot = GetSnapshot(); MarkAsRead(YAW, snapshot); return snapshot.yaw;	}
 	//! This method returns the roll angle, measured in degrees and whose range is -180 to 180. This angle is zero if the device is put on horizontal surface, positive if it turns right and negative if it turns left.
-	double GetRoll() {	flagNewRoll=false; return roll;	}
+	double GetRoll() {	const GPSSnapshot snapshot = GetSnapshot(); MarkAsRead(ROLL, snapshot); return snapshot.roll;	}
 	//! This method returns the pitch angle, measured in degrees and whose range is -180 to 180. This angle is zero if the device is put on horizontal surface, positive if the elevation is over the surface and negative if the elevation is below the surface.
-	double GetPitch() {	flagNewPitch=false; return pitch;	}
+	double GetPitch() {	const GPSSnapshot snapshot = GetSnapshot(); MarkAsRead(PITCH, snapshot); return snapshot.pitch;	}
 	//! This method returns the data rate when the streaming is enabled.
 	unsigned int GetDataRate() const { return DATARATE;	}
 	//! This method states if the communication with the Aaronia GPS receiver has been initialized.
 	bool IsConnected() const {	return flagConnected;	}
 	//! This method states if the data streaming is enabled.
 	bool IsStreamingEnabled() const {	return flagStreamingEnabled;	}
+	//! This method returns the attitude angles which are estimated by fusing the data of the gyroscope, the compass and the accelerometer, with their standard deviations.
+	AttitudeEstimate GetAttitude() const {	return GetSnapshot().attitude;	}
+	//! This method returns the clock which gives the GPS time of any instant, which is disciplined while the streaming is enabled.
+	const GPSClock & GetClock() const {	return clock;	}
+	//! This method sets the recorder where the position and the attitude are appended while the streaming is enabled, or a null pointer to stop recording them.
+	/*!	It must be called while the streaming is disabled and the recorder must exist while it is set. */
+	void SetRecorder(GPSRecorder * gpsRecorder) {	recorder = gpsRecorder;	}
 
 	//Friend functions//
 	//! The function which is executed by the thread which reads each reply of the GPS Logger and extract the data from them.
@@ -259,6 +926,298 @@ public:
 };
 
 
+//! The statistics of the edges which are counted by the class _EncoderCounter_.
+struct EncoderStatistics
+{
+	std::uint64_t numOfEdges[2]; //!< The number of rising edges of the channels A and B.
+	//! The number of edges which followed other one of the same channel and direction.
+	/*!	While the direction does not change, the rising edges of the two channels alternate, so an edge which follows
+	 * other one of the same channel means the edge of the other channel was missed, the encoder vibrated around an edge
+	 * or the edges were handled so late that their order was lost. In all these cases the count may be wrong. When the
+	 * direction changes, the first edge may be of the channel of the last one, so it is not counted. */
+	std::uint64_t numOfRepeatedEdges;
+	std::int64_t minEdgeInterval; //!< The minimum interval between two consecutive edges, in nanoseconds, or -1 if there were less than two edges.
+	std::int64_t lastEdgeTime; //!< The instant of the monotonic clock when the last edge was handled, in nanoseconds, or 0 if there was not any edge.
+};
+
+
+//! The class _EncoderCounter_ counts the rising edges of the two channels of the quadrature encoder of the azimuth rotator.
+/*!	The interrupt service routines (one per channel, which wiringPi runs in different threads) call the methods AddEdgeA()
+ * and AddEdgeB() with the level of the other channel, which gives the direction. The count is an atomic integer of 64
+ * bits which is modified with just one atomic addition, so no edge is lost because of a race between the routines, and it
+ * is read by the control loop with just one atomic load, which never waits for them. The angles are calculated from the
+ * difference between two counts, which is valid even if the count wrapped around, so the count is never cleared while
+ * the routines may be modifying it.
+ */
+class EncoderCounter
+{
+public:
+	//! The channels of the encoder.
+	enum Channel : int { CHANNEL_A=0, CHANNEL_B=1 };
+	static const std::int64_t COUNTS_PER_DEGREE = 2; //!< The number of counts (rising edges of both channels) per degree of the azimuth rotation.
+private:
+	//Attributes//
+	std::atomic<std::int64_t> count; //!< The number of edges in the positive direction minus the ones in the negative direction.
+	std::atomic<std::uint64_t> numOfEdges[2]; //!< The number of rising edges of each channel.
+	std::atomic<std::uint64_t> numOfRepeatedEdges; //!< The number of edges which followed other one of the same channel and direction.
+	std::atomic<int> lastEdge; //!< The channel and the direction of the last edge (2*channel, plus 1 if it was positive), or -1 if there was not any edge.
+	std::atomic<std::int64_t> lastEdgeTime; //!< The instant of the last edge, in nanoseconds.
+	std::atomic<std::int64_t> minEdgeInterval; //!< The minimum interval between two consecutive edges, in nanoseconds, or -1.
+
+	//Private methods//
+	//! This method counts an edge of the given channel in the given direction (1 or -1) and updates the statistics.
+	void AddEdge(const Channel channel, const int direction);
+public:
+	//Class Interface//
+	//! The constructor of the class _EncoderCounter_.
+	EncoderCounter();
+	//! This method counts a rising edge of the channel A, which is positive if the channel B is low.
+	void AddEdgeA(const bool flagPhaseBOn) {	AddEdge( CHANNEL_A, ( flagPhaseBOn ? -1 : 1 ) );	}
+	//! This method counts a rising edge of the channel B, which is positive if the channel A is high.
+	void AddEdgeB(const bool flagPhaseAOn) {	AddEdge( CHANNEL_B, ( flagPhaseAOn ? 1 : -1 ) );	}
+	//! This method returns the current count, without waiting for the interrupt service routines.
+	std::int64_t GetCount() const {	return count.load(std::memory_order_acquire);	}
+	//! This method returns the angle which was rotated since the given count, in degrees.
+	double GetDegreesSince(const std::int64_t startCount) const {	return ToDegrees( CountDifference( GetCount(), startCount ) );	}
+	//! This method returns the statistics of the edges.
+	EncoderStatistics GetStatistics() const;
+	//! This method clears the count and the statistics. It must not be called while the interrupt service routines may be running.
+	void Reset();
+	//! This method returns the difference between two counts, which is correct even if the count wrapped around between them.
+	static std::int64_t CountDifference(const std::int64_t count, const std::int64_t startCount);
+	//! This method converts a number of counts to degrees, without losing precision for any number of counts.
+	static double ToDegrees(const std::int64_t counts);
+};
+
+
+//! The class _SimulatedEncoder_ generates the edges of a quadrature encoder, so the class _EncoderCounter_ can be stress-tested without the rotator.
+/*!	A thread plays the role of the motor: it generates the transitions of the two channels at the given rate and posts
+ * each rising edge, with the level of the other channel at that instant, to the thread of its channel, which plays the
+ * role of the interrupt service routine of wiringPi and calls the method AddEdgeA() or AddEdgeB() of the counter. As
+ * with the interrupts, if an edge is posted before the previous edge of the same channel was handled, both are merged
+ * and one of them is lost, so the counter can be tested at edge rates which it cannot follow. The threads of the
+ * channels poll their posted edges, so they use a processor core each while the object exists.
+ */
+class SimulatedEncoder
+{
+	//Attributes//
+	//! The argument of the thread of each channel.
+	struct ChannelThreadArg
+	{
+		SimulatedEncoder * encoder; //!< The object whose edges are handled.
+		EncoderCounter::Channel channel; //!< The channel whose edges are handled.
+	} channelThreadArgs[2];
+	EncoderCounter & counter; //!< The counter whose methods are called for each edge.
+	std::atomic<int> postedEdges[2]; //!< The level of the other channel at the last edge of each channel which was not handled yet, or -1.
+	std::atomic<bool> flagEnabled; //!< A flag which states if the threads of the channels must keep running.
+	std::atomic<bool> flagMoving; //!< A flag which states if the thread of the motor is generating edges.
+	pthread_t channelThreadIDs[2]; //!< The threads of the channels.
+	pthread_t motorThreadID; //!< The thread of the motor.
+	bool flagMotorThread; //!< A flag which states if the thread of the motor was created and it was not joined yet.
+	unsigned int phaseState; //!< The state of the channels: 0 (A and B low), 1 (A high), 2 (A and B high) or 3 (B high).
+	std::int64_t numOfCountsToMove; //!< The number of counts of the current movement, whose sign is the direction.
+	double edgeRate; //!< The rate of the rising edges of the current movement, in edges per second.
+	std::int64_t generatedCount; //!< The count which would be reached if no edge were lost.
+	std::uint64_t numOfPostedEdges; //!< The number of edges which were posted to the threads of the channels.
+	std::atomic<std::uint64_t> numOfHandledEdges; //!< The number of edges which were handled by the threads of the channels.
+	std::atomic<std::uint64_t> numOfLostEdges; //!< The number of edges which were merged with the next one of the same channel.
+	std::int64_t lostCount; //!< The sum of the directions of the lost edges.
+
+	//Private methods//
+	//! This method posts a rising edge to the thread of the given channel.
+	void PostEdge(const EncoderCounter::Channel channel, const bool flagOtherPhaseOn, const int direction);
+	//! This method waits for the thread of the motor and joins it.
+	void JoinMotorThread();
+public:
+	//Class Interface//
+	//! The constructor of the class _SimulatedEncoder_, which starts the threads of the channels.
+	SimulatedEncoder(EncoderCounter & encoderCounter);
+	//! The destructor of the class _SimulatedEncoder_, which stops all the threads.
+	~SimulatedEncoder();
+	//! This method starts a movement of the given number of counts, whose sign is the direction, at the given rate of edges per second.
+	void StartMovement(const std::int64_t numOfCounts, const double rate);
+	//! This method waits until the current movement finishes and its edges are handled.
+	void WaitForMovement();
+	//! This method states if the current movement has not finished yet.
+	bool IsMoving() const {	return flagMoving.load(std::memory_order_acquire);	}
+	//! This method returns the count which would have been reached if no edge had been lost.
+	std::int64_t GetGeneratedCount() const {	return generatedCount;	}
+	//! This method returns the number of edges which were lost because they were posted before the previous one of the same channel was handled.
+	std::uint64_t GetNumOfLostEdges() const {	return numOfLostEdges.load(std::memory_order_relaxed);	}
+	//! This method returns the sum of the directions of the lost edges, so the generated count minus this one is the count the counter must reach.
+	std::int64_t GetLostCount() const {	return lostCount;	}
+
+	//Friend functions//
+	//! The function which is executed by the thread of each channel, which handles the posted edges.
+	friend void *SimulatedChannelThread(void * arg);
+	//! The function which is executed by the thread of the motor, which generates the edges of a movement.
+	friend void *SimulatedMotorThread(void * arg);
+};
+
+
+//! The parameters of a trapezoidal profile of the step rate of the azimuth motor.
+struct MotionProfileParameters
+{
+	double startRate; //!< The step rate at the beginning and at the end of a movement, which the motor follows from rest, in steps per second.
+	double cruiseRate; //!< The maximum step rate, in steps per second.
+	double acceleration; //!< The increase of the step rate at the beginning of a movement, in steps per second squared.
+	double deceleration; //!< The decrease of the step rate at the end of a movement, in steps per second squared.
+};
+
+
+//! The class _MotionProfile_ precomputes the intervals between the steps of a movement with a trapezoidal profile of the step rate.
+/*!	The step rate starts in the start rate, increases with the given acceleration up to the cruise rate and decreases
+ * with the given deceleration so the last step is given at the start rate again. If the movement is too short to reach
+ * the cruise rate, the profile is triangular. Each interval is the exact time between two steps of the segment which
+ * limits the rate, so the intervals are computed once per movement and the loop which gives the steps only waits.
+ */
+class MotionProfile
+{
+	//Attributes//
+	MotionProfileParameters parameters; //!< The parameters of the profile.
+	std::vector<std::uint32_t> intervals; //!< The intervals between each step of the movement and the next one, or the end of the movement, in nanoseconds.
+	std::int64_t duration; //!< The sum of the intervals, in nanoseconds.
+public:
+	//Class Interface//
+	//! The default constructor of the class _MotionProfile_, with a constant rate of 100 steps per second, the one of the step pulses of 10 ms.
+	MotionProfile();
+	//! This method sets the parameters of the profile, checking they are valid.
+	void SetParameters(const MotionProfileParameters & param);
+	//! This method returns the parameters of the profile.
+	const MotionProfileParameters & GetParameters() const {	return parameters;	}
+	//! This method computes the intervals between the steps of a movement of the given number of steps.
+	void Build(const std::size_t numOfSteps);
+	//! This method returns the interval after the given step, in nanoseconds. After the last step of the movement, it is the one of the start rate.
+	std::uint32_t GetInterval(const std::size_t step) const {	return( step < intervals.size() ? intervals[step] : std::uint32_t( std::llround(1e9/parameters.startRate) ) );	}
+	//! This method returns the number of steps of the movement.
+	std::size_t GetNumOfSteps() const {	return intervals.size();	}
+	//! This method returns the duration of the movement, in nanoseconds.
+	std::int64_t GetDuration() const {	return duration;	}
+};
+
+
+//! The class _StepperOutput_ is the interface of the signals of the driver of the azimuth motor: the direction and the step pulses.
+/*!	The class _StepperDriver_ only gives the steps through these methods, so the GPIO pins (the class _GPIOStepperOutput_)
+ * can be replaced by a simulated motor and encoder (the class _SimulatedStepperOutput_), which allows to test and
+ * benchmark the movements without the rotator.
+ */
+class StepperOutput
+{
+public:
+	//! The virtual destructor of the class _StepperOutput_.
+	virtual ~StepperOutput() {}
+	//! This method sets the direction of the rotation: clockwise (seen from above) or counterclockwise.
+	virtual void SetDirection(const bool flagClockwise) = 0;
+	//! This method sets the level of the step signal. The motor gives a step with each rising edge.
+	virtual void SetPulse(const bool flagHigh) = 0;
+};
+
+
+//! The class _GPIOStepperOutput_ sets the signals of the driver of the azimuth motor through the GPIO pins of the Raspberry Pi.
+class GPIOStepperOutput : public StepperOutput
+{
+public:
+	void SetDirection(const bool flagClockwise)
+	{
+#ifdef RASPBERRY_PI
+		digitalWrite(piPins.DIRECCION, ( flagClockwise ? pinsValues.DIR_HOR : pinsValues.DIR_ANTIHOR ) );
+#endif
+	}
+	void SetPulse(const bool flagHigh)
+	{
+#ifdef RASPBERRY_PI
+		digitalWrite(piPins.PUL, ( flagHigh ? pinsValues.PUL_ON : pinsValues.PUL_OFF ) );
+#endif
+	}
+};
+
+
+//! The class _SimulatedStepperOutput_ plays the role of the azimuth motor and of its encoder, so the movements can be tested without the rotator.
+/*!	Each step which is given rotates the simulated antenna one degree, and the edges of the encoder channels are counted
+ * by the given counter in the calling thread, as the interrupt service routines would do. A step which is given at a
+ * rate higher than the maximum one is lost, as the motor stalls, so the checking of the steps against the encoder counts
+ * can be tested. The rate of a step is averaged over its last two intervals, since the inertia of the rotor absorbs a
+ * single step which comes early after a late one, as the absolute instants of the class _StepperDriver_ produce.
+ */
+class SimulatedStepperOutput : public StepperOutput
+{
+	//Attributes//
+	EncoderCounter & counter; //!< The counter of the edges of the simulated encoder.
+	double maxStepRate; //!< The maximum step rate the motor follows, in steps per second, or zero if there is no limit.
+	bool flagClockwise; //!< The current direction of the rotation.
+	bool flagPulseHigh; //!< The current level of the step signal.
+	std::int64_t lastStepTime; //!< The instant of the last step, in nanoseconds, or zero if no step was given yet.
+	std::int64_t previousStepTime; //!< The instant of the step before the last one, in nanoseconds, or zero if less than two steps were given.
+	std::uint64_t numOfSteps; //!< The number of steps which were given.
+	std::uint64_t numOfLostSteps; //!< The number of steps which were lost because the motor could not follow them.
+public:
+	//Class Interface//
+	//! The constructor of the class _SimulatedStepperOutput_, whose steps are counted by the given counter.
+	SimulatedStepperOutput(EncoderCounter & encoderCounter, const double maxRate=0.0);
+	void SetDirection(const bool flagCw) {	flagClockwise=flagCw;	}
+	void SetPulse(const bool flagHigh);
+	//! This method returns the number of steps which were given.
+	std::uint64_t GetNumOfSteps() const {	return numOfSteps;	}
+	//! This method returns the number of steps which were lost because the motor could not follow them.
+	std::uint64_t GetNumOfLostSteps() const {	return numOfLostSteps;	}
+};
+
+
+//! The results of a movement of the azimuth motor, which are used to check the steps against the encoder counts.
+struct MoveStatistics
+{
+	std::uint64_t numOfSteps; //!< The number of steps which were given.
+	std::uint64_t numOfPlannedSteps; //!< The number of steps of the motion profile.
+	std::int64_t duration; //!< The time from the first step until the encoder reached the angle, in nanoseconds.
+	std::int64_t counts; //!< The counts of the encoder during the movement.
+	std::int64_t expectedCounts; //!< The counts which correspond to the given steps.
+	std::int64_t maxLateness; //!< The maximum delay of a step with respect to its instant, in nanoseconds.
+	double degrees; //!< The angle which was rotated according to the encoder, in degrees.
+
+	//! This method returns the difference between the counts of the encoder and the ones of the given steps.
+	std::int64_t GetCountError() const {	return( counts - expectedCounts );	}
+	//! This method returns the mean time per step, in milliseconds.
+	double GetTimePerStep() const {	return( numOfSteps > 0 ? duration * 1e-6 / numOfSteps : 0.0 );	}
+};
+
+
+//! The class _StepperDriver_ moves the azimuth motor following a motion profile until the encoder reaches the requested angle.
+/*!	The intervals of the profile are computed before the movement, from the number of steps of the requested angle, and
+ * the steps are given at absolute instants of the monotonic clock, so the errors of the waits do not accumulate. Each
+ * wait sleeps while the remaining time is long and polls the clock after that. The movement finishes when the encoder
+ * reaches the angle: if the motor lost steps, the missing ones are given at the start rate, up to a limit. At the end,
+ * the given steps are checked against the counts of the encoder.
+ */
+class StepperDriver
+{
+	//Attributes//
+	//Constants
+	static const std::int64_t STEPS_PER_DEGREE = 1; //!< The number of steps of the motor per degree of the azimuth rotation, as the search of the north assumes.
+	static const std::int64_t COUNTS_PER_STEP = EncoderCounter::COUNTS_PER_DEGREE / STEPS_PER_DEGREE; //!< The number of counts of the encoder per step.
+	//Variables
+	StepperOutput & output; //!< The signals of the driver of the motor.
+	EncoderCounter & encoder; //!< The counter of the edges of the encoder of the azimuth rotator.
+	MotionProfile profile; //!< The motion profile of the movements.
+
+	//Private methods//
+	//! This method waits until the given instant of the monotonic clock and returns the delay with which the wait finished, in nanoseconds.
+	static std::int64_t WaitUntil(const std::int64_t time);
+public:
+	//Class Interface//
+	static const std::int64_t MAX_COUNT_ERROR = COUNTS_PER_STEP; //!< The maximum difference between the counts of the encoder and the ones of the given steps which is tolerated.
+	//! The constructor of the class _StepperDriver_.
+	StepperDriver(StepperOutput & stepperOutput, EncoderCounter & encoderCounter) : output(stepperOutput), encoder(encoderCounter) {}
+	//! This method sets the parameters of the motion profile.
+	void SetProfile(const MotionProfileParameters & param) {	profile.SetParameters(param);	}
+	//! This method returns the parameters of the motion profile.
+	const MotionProfileParameters & GetProfile() const {	return profile.GetParameters();	}
+	//! This method gives one step at the start rate of the profile, in the current direction.
+	void Step();
+	//! This method rotates the antenna the given angle (clockwise if it is positive), stopping when the encoder reaches it.
+	MoveStatistics Move(const double degrees);
+};
+
+
 //! An enumeration which contains the possible states of the antenna polarization: HORIZONTAL, VERTICAL or UNKNOWN.
 enum Polarization : char { HORIZONTAL=0, VERTICAL=1, UNKNOWN };
 
@@ -276,9 +1235,8 @@ class AntennaPositioner
 	    int posicion;
 	} pos_actual, pos_anterior;
 
-	static volatile float cuenta;
+	static EncoderCounter encoder; //!< The counter of the edges of the encoder of the azimuth rotator, which is updated by the interrupt service routines.
 	volatile float yaw;
-	float n;
 	int cantPosiciones; //Variable que almacena la cantidad de posiciones azimutales
 	int polar; //POLAR = 0 (HORIZONTAL) ; POLAR = 1 (VERTICAL)
 	bool band_mueve_inicial;
@@ -286,8 +1244,21 @@ class AntennaPositioner
 	bool band_salta;
 	bool band_gps_ok;
 	GPSInterface & gpsInterface;
+	GPIOStepperOutput stepperOutput; //!< The GPIO pins of the driver of the azimuth motor.
+	StepperDriver stepper; //!< The driver of the azimuth motor, which gives the steps following the motion profile.
+	MoveStatistics lastRotation; //!< The statistics of the last azimuth rotation.
 	//Variables agregadas por mauro
 	double anguloInicial;
+	//Attributes of the move thread
+	pthread_t moveThread; //!< The ID of the thread which moves the antenna to the next position, so the movement overlaps the processing of the last sweep.
+	bool flagMoveThread; //!< A flag which indicates if the move thread is running. If it is not, the movements are done synchronously.
+	bool flagStopMoving; //!< A flag which asks the move thread to finish.
+	bool flagMoveRequested; //!< A flag which indicates a movement was requested and the move thread has not taken it yet.
+	bool flagMoving; //!< A flag which indicates a movement was requested and it has not finished yet.
+	std::promise<bool> movePromise; //!< The promise of the requested movement, whose future is returned by StartNextPosition().
+	double lastMoveTime; //!< The duration of the last movement, in seconds.
+	pthread_mutex_t moveMutex; //!< The mutex which protects the attributes of the requested movement.
+	pthread_cond_t moveCond; //!< The condition the move thread waits for when no movement was requested.
 
 	//Private methods//
 	void inicia_variables();
@@ -297,15 +1268,20 @@ class AntennaPositioner
 	bool actualizaActual(float pasos_aux);
 	void un_paso();
 	bool regresar();
+	void verificaFlancos(const std::uint64_t repetidosIniciales);
+	void verificaPasos(const MoveStatistics & giro);
+	//! This method changes the polarization and, when it becomes horizontal, moves the antenna to the next azimuth position, measuring the duration.
+	bool MoveToNextPosition();
+	//! This method is executed by the move thread to do the requested movements.
+	void ProcessMoves();
 public:
 	//! The unique constructor of the class _AntennaPositioner_.
 	AntennaPositioner(GPSInterface & gpsInterf);
 	//! The class destructor.
-	/*!	Its implementation is empty because the attributes are implicitly destroyed. However, the
-	 * destructor is defined here to allow this one to be called explicitly in any part of the code,
-	 * what is used by the signals handler to destroy the objects when a signal to finish the execution
-	 * of the software is received. */
-	~AntennaPositioner() {}
+	/*!	It finishes the move thread, waiting for the current movement, if any. The destructor can be called
+	 * explicitly in any part of the code, what is used by the signals handler to destroy the objects when a
+	 * signal to finish the execution of the software is received. */
+	~AntennaPositioner();
 	//! This method allows to set the number of azimuth positions.
 	void SetNumOfAzimPos(unsigned int number) {	cantPosiciones=number;	}
 	//! This method performs the initialization of the antenna positioning system.
@@ -314,6 +1290,14 @@ public:
 	bool NextAzimPosition();
 	//! This method change the antenna polarization.
 	bool ChangePolarization();
+	//! This method starts the movement of the antenna to the next position (polarization and, if needed, azimuth) in the move thread and returns a future to wait for it.
+	std::future<bool> StartNextPosition();
+	//! This method returns the duration of the last movement which was started with StartNextPosition(), in seconds.
+	double GetLastMoveTime() const {	return lastMoveTime;	}
+	//! This method returns the statistics of the azimuth rotation of the last movement which was started with StartNextPosition(). They are empty if the antenna was not rotated.
+	const MoveStatistics & GetLastRotationStatistics() const {	return lastRotation;	}
+	//! This method sets the motion profile of the azimuth rotations: the start and cruise step rates, the acceleration and the deceleration.
+	void SetMotionProfile(const MotionProfileParameters & param) {	stepper.SetProfile(param);	}
 	//! This method returns the current antenna azimuth angle.
 	float GetAzimPosition() const {		return pos_actual.grados;	}
 	//! This method returns the current antenna polarization, as a `std::string` object.
@@ -326,10 +1310,14 @@ public:
 	//unsigned int GetNumOfPositions() const {	return NUM_OF_POSITIONS;	}
 	//! This method states if the current position is the last one.
 	bool IsLastPosition() const {	return ( pos_actual.posicion >= (cantPosiciones-1) );	}
+	//! This method returns the statistics of the edges of the encoder, so the missed edges can be detected.
+	EncoderStatistics GetEncoderStatistics() const {	return encoder.GetStatistics();	}
 
 	//Friends functions//
 	friend void canalA();
 	friend void canalB();
+	//! The function which is executed by the move thread.
+	friend void *MoveThreadFunc(void * arg);
 };
 
 #endif /* ANTENNAPOSITIONING_H_ */
@@ -0,0 +1,199 @@
+/*! \file AttitudeFilter.cpp
+ * 	\brief This file contains the definitions of several methods of the class _AttitudeFilter_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "AntennaPositioning.h"
+
+const std::int64_t AttitudeFilter::MAX_GYRO_INTERVAL;
+
+/*!	\param [in,out] state The state of the filter of an angle.
+ * 	\param [in] time The current instant, in nanoseconds.
+ */
+void AttitudeFilter::AddRandomWalk(AngleState & state, const std::int64_t time)
+{
+	if(time > state.lastUpdateTime)
+	{
+		state.variance += RANDOM_WALK * RANDOM_WALK * (time - state.lastUpdateTime) * 1e-9;
+		state.lastUpdateTime = time;
+	}
+}
+
+/*!	An axis is used when its correlation is larger than MIN_CORRELATION and than four times the correlations of the
+ * other axes.
+ * \param [in] state The state of the filter of an angle.
+ * \param [out] sign The sign which must be applied to the rate of the axis: 1.0 or -1.0.
+ * \return The index of the axis (0 for x, 1 for y and 2 for z), or -1 if it is not known yet.
+ */
+int AttitudeFilter::GetGyroAxis(const AngleState & state, double & sign) const
+{
+	int bestAxis=0;
+	for(int axis=1; axis<3; axis++)
+		if( std::fabs(state.correlations[axis]) > std::fabs(state.correlations[bestAxis]) )
+			bestAxis=axis;
+
+	double otherCorrelation=0.0;
+	for(int axis=0; axis<3; axis++)
+		if(axis!=bestAxis)
+			otherCorrelation = std::max( otherCorrelation, std::fabs(state.correlations[axis]) );
+
+	const double bestCorrelation = std::fabs(state.correlations[bestAxis]);
+	if( bestCorrelation < MIN_CORRELATION || bestCorrelation < 4.0*otherCorrelation )
+		return -1;
+
+	sign = ( state.correlations[bestAxis] > 0.0 ? 1.0 : -1.0 );
+	return bestAxis;
+}
+
+/*!	\param [in] angle An angle, in degrees.
+ * 	\param [in] angleIndex The angle whose range must be used.
+ * 	\return The equivalent angle in the range 0 to 360 (yaw) or -180 to 180 (pitch and roll).
+ */
+double AttitudeFilter::WrapAngle(const double angle, const Angle angleIndex)
+{
+	double wrappedAngle = std::fmod(angle, 360.0);
+	if(wrappedAngle < 0.0)
+		wrappedAngle += 360.0;
+	if(angleIndex!=YAW && wrappedAngle > 180.0)
+		wrappedAngle -= 360.0;
+	return wrappedAngle;
+}
+
+/*!	The rotation of each axis between the previous sample and this one is integrated with the trapezoidal rule. The
+ * angles whose gyroscope axis is known are rotated and their variance grows with the uncertainty of the rates. The
+ * variance of the other angles grows with the square of the largest rotation, since any of them could have rotated
+ * that much. The samples which arrive after a gap longer than MAX_GYRO_INTERVAL are not integrated.
+ * \param [in] time The instant when the sample was received, in nanoseconds.
+ * \param [in] x The rate of the x axis, in degrees/s.
+ * \param [in] y The rate of the y axis, in degrees/s.
+ * \param [in] z The rate of the z axis, in degrees/s.
+ */
+void AttitudeFilter::AddGyroData(const std::int64_t time, const double x, const double y, const double z)
+{
+	const double rates[3] = { x, y, z };
+
+	if( flagGyroData && time > lastGyroTime && time - lastGyroTime <= MAX_GYRO_INTERVAL )
+	{
+		const double interval = (time - lastGyroTime) * 1e-9;
+		double rotations[3], maxRotation=0.0;
+		for(unsigned int axis=0; axis<3; axis++)
+		{
+			rotations[axis] = 0.5 * (lastRates[axis] + rates[axis]) * interval;
+			maxRotation = std::max( maxRotation, std::fabs(rotations[axis]) );
+		}
+
+		for(unsigned int i=0; i<NUM_OF_ANGLES; i++)
+		{
+			AngleState & state = states[i];
+			if(!state.flagInitialized)
+				continue;
+
+			for(unsigned int axis=0; axis<3; axis++)
+				state.rotations[axis] += rotations[axis];
+
+			AddRandomWalk(state, time);
+			double sign;
+			const int axis = GetGyroAxis(state, sign);
+			if(axis >= 0)
+			{
+				state.angle = WrapAngle( state.angle + sign*rotations[axis], Angle(i) );
+				state.variance += (GYRO_DEVIATION * interval) * (GYRO_DEVIATION * interval);
+			}
+			else
+				state.variance += maxRotation * maxRotation;
+		}
+	}
+
+	std::copy(rates, rates + 3, lastRates);
+	lastGyroTime=time;
+	flagGyroData=true;
+}
+
+/*!	Before the correction, the change of the measured angle since the previous measurement is correlated with the
+ * rotations of the gyroscope axes in the same interval. The innovations which are larger than GATE standard deviations
+ * increase the variance by their square, so the estimate follows a movement which was not predicted.
+ * \param [in] angleIndex The angle which is corrected.
+ * \param [in] time The instant when the measurement was received, in nanoseconds.
+ * \param [in] measurement The measured angle, in degrees.
+ * \param [in] deviation The standard deviation of the measurement, in degrees.
+ */
+void AttitudeFilter::Correct(const Angle angleIndex, const std::int64_t time, const double measurement, const double deviation)
+{
+	AngleState & state = states[angleIndex];
+	const double measurementVariance = deviation * deviation;
+
+	if(!state.flagInitialized)
+	{
+		state = AngleState();
+		state.angle = WrapAngle(measurement, angleIndex);
+		state.variance = measurementVariance;
+		state.lastUpdateTime = time;
+		state.lastMeasurement = measurement;
+		state.flagInitialized = true;
+		return;
+	}
+
+	const double change = WrapAngle(measurement - state.lastMeasurement, PITCH);
+	for(unsigned int axis=0; axis<3; axis++)
+	{
+		state.correlations[axis] += change * state.rotations[axis];
+		state.rotations[axis] = 0.0;
+	}
+	state.lastMeasurement = measurement;
+
+	AddRandomWalk(state, time);
+	const double innovation = WrapAngle(measurement - state.angle, PITCH);
+	if( innovation*innovation > GATE*GATE*(state.variance + measurementVariance) )
+		state.variance += innovation*innovation;
+
+	const double gain = state.variance / (state.variance + measurementVariance);
+	state.angle = WrapAngle(state.angle + gain*innovation, angleIndex);
+	state.variance *= (1.0 - gain);
+}
+
+/*!	\param [in] time The instant when the compass sample was received, in nanoseconds.
+ * 	\param [in] yaw The yaw angle which was calculated from the compass sample, in degrees.
+ */
+void AttitudeFilter::AddYaw(const std::int64_t time, const double yaw)
+{
+	Correct(YAW, time, yaw, YAW_DEVIATION);
+}
+
+/*!	\param [in] time The instant when the accelerometer sample was received, in nanoseconds.
+ * 	\param [in] pitch The pitch angle which was calculated from the accelerometer sample, in degrees.
+ * 	\param [in] roll The roll angle which was calculated from the accelerometer sample, in degrees.
+ * 	\param [in] accelMagnitude The magnitude of the measured acceleration, in g.
+ */
+void AttitudeFilter::AddTilt(const std::int64_t time, const double pitch, const double roll, const double accelMagnitude)
+{
+	const double accelerDeviation = ACCELER_DEVIATION_GAIN * (accelMagnitude - 1.0);
+	const double deviation = std::sqrt( TILT_DEVIATION*TILT_DEVIATION + accelerDeviation*accelerDeviation );
+	Correct(PITCH, time, pitch, deviation);
+	Correct(ROLL, time, roll, deviation);
+}
+
+/*!	The angles which were never measured are zero and their standard deviation is 180°. */
+AttitudeEstimate AttitudeFilter::GetEstimate() const
+{
+	double angles[NUM_OF_ANGLES], deviations[NUM_OF_ANGLES];
+	for(unsigned int i=0; i<NUM_OF_ANGLES; i++)
+	{
+		angles[i] = ( states[i].flagInitialized ? states[i].angle : 0.0 );
+		deviations[i] = ( states[i].flagInitialized ? std::sqrt(states[i].variance) : 180.0 );
+	}
+
+	AttitudeEstimate estimate;
+	estimate.yaw = angles[YAW]; estimate.pitch = angles[PITCH]; estimate.roll = angles[ROLL];
+	estimate.yawDeviation = deviations[YAW]; estimate.pitchDeviation = deviations[PITCH]; estimate.rollDeviation = deviations[ROLL];
+	estimate.flagValid = states[YAW].flagInitialized && states[PITCH].flagInitialized && states[ROLL].flagInitialized;
+	return estimate;
+}
+
+void AttitudeFilter::Reset()
+{
+	for(unsigned int i=0; i<NUM_OF_ANGLES; i++)
+		states[i] = AngleState();
+	std::fill(lastRates, lastRates + 3, 0.0);
+	lastGyroTime=0;
+	flagGyroData=false;
+}
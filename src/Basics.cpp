@@ -82,6 +82,50 @@ void WaitForEnter()
     cin.get();
 }
 
+/*! The function implements the Fowler-Noll-Vo hash (variant FNV-1a, 64 bits). It is not a cryptographic hash,
+ * 	it is just intended to produce a compact key which changes when the given data change. The hash of several
+ * 	blocks can be chained passing the hash of the previous block as the initial value.
+ * 	\param [in] data A pointer to the first byte of the block.
+ * 	\param [in] numOfBytes The size of the block in bytes.
+ * 	\param [in] initValue The initial value of the hash, which by default is the FNV offset basis.
+ */
+std::uint64_t CalculateHash(const void * data, const std::size_t numOfBytes, const std::uint64_t initValue)
+{
+	const std::uint64_t FNV_PRIME = 1099511628211ULL;
+	auto bytePtr = (const std::uint8_t*) data;
+	std::uint64_t hash = initValue;
+
+	for(std::size_t i=0; i<numOfBytes; i++)
+	{
+		hash ^= bytePtr[i];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+/*! The fields are hashed one by one, instead of hashing the whole structures, to avoid taking into account the padding bytes.
+ * 	\param [in] bandsParameters The parameters of all frequency bands.
+ */
+std::uint64_t CalculateHash(const std::vector<BandParameters> & bandsParameters)
+{
+	std::uint64_t hash = CalculateHash(nullptr, 0);
+	for(const auto & band : bandsParameters)
+	{
+		hash = CalculateHash( &band.bandNumber, sizeof(band.bandNumber), hash );
+		hash = CalculateHash( &band.flagEnable, sizeof(band.flagEnable), hash );
+		hash = CalculateHash( &band.startFreq, sizeof(band.startFreq), hash );
+		hash = CalculateHash( &band.stopFreq, sizeof(band.stopFreq), hash );
+		hash = CalculateHash( &band.rbw, sizeof(band.rbw), hash );
+		hash = CalculateHash( &band.vbw, sizeof(band.vbw), hash );
+		hash = CalculateHash( &band.sweepTime, sizeof(band.sweepTime), hash );
+		hash = CalculateHash( &band.flagDefaultSamplePoints, sizeof(band.flagDefaultSamplePoints), hash );
+		hash = CalculateHash( &band.samplePoints, sizeof(band.samplePoints), hash );
+		hash = CalculateHash( &band.detector, sizeof(band.detector), hash );
+	}
+	return hash;
+}
+
 /*! \param [in] vect A `std::vector<float>` container which must be negated.	*/
 std::vector<FreqValues::value_type> operator-(const std::vector<FreqValues::value_type> & vect)
 {
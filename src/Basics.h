@@ -64,6 +64,18 @@
 #include <pthread.h>
 // This library has been included to use the function std::max_element().
 #include <algorithm>
+// This library is used to measure time intervals with the monotonic clock `std::chrono::steady_clock`.
+#include <chrono>
+// This library is included to use the functions `std::memcpy()` and `strerror()`.
+#include <cstring>
+// This header declares the function `mmap()`, which is used to map files into memory to read them without copying them through streams.
+#include <sys/mman.h>
+// This header declares the function `fstat()`, which is used to know the size of a file.
+#include <sys/stat.h>
+// This header declares the function `open()` and its flags, which are used to get file descriptors.
+#include <fcntl.h>
+// This header declares the API of the library liblzma, which is used to compress the archives with the LZMA and XZ formats.
+#include <lzma.h>
 
 #ifdef RASPBERRY_PI
 // WiringPi is a PIN based GPIO access library for the SoC devices used in all Raspberry Pi versions.
@@ -221,6 +233,7 @@ struct TimeData
 	unsigned int hour; //!< This variable stores the hours as a number that can be between 0 and 23.
 	unsigned int minute; //!< This variable stores the minutes as a number that can be between 0 and 59.
 	unsigned int second; //!< This variable stores the seconds as a number that can be between 0 and 59.
+	unsigned int nanosecond; //!< This variable stores the fraction of the second, in nanoseconds, which is zero when the time was given with a resolution of one second.
 
 	//! The class' constructor which clear all attributes, i.e. set date and time as 00-00-0000T00:00:00.
 	TimeData() {	Clear();	}
@@ -233,6 +246,8 @@ struct TimeData
 	std::string GetTime() const;
 	//! A method to get a timestamp as a `std::string` with the format DD-MM-YYYYTHH:MM:SS.
 	std::string GetTimestamp() const {		return ( GetDate() + 'T' + GetTime() );		}
+	//! A method to get a timestamp as a `std::string` with the format DD-MM-YYYYTHH:MM:SS.UUUUUU, i.e. with microseconds.
+	std::string GetPreciseTimestamp() const;
 	//! This method is intended to set just the date.
 	void SetDate(const std::string & date);
 	//! This method is intended to set just the time.
@@ -244,7 +259,7 @@ struct TimeData
 	//! An overloading of the assignment operator.
 	const TimeData& operator=(const TimeData& anotherTimeData);
 	//! A method to clear all attributes, i.e. it set the object as 00-00-00T00:00:00.
-	void Clear() {	year=month=day=hour=minute=second=0;	}
+	void Clear() {	year=month=day=hour=minute=second=nanosecond=0;	}
 
 	//Friends functions//
 	//! An overloading of the operator < to compare two TimeData objects as the first one lesser than the second one.
@@ -270,6 +285,9 @@ struct FreqValues
 	//! The copy constructor
 	/*! \param [in] freqValues Another _FreqValues_ structure which is given to copy its attributes.	*/
 	FreqValues(const FreqValues& freqValues) {	operator=(freqValues);	}
+	//! The move constructor, which takes the data points of another _FreqValues_ structure without copying them.
+	/*! \param [in] freqValues Another _FreqValues_ structure whose data points are moved to this one.	*/
+	FreqValues(FreqValues&& freqValues) {	operator=( std::move(freqValues) );	}
 	//! This is the structure's destructor which is virtual because there are structures derived from this structure.
 	virtual ~FreqValues() {}
 	//! This method is intended to insert one data point (frequency,value) or a set of data points in the structure, at the end.
@@ -280,6 +298,13 @@ struct FreqValues
 	bool Empty() const {	return values.empty();	}
 	//! An overloading of the assignment operator adapted for this structure.
 	const FreqValues& operator=(const FreqValues & freqValues);
+	//! An overloading of the move assignment operator adapted for this structure.
+	/*! \param [in] freqValues Another _FreqValues_ structure whose data points are moved to this one.	*/
+	const FreqValues& operator=(FreqValues && freqValues)
+	{
+		values=std::move(freqValues.values); frequencies=std::move(freqValues.frequencies); timeData=freqValues.timeData;
+		return *this;
+	}
 	//! An overloading of the operator += adapted for this structure.
 	const FreqValues& operator+=(const FreqValues& rhs);
 	//! The aim of this method is to offer the mean value of all data points, i.e. it calculates the average.
@@ -356,10 +381,21 @@ struct Sweep : public FreqValues
 	//! A copy constructor which receives a _Sweep_ object.
 	/*!	\param [in] sweep Another _Sweep_ structure which is given to copy its attributes.	*/
 	Sweep(const Sweep & sweep) {	operator=(sweep);		}
+	//! The move constructor, which takes the data of another _Sweep_ object without copying the data points.
+	/*!	\param [in] sweep Another _Sweep_ structure whose data are moved to this one.	*/
+	Sweep(Sweep && sweep) {	operator=( std::move(sweep) );	}
 	//! The aim of this method is to clean the structure, i.e. to delete all data points, set azimuth angle to zero and clean polarization.
 	void Clear() {	FreqValues::Clear(); azimuthAngle=0.0; polarization.clear();	}
 	//! An overloading of the assignment operator adapted to this structure.
 	const Sweep & operator=(const Sweep & sweep);
+	//! An overloading of the move assignment operator adapted to this structure.
+	/*!	\param [in] sweep Another _Sweep_ structure whose data are moved to this one.	*/
+	const Sweep & operator=(Sweep && sweep)
+	{
+		FreqValues::operator=( std::move(sweep) );
+		azimuthAngle=sweep.azimuthAngle; polarization=std::move(sweep.polarization);
+		return *this;
+	}
 
 	//Friends functions//
 	//! An overloading of the unary operator - which negates a _Sweep_ object.
@@ -424,8 +460,8 @@ struct Sweep : public FreqValues
 //! The aim of this structure is to store the data related with the detected RF interference (RFI): frequency, power, azimuth angle, polarization, time, reference norm, etc.
 struct RFI : public FreqValues
 {
-	//! Enumeration which contains the reference documents (recommendations, protocols, etc.) of harmful RFI levels (a.k.a. thresholds): the ITU recommendation RA.769-2, SKA protocol Mode 1, SKA protocol Mode 2.
-	enum ThresholdsNorm {ITU_RA769_2_VLBI, SKA_MODE1, SKA_MODE2};
+	//! Enumeration which contains the reference documents (recommendations, protocols, etc.) of harmful RFI levels (a.k.a. thresholds): the ITU recommendation RA.769-2, SKA protocol Mode 1, SKA protocol Mode 2. The last value, NOISE_FLOOR, indicates the RFI was detected relative to the estimated noise floor of the sweep instead of a norm.
+	enum ThresholdsNorm {ITU_RA769_2_VLBI, SKA_MODE1, SKA_MODE2, NOISE_FLOOR};
 	float azimuthAngle; //!< The azimuth angle where this RFI was detected.
 	std::string polarization; //!< The antenna polarization of the sweep where the RFI was detected.
 	unsigned int numOfRFIBands; //!< The number of RFI bands defined as intervals of continuous data points where it was detected RFI.
@@ -435,6 +471,9 @@ struct RFI : public FreqValues
 	//! The copy constructor which receives a _RFI_ object.
 	/*! \param [in] rfi A _RFI_ structure given to copy its attributes.	*/
 	RFI(const RFI & rfi) {	operator=(rfi);		}
+	//! The move constructor, which takes the data of another _RFI_ object without copying the data points.
+	/*! \param [in] rfi A _RFI_ structure whose data are moved to this one.	*/
+	RFI(RFI && rfi) {	operator=( std::move(rfi) );	}
 	//! The aim of this method is to clean the attributes of this structure.
 	void Clear() { 	FreqValues::Clear(); azimuthAngle=0.0; numOfRFIBands=0; polarization.clear();	}
 	//! An overloading of the assignment operator adapted to receive a _RFI_ object.
@@ -446,6 +485,15 @@ struct RFI : public FreqValues
 		frequencies=anotherRFI.frequencies; timeData=anotherRFI.timeData; values=anotherRFI.values;
 		return *this;
 	}
+	//! An overloading of the move assignment operator adapted to receive a _RFI_ object.
+	/*! \param [in] anotherRFI Another _RFI_ structure whose data are moved to this one.	*/
+	const RFI & operator=(RFI && anotherRFI)
+	{
+		azimuthAngle=anotherRFI.azimuthAngle; polarization=std::move(anotherRFI.polarization);
+		numOfRFIBands=anotherRFI.numOfRFIBands; threshNorm=anotherRFI.threshNorm;
+		frequencies=std::move(anotherRFI.frequencies); timeData=anotherRFI.timeData; values=std::move(anotherRFI.values);
+		return *this;
+	}
 };
 
 //! This structure is intended to store the parameters which are used to configure the spectrum analyzer in each frequency band.
@@ -479,6 +527,11 @@ std::vector<FreqValues::value_type> operator-(const std::vector<FreqValues::valu
 //! This function stop the execution until any key is pressed by the user and it was used for debugging purpose.
 void WaitForEnter();
 
+//! This function calculates a 64-bit FNV-1a hash of a block of bytes, which is used to detect changes in frequency grids, bands parameters, etc.
+std::uint64_t CalculateHash(const void * data, const std::size_t numOfBytes, const std::uint64_t initValue=14695981039346656037ULL);
+//! This function calculates a 64-bit hash of the parameters of all frequency bands, which is used to detect changes in the band plan.
+std::uint64_t CalculateHash(const std::vector<BandParameters> & bandsParameters);
+
 //! This function initializes all GPIO pins which are used for the input and output signals, in the way it is described in structure _piPins_.
 void InitializeGPIO();
 
@@ -0,0 +1,161 @@
+/*! \file BufferedFileWriter.cpp
+ * 	\brief This file contains the definitions of several methods of the class _BufferedFileWriter_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataStorage.h"
+
+/*!	\param [in] bufferSize The size of the buffer in the user space, in bytes.	*/
+BufferedFileWriter::BufferedFileWriter(const std::size_t bufferSize) : buffer(bufferSize)
+{
+	fd=-1;
+	bufferedBytes=0;
+	externalStats=nullptr;
+	fileSize=0;
+}
+
+BufferedFileWriter::~BufferedFileWriter()
+{
+	try
+	{
+		Close();
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "\nWarning: " << exc.what() << endl;
+	}
+}
+
+void BufferedFileWriter::Count(const std::uint64_t syscalls, const std::uint64_t writes, const std::uint64_t syncs, const std::uint64_t bytes)
+{
+	stats.numOfSyscalls += syscalls;
+	stats.numOfWrites += writes;
+	stats.numOfSyncs += syncs;
+	stats.numOfBytes += bytes;
+
+	if(externalStats!=nullptr)
+	{
+		externalStats->numOfSyscalls += syscalls;
+		externalStats->numOfWrites += writes;
+		externalStats->numOfSyncs += syncs;
+		externalStats->numOfBytes += bytes;
+	}
+}
+
+/*!	If there was a file open, it is closed before.
+ * \param [in] path The path of the file.
+ * \param [in] flagAppend If it is `true` the data are written at the end of the file, keeping its previous content,
+ * otherwise the file is truncated.
+ */
+void BufferedFileWriter::Open(const std::string & path, const bool flagAppend)
+{
+	Close();
+
+	fd = open( path.c_str(), O_WRONLY | O_CREAT | (flagAppend ? O_APPEND : O_TRUNC), 0644 );
+	Count(1, 0, 0, 0);
+	if(fd < 0)
+	{
+		rfims_exception exc("the file " + path + " could not be opened");
+		exc.Append( strerror(errno) );
+		throw(exc);
+	}
+
+	filePath = path;
+	bufferedBytes = 0;
+
+	struct stat fileStatus;
+	fileSize = ( flagAppend && fstat(fd, &fileStatus)==0 ) ? fileStatus.st_size : 0;
+}
+
+void BufferedFileWriter::WriteToFile(const char * data, std::size_t numOfBytes)
+{
+	while(numOfBytes > 0)
+	{
+		ssize_t written = write(fd, data, numOfBytes);
+		Count(1, 1, 0, 0);
+		if(written < 0)
+		{
+			if(errno==EINTR)
+				continue;
+
+			rfims_exception exc("the data could not be written to the file " + filePath);
+			exc.Append( strerror(errno) );
+			throw(exc);
+		}
+		Count(0, 0, 0, written);
+		data += written;
+		numOfBytes -= written;
+	}
+}
+
+/*!	If the data do not fit in the free space of the buffer, the buffer is written to the file before, and if the data
+ * are bigger than the whole buffer they are written directly to the file.
+ * \param [in] data A pointer to the first byte of the data.
+ * \param [in] numOfBytes The number of bytes to be written.
+ */
+void BufferedFileWriter::Write(const void * data, const std::size_t numOfBytes)
+{
+	if(fd < 0)
+		throw rfims_exception("the data could not be written because there is no file open.");
+
+	if( bufferedBytes + numOfBytes > buffer.size() )
+		Flush();
+
+	if( numOfBytes >= buffer.size() )
+		WriteToFile( (const char*) data, numOfBytes );
+	else
+	{
+		std::memcpy( buffer.data() + bufferedBytes, data, numOfBytes );
+		bufferedBytes += numOfBytes;
+	}
+	fileSize += numOfBytes;
+}
+
+void BufferedFileWriter::Flush()
+{
+	if( fd>=0 && bufferedBytes>0 )
+	{
+		//The counter is cleared before, so the buffer is not written twice if there is an error
+		std::size_t numOfBytes = bufferedBytes;
+		bufferedBytes = 0;
+		WriteToFile( buffer.data(), numOfBytes );
+	}
+}
+
+void BufferedFileWriter::Sync()
+{
+	if(fd < 0)
+		return;
+
+	Flush();
+
+	int retValue = fdatasync(fd);
+	Count(1, 0, 1, 0);
+	if(retValue < 0)
+	{
+		rfims_exception exc("the file " + filePath + " could not be synchronized with the storage device");
+		exc.Append( strerror(errno) );
+		throw(exc);
+	}
+}
+
+void BufferedFileWriter::Close()
+{
+	if(fd < 0)
+		return;
+
+	try
+	{
+		Flush();
+	}
+	catch(rfims_exception & exc)
+	{
+		close(fd);
+		fd=-1;
+		throw;
+	}
+
+	close(fd);
+	Count(1, 0, 0, 0);
+	fd=-1;
+}
@@ -0,0 +1,106 @@
+/*! \file CSVFormatter.cpp
+ * 	\brief This file contains the definitions of several methods of the class _CSVFormatter_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataStorage.h"
+
+/*!	The buffer grows, at least, to the double of its size, so the lines are formatted without reallocations once the
+ * buffer has the size of the longest line.
+ * \param [in] numOfChars The number of characters which are going to be written.
+ * \return A pointer to the end of the text, where the new characters must be written.
+ */
+char * CSVFormatter::Reserve(const std::size_t numOfChars)
+{
+	if( length + numOfChars > buffer.size() )
+		buffer.resize( std::max( 2*buffer.size(), length + numOfChars ) );
+	return( buffer.data() + length );
+}
+
+/*!	\param [out] dest The position where the digits are written.
+ * \param [in] value The integer to be formatted.
+ * \return A pointer to the character after the last digit.
+ */
+char * CSVFormatter::FormatUnsigned(char * dest, std::uint64_t value)
+{
+	//The digits are obtained from the least significant one, so they are reversed
+	char digits[20];
+	unsigned int numOfDigits=0;
+	do
+	{
+		digits[numOfDigits++] = char( '0' + value%10 );
+		value /= 10;
+	}while(value > 0);
+
+	while(numOfDigits > 0)
+		*dest++ = digits[--numOfDigits];
+
+	return dest;
+}
+
+/*!	The format is the same one which is used by the streams with the flags `std::ios::fixed` and `std::ios::showpoint`.
+ * \param [out] dest The position where the text is written, which must have room for MAX_NUMBER_LENGTH characters.
+ * \param [in] value The value to be formatted.
+ * \param [in] precision The number of decimal digits.
+ * \return A pointer to the character after the last one.
+ */
+char * CSVFormatter::FormatWithPrintf(char * dest, const double value, const int precision)
+{
+	const int numOfChars = std::snprintf(dest, MAX_NUMBER_LENGTH, "%#.*f", precision, value);
+	if( numOfChars < 0 || std::size_t(numOfChars) >= MAX_NUMBER_LENGTH )
+		throw rfims_exception("a value could not be formatted as text.");
+	return( dest + numOfChars );
+}
+
+/*!	The value is multiplied by 10 as a `double`, what is exact for any `float`, and rounded to the nearest integer with
+ * the ties rounded to the even integer, the same rounding which is done by the class _SweepCodec_. The negative values
+ * which are rounded to zero keep their sign, so they are formatted as "-0.0", as the streams do.
+ * \param [out] dest The position where the text is written, which must have room for MAX_NUMBER_LENGTH characters.
+ * \param [in] value The value to be formatted.
+ * \return A pointer to the character after the last one.
+ */
+char * CSVFormatter::FormatOneDecimal(char * dest, const float value)
+{
+	const double scaledValue = double(value) * 10.0;
+	if( !( std::fabs(scaledValue) < 1e15 ) )
+		return FormatWithPrintf(dest, value, 1);
+
+	if( std::signbit(value) )
+		*dest++ = '-';
+
+	const std::uint64_t tenths = std::uint64_t( std::fabs( std::nearbyint(scaledValue) ) );
+	dest = FormatUnsigned(dest, tenths/10);
+	*dest++ = '.';
+	*dest++ = char( '0' + tenths%10 );
+
+	return dest;
+}
+
+/*!	The frequency in MHz with four decimal digits is the frequency in hundreds of Hz, so it is rounded with integer
+ * arithmetic. The streams format the value double(frequency)/1e6, whose error is much smaller than 1 Hz for the
+ * frequencies below 2^50 Hz, so both roundings only could differ when the frequency is exactly between two outputs
+ * (the remainder is 50 Hz). In that case, the value is formatted with snprintf(), as the streams do.
+ * \param [out] dest The position where the text is written, which must have room for MAX_NUMBER_LENGTH characters.
+ * \param [in] frequency The frequency value, in Hz.
+ * \return A pointer to the character after the last one.
+ */
+char * CSVFormatter::FormatFrequency(char * dest, const std::uint64_t frequency)
+{
+	const std::uint64_t remainder = frequency % 100;
+	if( remainder==50 || frequency >= (std::uint64_t(1) << 50) )
+		return FormatWithPrintf(dest, double(frequency)/1e6, 4);
+
+	const std::uint64_t hundreds = frequency/100 + ( remainder>50 ? 1 : 0 );
+	dest = FormatUnsigned(dest, hundreds/10000);
+	*dest++ = '.';
+
+	//The four decimal digits, with the leading zeros
+	std::uint64_t decimals = hundreds%10000;
+	for(int i=3; i>=0; i--)
+	{
+		dest[i] = char( '0' + decimals%10 );
+		decimals /= 10;
+	}
+
+	return( dest + 4 );
+}
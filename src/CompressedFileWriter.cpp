@@ -0,0 +1,195 @@
+/*! \file CompressedFileWriter.cpp
+ * 	\brief This file contains the definitions of several methods of the class _CompressedFileWriter_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataStorage.h"
+
+CompressedFileWriter::CompressedFileWriter() : outBuffer(131072), file(262144)
+{
+	format=XZ;
+	preset=6;
+	numOfThreads=0;
+	stream = LZMA_STREAM_INIT;
+	flagStreamOpen=false;
+	initialFileSize=0;
+}
+
+CompressedFileWriter::~CompressedFileWriter()
+{
+	if(flagStreamOpen)
+		lzma_end(&stream);
+}
+
+/*!	\param [in] form The format of the compressed files: XZ or LZMA_ALONE.
+ * \param [in] pres The compression preset, between 0 (the fastest) and 9 (the best compression). By default it is 6,
+ * which is the default preset of the utilities 'xz' and 'lzma'.
+ * \param [in] threads The number of threads which are used to compress with the XZ format. If it is 0, a thread per
+ * processor core is used. The LZMA format is always compressed with one thread.
+ */
+void CompressedFileWriter::SetParameters(const Format form, const std::uint32_t pres, const unsigned int threads)
+{
+	format=form;
+	preset = (pres<=9) ? pres : 9;
+	numOfThreads=threads;
+}
+
+/*!	If there was a file open, it is closed before, finishing its compression.
+ * \param [in] path The path of the compressed file.
+ * \param [in] flagAppend If it is `true` the compressed stream is written at the end of the file, keeping its previous
+ * content, otherwise the file is truncated. The XZ format allows several compressed streams to be concatenated in the same
+ * file, and they are decompressed as a single stream.
+ */
+void CompressedFileWriter::Open(const std::string & path, const bool flagAppend)
+{
+	Close();
+
+	lzma_ret ret;
+	if(format==LZMA_ALONE)
+	{
+		lzma_options_lzma options;
+		if( lzma_lzma_preset(&options, preset) )
+			throw( rfims_exception("the compression preset is not supported by liblzma.") );
+		ret = lzma_alone_encoder(&stream, &options);
+	}
+	else
+	{
+#if LZMA_VERSION >= 50020002
+		unsigned int threads = (numOfThreads>0) ? numOfThreads : lzma_cputhreads();
+		if(threads > 1)
+		{
+			lzma_mt mtOptions;
+			std::memset(&mtOptions, 0, sizeof(mtOptions));
+			mtOptions.threads = threads;
+			mtOptions.preset = preset;
+			mtOptions.check = LZMA_CHECK_CRC64;
+			ret = lzma_stream_encoder_mt(&stream, &mtOptions);
+		}
+		else
+#endif
+			ret = lzma_easy_encoder(&stream, preset, LZMA_CHECK_CRC64);
+	}
+
+	if(ret!=LZMA_OK)
+	{
+		rfims_exception exc("the compression stream of the file " + path + " could not be initialized");
+		exc.Append( ret==LZMA_MEM_ERROR ? "there is not enough memory." : "the compression options are not supported." );
+		throw(exc);
+	}
+	flagStreamOpen=true;
+
+	try
+	{
+		struct stat fileStatus;
+		initialFileSize = ( flagAppend && stat(path.c_str(), &fileStatus)==0 ) ? fileStatus.st_size : 0;
+		file.Open(path, flagAppend);
+	}
+	catch(std::exception & exc)
+	{
+		lzma_end(&stream);
+		flagStreamOpen=false;
+		throw;
+	}
+
+	stats.Clear();
+}
+
+/*!	The compressor consumes all the given data and the compressed data which it generates are written to the file
+ * through a buffer. When the action is LZMA_FINISH the compressor is called until the end of the stream is written.
+ * \param [in] data A pointer to the data to be compressed.
+ * \param [in] numOfBytes The number of bytes to be compressed.
+ * \param [in] action LZMA_RUN to compress data or LZMA_FINISH to finish the stream.
+ */
+void CompressedFileWriter::Compress(const void * data, const std::size_t numOfBytes, const lzma_action action)
+{
+	stream.next_in = (const std::uint8_t*) data;
+	stream.avail_in = numOfBytes;
+
+	lzma_ret ret;
+	do
+	{
+		stream.next_out = outBuffer.data();
+		stream.avail_out = outBuffer.size();
+
+		ret = lzma_code(&stream, action);
+		if(ret!=LZMA_OK && ret!=LZMA_STREAM_END)
+		{
+			rfims_exception exc("the compression of the file " + file.GetPath() + " failed");
+			exc.Append( ret==LZMA_MEM_ERROR ? "there is not enough memory." : "the compressor returned an error." );
+			throw(exc);
+		}
+
+		std::size_t numOfOutBytes = outBuffer.size() - stream.avail_out;
+		file.Write(outBuffer.data(), numOfOutBytes);
+		stats.numOfOutputBytes += numOfOutBytes;
+	}
+	while( stream.avail_in>0 || (action==LZMA_FINISH && ret!=LZMA_STREAM_END) );
+}
+
+/*!	\param [in] data A pointer to the data to be compressed.
+ * \param [in] numOfBytes The number of bytes to be compressed.
+ */
+void CompressedFileWriter::Write(const void * data, const std::size_t numOfBytes)
+{
+	if(!flagStreamOpen)
+		throw( rfims_exception("the compressed file writer was asked to write data but there is no file open.") );
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	Compress(data, numOfBytes, LZMA_RUN);
+	stats.numOfInputBytes += numOfBytes;
+
+	stats.elapsedTime += std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count();
+}
+
+/*!	If there is no file open, this method does nothing.	*/
+void CompressedFileWriter::Close()
+{
+	if(flagStreamOpen)
+	{
+		auto startTime = std::chrono::steady_clock::now();
+
+		try
+		{
+			Compress(nullptr, 0, LZMA_FINISH);
+			file.Close();
+		}
+		catch(std::exception & exc)
+		{
+			Abort();
+			throw;
+		}
+		lzma_end(&stream);
+		flagStreamOpen=false;
+
+		stats.elapsedTime += std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count();
+	}
+}
+
+/*!	This method should be called when the compression failed, to avoid leaving an incomplete file which could be
+ * mistaken for a valid one. If the stream was being appended to an existing file, the file is truncated to its previous
+ * size, so the streams which were written before are kept.
+ */
+void CompressedFileWriter::Abort()
+{
+	if(flagStreamOpen)
+	{
+		lzma_end(&stream);
+		flagStreamOpen=false;
+
+		std::string path = file.GetPath();
+		try
+		{
+			file.Close();
+		}
+		catch(std::exception & exc) {}
+
+		if(initialFileSize > 0)
+		{
+			if( truncate(path.c_str(), initialFileSize)!=0 )
+				cerr << "\nWarning: the incomplete compressed stream could not be removed from the file " << path << '.' << endl;
+		}
+		else
+			std::remove( path.c_str() );
+	}
+}
@@ -7,21 +7,22 @@
 
 ////////////////////Friends functions////////////////////////
 
-//! The function which is executed by the thread which is responsible for the concurrent uploading of the data files.
+//! The function which is executed by the thread which is responsible for the archiving and the uploading of the data files, in parallel with the capture.
 void *UploadThreadFunc(void *arg)
 {
 	auto * dataLoggerPtr = (DataLogger*) arg;
 
-	try
-	{
-		dataLoggerPtr->ArchiveAndCompress();
-		dataLoggerPtr->UploadData();
-	}
-	catch(std::exception & exc)
-	{
-		strcpy( dataLoggerPtr->threadMsg, exc.what() );
-		pthread_exit( (void*)dataLoggerPtr->threadMsg );
-	}
+	dataLoggerPtr->ProcessUploadJobs();
+
+	return NULL;
+}
+
+//! The function which is executed by the thread which is responsible for the saving of the sweeps and RFI which are inserted in the logging queue.
+void *LoggingThreadFunc(void *arg)
+{
+	auto * dataLoggerPtr = (DataLogger*) arg;
+
+	dataLoggerPtr->ProcessLogQueue();
 
 	return NULL;
 }
@@ -29,8 +30,11 @@ void *UploadThreadFunc(void *arg)
 //////////////////Class' methods////////////////////
 
 /*! The constructor initializes all the internal attributes, checks if the corresponding folders exist and if
- * any folder does not exist then it is created. Also, it checks if there is a shell available to be able to
- * execute the external python script "client.py" to upload the data.
+ * any folder does not exist then it is created. The persistent queue of files to upload is loaded, so the archives
+ * which were not uploaded before a restart are not forgotten, and the journal is read to repair the data of the
+ * measurement cycles which were interrupted by a power cut (see the method RecoverFromJournal()). Finally, the logging thread is created,
+ * which saves the sweeps and RFI inserted in the logging queue, and the upload thread, which archives and uploads
+ * the data of the finished measurement cycles. If these threads cannot be created, their work is done synchronously.
  */
 DataLogger::DataLogger()
 {
@@ -41,6 +45,21 @@ DataLogger::DataLogger()
 	flagUseSweepTimestamp=false;
 	uploadThread=0;
 	numOfSweeps=12;
+	durabilityPolicy=SYNC_PERIODIC;
+	syncPeriod=60;
+	lastSyncTime=std::chrono::steady_clock::now();
+	archiveFormat=CompressedFileWriter::XZ;
+	flagIncrementalArchive=false;
+	queueCapacity=8;
+	queueFullPolicy=BLOCK;
+	loggingThread=0;
+	flagLoggingThread=false;
+	flagStopLogging=false;
+	flagSavingElement=false;
+	flagUploadThread=false;
+	flagStopUploading=false;
+	uploadRetryPeriod=600;
+	storageQuota=0;
 
 	try
 	{
@@ -52,6 +71,9 @@ DataLogger::DataLogger()
 
 		if( !boost::filesystem::exists(FRONT_END_PARAM_PATH) )
 			boost::filesystem::create_directory(FRONT_END_PARAM_PATH);
+
+		if( !boost::filesystem::exists(UPLOADS_PATH) )
+			boost::filesystem::create_directory(UPLOADS_PATH);
 	}
 	catch(boost::filesystem::filesystem_error & exc)
 	{
@@ -60,32 +82,105 @@ DataLogger::DataLogger()
 		throw(rfimsExc);
 	}
 
-	ofs.exceptions( std::ofstream::failbit | std::ofstream::badbit );
-	ofs.setf(std::ios::fixed, std::ios::floatfield);
-	ofs.setf( std::ios::dec | std::ios::left | std::ios::showpoint);
+	uploader.Open(UPLOADS_PATH);
+
+	try
+	{
+		if( !retentionIndex.Open(RETENTION_INDEX_PATH) )
+			IndexExistingFiles();
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "\nWarning: the retention index could not be loaded: " << exc.what() << endl;
+	}
+
+	try
+	{
+		RecoverFromJournal();
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "\nWarning: the recovery from the journal failed: " << exc.what() << endl;
+	}
+
+	oss.setf(std::ios::fixed, std::ios::floatfield);
+	oss.setf( std::ios::dec | std::ios::left | std::ios::showpoint);
 
-	//It is controlled if the shell is available
-	if( system(nullptr)==0 )
-		cerr << "\nWarning: the shell is not available so the files will not be able to be compressed." << endl;
+	sweepStore.SetIOStatistics(&cycleIOStats);
+	rfiFile.SetIOStatistics(&cycleIOStats);
+
+	pthread_mutex_init(&queueMutex, NULL);
+	pthread_cond_init(&queueNotEmptyCond, NULL);
+	pthread_cond_init(&queueNotFullCond, NULL);
+	pthread_cond_init(&queueDrainedCond, NULL);
+
+	//Creating the logging thread
+	if( pthread_create(&loggingThread, NULL, LoggingThreadFunc, (void*)this)==0 )
+		flagLoggingThread=true;
+	else
+		cerr << "\nWarning: the creation of the logging thread failed so the data will be saved synchronously." << endl;
+
+	pthread_mutex_init(&jobsMutex, NULL);
+	pthread_cond_init(&jobsCond, NULL);
+
+	//Creating the upload thread
+	if( pthread_create(&uploadThread, NULL, UploadThreadFunc, (void*)this)==0 )
+		flagUploadThread=true;
+	else
+		cerr << "\nWarning: the creation of the upload thread failed so the data will be archived and uploaded synchronously." << endl;
 }
 
+/*! The destructor asks the logging thread to finish once all the elements of the logging queue have been saved,
+ * so no data are lost, and then it closes the files. Also, it asks the upload thread to finish once the pending
+ * measurement cycles have been archived, without uploading them, because the files which were not uploaded remain
+ * in the persistent upload queue and they are uploaded when the software starts again.
+ */
 DataLogger::~DataLogger()
 {
-	ofs.exceptions( std::ofstream::goodbit );
-	ofs.flush();
-	ofs.close();
+	if(flagUploadThread)
+	{
+		pthread_mutex_lock(&jobsMutex);
+		flagStopUploading=true;
+		if( !uploadJobs.empty() )
+			cout << "\nWaiting for " << uploadJobs.size() << " measurement cycle(s) to be archived" << endl;
+		pthread_cond_signal(&jobsCond);
+		pthread_mutex_unlock(&jobsMutex);
+
+		if( pthread_join(uploadThread, NULL)!=0 )
+			cerr << "\nWarning: The checking of finishing of the upload thread failed." << endl;
+	}
 
-	void **retval = (void**) &sweepIndex; //The pointer to the return value of the thread is initialized with the direction
-											//of any variable to avoid this pointer to be equal to NULL
+	pthread_cond_destroy(&jobsCond);
+	pthread_mutex_destroy(&jobsMutex);
 
-	// if the thread finished
-	int retValueJoin = pthread_join(uploadThread, retval);
-	//Checking if the last operation finished wrongly or if the thread does not exist
-	if(retValueJoin!=0 && retValueJoin!=ESRCH)
-		cerr << "\nWarning: The checking of finishing of the thread to upload data failed." << endl;
-	//Checking the value returned by the thread if that existed
-	if(retValueJoin==0 && retval!=NULL)
-		cerr << "\nWarning: " << (char*) (*retval) << endl;
+	if(flagLoggingThread)
+	{
+		pthread_mutex_lock(&queueMutex);
+		flagStopLogging=true;
+		pthread_cond_signal(&queueNotEmptyCond);
+		pthread_mutex_unlock(&queueMutex);
+
+		if( pthread_join(loggingThread, NULL)!=0 )
+			cerr << "\nWarning: The checking of finishing of the logging thread failed." << endl;
+		else if( !loggingErrorMsg.empty() )
+			cerr << "\nWarning: " << loggingErrorMsg << endl;
+	}
+
+	pthread_cond_destroy(&queueDrainedCond);
+	pthread_cond_destroy(&queueNotFullCond);
+	pthread_cond_destroy(&queueNotEmptyCond);
+	pthread_mutex_destroy(&queueMutex);
+
+	try
+	{
+		sweepStore.Close();
+		rfiFile.Close();
+		journal.Close();
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "\nWarning: " << exc.what() << endl;
+	}
 }
 
 /*! This method should be called each time the bands' parameters are reloaded (or loaded by first time),
@@ -99,48 +194,40 @@ DataLogger::~DataLogger()
  */
 void DataLogger::SaveBandsParamAsCSV(const std::vector<BandParameters> & bandsParamVector)
 {
+	//The elements of the logging queue use the bands parameters, so they must be saved before the parameters change
+	Drain();
+
 	if( !bandsParamVector.empty() )
 	{
 		boost::filesystem::path filePath(BANDS_PARAM_CSV_PATH);
 		filePath /= "freqbands.csv";
-		if( boost::filesystem::exists(filePath) )
-			boost::filesystem::remove(filePath);
 
-		try
-		{
-			ofs.open( filePath.string() );
-		}
-		catch(std::ofstream::failure& exc)
-		{
-			rfims_exception rfimsExc("the file " + filePath.string() + " could not be opened");
-			rfimsExc.Append( exc.what() );
-			throw( rfimsExc );
-		}
+		oss.str("");
 
 		//Saving the header row
-		ofs << "Band Index,Enabling,Fstart(MHz),Fstop(MHz),RBW(MHz),VBW(MHz),Sweep Time(ms),Sample Points,Detector\r\n";
+		oss << "Band Index,Enabling,Fstart(MHz),Fstop(MHz),RBW(MHz),VBW(MHz),Sweep Time(ms),Sample Points,Detector\r\n";
 
 		//Saving the data of each frequency band
 		for(const BandParameters & oneBandParam : bandsParamVector)
 		{
-			ofs << oneBandParam.bandNumber << ',';
-			ofs << oneBandParam.flagEnable << ',';
-			ofs << std::setprecision(2) << (oneBandParam.startFreq)/1e6 << ','; //It is saved in MHz
-			ofs << std::setprecision(2) << (oneBandParam.stopFreq)/1e6 << ','; //It is saved in MHz
-			ofs << std::setprecision(4) << (oneBandParam.rbw)/1e6 << ','; //It is saved in MHz
-			ofs << std::setprecision(4) << (oneBandParam.vbw)/1e6 << ','; //It is saved in MHz
-			ofs << oneBandParam.sweepTime << ','; //It is saved in ms
-			ofs << oneBandParam.samplePoints << ',';
+			oss << oneBandParam.bandNumber << ',';
+			oss << oneBandParam.flagEnable << ',';
+			oss << std::setprecision(2) << (oneBandParam.startFreq)/1e6 << ','; //It is saved in MHz
+			oss << std::setprecision(2) << (oneBandParam.stopFreq)/1e6 << ','; //It is saved in MHz
+			oss << std::setprecision(4) << (oneBandParam.rbw)/1e6 << ','; //It is saved in MHz
+			oss << std::setprecision(4) << (oneBandParam.vbw)/1e6 << ','; //It is saved in MHz
+			oss << oneBandParam.sweepTime << ','; //It is saved in ms
+			oss << oneBandParam.samplePoints << ',';
 			if( oneBandParam.detector==0 )
-				ofs << "RMS";
+				oss << "RMS";
 			else
-				ofs << "Min/Max";
-			ofs << "\r\n";
+				oss << "Min/Max";
+			oss << "\r\n";
 		}
 
-		ofs.flush();
-		ofs.close();
+		SaveTextFile(filePath);
 
+		bandsParameters = bandsParamVector;
 		flagNewBandsParam=true;
 	}
 	else
@@ -164,6 +251,9 @@ void DataLogger::SaveBandsParamAsCSV(const std::vector<BandParameters> & bandsPa
  */
 void DataLogger::SaveFrontEndParam(const FreqValues & gain, const FreqValues & noiseFigure)
 {
+	//The elements of the logging queue use the timestamp of the measurement cycle, so they must be saved before it changes
+	Drain();
+
 	if( !gain.Empty() && !noiseFigure.Empty() )
 	{
 		currMeasCycleTimestamp = gain.timeData.GetTimestamp();
@@ -173,56 +263,38 @@ void DataLogger::SaveFrontEndParam(const FreqValues & gain, const FreqValues & n
 		std::string filename("noisefigure_");
 		filename += currMeasCycleTimestamp + ".csv";
 		filePath /= filename;
-		try
-		{
-			ofs.open( filePath.string() );
-		}
-		catch(std::ofstream::failure& exc)
-		{
-			rfims_exception rfimsExc("the file " + filePath.string() + " could not be opened");
-			rfimsExc.Append( exc.what() );
-			throw( rfimsExc );
-		}
 
 		//Saving the noise figure data
-		ofs << "Timestamp";
+		oss.str("");
+		oss << "Timestamp";
 		for(const auto & freq : noiseFigure.frequencies)
-			ofs << ',' << std::setprecision(4) << double(freq)/1e6;
-		ofs << "\r\n";
-		ofs << currMeasCycleTimestamp;
+			oss << ',' << std::setprecision(4) << double(freq)/1e6;
+		oss << "\r\n";
+		oss << currMeasCycleTimestamp;
 		for(const auto& nf : noiseFigure.values)
-			ofs << ',' << std::setprecision(2) << nf;
-		ofs << "\r\n";
+			oss << ',' << std::setprecision(2) << nf;
+		oss << "\r\n";
 
-		ofs.flush();
-		ofs.close();
+		SaveTextFile(filePath);
+		retentionIndex.Add( gain.timeData, filePath.string() );
 
 		filename = "gain_" + currMeasCycleTimestamp + ".csv";
 		filePath.remove_filename();
 		filePath /= filename;
-		try
-		{
-			ofs.open( filePath.string() );
-		}
-		catch(std::ofstream::failure& exc)
-		{
-			rfims_exception rfimsExc("the file " + filePath.string() + " could not be opened");
-			rfimsExc.Append( exc.what() );
-			throw( rfimsExc );
-		}
 
 		//Saving the gain data
-		ofs << "Timestamp";
+		oss.str("");
+		oss << "Timestamp";
 		for(const auto& freq : gain.frequencies)
-			ofs << ',' << std::setprecision(4) << double(freq)/1e6;
-		ofs << "\r\n";
-		ofs << currMeasCycleTimestamp;
+			oss << ',' << std::setprecision(4) << double(freq)/1e6;
+		oss << "\r\n";
+		oss << currMeasCycleTimestamp;
 		for(const auto& g : gain.values)
-			ofs << ',' << std::setprecision(1) << g;
-		ofs << "\r\n";
+			oss << ',' << std::setprecision(1) << g;
+		oss << "\r\n";
 
-		ofs.flush();
-		ofs.close();
+		SaveTextFile(filePath);
+		retentionIndex.Add( gain.timeData, filePath.string() );
 
 		flagNewFrontEndParam=true;
 	}
@@ -231,14 +303,16 @@ void DataLogger::SaveFrontEndParam(const FreqValues & gain, const FreqValues & n
 }
 
 /*!	The given sweep is saved in [BASE_PATH](\ref BASE_PATH)/measurements/ with the filename format
- * "sweep_DD-MM-YYYYTHH:MM:SS.csv" where the last part is the timestamp of the measurement cycle,
+ * "sweeps_DD-MM-YYYYTHH:MM:SS.bin" where the last part is the timestamp of the measurement cycle,
  * which correspond to the beginning of this one.
  *
- * All sweeps which corresponds to the same measurement cycle are saved in the same file and the method
- * automatically create a new file or reopen the corresponding file each time a new sweep must be saved.
+ * All sweeps which corresponds to the same measurement cycle are saved in the same binary sweeps store file (see
+ * _SweepStoreWriter_): the bands parameters and the frequency values are written once, at the beginning of the file,
+ * and then each sweep is appended as a fixed-size record, without formatting its values as text. The file is converted
+ * to the CSV format when it is archived to be uploaded, in the method ArchiveAndCompress().
  * \param [in] sweep A structure with the sweep to be saved.
  */
-void DataLogger::SaveSweep(const Sweep & sweep)
+void DataLogger::WriteSweep(const Sweep & sweep)
 {
 	//The data are saved only if a sweep has been loaded
 	if( !sweep.Empty() )
@@ -254,140 +328,486 @@ void DataLogger::SaveSweep(const Sweep & sweep)
 			if(flagUseSweepTimestamp || !flagNewFrontEndParam)
 				currMeasCycleTimestamp=sweep.timeData.GetTimestamp();
 
+			//Closing the RFI file of the previous measurement cycle, if it was not closed
+			rfiFile.Close();
 
 			//Creating the new sweeps file
 			boost::filesystem::path filePath(MEASUREMENTS_PATH);
-			filePath /= ( "sweeps_" + currMeasCycleTimestamp + ".csv" );
-			try
-			{
-				ofs.open( filePath.string() );
-			}
-			catch(std::ofstream::failure& exc)
-			{
-				rfims_exception rfimsExc("the file " + filePath.string() + " could not be created");
-				rfimsExc.Append( exc.what() );
-				throw(rfimsExc);
-			}
-			
-			//Writing header with frequency values
-			ofs << "Timestamp,Azimuthal Angle,Polarization";
-			for(const auto& freq : sweep.frequencies)
-				ofs << ',' << std::setprecision(4) << double(freq)/1e6; //The frequency values are saved in MHz
-			ofs << "\r\n";
+			filePath /= ( "sweeps_" + currMeasCycleTimestamp + ".bin" );
+			sweepStore.Open( filePath.string(), bandsParameters, sweep.frequencies );
+
+			//The flags which define the parameters files of the cycle are journaled, so the cycle can be archived after a power cut
+			const std::uint64_t paramFlags = (flagNewFrontEndParam ? 1 : 0) | (flagNewBandsParam ? 2 : 0);
+			journal.Append( MeasurementJournal::Record(MeasurementJournal::CYCLE_STARTED, currMeasCycleTimestamp, "", paramFlags) );
+
+			//Starting the archive of the new measurement cycle, which is built while the data are saved
+			if(flagIncrementalArchive && archiveFormat==CompressedFileWriter::XZ)
+				try
+				{
+					boost::filesystem::path archivePath(UPLOADS_PATH);
+					archivePath /= ( "rfims_data_" + currMeasCycleTimestamp + ".tar" + CompressedFileWriter::GetExtension(archiveFormat) );
+					cycleArchive.Open( archivePath.string(), "sweeps_" + currMeasCycleTimestamp + ".csv" );
+
+					//The parameters files are known since the beginning of the cycle
+					for(const auto & paramFile : GetParamFilesToArchive())
+						cycleArchive.AddFile( paramFile.first, paramFile.second.string() );
+
+					csvFormatter.Clear();
+					SweepStoreReader::WriteCSVHeader( csvFormatter, sweep.frequencies.data(), sweep.frequencies.size() );
+					cycleArchive.WriteSweepsText( csvFormatter.Data(), csvFormatter.Size() );
+				}
+				catch(std::exception & exc)
+				{
+					cycleArchive.Abort();
+					cerr << "\nWarning: " << exc.what() << " The data will be archived at the end of the measurement cycle." << endl;
+				}
 		}
-		else
-		{
-			//Opening an existing sweeps file
-			boost::filesystem::path filePath(MEASUREMENTS_PATH);
-			filePath /= ( "sweeps_" + currMeasCycleTimestamp + ".csv" );
+
+		sweepStore.Append(sweep);
+		journal.Append( MeasurementJournal::Record(MeasurementJournal::SWEEP_SAVED, currMeasCycleTimestamp, "", sweepStore.GetSize()) );
+
+		//The sweep is formatted as a row of the CSV sweeps file, as it is done when the sweeps store is exported, and compressed
+		if( cycleArchive.IsOpen() )
 			try
 			{
-				ofs.open( filePath.string(), std::ofstream::out | std::ofstream::app );
+				csvFormatter.Clear();
+				const std::string & polarization = ( sweep.polarization=="horizontal" || sweep.polarization=="vertical" ) ? sweep.polarization : "";
+				SweepStoreReader::WriteCSVRow( csvFormatter, sweep.timeData.GetTimestamp(), sweep.azimuthAngle, polarization, sweep.values.data(), sweep.values.size() );
+				cycleArchive.WriteSweepsText( csvFormatter.Data(), csvFormatter.Size() );
 			}
-			catch(std::ofstream::failure& exc)
+			catch(std::exception & exc)
 			{
-				rfims_exception rfimsExc("the file " + filePath.string() + " could not be opened");
-				rfimsExc.Append( exc.what() );
-				throw( rfimsExc );
+				cycleArchive.Abort();
+				cerr << "\nWarning: " << exc.what() << " The data will be archived at the end of the measurement cycle." << endl;
 			}
-		}
-		
-		//Writing the extra data
-		ofs << sweep.timeData.GetTimestamp();
-		ofs << ',' << std::setprecision(1) << sweep.azimuthAngle;
-		ofs << ',' << sweep.polarization;
-
-		//Writing sweep's power values
-		for(const auto& power : sweep.values)
-			ofs << ',' << std::setprecision(1) << power; //The power values are saved in dBm with just one decimal digit
-		ofs << "\r\n";
-		
-		ofs.flush();
-		ofs.close();
+
+		ApplyDurabilityPolicy();
 	}
 	else
 		throw( rfims_exception("the data logger was asked to save an empty sweep.") );
 }
 
-/*! Each given structure with the RFI detected in the last sweep is saved in a different file with the filename format
- * RFI_x.csv, where 'x' is an integer number between 1 and 2*(number of azimuth positions). So each file corresponds to
- * a sweep of the measurement cycle and all the files of determined measurement cycle are in the same folder,
- * [BASE_PATH](\ref BASE_PATH)/measurement/RFI_DD-MM-YYYYTHH:MM:SS/ where the last part of the folder's name is the
- * timestamp of the measurement cycle.
+/*! The RFI which is detected in the sweeps of a measurement cycle is appended to a single file,
+ * [BASE_PATH](\ref BASE_PATH)/measurements/RFI_DD-MM-YYYYTHH:MM:SS.csv, where the last part of the filename is the
+ * timestamp of the measurement cycle. The file is kept open during the whole cycle, to avoid the creation of a file
+ * per sweep. Each RFI structure is preceded by a line "#RFI_x.csv", where 'x' is an integer number between 1 and
+ * 2*(number of azimuth positions), followed by the header and the values, so the file can be split, when the data are
+ * archived, in the files RFI_x.csv which are expected by the remote server, one per sweep, in the folder
+ * RFI_DD-MM-YYYYTHH:MM:SS/. The RFI which was detected relative to the noise floor, instead of a norm, is identified
+ * with the name RFI_NF_x.csv.
  * \param [in] rfi A structure with RFI to be saved.
  */
-void DataLogger::SaveRFI(const RFI& rfi)
+void DataLogger::WriteRFI(const RFI& rfi)
 {
 	if( !rfi.Empty() )
 	{
-		boost::filesystem::path filePath(MEASUREMENTS_PATH);
-
-		//Adding the folder's name to the path
-		filePath /= ("RFI_" + currMeasCycleTimestamp); //This variable is controlled in SaveSweep() or SaveFrontEndParam()
-
-		if(sweepIndex==0) //This variables is controlled in SaveSweep()
-			//Creating a new folder to save there the RFI files corresponding to a new measurement cycle
-			boost::filesystem::create_directory(filePath);
+		if( !rfiFile.IsOpen() )
+		{
+			boost::filesystem::path filePath(MEASUREMENTS_PATH);
+			filePath /= ("RFI_" + currMeasCycleTimestamp + ".csv"); //This variable is controlled in SaveSweep() or SaveFrontEndParam()
+			rfiFile.Open( filePath.string(), true );
+		}
 
-		//Adding the filename to the path
-		std::ostringstream oss;
-		oss << "RFI_" << (sweepIndex+1) << ".csv";
-		filePath /= oss.str();
+		csvFormatter.Clear();
 
-		ofs.open( filePath.string() );
+		//Writing the name of the file which corresponds to this RFI
+		std::ostringstream rfiFilename;
+		rfiFilename << ( rfi.threshNorm==RFI::NOISE_FLOOR ? "RFI_NF_" : "RFI_" ) << (sweepIndex+1) << ".csv";
+		csvFormatter.Append('#');
+		csvFormatter.Append( rfiFilename.str() );
+		csvFormatter.Append("\r\n");
+		const std::size_t contentPos = csvFormatter.Size();
 
 		//Writing the header with frequency values where the RFI was detected
-		ofs << "RFI Index,Timestamp,Azimuthal Angle,Polarization";
+		csvFormatter.Append("RFI Index,Timestamp,Azimuthal Angle,Polarization");
 		for(const auto& freq : rfi.frequencies)
-			ofs << ',' << std::setprecision(4) << double(freq)/1e6; //The frequency values are saved in MHz
-		ofs << "\r\n";
+		{
+			csvFormatter.Append(',');
+			csvFormatter.AppendFrequency(freq); //The frequency values are saved in MHz
+		}
+		csvFormatter.Append("\r\n");
 
 		//Writing the extra data
-		ofs << (sweepIndex+1);
-		ofs << ',' << rfi.timeData.GetTimestamp();
-		ofs << ',' << std::setprecision(1) << rfi.azimuthAngle;
-		ofs << ',' << rfi.polarization;
+		csvFormatter.AppendUnsigned(sweepIndex+1);
+		csvFormatter.Append(',');
+		csvFormatter.Append( rfi.timeData.GetTimestamp() );
+		csvFormatter.Append(',');
+		csvFormatter.AppendOneDecimal(rfi.azimuthAngle);
+		csvFormatter.Append(',');
+		csvFormatter.Append(rfi.polarization);
 
 		//Writing the power values, in dBm
 		for(const auto& power : rfi.values)
-			ofs << ',' << std::setprecision(1) << power;
-		ofs << "\r\n";
+		{
+			csvFormatter.Append(',');
+			csvFormatter.AppendOneDecimal(power);
+		}
+		csvFormatter.Append("\r\n");
 
-		ofs.flush();
-		ofs.close();
+		rfiFile.Write( csvFormatter.Data(), csvFormatter.Size() );
+		journal.Append( MeasurementJournal::Record(MeasurementJournal::RFI_SAVED, currMeasCycleTimestamp, "", rfiFile.GetSize()) );
+
+		//The RFI file is added to the archive of the measurement cycle, if it is being built
+		if( cycleArchive.IsOpen() )
+			try
+			{
+				const std::string rfiFolderName = "RFI_" + currMeasCycleTimestamp;
+				if(!flagStoredRFI)
+					cycleArchive.AddDirectory(rfiFolderName);
+				cycleArchive.AddData( rfiFolderName + '/' + rfiFilename.str(), csvFormatter.Data() + contentPos, csvFormatter.Size() - contentPos );
+			}
+			catch(std::exception & exc)
+			{
+				cycleArchive.Abort();
+				cerr << "\nWarning: " << exc.what() << " The data will be archived at the end of the measurement cycle." << endl;
+			}
 
 		flagStoredRFI=true;
+
+		ApplyDurabilityPolicy();
 	}
 	else
 		throw( rfims_exception("the data logger was asked to save an empty RFI structure.") );
 }
 
-/*!	To archive the data files the utility 'tar' is used and thr utility 'lzma' is used to compress to resulting archive
- * file. The resulting compressed archive file is name as "rfims_data_DD-MM-YYYYTHH:MM:SS.tar.lzma", where the last
- * part, before the extension is the timestamp of the corresponding measurement cycle.
+/*!	The sweep is saved synchronously, once the elements which are waiting in the logging queue have been saved, so the
+ * order of the data is kept. To save a sweep without stopping the calling thread the method QueueSweep() should be used.
+ * \param [in] sweep A structure with the sweep to be saved.
  */
-void DataLogger::ArchiveAndCompress()
+void DataLogger::SaveSweep(const Sweep & sweep)
 {
-	///////////Copying data files to the uploads folder////////////
-	boost::filesystem::path destPath(UPLOADS_PATH);
+	Drain();
+	WriteSweep(sweep);
+}
 
-	boost::filesystem::path sweepsFilePath(MEASUREMENTS_PATH);
-	std::string sweepFilename = "sweeps_" + currMeasCycleTimestamp + ".csv";
-	sweepsFilePath /= sweepFilename;
-	if( boost::filesystem::exists(sweepsFilePath) )
-		boost::filesystem::copy_file(sweepsFilePath, (destPath / sweepFilename), boost::filesystem::copy_option::overwrite_if_exists);
-	else
-		throw( rfims_exception("the sweep file does not exist.") );
+/*!	The RFI is saved synchronously, once the elements which are waiting in the logging queue have been saved, so the
+ * order of the data is kept. To save a RFI without stopping the calling thread the method QueueRFI() should be used.
+ * \param [in] rfi A structure with RFI to be saved.
+ */
+void DataLogger::SaveRFI(const RFI& rfi)
+{
+	Drain();
+	WriteRFI(rfi);
+}
+
+/*!	The sweep is moved into the logging queue, without copying its data points, and the logging thread saves it later, as
+ * it is done by the method SaveSweep(), so the calling thread can continue with the capture of the next sweep while the
+ * data are being written to the storage device. If the queue is full the calling thread waits until the logging thread
+ * takes an element from the queue (backpressure); the data are never discarded. An error which happened in the logging
+ * thread is reported here, with an exception, the next time an element is queued.
+ * \param [in] sweep A structure with the sweep to be saved, which is left empty.
+ */
+void DataLogger::QueueSweep(Sweep&& sweep)
+{
+	if( sweep.Empty() )
+		throw( rfims_exception("the data logger was asked to save an empty sweep.") );
+
+	LogElement element;
+	element.flagRFI=false;
+	element.sweep=std::move(sweep);
+	QueueElement( std::move(element) );
+}
+
+/*!	The RFI is moved into the logging queue, without copying its data points, and the logging thread saves it later, as
+ * it is done by the method SaveRFI(). The behavior when the queue is full and the reporting of errors are the same as
+ * in the method QueueSweep().
+ * \param [in] rfi A structure with RFI to be saved, which is left empty.
+ */
+void DataLogger::QueueRFI(RFI&& rfi)
+{
+	if( rfi.Empty() )
+		throw( rfims_exception("the data logger was asked to save an empty RFI structure.") );
+
+	LogElement element;
+	element.flagRFI=true;
+	element.rfi=std::move(rfi);
+	QueueElement( std::move(element) );
+}
+
+/*!	If the logging thread does not exist, the element is saved immediately. Otherwise, the element is inserted at the end
+ * of the queue, after waiting if the queue is full, and the logging thread is woken up.
+ * \param [in] element The element to be inserted in the queue.
+ */
+void DataLogger::QueueElement(LogElement && element)
+{
+	if(!flagLoggingThread)
+	{
+		if(element.flagRFI)
+			WriteRFI(element.rfi);
+		else
+			WriteSweep(element.sweep);
+		return;
+	}
+
+	pthread_mutex_lock(&queueMutex);
+
+	if( logQueue.size() >= queueCapacity )
+	{
+		queueStats.numOfBlockings++;
+		while( logQueue.size() >= queueCapacity )
+			pthread_cond_wait(&queueNotFullCond, &queueMutex);
+	}
+
+	element.queueTime = std::chrono::steady_clock::now();
+	logQueue.push( std::move(element) );
+	queueStats.depth = logQueue.size();
+	if(queueStats.depth > queueStats.maxDepth)
+		queueStats.maxDepth = queueStats.depth;
+
+	std::string errorMsg;
+	errorMsg.swap(loggingErrorMsg);
+
+	pthread_cond_signal(&queueNotEmptyCond);
+	pthread_mutex_unlock(&queueMutex);
+
+	if( !errorMsg.empty() )
+		throw( rfims_exception("the logging thread failed: " + errorMsg) );
+}
+
+/*!	The logging thread takes the elements from the front of the queue and saves them, one at a time, without holding the
+ * mutex while the data are written, so the producer is only stopped to insert an element. The time which elapses since an
+ * element is queued until it is saved is measured to update the statistics of the queue. When the thread is asked to
+ * finish it saves the remaining elements before it returns.
+ */
+void DataLogger::ProcessLogQueue()
+{
+	pthread_mutex_lock(&queueMutex);
+
+	while(true)
+	{
+		while( logQueue.empty() && !flagStopLogging )
+			pthread_cond_wait(&queueNotEmptyCond, &queueMutex);
+
+		if( logQueue.empty() )
+			break; //The thread was asked to finish and there are no more elements
+
+		LogElement element( std::move( logQueue.front() ) );
+		logQueue.pop();
+		queueStats.depth = logQueue.size();
+		flagSavingElement=true;
+		pthread_cond_signal(&queueNotFullCond);
+		pthread_mutex_unlock(&queueMutex);
+
+		std::string errorMsg;
+		try
+		{
+			if(element.flagRFI)
+				WriteRFI(element.rfi);
+			else
+				WriteSweep(element.sweep);
+		}
+		catch(std::exception & exc)
+		{
+			errorMsg = exc.what();
+		}
+
+		const double latency = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - element.queueTime ).count();
+
+		pthread_mutex_lock(&queueMutex);
+
+		flagSavingElement=false;
+		queueStats.numOfSavedElements++;
+		queueStats.lastWriteLatency = latency;
+		if(latency > queueStats.maxWriteLatency)
+			queueStats.maxWriteLatency = latency;
+		queueStats.meanWriteLatency += (latency - queueStats.meanWriteLatency) / queueStats.numOfSavedElements;
+
+		if( !errorMsg.empty() )
+			loggingErrorMsg = errorMsg;
+
+		if( logQueue.empty() )
+			pthread_cond_broadcast(&queueDrainedCond);
+	}
+
+	pthread_mutex_unlock(&queueMutex);
+}
+
+/*!	\return The message of the last error which happened in the logging thread and which had not been reported yet, or
+ * an empty string if there was no error.
+ */
+std::string DataLogger::WaitForLogQueue()
+{
+	std::string errorMsg;
+
+	if(flagLoggingThread)
+	{
+		pthread_mutex_lock(&queueMutex);
+		while( !logQueue.empty() || flagSavingElement )
+			pthread_cond_wait(&queueDrainedCond, &queueMutex);
+		errorMsg.swap(loggingErrorMsg);
+		pthread_mutex_unlock(&queueMutex);
+	}
+
+	return errorMsg;
+}
+
+/*!	The calling thread is stopped until all the elements of the logging queue have been saved. If there was an error in the
+ * logging thread, which had not been reported yet, an exception is thrown.
+ */
+void DataLogger::Drain()
+{
+	const std::string errorMsg = WaitForLogQueue();
+	if( !errorMsg.empty() )
+		throw( rfims_exception("the logging thread failed: " + errorMsg) );
+}
+
+/*!	\param [in] capacity The maximum number of elements of the logging queue, which must be at least 1.
+ * \param [in] policy The policy which defines what happens when the logging queue is full: BLOCK means the producer just
+ * waits when the queue is full; SKIP_PLOTS means, additionally, the method IsCongested() returns true when the queue is
+ * half full, so the plotting, which is the least important task, can be skipped before the producer has to wait.
+ */
+void DataLogger::SetQueueParameters(const unsigned int capacity, const QueueFullPolicy policy)
+{
+	pthread_mutex_lock(&queueMutex);
+	queueCapacity = (capacity>0) ? capacity : 1;
+	queueFullPolicy = policy;
+	pthread_cond_broadcast(&queueNotFullCond);
+	pthread_mutex_unlock(&queueMutex);
+}
 
+/*!	\return True if the policy is SKIP_PLOTS and the logging queue is, at least, half full.	*/
+bool DataLogger::IsCongested()
+{
+	pthread_mutex_lock(&queueMutex);
+	const bool flagCongested = ( queueFullPolicy==SKIP_PLOTS && 2*logQueue.size() >= queueCapacity );
+	pthread_mutex_unlock(&queueMutex);
+	return flagCongested;
+}
+
+/*!	\return A copy of the statistics of the logging queue: the current and maximum depth, the number of saved elements, the
+ * number of times the producer had to wait and the latency of the writing, since an element is queued until it is saved.
+ */
+QueueStatistics DataLogger::GetQueueStatistics()
+{
+	pthread_mutex_lock(&queueMutex);
+	QueueStatistics stats(queueStats);
+	pthread_mutex_unlock(&queueMutex);
+	return stats;
+}
+
+/*!	When the policy is SYNC_PER_SWEEP the files are synchronized each time this method is called, i.e. after each sweep or
+ * RFI is saved. When it is SYNC_PERIODIC they are synchronized if the configured period has elapsed since the last
+ * synchronization. When it is SYNC_PER_CYCLE the data are kept in the buffers until the method FinishMeasCycle() is called.
+ *
+ * The records of the journal are committed, as a group, each time the files are synchronized, after them, so a record is
+ * never in the storage device before the data it refers to. If a commit interval was set with the method
+ * SetJournalCommitInterval(), the files are also synchronized, and the journal committed, when that interval elapses.
+ */
+void DataLogger::ApplyDurabilityPolicy()
+{
+	bool flagSync = journal.IsCommitDue();
+
+	switch(durabilityPolicy)
+	{
+	case SYNC_PER_SWEEP:
+		flagSync=true;
+		break;
+	case SYNC_PERIODIC:
+		flagSync = flagSync || ( std::chrono::steady_clock::now() - lastSyncTime >= std::chrono::seconds(syncPeriod) );
+		break;
+	case SYNC_PER_CYCLE:
+	default:
+		break;
+	}
+
+	if(flagSync)
+	{
+		sweepStore.Sync();
+		rfiFile.Sync();
+		journal.Commit();
+		lastSyncTime = std::chrono::steady_clock::now();
+	}
+}
+
+/*!	This method should be called when the last sweep of a measurement cycle was queued or saved, before the data are
+ * archived. Firstly, it waits until all the elements of the logging queue have been saved. Then, whatever the durability
+ * policy is, the files of the cycle are synchronized with the storage device and closed here, and the end of the cycle
+ * is committed to the journal. Also, the counters of
+ * input/output operations of the cycle are saved, and they can be got with the method GetLastCycleIOStatistics(). Finally,
+ * if the archive of the cycle was being built while the data were saved, it is completed, which just takes a few
+ * milliseconds, so it is ready to be uploaded; if that fails, the data are archived later, by the upload thread.
+ */
+void DataLogger::FinishMeasCycle()
+{
+	//The files are closed even if the logging thread failed, and the error is reported at the end
+	const std::string errorMsg = WaitForLogQueue();
+
+	sweepStore.Sync();
+	sweepStore.Close();
+	rfiFile.Sync();
+	rfiFile.Close();
+	journal.Append( MeasurementJournal::Record(MeasurementJournal::CYCLE_FINISHED, currMeasCycleTimestamp) );
+	journal.Commit();
+	lastSyncTime = std::chrono::steady_clock::now();
+
+	//The files of the cycle are added to the retention index, so they are removed when they are old
+	try
+	{
+		TimeData cycleTime;
+		cycleTime.SetTimestamp(currMeasCycleTimestamp);
+		boost::filesystem::path filePath(MEASUREMENTS_PATH);
+		retentionIndex.Add( cycleTime, ( filePath / ( "sweeps_" + currMeasCycleTimestamp + ".bin" ) ).string() );
+		retentionIndex.Add( cycleTime, ( filePath / ( "RFI_" + currMeasCycleTimestamp + ".csv" ) ).string() );
+		retentionIndex.Commit();
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "\nWarning: the files of the measurement cycle could not be added to the retention index: " << exc.what() << endl;
+	}
+
+	lastCycleIOStats = cycleIOStats;
+	cycleIOStats.Clear();
+
+	//Completing the archive which was built while the data were saved
+	readyArchiveName.clear();
+	if( cycleArchive.IsOpen() )
+		try
+		{
+			cycleArchive.Close();
+			readyArchiveName = boost::filesystem::path( cycleArchive.GetPath() ).filename().string();
+		}
+		catch(std::exception & exc)
+		{
+			cycleArchive.Abort();
+			cerr << "\nWarning: " << exc.what() << " The data will be archived again." << endl;
+		}
+
+	if( !errorMsg.empty() )
+		throw( rfims_exception("the logging thread failed: " + errorMsg) );
+}
+
+/*!	The file is written in one go, through a _BufferedFileWriter_ object, so the input/output operations are counted.
+ * \param [in] filePath The path of the file, which is overwritten if it exists.
+ */
+void DataLogger::SaveTextFile(const boost::filesystem::path & filePath)
+{
+	BufferedFileWriter file;
+	file.SetIOStatistics(&cycleIOStats);
+	file.Open( filePath.string() );
+	file.Write( oss.str() );
+	file.Close();
+}
+
+/*!	The gain and noise figure files are the ones which were estimated in the measurement cycle, if the method
+ * SaveFrontEndParam() was called, or the default ones otherwise. The bands parameters file is only archived when the
+ * bands parameters were loaded again.
+ * \param [in] timestamp The timestamp of the measurement cycle.
+ * \param [in] flagFrontEndParam A flag which indicates if the front end parameters were estimated in the measurement cycle.
+ * \param [in] flagBandsParam A flag which indicates if the bands parameters were loaded in the measurement cycle.
+ * \return A vector with pairs formed by the name of each file inside the archive and its path.
+ */
+std::vector< std::pair<std::string, boost::filesystem::path> > DataLogger::GetParamFilesToArchive(const std::string & timestamp,
+		const bool flagFrontEndParam, const bool flagBandsParam) const
+{
 	boost::filesystem::path gainFilePath(FRONT_END_PARAM_PATH);
 	boost::filesystem::path noiseFigFilePath(FRONT_END_PARAM_PATH);
 	std::string gainFilename;
 	std::string noiseFigFilename;
-	if(flagNewFrontEndParam)
+	if(flagFrontEndParam)
 	{
-		gainFilename = "gain_" + currMeasCycleTimestamp + ".csv";
+		gainFilename = "gain_" + timestamp + ".csv";
 		gainFilePath /= gainFilename;
-		noiseFigFilename = "noisefigure_" + currMeasCycleTimestamp + ".csv";
+		noiseFigFilename = "noisefigure_" + timestamp + ".csv";
 		noiseFigFilePath /= noiseFigFilename;
 	}
 	else
@@ -400,165 +820,264 @@ void DataLogger::ArchiveAndCompress()
 		noiseFigFilePath /= noiseFigFilename;
 	}
 
-	if( boost::filesystem::exists(gainFilePath) )
-		boost::filesystem::copy_file(gainFilePath, (destPath / gainFilename), boost::filesystem::copy_option::overwrite_if_exists);
-	else
+	if( !boost::filesystem::exists(gainFilePath) )
 		throw( rfims_exception("the gain file does not exist.") );
 
-	if( boost::filesystem::exists(noiseFigFilePath) )
-		boost::filesystem::copy_file(noiseFigFilePath, (destPath / noiseFigFilename), boost::filesystem::copy_option::overwrite_if_exists);
-	else
+	if( !boost::filesystem::exists(noiseFigFilePath) )
 		throw( rfims_exception("the noise figure file does not exist.") );
 
-	if(flagNewBandsParam)
+	std::vector< std::pair<std::string, boost::filesystem::path> > paramFiles;
+	paramFiles.emplace_back(gainFilename, gainFilePath);
+	paramFiles.emplace_back(noiseFigFilename, noiseFigFilePath);
+
+	if(flagBandsParam)
 	{
 		boost::filesystem::path bandsParamFilePath(BANDS_PARAM_CSV_PATH);
 		bandsParamFilePath /= "freqbands.csv";
-		if( boost::filesystem::exists(bandsParamFilePath) )
-			boost::filesystem::copy_file(bandsParamFilePath, (destPath / "freqbands.csv"), boost::filesystem::copy_option::overwrite_if_exists);
-		else
+		if( !boost::filesystem::exists(bandsParamFilePath) )
 			throw( rfims_exception("the bands parameters file (CSV) does not exist.") );
+		paramFiles.emplace_back("freqbands.csv", bandsParamFilePath);
 	}
 
-	std::string rfiFolderName = "RFI_" + currMeasCycleTimestamp;
-	if(flagStoredRFI)
+	return paramFiles;
+}
+
+/*!	The data files of the measurement cycle are archived with the tar format and compressed, in the same process, with
+ * the library liblzma: the files are read from their original locations and they are given directly to the compressor,
+ * so they are not copied to the uploads folder and neither the archive nor the compressed archive needs to be written
+ * twice. The sweeps store is converted to the CSV format, and the RFI file of the cycle is split in one file per sweep,
+ * in memory. The resulting compressed archive file is named as "rfims_data_DD-MM-YYYYTHH:MM:SS.tar.xz", where the last
+ * part, before the extension, is the timestamp of the corresponding measurement cycle. If the legacy LZMA format was
+ * selected with the method SetCompression(), the extension is ".tar.lzma", as it was when the utility 'lzma' was used.
+ *
+ * If the archive was built incrementally, while the data were saved (see the method EnableIncrementalArchive()), this
+ * method just puts it in the persistent queue of files to upload.
+ * \param [in] job The data of the measurement cycle, which were taken when the job was queued.
+ */
+void DataLogger::ArchiveAndCompress(const UploadJob & job)
+{
+	//If the archive was built while the data were saved, it is ready to be uploaded
+	if( !job.readyArchiveName.empty() )
 	{
-		boost::filesystem::path rfiPath(MEASUREMENTS_PATH);
-		rfiPath /= rfiFolderName;
-		if( boost::filesystem::exists(rfiPath) && boost::filesystem::is_directory(rfiPath) )
-		{
-			auto destRFIFolderPath = destPath / rfiFolderName;
-			boost::filesystem::create_directory(destRFIFolderPath);
-			for(const boost::filesystem::directory_entry& rfiFile : boost::filesystem::directory_iterator(rfiPath))
-				boost::filesystem::copy_file(rfiFile.path(), (destRFIFolderPath / rfiFile.path().filename()), boost::filesystem::copy_option::overwrite_if_exists);
-		}
-		else
-			throw( rfims_exception("the folder with RFI files does not exist or there is an error in the path.") );
+		uploader.Enqueue(job.readyArchiveName);
+		journal.Append( MeasurementJournal::Record(MeasurementJournal::ARCHIVE_CREATED, job.timestamp, job.readyArchiveName) );
+		lastArchiveStats = job.archiveStats;
+		return;
 	}
 
-	/////////////////////////////////////////////////////////////////////////////
-
-	///////////////////Archiving the files//////////////////////
-	std::string archiveName = "rfims_data_" + currMeasCycleTimestamp + ".tar";
-
-	//If there is an archive file with the same name is removed
-	boost::filesystem::path archivePath(UPLOADS_PATH);
-	archivePath /= archiveName;
-	if( boost::filesystem::exists(archivePath) )
-		boost::filesystem::remove(archivePath);
-
-	//Building the command to call 'tar'
-	std::string command("tar --create");
-	command += " --file " + archivePath.string();
-	command += " --directory " + UPLOADS_PATH + '/';
-	command += ' ' + sweepFilename;
-	command += ' ' + gainFilename;
-	command += ' ' + noiseFigFilename;
-	if(flagNewBandsParam)
-		command += " freqbands.csv";
-	if(flagStoredRFI)
-		command += ' ' + rfiFolderName;
-
-	//Calling the utility 'tar'
-	if( system( command.c_str() ) < 0 )
-		throw( rfims_exception("the calling to the utility 'tar', using system(), to archive the data files failed.") );
-	//////////////////////////////////////////////////////////////
+	///////////Checking the data files which will be archived////////////
+	boost::filesystem::path sweepsFilePath(MEASUREMENTS_PATH);
+	std::string sweepFilename = "sweeps_" + job.timestamp + ".csv";
+	sweepsFilePath /= ( "sweeps_" + job.timestamp + ".bin" );
+	if( !boost::filesystem::exists(sweepsFilePath) )
+		throw( rfims_exception("the sweep file does not exist.") );
 
-	/////////////Compressing the archive with the utility 'lzma'/////////////////
-	std::string compArchiveName = archiveName + ".lzma";
+	std::string rfiFolderName = "RFI_" + job.timestamp;
+	boost::filesystem::path rfiPath(MEASUREMENTS_PATH);
+	rfiPath /= ( rfiFolderName + ".csv" );
+	if( job.flagRFI && !boost::filesystem::exists(rfiPath) )
+		throw( rfims_exception("the file with RFI does not exist or there is an error in the path.") );
+	/////////////////////////////////////////////////////////////////////////////
 
-	//If there is a compressed archive file with the same name is removed
+	///////////////////Archiving and compressing the files//////////////////////
+	std::string compArchiveName = "rfims_data_" + job.timestamp + ".tar" + CompressedFileWriter::GetExtension(archiveFormat);
 	boost::filesystem::path compArchivePath(UPLOADS_PATH);
 	compArchivePath /= compArchiveName;
-	if( boost::filesystem::exists(compArchivePath) )
-		boost::filesystem::remove(compArchivePath);
-
-	//Building the command
-	command.clear();
-	command += "lzma --compress -9 --threads=0 ";
-	command += archivePath.string();
-
-	//Calling the utility 'lzma'
-	if( system( command.c_str() ) < 0 )
-		throw( rfims_exception("the calling to the utility 'lzma', using system(), to compress the archive file failed.") );
-	///////////////////////////////////////////////////////////////
-
-	////////Deleting the files which were copied to the uploads folder//////////
-	boost::filesystem::remove(UPLOADS_PATH + '/' + sweepFilename);
-	boost::filesystem::remove(UPLOADS_PATH + '/' + gainFilename);
-	boost::filesystem::remove(UPLOADS_PATH + '/' + noiseFigFilename);
-	if(flagNewBandsParam)
-		boost::filesystem::remove(UPLOADS_PATH + '/' + "freqbands.csv");
-	if(flagStoredRFI)
-		boost::filesystem::remove_all(UPLOADS_PATH + '/' + rfiFolderName);
-	//////////////////////////////////////////////////////////////////
-
-	filesToUpload.push(compArchiveName);
 
-	flagNewFrontEndParam=false;
-	flagNewBandsParam=false;
-	flagStoredRFI=false;
+	try
+	{
+		//If there is a compressed archive file with the same name, it is overwritten
+		archiveWriter.Open( compArchivePath.string() );
+
+		//The binary sweeps store is converted to the CSV format which is expected by the remote server
+		{
+			SweepStoreReader sweepStoreReader;
+			sweepStoreReader.Open( sweepsFilePath.string() );
+			std::ostringstream csvStream;
+			sweepStoreReader.ExportCSV(csvStream);
+			archiveWriter.AddData( sweepFilename, csvStream.str() );
+		}
+
+		for(const auto & paramFile : job.paramFiles)
+			archiveWriter.AddFile( paramFile.first, paramFile.second.string() );
+
+		if(job.flagRFI)
+		{
+			//The RFI file of the cycle is split in one file per sweep, as it is expected by the remote server
+			archiveWriter.AddDirectory(rfiFolderName);
+
+			std::ifstream ifs( rfiPath.string(), std::ifstream::in | std::ifstream::binary );
+			std::string line, filename, content;
+			while( std::getline(ifs, line) )
+			{
+				if( !line.empty() && line.front()=='#' )
+				{
+					//A new RFI file starts here, the filename is between the '#' and the '\r'
+					if( !filename.empty() )
+						archiveWriter.AddData(rfiFolderName + '/' + filename, content);
+					filename = line.substr(1, line.find('\r') - 1);
+					content.clear();
+				}
+				else if( !filename.empty() )
+					content += line + '\n';
+			}
+			if( !filename.empty() )
+				archiveWriter.AddData(rfiFolderName + '/' + filename, content);
+		}
+
+		archiveWriter.Close();
+	}
+	catch(std::exception & exc)
+	{
+		archiveWriter.Abort();
+		throw;
+	}
+	lastArchiveStats = archiveWriter.GetStatistics();
+	//////////////////////////////////////////////////////////////
+
+	uploader.Enqueue(compArchiveName);
+	journal.Append( MeasurementJournal::Record(MeasurementJournal::ARCHIVE_CREATED, job.timestamp, compArchiveName) );
 }
 
-void DataLogger::DeleteOldFiles() const
+/*!	The files are not searched in the folders: the files of the measurement cycles which are older than
+ * [RETENTION_DAYS](\ref RETENTION_DAYS) days, relative to the current measurement cycle, are taken from the front of the
+ * retention index, which is ordered by the timestamps of the cycles, and they are removed. If a storage quota was set
+ * with the method SetStorageQuota(), the files of the oldest cycles are removed too, until the total size of the files
+ * of the index fits in the quota; the files of the last finished cycle are always kept, and so are the ones of the
+ * cycles whose upload jobs are pending, since the upload thread could still need to read them to build their archives.
+ * So, the cost of this method only depends on the number of files which are removed, not on the number of files which
+ * are kept.
+ */
+void DataLogger::DeleteOldFiles()
 {
 	//Getting the date 30 days back
 	TimeData oneMonthBackDate;
 	oneMonthBackDate.SetTimestamp(currMeasCycleTimestamp);
-	oneMonthBackDate.TurnBackDays(30);
+	oneMonthBackDate.TurnBackDays(RETENTION_DAYS);
 
-	//Deleting old sweeps files and directories with old rfi files
-	for( const auto & dirEntry : boost::filesystem::directory_iterator(MEASUREMENTS_PATH) )
+	std::vector<RetentionIndex::Entry> oldFiles = retentionIndex.PopOlderThan(oneMonthBackDate);
+	if(storageQuota>0)
 	{
-		std::string dirEntryName = dirEntry.path().filename().string();
-		std::size_t datePos = dirEntryName.find('_');
-		if( datePos == std::string::npos )
-			cerr << "\nWarning: A file or directory with a unexpected name format was found in " << MEASUREMENTS_PATH << '.' << endl;
-		else
+		std::set<TimeData> pendingCycles;
+		pthread_mutex_lock(&jobsMutex);
+		for(const auto & timestamp : pendingJobTimestamps)
 		{
-			datePos++;
-			TimeData fileDate;
-			fileDate.SetDate( dirEntryName.substr(datePos, 10) );
-			if( fileDate < oneMonthBackDate )
-				boost::filesystem::remove_all( dirEntry.path() );
+			TimeData cycleTime;
+			cycleTime.SetTimestamp(timestamp);
+			pendingCycles.insert(cycleTime);
 		}
+		pthread_mutex_unlock(&jobsMutex);
+
+		std::vector<RetentionIndex::Entry> excessFiles = retentionIndex.PopToFitQuota(storageQuota, pendingCycles);
+		oldFiles.insert( oldFiles.end(), excessFiles.begin(), excessFiles.end() );
+	}
+
+	for(const auto & oldFile : oldFiles)
+	{
+		boost::system::error_code errorCode;
+		boost::filesystem::remove_all(oldFile.path, errorCode);
+		if(errorCode)
+			cerr << "\nWarning: the old file " << oldFile.path << " could not be removed: " << errorCode.message() << endl;
 	}
 
-	//Deleting old front end parameters files
-	for( const auto & dirEntry : boost::filesystem::directory_iterator(FRONT_END_PARAM_PATH) )
+	retentionIndex.Commit();
+}
+
+/*!	This method is called when the retention index file does not exist, for example the first time the software is
+ * executed with a retention index, so the files which were saved before are removed when they are old too. The
+ * timestamp of the measurement cycle of each file is taken from its name, after the first character '_'.
+ */
+void DataLogger::IndexExistingFiles()
+{
+	for(const auto & folderPath : {MEASUREMENTS_PATH, FRONT_END_PARAM_PATH})
 	{
-		std::string dirEntryName = dirEntry.path().filename().string();
-		if(dirEntryName != "default")
+		for( const auto & dirEntry : boost::filesystem::directory_iterator(folderPath) )
 		{
-			size_t datePos = dirEntryName.find('_');
+			std::string dirEntryName = dirEntry.path().filename().string();
+			if(dirEntryName == "default")
+				continue;
+
+			std::size_t datePos = dirEntryName.find('_');
 			if( datePos == std::string::npos )
-				cerr << "\nWarning: A file with a unexpected name format was found in " << FRONT_END_PARAM_PATH << '.' << endl;
+				cerr << "\nWarning: A file or directory with a unexpected name format was found in " << folderPath << '.' << endl;
 			else
 			{
 				datePos++;
 				TimeData fileDate;
-				fileDate.SetDate( dirEntryName.substr(datePos, 10) );
-				if( fileDate < oneMonthBackDate )
-					boost::filesystem::remove( dirEntry.path() );
+				const std::string timestamp = dirEntryName.substr(datePos, 19);
+				if( timestamp.size()==19 && timestamp[10]=='T' )
+					fileDate.SetTimestamp(timestamp);
+				else
+					fileDate.SetDate( dirEntryName.substr(datePos, 10) );
+				retentionIndex.Add( fileDate, dirEntry.path().string() );
 			}
 		}
 	}
+
+	retentionIndex.Commit();
 }
 
-/*! To upload the files the script /usr/local/client.py is called. This script try to send the archive
+/*! If the host is empty, the archives are uploaded by the external python script "client.py", so it is checked that
+ * there is a shell available to execute it. The archives are compressed by the software itself, so the shell is not
+ * needed otherwise.
+ * \param [in] host The name or the IP address of the upload server, or an empty string to use the script client.py.
+ * \param [in] port The TCP port of the upload server.
+ * \param [in] numOfThreads The maximum number of archives which are uploaded at the same time.
+ */
+void DataLogger::SetUploadServer(const std::string & host, const std::uint16_t port, const unsigned int numOfThreads)
+{
+	uploader.SetServer(host, port);
+	uploader.SetTransferParameters(262144, numOfThreads);
+
+	if( host.empty() && system(nullptr)==0 )
+		cerr << "\nWarning: the shell is not available so the script client.py will not be able to upload the files." << endl;
+}
+
+/*! If an upload server was set with the method SetUploadServer(), the files are uploaded by the object _uploader_,
+ * in chunks, resuming the interrupted transfers, retrying the failed ones with an exponential backoff and uploading
+ * several files at the same time. A file which fails does not stop the uploading of the others.
+ *
+ * Otherwise, to upload the files the script /usr/local/client.py is called. This script try to send the archive
  * file many times through one hour, taking into account the possibility that there is no Internet
  * connection in the first try. If the script achieves the sending, then it wakes up the remote server
  * to that one to read the files, and finally the script removes the local archive file. If the script
- * ends with errors, the file is not deleted and remains in a queue waiting to be send. The idea is the
+ * ends with errors, the file is not deleted and remains in the queue waiting to be send. The idea is the
  * uploading to perform at the end of each measurement cycle.
+ *
+ * In both cases the queue of files to upload is saved in the uploads folder, so the files which were not uploaded
+ * are retried even after a restart of the software, and the uploaded files are recorded in the journal.
  */
 void DataLogger::UploadData()
 {
+	if( uploader.IsEnabled() )
+	{
+		const std::vector<std::string> pendingFiles = uploader.GetPendingFiles();
+		std::string errorMsg;
+		try
+		{
+			uploader.UploadPending();
+		}
+		catch(std::exception & exc)
+		{
+			errorMsg = exc.what();
+		}
+
+		//The files which are not pending anymore were uploaded
+		const std::vector<std::string> remainingFiles = uploader.GetPendingFiles();
+		for(const auto & filename : pendingFiles)
+			if( std::find( remainingFiles.begin(), remainingFiles.end(), filename )==remainingFiles.end() )
+				journal.Append( MeasurementJournal::Record(MeasurementJournal::UPLOAD_DONE, "", filename) );
+
+		if( !errorMsg.empty() )
+			throw rfims_exception(errorMsg);
+		return;
+	}
+
 	int retValue=0, procRetValue=0;
-	while( !filesToUpload.empty() && retValue==0 )
+	for(const auto & filename : uploader.GetPendingFiles())
 	{
 		std::string command("python3 /usr/local/client.py ");
-		command += UPLOADS_PATH + '/' + filesToUpload.front();
+		command += UPLOADS_PATH + '/' + filename;
 		if( ( retValue = system( command.c_str() ) ) < 0 )
 		{
 			std::ostringstream oss;
@@ -567,7 +1086,10 @@ void DataLogger::UploadData()
 		}
 
 		if(retValue==0)
-			filesToUpload.pop();
+		{
+			uploader.Dequeue(filename);
+			journal.Append( MeasurementJournal::Record(MeasurementJournal::UPLOAD_DONE, "", filename) );
+		}
 		else
 		{
 			procRetValue = retValue >> 8;
@@ -591,42 +1113,364 @@ void DataLogger::UploadData()
 	}
 }
 
-/*! This method creates a thread where the methods `ArchiveAndCompress()` and `UploadData()` are called.
- * After the creation of the thread, the method ends and the main thread can continues with the next
- * operations, like the moving of the antenna, the capture of a new sweep, etc. The next time this method
- * is called, it will control if the last thread has finished, if not, the method will wait to the thread
- * to finish, and then it will create a new thread for the uploading of the new data.
+/*!	\param [in] job The data of the measurement cycle.
+ * \param [in] flagUploading If it is `false` the data are just archived, and they remain in the persistent upload queue.
+ */
+void DataLogger::DoUploadJob(const UploadJob & job, const bool flagUploading)
+{
+	try
+	{
+		ArchiveAndCompress(job);
+
+		cout << "\nThe data of the cycle " << job.timestamp << " were archived and compressed: " << lastArchiveStats.numOfInputBytes;
+		cout << " bytes to " << lastArchiveStats.numOfOutputBytes << " bytes (ratio " << lastArchiveStats.GetRatio() << ") in ";
+		cout << lastArchiveStats.elapsedTime << " ms" << endl;
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "\nWarning: the data of the cycle " << job.timestamp << " could not be archived: " << exc.what() << endl;
+		return;
+	}
+
+	if(flagUploading)
+	{
+		try
+		{
+			UploadData();
+		}
+		catch(std::exception & exc)
+		{
+			cerr << "\nWarning: " << exc.what() << endl;
+		}
+
+		if( uploader.IsEnabled() )
+		{
+			const UploadStatistics & uploadStats = uploader.GetStatistics();
+			cout << "\nThe data were uploaded: " << uploadStats.numOfFiles << " file(s), " << uploadStats.numOfBytes << " bytes in ";
+			cout << uploadStats.elapsedTime << " ms (" << uploadStats.GetThroughput()/1024.0 << " KiB/s)" << endl;
+		}
+	}
+}
+
+/*!	The jobs are done one by one, in the same order they were queued, so the jobs of several measurement cycles can
+ * wait in the queue while the network or the compression are slow, and the errors are reported as warnings, when they
+ * happen, without stopping the thread. When there is no job and the files are uploaded natively, the thread wakes up
+ * periodically to retry the uploading of the files which failed. When the thread is asked to finish, it archives the
+ * pending jobs but it does not upload them.
+ */
+void DataLogger::ProcessUploadJobs()
+{
+	pthread_mutex_lock(&jobsMutex);
+	while(true)
+	{
+		if( uploadJobs.empty() && !flagStopUploading )
+		{
+			struct timespec wakeUpTime;
+			clock_gettime(CLOCK_REALTIME, &wakeUpTime);
+			wakeUpTime.tv_sec += uploadRetryPeriod;
+			if( pthread_cond_timedwait(&jobsCond, &jobsMutex, &wakeUpTime)==ETIMEDOUT && uploadJobs.empty() &&
+					!flagStopUploading && uploader.IsEnabled() )
+			{
+				//Retrying the uploading of the files which failed before
+				pthread_mutex_unlock(&jobsMutex);
+				if( !uploader.GetPendingFiles().empty() )
+					try
+					{
+						UploadData();
+					}
+					catch(std::exception & exc)
+					{
+						cerr << "\nWarning: " << exc.what() << endl;
+					}
+				pthread_mutex_lock(&jobsMutex);
+			}
+			continue;
+		}
+
+		if( uploadJobs.empty() )
+			break; //The thread was asked to finish
+
+		UploadJob job = std::move( uploadJobs.front() );
+		uploadJobs.pop();
+		const bool flagUploading = !flagStopUploading;
+		pthread_mutex_unlock(&jobsMutex);
+
+		DoUploadJob(job, flagUploading);
+
+		pthread_mutex_lock(&jobsMutex);
+		pendingJobTimestamps.erase( pendingJobTimestamps.find(job.timestamp) );
+	}
+	pthread_mutex_unlock(&jobsMutex);
+}
+
+/*! The data of the measurement cycle which has just finished are taken and inserted, as a job, in the queue of the
+ * upload thread, which archives and uploads them in parallel with the next operations, like the moving of the antenna,
+ * the capture of a new sweep, etc. This method never waits for the archiving or the uploading of the previous cycles,
+ * whose jobs just wait in the queue, and the errors of the jobs are reported by the upload thread. If the upload
+ * thread could not be created, the job is done here.
  */
 void DataLogger::PrepareAndUploadData()
 {
-	void **retval = (void**) &sweepIndex; //The pointer to the return value of the thread is initialized with the direction
-										//of any variable to avoid this pointer to be equal to NULL
+	//The files which will be archived must be complete
+	Drain();
+
+	UploadJob job;
+	job.timestamp = currMeasCycleTimestamp;
+	job.readyArchiveName = readyArchiveName;
+	if( !readyArchiveName.empty() )
+		job.archiveStats = cycleArchive.GetStatistics();
+	else
+		job.paramFiles = GetParamFilesToArchive();
+	job.flagRFI = flagStoredRFI;
+
+	readyArchiveName.clear();
+	flagNewFrontEndParam=false;
+	flagNewBandsParam=false;
+	flagStoredRFI=false;
+
+	QueueUploadJob( std::move(job) );
+}
+
+/*!	\param [in] job The data of the measurement cycle, which are moved to the queue.	*/
+void DataLogger::QueueUploadJob(UploadJob && job)
+{
+	if(flagUploadThread)
+	{
+		pthread_mutex_lock(&jobsMutex);
+		pendingJobTimestamps.insert(job.timestamp);
+		uploadJobs.push( std::move(job) );
+		pthread_cond_signal(&jobsCond);
+		pthread_mutex_unlock(&jobsMutex);
+	}
+	else
+		DoUploadJob(job, true);
+}
+
+std::size_t DataLogger::GetNumOfUploadJobs()
+{
+	pthread_mutex_lock(&jobsMutex);
+	std::size_t numOfJobs = uploadJobs.size();
+	pthread_mutex_unlock(&jobsMutex);
+	return numOfJobs;
+}
+
+/*!	The data file is truncated after the last operation which was journaled and whose data are in the file, so a sweep or
+ * a RFI which was being written when the power was cut, or which was written after the last commit, is discarded. If no
+ * operation was journaled, the file is not modified.
+ * \param [in] filePath The path of the data file.
+ * \param [in] journaledSizes The sizes the file had after each journaled operation, in increasing order.
+ * \return The size of the file after the last journaled operation which is in the file, or 0 if there is no such operation or the file does not exist.
+ */
+static std::uint64_t TruncateToJournaledSize(const boost::filesystem::path & filePath, const std::vector<std::uint64_t> & journaledSizes)
+{
+	boost::system::error_code errorCode;
+	const std::uint64_t fileSize = boost::filesystem::file_size(filePath, errorCode);
+	if(errorCode)
+		return 0;
+
+	std::uint64_t size=0;
+	for(auto sizeIt = journaledSizes.crbegin(); sizeIt != journaledSizes.crend() && size==0; sizeIt++)
+		if(*sizeIt <= fileSize)
+			size = *sizeIt;
 
-	//Checking if the previous thread finished
-	int retValueJoin = pthread_join(uploadThread, retval);
-	//Checking if the last operation finished wrongly or if the thread does not exist
-	if(retValueJoin!=0 && retValueJoin!=ESRCH)
-		throw rfims_exception("the checking of the finishing of the last thread to upload data failed.");
+	if( size>0 && size<fileSize )
+		boost::filesystem::resize_file(filePath, size);
 
-	//Checking the value returned by the thread if that existed
-	if(retValueJoin==0)
+	return size;
+}
+
+/*!	The records of the journal are grouped by measurement cycle and each cycle is handled according to the last operation
+ * which was committed, so only the files which are named in the journal are checked, instead of scanning the folders:
+ * - If the cycle did not finish, because the power was cut, its sweeps file and its RFI file are truncated after the
+ * last sweep and the last RFI which were journaled, and the temporary files of the archive which was being built are
+ * removed. Then, the cycle is handled as a finished one.
+ * - If the cycle finished but its archive was not created, the archive which could have been left incomplete is removed
+ * and the cycle is saved to be archived when the method QueueRecoveredCycles() is called.
+ * - If the archive was created but it was not uploaded, it is inserted in the persistent upload queue, if it is not there.
+ * - If the archive was uploaded, the cycle is forgotten.
+ *
+ * Finally, the journal is rewritten with the state of the cycles which were not forgotten, so it does not grow
+ * indefinitely. The cycles whose data files were removed, for example by the method DeleteOldFiles(), are forgotten too.
+ */
+void DataLogger::RecoverFromJournal()
+{
+	const std::vector<MeasurementJournal::Record> records = journal.Open(JOURNAL_PATH);
+
+	//The state of each measurement cycle, according to the journal
+	struct CycleState
+	{
+		std::string timestamp;
+		std::uint64_t paramFlags;
+		std::vector<std::uint64_t> sweepsSizes;
+		std::vector<std::uint64_t> rfiSizes;
+		bool flagFinished;
+		std::string archiveName;
+		bool flagUploaded;
+	};
+	std::vector<CycleState> cycles;
+	std::map<std::string, std::size_t> cycleIndexes, archiveIndexes;
+
+	for(const auto & record : records)
 	{
-		//Checking the value returned by the last thread
-		if(retval==PTHREAD_CANCELED)
-			cerr << "\nWarning: the last thread to upload data was cancelled." << endl;
-		else if(retval!=NULL)
-			throw rfims_exception( (char*) (*retval) );
+		if(record.type==MeasurementJournal::UPLOAD_DONE)
+		{
+			auto archiveIt = archiveIndexes.find(record.filename);
+			if( archiveIt!=archiveIndexes.end() )
+				cycles[archiveIt->second].flagUploaded=true;
+			continue;
+		}
+
+		auto cycleIt = cycleIndexes.find(record.timestamp);
+		if(record.type==MeasurementJournal::CYCLE_STARTED)
+		{
+			if( cycleIt==cycleIndexes.end() )
+			{
+				cycleIt = cycleIndexes.emplace( record.timestamp, cycles.size() ).first;
+				cycles.push_back( CycleState() );
+			}
+			CycleState & cycle = cycles[cycleIt->second];
+			cycle.timestamp = record.timestamp;
+			cycle.paramFlags = record.value;
+			cycle.sweepsSizes.clear();
+			cycle.rfiSizes.clear();
+			cycle.flagFinished=false;
+			cycle.archiveName.clear();
+			cycle.flagUploaded=false;
+			continue;
+		}
+
+		if( cycleIt==cycleIndexes.end() )
+			continue;
+		CycleState & cycle = cycles[cycleIt->second];
+		switch(record.type)
+		{
+		case MeasurementJournal::SWEEP_SAVED:
+			cycle.sweepsSizes.push_back(record.value);
+			break;
+		case MeasurementJournal::RFI_SAVED:
+			cycle.rfiSizes.push_back(record.value);
+			break;
+		case MeasurementJournal::CYCLE_FINISHED:
+			cycle.flagFinished=true;
+			break;
+		case MeasurementJournal::ARCHIVE_CREATED:
+			cycle.archiveName = record.filename;
+			archiveIndexes[record.filename] = cycleIt->second;
+			break;
+		default:
+			break;
+		}
 	}
 
-	//Creating a new thread to prepare data (archive and compress) and to upload the data
-	int retValueCreate = pthread_create(&uploadThread, NULL, UploadThreadFunc, (void*)this);
-	if(retValueCreate!=0)
+	std::vector<MeasurementJournal::Record> compactedRecords;
+	unsigned int numOfRepairedCycles=0;
+	recoveredCycles.clear();
+
+	for(auto & cycle : cycles)
 	{
-		rfims_exception exc("the creation of the thread to prepare and upload data failed");
-		if(retValueCreate==EAGAIN)
-			exc.Append("insufficient resources to create a thread.");
+		if(cycle.flagUploaded)
+			continue;
+
+		boost::filesystem::path sweepsPath(MEASUREMENTS_PATH);
+		sweepsPath /= ( "sweeps_" + cycle.timestamp + ".bin" );
+		boost::filesystem::path rfiPath(MEASUREMENTS_PATH);
+		rfiPath /= ( "RFI_" + cycle.timestamp + ".csv" );
+		const std::string archiveBaseName = "rfims_data_" + cycle.timestamp + ".tar";
+
+		std::uint64_t sweepsSize = cycle.sweepsSizes.empty() ? 0 : cycle.sweepsSizes.back();
+		std::uint64_t rfiSize = cycle.rfiSizes.empty() ? 0 : cycle.rfiSizes.back();
+		if(!cycle.flagFinished)
+		{
+			sweepsSize = TruncateToJournaledSize(sweepsPath, cycle.sweepsSizes);
+			rfiSize = TruncateToJournaledSize(rfiPath, cycle.rfiSizes);
+
+			//The temporary files of the archive which was being built while the data were saved are removed
+			boost::filesystem::path partPath(UPLOADS_PATH);
+			partPath /= ( archiveBaseName + CompressedFileWriter::GetExtension(CompressedFileWriter::XZ) );
+			boost::filesystem::remove( partPath.string() + ".part" );
+			boost::filesystem::remove( partPath.string() + ".sweeps.part" );
+
+			//The files of the cycle were not added to the retention index because the cycle did not finish
+			TimeData cycleTime;
+			cycleTime.SetTimestamp(cycle.timestamp);
+			retentionIndex.Add( cycleTime, sweepsPath.string() );
+			retentionIndex.Add( cycleTime, rfiPath.string() );
+
+			numOfRepairedCycles++;
+		}
+
+		if( cycle.archiveName.empty() )
+		{
+			//An archive of the cycle could have been left incomplete, so it is removed and it will be created again
+			for(const auto format : {CompressedFileWriter::XZ, CompressedFileWriter::LZMA_ALONE})
+			{
+				const std::string archiveName = archiveBaseName + CompressedFileWriter::GetExtension(format);
+				uploader.Dequeue(archiveName);
+				boost::filesystem::remove( boost::filesystem::path(UPLOADS_PATH) / archiveName );
+			}
+
+			if( sweepsSize==0 || !boost::filesystem::exists(sweepsPath) )
+				continue;
+
+			RecoveredCycle recoveredCycle;
+			recoveredCycle.timestamp = cycle.timestamp;
+			recoveredCycle.flagNewFrontEndParam = (cycle.paramFlags & 1)!=0;
+			recoveredCycle.flagNewBandsParam = (cycle.paramFlags & 2)!=0;
+			recoveredCycle.flagRFI = ( rfiSize>0 && boost::filesystem::exists(rfiPath) );
+			recoveredCycles.push_back(recoveredCycle);
+		}
 		else
-			exc.Append("unknown error.");
-		throw(exc);
+		{
+			if( !boost::filesystem::exists( boost::filesystem::path(UPLOADS_PATH) / cycle.archiveName ) )
+				continue;
+			uploader.Enqueue(cycle.archiveName);
+		}
+
+		//The state of the cycle is summarized in the compacted journal
+		compactedRecords.emplace_back(MeasurementJournal::CYCLE_STARTED, cycle.timestamp, "", cycle.paramFlags);
+		if(sweepsSize>0)
+			compactedRecords.emplace_back(MeasurementJournal::SWEEP_SAVED, cycle.timestamp, "", sweepsSize);
+		if(rfiSize>0)
+			compactedRecords.emplace_back(MeasurementJournal::RFI_SAVED, cycle.timestamp, "", rfiSize);
+		compactedRecords.emplace_back(MeasurementJournal::CYCLE_FINISHED, cycle.timestamp);
+		if( !cycle.archiveName.empty() )
+			compactedRecords.emplace_back(MeasurementJournal::ARCHIVE_CREATED, cycle.timestamp, cycle.archiveName);
+	}
+
+	journal.Rewrite(compactedRecords);
+	retentionIndex.Commit();
+
+	if(numOfRepairedCycles>0)
+		cout << "\nThe data of " << numOfRepairedCycles << " interrupted measurement cycle(s) were recovered from the journal" << endl;
+}
+
+/*!	The recovered measurement cycles are archived and uploaded by the upload thread, as the cycles which finish normally,
+ * so this method does not wait. It should be called once the compression was configured.
+ * \return The number of measurement cycles which were queued.
+ */
+std::size_t DataLogger::QueueRecoveredCycles()
+{
+	std::size_t numOfQueuedCycles=0;
+
+	for(const auto & recoveredCycle : recoveredCycles)
+	{
+		UploadJob job;
+		job.timestamp = recoveredCycle.timestamp;
+		job.flagRFI = recoveredCycle.flagRFI;
+		try
+		{
+			job.paramFiles = GetParamFilesToArchive(recoveredCycle.timestamp, recoveredCycle.flagNewFrontEndParam, recoveredCycle.flagNewBandsParam);
+		}
+		catch(std::exception & exc)
+		{
+			cerr << "\nWarning: the measurement cycle " << recoveredCycle.timestamp << " could not be recovered: " << exc.what() << endl;
+			continue;
+		}
+
+		QueueUploadJob( std::move(job) );
+		numOfQueuedCycles++;
 	}
+	recoveredCycles.clear();
+
+	return numOfQueuedCycles;
 }
@@ -0,0 +1,821 @@
+/*!	\file DataStorage.h
+ * 	\brief This header file contains the declarations of the classes which implement the storage formats of the
+ * 	measurements.
+ *
+ * 	The tasks which are performed by the classes defined here are the following:
+ * 	- Buffered writing of files, counting the system calls and the bytes which are written.
+ * 	- Appending of sweeps to a binary sweeps store.
+ * 	- Encoding of the sweeps as quantized differences, to store them in a more compact way.
+ * 	- Reading of a binary sweeps store, mapped into memory, and its conversion to the CSV format.
+ * 	- Formatting of the values of the CSV files with a fixed number of decimal digits, without streams.
+ * 	- Compression of a stream of data with the LZMA or XZ formats and archiving of files with the tar format.
+ * 	- Journaling of the operations over the measurements, so the state of the data can be recovered after a power cut.
+ * 	- Indexing of the files of the measurement cycles, so the old files can be removed without scanning the folders.
+ * 	- Indexing of the records of the measurement cycles, so they can be queried by time, azimuth, polarization and frequency.
+ * 	\author Mauro Diamantino
+ */
+
+#ifndef DATASTORAGE_H_
+#define DATASTORAGE_H_
+
+// Inclusion of the header file which has the declarations of the global functions, global classes, etc. and the inclusions of the global libraries.
+#include "Basics.h"
+
+#include <map> //This library allows the use of the `std::map` and `std::multimap` containers
+#include <set> //This library allows the use of the `std::set` and `std::multiset` containers
+#include <functional> //This library allows the use of the `std::function` class
+
+
+//! A structure which stores the counters of the input/output operations which were performed on files.
+struct IOStatistics
+{
+	std::uint64_t numOfSyscalls; //!< The number of system calls: open(), write(), fdatasync() and close().
+	std::uint64_t numOfWrites; //!< The number of calls to write(), which is a part of the total number of system calls.
+	std::uint64_t numOfSyncs; //!< The number of calls to fdatasync(), which is a part of the total number of system calls.
+	std::uint64_t numOfBytes; //!< The number of bytes which were written.
+	//! The default constructor, which clears the counters.
+	IOStatistics() {	Clear();	}
+	//! This method clears all counters.
+	void Clear() {	numOfSyscalls=numOfWrites=numOfSyncs=numOfBytes=0;	}
+};
+
+//! A structure which stores the statistics of a queue of data which are waiting to be saved by a logging thread.
+struct QueueStatistics
+{
+	unsigned int depth; //!< The number of elements which are currently waiting in the queue.
+	unsigned int maxDepth; //!< The maximum number of elements which were waiting in the queue at the same time.
+	std::uint64_t numOfSavedElements; //!< The number of elements which were taken from the queue and saved.
+	std::uint64_t numOfBlockings; //!< The number of times the producer had to wait because the queue was full.
+	double lastWriteLatency; //!< The time, in milliseconds, which the last element took to be saved, since it was queued.
+	double maxWriteLatency; //!< The maximum time, in milliseconds, which an element took to be saved, since it was queued.
+	double meanWriteLatency; //!< The mean time, in milliseconds, which the elements took to be saved, since they were queued.
+	//! The default constructor, which clears the statistics.
+	QueueStatistics() {	Clear();	}
+	//! This method clears all statistics.
+	void Clear() {	depth=maxDepth=0; numOfSavedElements=numOfBlockings=0; lastWriteLatency=maxWriteLatency=meanWriteLatency=0.0;	}
+};
+
+
+//! The aim of this class is to write a file through a large buffer in the user space, so the file can be kept open for a long time while the data are written with few system calls.
+/*!	The data are copied to the buffer and they are only written to the file when the buffer is full or when the methods
+ * 	Flush() or Sync() are called explicitly, so the durability is decided by the user of the class: Flush() gives the data to
+ * 	the kernel and Sync() also waits for the data to be written in the storage device. The number of system calls and the
+ * 	number of bytes which are written are counted, and they can be accumulated in an external _IOStatistics_ structure too.
+ */
+class BufferedFileWriter
+{
+	//Attributes//
+	int fd; //!< The file descriptor.
+	std::string filePath; //!< The path of the current file.
+	std::vector<char> buffer; //!< The buffer in the user space.
+	std::size_t bufferedBytes; //!< The number of bytes which are waiting in the buffer.
+	IOStatistics stats; //!< The counters of this object.
+	IOStatistics * externalStats; //!< A pointer to an external structure where the counters are also accumulated, or `nullptr`.
+	std::uint64_t fileSize; //!< The size the current file has when the buffered bytes are written, in bytes.
+	//Private methods//
+	//! This method writes a block of bytes directly to the file, retrying if the writing was partial.
+	void WriteToFile(const char * data, std::size_t numOfBytes);
+	//! This method updates the internal and external counters.
+	void Count(const std::uint64_t syscalls, const std::uint64_t writes, const std::uint64_t syncs, const std::uint64_t bytes);
+public:
+	//Class interface//
+	//! The class constructor, which receives the size of the buffer.
+	BufferedFileWriter(const std::size_t bufferSize=262144);
+	//! The class destructor, which writes the buffered data and closes the file.
+	~BufferedFileWriter();
+	//! This method opens a file to write, keeping the previous content or truncating it.
+	void Open(const std::string & path, const bool flagAppend=false);
+	//! This method writes a block of bytes.
+	void Write(const void * data, const std::size_t numOfBytes);
+	//! This method writes a string.
+	void Write(const std::string & str) {	Write( str.data(), str.size() );	}
+	//! This method gives the buffered data to the kernel.
+	void Flush();
+	//! This method gives the buffered data to the kernel and then it waits for the data to be written in the storage device.
+	void Sync();
+	//! This method writes the buffered data and closes the file.
+	void Close();
+	//! This method states if there is a file open.
+	bool IsOpen() const {	return( fd>=0 );	}
+	//! This method returns the path of the current file.
+	const std::string & GetPath() const {	return filePath;	}
+	//! This method returns the size of the current file, including the bytes which are waiting in the buffer.
+	std::uint64_t GetSize() const {	return fileSize;	}
+	//! This method returns the counters of this object.
+	const IOStatistics & GetIOStatistics() const {	return stats;	}
+	//! This method sets an external structure where the counters are also accumulated.
+	void SetIOStatistics(IOStatistics * statsPtr) {	externalStats=statsPtr;		}
+};
+
+
+//#/////////////////////////BINARY SWEEPS STORE FORMAT//////////////////////////////
+
+//! The header which is at the beginning of a binary sweeps store file.
+/*!	The file format is the following, where all the values are written with the byte order of the machine (little endian
+ * 	in the Raspberry Pi):
+ * 	- This header (32 bytes).
+ * 	- A table with the parameters of the frequency bands, one _SweepStoreBandRecord_ per band.
+ * 	- The frequency grid: _numOfPoints_ frequency values in Hz (`std::uint64_t`).
+ * 	- The records, one per sweep, each one with a _SweepStoreRecordHeader_ followed by _numOfPoints_ power values in dBm (`float`).
+ *
+ * 	So, the band plan and the frequency grid are written just once and then all the records have the same size, which
+ * 	allows to access any sweep directly when the file is mapped into memory.
+ *
+ * 	The version 2 of the format is the same, except the power values of each record are encoded by a _SweepCodec_ object,
+ * 	so the records have a variable size: the field _recordSize_ of this header is 0 and the field _reserved_ of the header
+ * 	of each record saves the size of the encoded values which follow it.
+ */
+struct SweepStoreFileHeader
+{
+	char magic[8]; //!< The identifier of the file type: "RFIMSSWP".
+	std::uint32_t version; //!< The version of the file format.
+	std::uint32_t headerSize; //!< The total size of the header, the bands table and the frequency grid, in bytes, i.e. the offset of the first record.
+	std::uint32_t numOfBands; //!< The number of frequency bands in the bands table.
+	std::uint32_t numOfPoints; //!< The number of points of the frequency grid, i.e. the number of power values of each sweep.
+	std::uint32_t recordSize; //!< The size of each record, in bytes.
+	std::uint32_t reserved; //!< Reserved for future use, it is set to zero.
+};
+
+//! The parameters of one frequency band, as they are written in the bands table of a binary sweeps store file.
+struct SweepStoreBandRecord
+{
+	std::uint32_t bandNumber; //!< The band index.
+	std::uint32_t flagEnable; //!< The enabling of the band: 0 or 1.
+	float startFreq; //!< Initial frequency in Hz.
+	float stopFreq; //!< Final frequency in Hz.
+	float rbw; //!< Resolution Bandwidth in Hz.
+	float vbw; //!< Video Bandwidth in Hz.
+	std::uint32_t sweepTime; //!< The sweep time in ms.
+	std::uint32_t flagDefaultSamplePoints; //!< It indicates if the sample points number was left with its default value: 0 or 1.
+	std::uint32_t samplePoints; //!< The number of samples points.
+	std::uint32_t detector; //!< The display detector: 0 for RMS or 1 for Min/Max.
+};
+
+//! The header of each record (sweep) of a binary sweeps store file.
+struct SweepStoreRecordHeader
+{
+	std::uint16_t year; //!< The year of the sweep timestamp.
+	std::uint8_t month; //!< The month of the sweep timestamp.
+	std::uint8_t day; //!< The day of the sweep timestamp.
+	std::uint8_t hour; //!< The hour of the sweep timestamp.
+	std::uint8_t minute; //!< The minute of the sweep timestamp.
+	std::uint8_t second; //!< The second of the sweep timestamp.
+	std::uint8_t polarization; //!< The antenna polarization: 0 for horizontal, 1 for vertical and 2 for unknown.
+	float azimuthAngle; //!< The azimuth angle of the antenna, in degrees.
+	std::uint32_t reserved; //!< In the version 1 it is reserved for future use and it is set to zero. In the version 2 it is the size of the encoded values, in bytes.
+};
+
+//#////////////////////////////////////////////////////////////////////////////////
+
+
+//! The aim of this class is to encode the power values of the sweeps of a measurement cycle in a compact way, and to decode them.
+/*!	The power values are quantized with a resolution of 0.1 dB, which is the resolution of the CSV files, and the rounding
+ * 	is the same as the one of the CSV formatting, so the values which are decoded give exactly the same CSV text as the
+ * 	original ones. Each sweep is encoded with the smaller of two predictions: the same bin in the previous sweep (INTER),
+ * 	since the sweeps of a cycle share the frequency grid and they are very correlated, or the previous bin in the same
+ * 	sweep (INTRA). The differences between the quantized values and the predictions are small integers, which are packed
+ * 	as zigzag varints: one byte for the differences between -64 and 63. The sweeps which have values that cannot be
+ * 	quantized exactly (not finite, too big or negative values which are rounded to -0.0) are stored as-is (RAW).
+ *
+ * 	The encoded data of a sweep are: a byte with the encoding (RAW, INTRA or INTER) and the values. As the INTER encoding
+ * 	depends on the previous sweep, the sweeps must be decoded in the same order they were encoded, with an object which
+ * 	starts with the same state.
+ */
+class SweepCodec
+{
+public:
+	//! The encodings of a sweep.
+	enum Encoding : std::uint8_t {RAW=0, INTRA=1, INTER=2};
+private:
+	//Attributes//
+	//Constants
+	static const std::int32_t MAX_QUANT_VALUE = 1<<20; //!< The maximum absolute value of a quantized value, so the decoded value has enough precision.
+	//Variables
+	std::vector<std::int32_t> reference; //!< The quantized values of the previous sweep, or an empty vector if there is no previous sweep.
+	std::vector<std::int32_t> quantValues; //!< A buffer with the quantized values of the current sweep, which is reused between sweeps.
+	//Private methods//
+	//! This method appends an integer to a string as a zigzag varint.
+	static void PutVarint(std::string & output, const std::int32_t value);
+	//! This method reads a zigzag varint and returns the position after it.
+	static const char * GetVarint(const char * data, const char * end, std::int32_t & value);
+	//! This method returns the number of bytes of an integer packed as a zigzag varint.
+	static std::size_t GetVarintSize(const std::int32_t value);
+public:
+	//Class interface//
+	//! This method forgets the previous sweep, so the next one is encoded, or decoded, without it.
+	void Reset() {	reference.clear();	}
+	//! This method encodes the power values of a sweep and appends the result to the given string.
+	Encoding Encode(const float * values, const std::size_t numOfPoints, std::string & output);
+	//! This method decodes the power values of a sweep and returns the number of bytes which were read.
+	std::size_t Decode(const char * data, const std::size_t size, float * values, const std::size_t numOfPoints);
+};
+
+
+//! The aim of this class is to append the calibrated sweeps of a measurement cycle to a binary sweeps store file.
+/*!	Unlike the CSV format, the power values are not formatted as text, they are written as-is, so the time needed to save
+ * 	a sweep is just the time needed to copy its values to the file. The format of the file is described in the structure
+ * 	_SweepStoreFileHeader_.
+ */
+class SweepStoreWriter
+{
+	//Attributes//
+	//Constants
+	const std::uint32_t VERSION = 1; //!< The version of the file format which is written when the power values are not encoded.
+	const std::uint32_t VERSION_ENCODED = 2; //!< The version of the file format which is written when the power values are encoded.
+	//Variables
+	BufferedFileWriter file; //!< The object which is used to write the file.
+	bool flagEncoding; //!< A flag which indicates if the power values are encoded with the object _codec_.
+	SweepCodec codec; //!< The object which encodes the power values of the sweeps.
+	std::string encodedValues; //!< A buffer with the encoded values of the current sweep, which is reused between sweeps.
+	std::uint32_t numOfPoints; //!< The number of points of the frequency grid of the current file.
+	std::size_t numOfRecords; //!< The number of records which have been appended to the current file.
+	std::vector<char> recordBuffer; //!< A buffer which is used to build each record before writing it, which is reused between sweeps.
+public:
+	//Class interface//
+	//! The unique class constructor, which receives the size of the buffer in the user space.
+	SweepStoreWriter(const std::size_t bufferSize=1048576) : file(bufferSize) {	flagEncoding=false; numOfPoints=0; numOfRecords=0;	}
+	//! The class destructor, which closes the file if it is open.
+	~SweepStoreWriter() {}
+	//! This method defines if the power values of the next files are encoded with a _SweepCodec_ object (version 2) or they are written as-is (version 1).
+	void SetEncoding(const bool flagEnable) {	flagEncoding=flagEnable;	}
+	//! This method creates a new file, writing the header with the band plan and the frequency grid.
+	void Open(const std::string & path, const std::vector<BandParameters> & bandsParameters, const std::vector<std::uint_least64_t> & frequencies);
+	//! This method appends a sweep to the file, as a new record.
+	void Append(const Sweep & sweep);
+	//! This method gives the buffered data to the kernel.
+	void Flush() {	file.Flush();	}
+	//! This method gives the buffered data to the kernel and then it waits for the data to be written in the storage device.
+	void Sync() {	file.Sync();	}
+	//! This method closes the file.
+	void Close() {	file.Close();	}
+	//! This method states if there is a file open.
+	bool IsOpen() const {	return file.IsOpen();	}
+	//! This method returns the path of the current file.
+	const std::string & GetPath() const {	return file.GetPath();	}
+	//! This method returns the size of the current file, including the bytes which are waiting in the buffer.
+	std::uint64_t GetSize() const {	return file.GetSize();	}
+	//! This method sets an external structure where the counters of input/output operations are accumulated.
+	void SetIOStatistics(IOStatistics * statsPtr) {	file.SetIOStatistics(statsPtr);	}
+	//! This method returns the number of records which have been appended to the current file.
+	std::size_t GetNumOfRecords() const {	return numOfRecords;	}
+};
+
+
+//! The aim of this class is to format the lines of the CSV files in a buffer which is reused, without the overhead of the streams.
+/*!	The numbers are formatted with integer arithmetic and the text is identical, byte by byte, to the one which is given
+ * 	by a stream with the flags `std::ios::fixed` and `std::ios::showpoint`, i.e. by printf() with the format "%#.*f": the
+ * 	exact value is rounded to the nearest output and the ties are rounded to the even digit. The few values which cannot
+ * 	be formatted in that way (values which are not finite or too big and frequencies which are exactly between two
+ * 	outputs) are formatted with snprintf(), as the streams do.
+ */
+class CSVFormatter
+{
+	//Attributes//
+	//Constants
+	static const std::size_t MAX_NUMBER_LENGTH = 64; //!< The maximum number of characters of a formatted number.
+	//Variables
+	std::vector<char> buffer; //!< The buffer where the text is formatted, which keeps its size between lines.
+	std::size_t length; //!< The number of characters of the text.
+	//Private methods//
+	//! This method ensures the buffer has room for the given number of characters after the text and returns a pointer to the end of the text.
+	char * Reserve(const std::size_t numOfChars);
+	//! This method writes the decimal digits of an unsigned integer and returns a pointer to the character after the last one.
+	static char * FormatUnsigned(char * dest, std::uint64_t value);
+	//! This method formats a value with snprintf(), as the streams do, and returns a pointer to the character after the last one.
+	static char * FormatWithPrintf(char * dest, const double value, const int precision);
+public:
+	//Class interface//
+	//! The unique class constructor.
+	CSVFormatter() {	length=0;	}
+	//! This method formats a value with one decimal digit, as the power values (dBm) and the azimuth angles (degrees) are saved, and returns a pointer to the character after the last one.
+	static char * FormatOneDecimal(char * dest, const float value);
+	//! This method formats a frequency given in Hz as MHz with four decimal digits and returns a pointer to the character after the last one.
+	static char * FormatFrequency(char * dest, const std::uint64_t frequency);
+	//! This method removes the text, keeping the buffer.
+	void Clear() {	length=0;	}
+	//! This method appends a character.
+	void Append(const char c) {	*Reserve(1) = c; length++;	}
+	//! This method appends a null-terminated string.
+	void Append(const char * str) {	const std::size_t len = std::strlen(str); std::memcpy( Reserve(len), str, len ); length += len;	}
+	//! This method appends a string.
+	void Append(const std::string & str) {	std::memcpy( Reserve( str.size() ), str.data(), str.size() ); length += str.size();	}
+	//! This method appends an unsigned integer.
+	void AppendUnsigned(const std::uint64_t value) {	length = FormatUnsigned( Reserve(MAX_NUMBER_LENGTH), value ) - buffer.data();	}
+	//! This method appends a value with one decimal digit.
+	void AppendOneDecimal(const float value) {	length = FormatOneDecimal( Reserve(MAX_NUMBER_LENGTH), value ) - buffer.data();	}
+	//! This method appends a frequency given in Hz as MHz with four decimal digits.
+	void AppendFrequency(const std::uint64_t frequency) {	length = FormatFrequency( Reserve(MAX_NUMBER_LENGTH), frequency ) - buffer.data();	}
+	//! This method returns a pointer to the text, which is not null-terminated.
+	const char * Data() const {	return buffer.data();	}
+	//! This method returns the number of characters of the text.
+	std::size_t Size() const {	return length;	}
+	//! This method returns a copy of the text.
+	std::string Str() const {	return std::string( buffer.data(), length );	}
+};
+
+
+//! The aim of this class is to read a binary sweeps store file, which is mapped into memory, and to convert it to the CSV format.
+/*!	The records are accessed directly in the mapped memory, without copying or parsing them. The CSV file which is generated
+ * 	by the method ExportCSV() is identical, byte by byte, to the sweeps file which was generated by the class _DataLogger_
+ * 	before the binary format was introduced, so the users of that format do not notice any difference.
+ */
+class SweepStoreReader
+{
+	//Attributes//
+	const char * mapAddr; //!< The address where the file is mapped.
+	std::size_t mapSize; //!< The size of the mapped region, in bytes.
+	const SweepStoreFileHeader * header; //!< A pointer to the file header, in the mapped memory.
+	std::size_t numOfRecords; //!< The number of complete records in the file.
+	std::vector<std::size_t> recordOffsets; //!< The offsets of the records in the file, when the records have a variable size (version 2).
+	std::vector<float> decodedValues; //!< The decoded power values of all the records, when they are encoded (version 2).
+	//Private methods//
+	//! This method decodes all the records of a file whose power values are encoded.
+	void DecodeRecords();
+	//! This method returns a pointer to the header of the given record, in the mapped memory.
+	const SweepStoreRecordHeader * GetRecordHeader(const std::size_t index) const;
+public:
+	//Class interface//
+	//! The unique class constructor.
+	SweepStoreReader() {	mapAddr=nullptr; mapSize=0; header=nullptr; numOfRecords=0;	}
+	//! The class destructor, which unmaps the file if it is mapped.
+	~SweepStoreReader() {	Close();	}
+	//! This method maps a binary sweeps store file into memory and validates its header.
+	void Open(const std::string & path);
+	//! This method unmaps the file.
+	void Close();
+	//! This method states if there is a file mapped.
+	bool IsOpen() const {	return( mapAddr!=nullptr );	}
+	//! This method returns the number of records (sweeps) of the file.
+	std::size_t GetNumOfRecords() const {	return numOfRecords;	}
+	//! This method returns the number of points of the frequency grid.
+	std::size_t GetNumOfPoints() const {	return header->numOfPoints;		}
+	//! This method returns a pointer to the frequency values (Hz) of the grid, in the mapped memory.
+	const std::uint64_t * GetFrequencies() const {	return (const std::uint64_t*) ( mapAddr + sizeof(SweepStoreFileHeader) + header->numOfBands*sizeof(SweepStoreBandRecord) );	}
+	//! This method returns the parameters of the frequency bands which were stored in the file.
+	std::vector<BandParameters> GetBandsParameters() const;
+	//! This method returns the timestamp of the given record.
+	TimeData GetTimeData(const std::size_t index) const;
+	//! This method returns the azimuth angle of the given record.
+	float GetAzimuthAngle(const std::size_t index) const {	return GetRecordHeader(index)->azimuthAngle;	}
+	//! This method returns the polarization of the given record, as a string: "horizontal" or "vertical".
+	std::string GetPolarization(const std::size_t index) const;
+	//! This method returns a pointer to the power values (dBm) of the given record, in the mapped memory or in the buffer of decoded values.
+	const float * GetValues(const std::size_t index) const;
+	//! This method returns a whole record as a _Sweep_ object.
+	Sweep GetSweep(const std::size_t index) const;
+	//! This method writes the sweeps in the CSV format to the given stream.
+	void ExportCSV(std::ostream & os) const;
+	//! This method writes the sweeps in the CSV format to the given file.
+	void ExportCSV(const std::string & csvPath) const;
+	//! This method appends the header row of the CSV format, with the frequency values, to the given formatter.
+	static void WriteCSVHeader(CSVFormatter & formatter, const std::uint64_t * frequencies, const std::size_t numOfPoints);
+	//! This method appends a row of the CSV format, with the data of one sweep, to the given formatter.
+	static void WriteCSVRow(CSVFormatter & formatter, const std::string & timestamp, const float azimuthAngle, const std::string & polarization,
+			const float * values, const std::size_t numOfPoints);
+};
+
+
+//#///////////////////////////COMPRESSED ARCHIVES////////////////////////////////
+
+//! A structure which stores the statistics of the compression of a file.
+struct CompressionStatistics
+{
+	std::uint64_t numOfInputBytes; //!< The number of bytes which were given to the compressor.
+	std::uint64_t numOfOutputBytes; //!< The number of compressed bytes which were written to the file.
+	double elapsedTime; //!< The time, in milliseconds, which was spent compressing and writing the data.
+	//! The default constructor, which clears the statistics.
+	CompressionStatistics() {	Clear();	}
+	//! This method clears all statistics.
+	void Clear() {	numOfInputBytes=numOfOutputBytes=0; elapsedTime=0.0;	}
+	//! This method returns the compression ratio, i.e. the number of input bytes divided by the number of output bytes.
+	double GetRatio() const {	return( numOfOutputBytes>0 ? double(numOfInputBytes)/numOfOutputBytes : 0.0 );	}
+};
+
+
+//! The aim of this class is to compress a stream of data with the library liblzma and to write the result to a file.
+/*!	The data are compressed as they are given to the object, in the thread which calls the method Write(), so the data do
+ * 	not need to be written to an intermediate file. Two formats are supported: the XZ format, which can be compressed with
+ * 	several threads if the version of liblzma allows it, and the legacy LZMA format (.lzma), which is the format generated
+ * 	by the utility 'lzma'. The compression preset goes from 0 (the fastest) to 9 (the best compression).
+ */
+class CompressedFileWriter
+{
+public:
+	//! The formats of the compressed file.
+	enum Format {XZ, LZMA_ALONE};
+private:
+	//Attributes//
+	Format format; //!< The format of the compressed file.
+	std::uint32_t preset; //!< The compression preset, between 0 and 9.
+	unsigned int numOfThreads; //!< The number of threads which are used to compress with the XZ format, 0 means one per processor core.
+	lzma_stream stream; //!< The structure which is used by liblzma to keep the state of the compression.
+	bool flagStreamOpen; //!< A flag which indicates if the compression stream was initialized.
+	std::vector<std::uint8_t> outBuffer; //!< The buffer which receives the compressed data before they are written to the file.
+	BufferedFileWriter file; //!< The object which is used to write the compressed file.
+	CompressionStatistics stats; //!< The statistics of the current file.
+	std::uint64_t initialFileSize; //!< The size of the file before the current stream was appended, or 0 if the file was truncated.
+	//Private methods//
+	//! This method gives data to the compressor and writes the compressed data which are generated.
+	void Compress(const void * data, const std::size_t numOfBytes, const lzma_action action);
+public:
+	//Class interface//
+	//! The unique class constructor.
+	CompressedFileWriter();
+	//! The class destructor, which discards the compression stream if it was not finished.
+	~CompressedFileWriter();
+	//! This method sets the format and the compression parameters which are used for the next files.
+	void SetParameters(const Format form, const std::uint32_t pres=6, const unsigned int threads=0);
+	//! This method creates a new compressed file.
+	void Open(const std::string & path, const bool flagAppend=false);
+	//! This method compresses a block of bytes.
+	void Write(const void * data, const std::size_t numOfBytes);
+	//! This method compresses a string.
+	void Write(const std::string & str) {	Write( str.data(), str.size() );	}
+	//! This method finishes the compression stream and closes the file.
+	void Close();
+	//! This method discards the compression stream and removes the incomplete file.
+	void Abort();
+	//! This method states if there is a file open.
+	bool IsOpen() const {	return flagStreamOpen;	}
+	//! This method returns the format of the compressed files.
+	Format GetFormat() const {	return format;	}
+	//! This method returns the statistics of the current, or the last, file.
+	const CompressionStatistics & GetStatistics() const {	return stats;	}
+	//! This method returns the usual file extension of the given format, with the dot.
+	static std::string GetExtension(const Format form) {	return( form==XZ ? ".xz" : ".lzma" );	}
+};
+
+
+//! The aim of this class is to build an archive with the tar format (ustar) which is compressed as it is built.
+/*!	The files are read from their original locations and they are written directly to the compressed stream, so they do
+ * 	not need to be copied to a temporary folder. Also, data which are in memory can be archived as a file, so the files which
+ * 	must be generated just to be archived do not need to be written to the storage device.
+ */
+class TarArchiveWriter
+{
+	//Attributes//
+	//Constants
+	static const std::size_t BLOCK_SIZE = 512; //!< The size of the blocks of a tar archive.
+	//Variables
+	CompressedFileWriter compFile; //!< The object which compresses the archive and writes it to the file.
+	std::vector<char> readBuffer; //!< A buffer which is used to read the files which are archived.
+	//Private methods//
+	//! This method writes the zeros which are needed to complete the last block of an entry.
+	void WritePadding(const std::uint64_t entrySize);
+public:
+	//Class interface//
+	//! The unique class constructor.
+	TarArchiveWriter() : readBuffer(65536) {}
+	//! This method sets the format and the compression parameters which are used for the next archives.
+	void SetCompression(const CompressedFileWriter::Format format, const std::uint32_t preset=6, const unsigned int threads=0) {	compFile.SetParameters(format, preset, threads);	}
+	//! This method creates a new compressed archive, or appends a new compressed stream with more entries to an existing one.
+	void Open(const std::string & path, const bool flagAppend=false) {	compFile.Open(path, flagAppend);	}
+	//! This method adds a directory to the archive.
+	void AddDirectory(const std::string & name);
+	//! This method adds a file to the archive, reading it from the given path.
+	void AddFile(const std::string & name, const std::string & sourcePath);
+	//! This method adds a file to the archive whose content is the given block of bytes.
+	void AddData(const std::string & name, const void * data, const std::size_t numOfBytes);
+	//! This method adds a file to the archive whose content is the given string.
+	void AddData(const std::string & name, const std::string & content) {	AddData( name, content.data(), content.size() );	}
+	//! This method writes the end of the archive, if it is required, finishes the compression and closes the file.
+	void Close(const bool flagEndOfArchive=true);
+	//! This method discards the archive and removes the incomplete file.
+	void Abort() {	compFile.Abort();	}
+	//! This method returns the statistics of the compression of the current, or the last, archive.
+	const CompressionStatistics & GetStatistics() const {	return compFile.GetStatistics();	}
+	//! This method builds the header of a tar entry.
+	static std::string MakeHeader(const std::string & name, const std::uint64_t size, const char typeflag='0', const std::time_t mtime=std::time(nullptr));
+	//! This method returns the number of zeros which are needed to complete the last block of an entry.
+	static std::size_t GetPaddingSize(const std::uint64_t entrySize) {	return( (BLOCK_SIZE - entrySize % BLOCK_SIZE) % BLOCK_SIZE );	}
+};
+
+
+//! The aim of this class is to build a compressed tar archive while its files are being generated, so the compression is spread over the time.
+/*!	The archive has a text file, the sweeps file, which grows until the archive is closed, and other files which are
+ * 	complete when they are added. The tar format needs the size of each file before its content, so the text of the sweeps
+ * 	file is compressed in a separate stream, in a temporary file, while the other files are compressed as complete entries in
+ * 	the archive itself. When the archive is closed, the header of the sweeps file is compressed in a small stream which is
+ * 	appended to the archive, then the compressed text of the sweeps file is appended, without decompressing it, and finally
+ * 	a small stream with the end of the archive is appended. The XZ format allows the concatenation of compressed streams,
+ * 	which are decompressed as one, so the result is a normal .tar.xz file and the closing takes just a few milliseconds.
+ * 	The archive is built with a temporary name, with the extension ".part", and it is renamed when it is complete.
+ */
+class IncrementalArchiveWriter
+{
+	//Attributes//
+	TarArchiveWriter entries; //!< The object which compresses the complete entries directly in the archive.
+	CompressedFileWriter sweepsText; //!< The object which compresses the text of the sweeps file in a temporary file.
+	CompressedFileWriter trailer; //!< The object which is used to append the small streams when the archive is closed.
+	std::uint32_t preset; //!< The compression preset, between 0 and 9.
+	std::string archivePath; //!< The path of the final archive.
+	std::string sweepsName; //!< The name of the sweeps file inside the archive.
+	bool flagOpen; //!< A flag which indicates if there is an archive being built.
+	CompressionStatistics stats; //!< The statistics of the last archive which was closed.
+	double closingTime; //!< The time, in milliseconds, which was needed to close the last archive.
+	//Private methods//
+	//! This method returns the temporary path of the archive while it is being built.
+	std::string GetPartPath() const {	return( archivePath + ".part" );	}
+	//! This method returns the path of the temporary file with the compressed text of the sweeps file.
+	std::string GetSweepsPartPath() const {	return( archivePath + ".sweeps.part" );		}
+public:
+	//Class interface//
+	//! The unique class constructor.
+	IncrementalArchiveWriter() {	preset=6; flagOpen=false; closingTime=0.0;	}
+	//! The class destructor, which discards the archive if it was not closed.
+	~IncrementalArchiveWriter() {	Abort();	}
+	//! This method sets the compression preset which is used for the next archives.
+	void SetCompression(const std::uint32_t pres) {	preset=pres;	}
+	//! This method starts a new archive.
+	void Open(const std::string & path, const std::string & sweepsFilename);
+	//! This method compresses a piece of text of the sweeps file.
+	void WriteSweepsText(const std::string & text) {	sweepsText.Write(text);		}
+	//! This method compresses a piece of text of the sweeps file, given as a block of characters.
+	void WriteSweepsText(const char * text, const std::size_t numOfChars) {	sweepsText.Write(text, numOfChars);		}
+	//! This method adds a directory to the archive.
+	void AddDirectory(const std::string & name) {	entries.AddDirectory(name);		}
+	//! This method adds a file to the archive, reading it from the given path.
+	void AddFile(const std::string & name, const std::string & sourcePath) {	entries.AddFile(name, sourcePath);	}
+	//! This method adds a file to the archive whose content is the given string.
+	void AddData(const std::string & name, const std::string & content) {	entries.AddData(name, content);		}
+	//! This method adds a file to the archive whose content is the given block of bytes.
+	void AddData(const std::string & name, const void * data, const std::size_t numOfBytes) {	entries.AddData(name, data, numOfBytes);	}
+	//! This method completes the archive with the sweeps file and the end of the archive, and gives it its final name.
+	void Close();
+	//! This method discards the archive and removes the temporary files.
+	void Abort();
+	//! This method states if there is an archive being built.
+	bool IsOpen() const {	return flagOpen;	}
+	//! This method returns the path of the archive which is being built, or of the last archive which was closed.
+	const std::string & GetPath() const {	return archivePath;		}
+	//! This method returns the statistics of the last archive which was closed, where the time is the sum of the times spent compressing during the whole building.
+	const CompressionStatistics & GetStatistics() const {	return stats;	}
+	//! This method returns the time, in milliseconds, which was needed to close the last archive.
+	double GetClosingTime() const {	return closingTime;		}
+};
+
+
+//#/////////////////////////MEASUREMENTS JOURNAL//////////////////////////////
+
+//! The aim of this class is to keep an append-only journal of the operations over the measurements, so the state of the data files and the archives can be recovered after a power cut.
+/*!	The journal file starts with the 8 bytes "RFIMSJ01" and then it has one record per operation: a sweep or a RFI was
+ * 	saved, a measurement cycle started or finished, an archive was created or uploaded. Each record has the following
+ * 	fields, with the byte order of the machine:
+ * 	- The size of the body, in bytes (`std::uint32_t`).
+ * 	- The body: the type of record (`std::uint8_t`), a value (`std::uint64_t`), the length of the timestamp of the measurement
+ * 	cycle (`std::uint8_t`) followed by its characters, and the length of a filename (`std::uint16_t`) followed by its characters.
+ * 	- The CRC32 of the body (`std::uint32_t`).
+ *
+ * 	So, when the journal is opened, a record which was written partially, because the power was cut, is detected and
+ * 	discarded, with all the records which follow it. The records are kept in memory when they are appended and they are
+ * 	written, and synchronized with the storage device, in groups (group commit) with the method Commit(), which should be
+ * 	called once the data files have been synchronized, so a record is never durable before the data it refers to. The method
+ * 	IsCommitDue() states if the configured interval has elapsed since the last commit; by default the interval is 0, which
+ * 	means the commits are only done when the user of the class decides it. This class is thread safe.
+ */
+class MeasurementJournal
+{
+public:
+	//! The types of records of the journal.
+	enum RecordType : std::uint8_t {CYCLE_STARTED=1, SWEEP_SAVED=2, RFI_SAVED=3, CYCLE_FINISHED=4, ARCHIVE_CREATED=5, UPLOAD_DONE=6};
+	//! A structure which stores a record of the journal.
+	struct Record
+	{
+		RecordType type; //!< The type of record.
+		std::string timestamp; //!< The timestamp of the measurement cycle the record refers to, or an empty string.
+		std::string filename; //!< The name of the archive, for the records ARCHIVE_CREATED and UPLOAD_DONE, or an empty string.
+		std::uint64_t value; //!< The size of the data file after the operation, for the records SWEEP_SAVED and RFI_SAVED, or the flags of the measurement cycle, for the record CYCLE_STARTED.
+		//! The default constructor.
+		Record(const RecordType typ=CYCLE_STARTED, const std::string & ts="", const std::string & name="", const std::uint64_t val=0) :
+			type(typ), timestamp(ts), filename(name), value(val) {}
+	};
+private:
+	//Attributes//
+	//Constants
+	const std::string MAGIC = "RFIMSJ01"; //!< The bytes which are at the beginning of the journal file.
+	const std::uint32_t MAX_BODY_SIZE = 65536; //!< The maximum size of the body of a record, which allows to detect corrupt sizes.
+	//Variables
+	int fd; //!< The file descriptor of the journal file.
+	std::string path; //!< The path of the journal file.
+	std::string pendingRecords; //!< The records which were appended but not committed yet, already serialized.
+	std::size_t numOfPendingRecords; //!< The number of records which were appended but not committed yet.
+	unsigned int commitInterval; //!< The minimum interval between two commits, in milliseconds, which is used by the method IsCommitDue().
+	std::chrono::steady_clock::time_point lastCommitTime; //!< The time of the last commit.
+	std::uint64_t numOfCommits; //!< The number of commits which wrote records.
+	std::uint64_t numOfCommittedRecords; //!< The number of records which were committed.
+	pthread_mutex_t mutex; //!< The mutex which protects the pending records and the file.
+	//Private methods//
+	//! This method serializes a record and appends it to the given string.
+	static void Serialize(const Record & record, std::string & output);
+	//! This method writes a block of bytes to the journal file, retrying if the writing was partial.
+	void WriteToFile(const int fileDesc, const std::string & data) const;
+public:
+	//Class interface//
+	//! The unique class constructor.
+	MeasurementJournal();
+	//! The class destructor, which commits the pending records and closes the file.
+	~MeasurementJournal();
+	//! This method opens, or creates, a journal file and returns its valid records, discarding the ones which were written partially.
+	std::vector<Record> Open(const std::string & journalPath);
+	//! This method replaces atomically the content of the journal with the given records, for example to compact it.
+	void Rewrite(const std::vector<Record> & records);
+	//! This method appends a record to the group of records which will be written by the next commit.
+	void Append(const Record & record);
+	//! This method states if there are pending records and the commit interval has elapsed since the last commit.
+	bool IsCommitDue();
+	//! This method writes the pending records and synchronizes the journal file with the storage device.
+	void Commit();
+	//! This method commits the pending records and closes the file.
+	void Close();
+	//! This method states if there is a journal file open.
+	bool IsOpen() const {	return( fd>=0 );	}
+	//! This method sets the minimum interval between two commits, in milliseconds, or 0 to commit only when the user of the class decides it.
+	void SetCommitInterval(const unsigned int interval) {	commitInterval=interval;	}
+	//! This method returns the number of commits which wrote records.
+	std::uint64_t GetNumOfCommits() const {	return numOfCommits;	}
+	//! This method returns the number of records which were committed.
+	std::uint64_t GetNumOfCommittedRecords() const {	return numOfCommittedRecords;	}
+};
+
+
+//#/////////////////////////RETENTION INDEX//////////////////////////////
+
+//! The aim of this class is to keep an index of the files of the measurement cycles, ordered by the timestamp of the cycles and with their sizes, so the old files can be removed without scanning the folders.
+/*!	The index is saved in a text file with one line per operation: a line "+ timestamp size path" when a file is added
+ * 	and a line "- timestamp path" when a file is taken out of the index, so each change just appends a few lines to the
+ * 	file, instead of rewriting it. When the index is opened, the lines are replayed and, if the lines of files which are
+ * 	not in the index anymore are the majority, the file is compacted. The oldest files are taken out of the index with the
+ * 	methods PopOlderThan() and PopToFitQuota(), whose cost only depends on the number of files which are taken out, and
+ * 	the user of the class is who removes them. The changes are written to the file by the method Commit().
+ */
+class RetentionIndex
+{
+public:
+	//! A structure which stores the data of a file of the index.
+	struct Entry
+	{
+		std::string path; //!< The path of the file or directory.
+		std::uint64_t size; //!< The size of the file, or of the content of the directory, in bytes.
+	};
+private:
+	//Attributes//
+	std::string indexPath; //!< The path of the index file.
+	std::multimap<TimeData, Entry> entries; //!< The files of the index, ordered by the timestamp of their measurement cycles.
+	std::uint64_t totalSize; //!< The sum of the sizes of the files of the index, in bytes.
+	std::size_t numOfLines; //!< The number of lines of the index file.
+	std::string pendingLines; //!< The lines which must be appended to the index file by the next commit.
+	//Private methods//
+	//! This method writes the given text to a file, synchronizing it with the storage device.
+	void WriteFile(const std::string & path, const std::string & text, const bool flagAppend) const;
+	//! This method takes an entry out of the index and returns it.
+	Entry Pop(const std::multimap<TimeData, Entry>::iterator entryIt);
+public:
+	//Class interface//
+	//! The unique class constructor.
+	RetentionIndex() {	totalSize=0; numOfLines=0;	}
+	//! This method loads the index from the given file and returns `false` if the file did not exist, in which case an empty index is created.
+	bool Open(const std::string & path);
+	//! This method adds a file, or a directory, of the measurement cycle with the given timestamp to the index, if it exists.
+	void Add(const TimeData & cycleTime, const std::string & path);
+	//! This method takes out of the index the files of the measurement cycles which are older than the given time and returns them.
+	std::vector<Entry> PopOlderThan(const TimeData & limitTime);
+	//! This method takes out of the index the files of the oldest measurement cycles until the total size is not bigger than the given quota, keeping the last cycle and the given ones, and returns them.
+	std::vector<Entry> PopToFitQuota(const std::uint64_t quota, const std::set<TimeData> & keptCycles);
+	//! This method appends the changes to the index file.
+	void Commit();
+	//! This method returns the sum of the sizes of the files of the index, in bytes.
+	std::uint64_t GetTotalSize() const {	return totalSize;	}
+	//! This method returns the number of files of the index.
+	std::size_t Size() const {	return entries.size();	}
+};
+
+
+//#//////////////////////////QUERY INDEX///////////////////////////////
+
+//! A structure which stores the conditions which the records (sweeps) must meet to be returned by a query.
+struct MeasurementQuery
+{
+	TimeData startTime; //!< The records whose timestamps are before this time are discarded.
+	TimeData stopTime; //!< The records whose timestamps are after this time are discarded.
+	bool flagAzimuth; //!< A flag which indicates if the records are filtered by their azimuth angles.
+	float azimuthAngle; //!< The azimuth angle of the records, in degrees.
+	float azimuthTolerance; //!< The maximum difference between the azimuth angle of a record and the one of the query, in degrees.
+	std::string polarization; //!< The polarization of the records: "horizontal", "vertical" or an empty string to accept both.
+	std::uint64_t startFreq; //!< The first frequency, in Hz, of the values which are extracted.
+	std::uint64_t stopFreq; //!< The last frequency, in Hz, of the values which are extracted. If it is equal to _startFreq_, the value of the nearest frequency is extracted.
+	bool flagOnlyRFI; //!< A flag which indicates if only the records which have RFI in the bands of the frequency range are returned.
+	//! The default constructor, which sets a query that accepts all the records and all the frequencies.
+	MeasurementQuery();
+};
+
+//! A structure which stores the records of a measurement cycle which met the conditions of a query.
+struct QueryResult
+{
+	//! A structure which stores a record which met the conditions of a query.
+	struct Record
+	{
+		std::size_t index; //!< The index of the record in its measurement cycle, starting at zero.
+		TimeData timeData; //!< The timestamp of the record.
+		float azimuthAngle; //!< The azimuth angle of the antenna, in degrees.
+		std::string polarization; //!< The antenna polarization.
+		std::uint64_t rfiBands; //!< A bitmap with the bands where RFI was detected: the bit _i_ is set if there was RFI in the band _i_.
+		std::vector<float> values; //!< The power values (dBm) of the frequencies which were extracted.
+	};
+	std::string cycleTimestamp; //!< The timestamp of the measurement cycle.
+	std::vector<std::uint64_t> frequencies; //!< The frequencies (Hz) of the values which were extracted.
+	std::vector<Record> records; //!< The records which met the conditions, in the order they were saved.
+};
+
+//! The aim of this class is to keep an index of the records of the binary sweeps stores of the measurement cycles, so they can be queried without parsing the whole files.
+/*!	The index keeps, for each file sweeps_DD-MM-YYYYTHH:MM:SS.bin, its size, the frequency ranges of its bands and, for
+ * 	each record, its offset in the file, its timestamp, azimuth angle and polarization and a bitmap with the bands where
+ * 	RFI was detected, which is taken from the file RFI_DD-MM-YYYYTHH:MM:SS.csv of the same cycle. So a query only reads the
+ * 	records which meet its conditions and only the values of the frequencies which were requested, and the files which do
+ * 	not have any matching record are not read at all. In the files whose power values are encoded (version 2), a record
+ * 	may depend on the previous one, so the decoding starts at the last record before the first match which does not depend
+ * 	on others (key record) and it stops at the last match.
+ *
+ * 	The index is saved in a text file which is rewritten atomically by the method Update(), which only indexes again the
+ * 	files whose sizes changed and forgets the files which were removed. The files are indexed and queried by several
+ * 	threads at the same time.
+ *
+ * 	The index file has a line "F timestamp store_size rfi_size version points records bands start:stop..." per file,
+ * 	followed by a line "R offset timestamp azimuth polarization key rfi_bitmap" per record.
+ */
+class MeasurementIndex
+{
+public:
+	//! A structure which stores the data of a record of the index.
+	struct RecordEntry
+	{
+		std::uint64_t offset; //!< The offset of the record in the file, in bytes.
+		TimeData timeData; //!< The timestamp of the record.
+		float azimuthAngle; //!< The azimuth angle of the antenna, in degrees.
+		std::uint8_t polarization; //!< The antenna polarization: 0 for horizontal, 1 for vertical and 2 for unknown.
+		bool flagKey; //!< A flag which indicates if the record can be decoded without the previous one.
+		std::uint64_t rfiBands; //!< A bitmap with the bands where RFI was detected.
+	};
+	//! A structure which stores the data of a file of the index.
+	struct FileEntry
+	{
+		std::string cycleTimestamp; //!< The timestamp of the measurement cycle, which is taken from the filename.
+		TimeData cycleTime; //!< The timestamp of the measurement cycle, which is used to sort the files.
+		std::uint64_t storeSize; //!< The size of the sweeps store when it was indexed, in bytes.
+		std::uint64_t rfiSize; //!< The size of the RFI file when it was indexed, in bytes, or 0 if it did not exist.
+		std::uint32_t version; //!< The version of the format of the sweeps store.
+		std::uint32_t numOfPoints; //!< The number of points of the frequency grid.
+		std::vector< std::pair<float, float> > bands; //!< The start and stop frequencies, in Hz, of the bands.
+		std::vector<RecordEntry> records; //!< The records of the file.
+	};
+private:
+	//Attributes//
+	//Constants
+	static const std::size_t MAX_NUM_OF_BANDS = 64; //!< The maximum number of bands whose RFI is recorded in the bitmaps.
+	//Variables
+	std::string measurementsPath; //!< The path of the folder where the measurements files are.
+	std::string indexPath; //!< The path of the index file.
+	std::vector<FileEntry> files; //!< The files of the index, sorted by the timestamps of their measurement cycles.
+	unsigned int numOfThreads; //!< The maximum number of threads which index or query the files at the same time.
+	std::function<void(std::size_t)> task; //!< The function which is run by the threads for each file.
+	std::size_t numOfTasks; //!< The number of files which must be processed by the threads.
+	std::size_t nextTask; //!< The index of the next file which must be processed.
+	std::vector<std::string> errorMessages; //!< The messages of the errors which occurred in the threads.
+	pthread_mutex_t mutex; //!< The mutex which protects the tasks and the error messages from the concurrent access of the threads.
+	//Private methods//
+	//! This method runs the given function for each file, from 0 to numOfFiles-1, with several threads.
+	void RunTasks(const std::size_t numOfFiles, const std::function<void(std::size_t)> & function);
+	//! This method takes tasks and runs them until there are no more. It is run by each thread.
+	void ProcessTasks();
+	//! This method reads the records of a sweeps store and the RFI of its cycle and fills the given entry.
+	void IndexFile(FileEntry & fileEntry) const;
+	//! This method reads the RFI file of a cycle and sets the bitmaps of the records.
+	void IndexRFI(const std::string & rfiPath, FileEntry & fileEntry) const;
+	//! This method queries a file of the index.
+	void QueryFile(const FileEntry & fileEntry, const MeasurementQuery & query, QueryResult & result) const;
+	//! This method returns the path of the sweeps store of the given measurement cycle.
+	std::string GetStorePath(const std::string & cycleTimestamp) const {	return( measurementsPath + "/sweeps_" + cycleTimestamp + ".bin" );	}
+	//! This method returns the path of the RFI file of the given measurement cycle.
+	std::string GetRFIPath(const std::string & cycleTimestamp) const {	return( measurementsPath + "/RFI_" + cycleTimestamp + ".csv" );	}
+public:
+	//Class interface//
+	//! The unique class constructor.
+	MeasurementIndex();
+	//! The class destructor.
+	~MeasurementIndex() {	pthread_mutex_destroy(&mutex);	}
+	//! This method sets the folder of the measurements files and the index file, and loads the index if the file exists.
+	void Open(const std::string & folderPath, const std::string & filePath);
+	//! This method indexes the files which are new or have changed, forgets the removed ones, saves the index and returns the number of files which were indexed.
+	std::size_t Update();
+	//! This method saves the index to its file, atomically.
+	void Save() const;
+	//! This method returns the records which meet the conditions of the query, grouped by measurement cycle.
+	std::vector<QueryResult> Query(const MeasurementQuery & query);
+	//! This method sets the maximum number of threads which index or query the files at the same time.
+	void SetNumOfThreads(const unsigned int threads) {	numOfThreads = std::max(threads, 1U);	}
+	//! This method returns the files of the index.
+	const std::vector<FileEntry> & GetFiles() const {	return files;	}
+
+	friend void *IndexThreadFunc(void *);
+};
+
+#endif /* DATASTORAGE_H_ */
@@ -0,0 +1,384 @@
+/*! \file DataUploader.cpp
+ * 	\brief This file contains the definitions of several methods of the class _DataUploader_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataUploading.h"
+
+////////////////////Friends functions////////////////////////
+
+//! The function which is executed by each thread which uploads files concurrently.
+void *UploaderThreadFunc(void *arg)
+{
+	auto * uploaderPtr = (DataUploader*) arg;
+
+	uploaderPtr->ProcessQueue();
+
+	return NULL;
+}
+
+//////////////////Class' methods////////////////////
+
+DataUploader::DataUploader()
+{
+	port=0;
+	chunkSize=262144;
+	numOfThreads=2;
+	timeout=60;
+	attemptsPerPass=3;
+	initialDelay=5;
+	maxDelay=3600;
+	flagRemoveUploaded=true;
+
+	pthread_mutex_init(&mutex, NULL);
+}
+
+DataUploader::~DataUploader()
+{
+	pthread_mutex_destroy(&mutex);
+}
+
+/*!	The archives of the measurements (rfims_data_*.tar.xz and rfims_data_*.tar.lzma) which are in the folder but not
+ * in the queue, for example because they were generated before the queue existed, are inserted in the queue in the
+ * order they were modified.
+ * \param [in] folderPath The path of the uploads folder, where the queue file is saved too.
+ */
+void DataUploader::Open(const std::string & folderPath)
+{
+	pthread_mutex_lock(&mutex);
+
+	try
+	{
+		uploadsPath = folderPath;
+		queue.Load(uploadsPath + '/' + QUEUE_FILENAME);
+
+		std::vector< std::pair<std::time_t, std::string> > orphanFiles;
+		for( const auto & dirEntry : boost::filesystem::directory_iterator(uploadsPath) )
+		{
+			const std::string filename = dirEntry.path().filename().string();
+			if( filename.compare(0, 11, "rfims_data_")==0 && ( boost::algorithm::ends_with(filename, ".tar.xz") ||
+					boost::algorithm::ends_with(filename, ".tar.lzma") ) && queue.Find(filename)==nullptr )
+				orphanFiles.emplace_back( boost::filesystem::last_write_time( dirEntry.path() ), filename );
+		}
+
+		if( !orphanFiles.empty() )
+		{
+			std::sort( orphanFiles.begin(), orphanFiles.end() );
+			for(const auto & orphan : orphanFiles)
+				queue.Push(orphan.second);
+			queue.Save();
+		}
+	}
+	catch(std::exception & exc)
+	{
+		pthread_mutex_unlock(&mutex);
+		rfims_exception rfimsExc("the upload queue could not be loaded");
+		rfimsExc.Append( exc.what() );
+		throw(rfimsExc);
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+/*!	\param [in] chunkBytes The size of the chunks, in bytes. The server confirms each chunk, so a transfer which is
+ * interrupted is resumed from the last complete chunk.
+ * \param [in] threads The maximum number of files which are uploaded at the same time, at least one.
+ * \param [in] timeoutSecs The timeout of the network operations, in seconds.
+ */
+void DataUploader::SetTransferParameters(const std::size_t chunkBytes, const unsigned int threads, const unsigned int timeoutSecs)
+{
+	chunkSize = (chunkBytes>0) ? chunkBytes : 262144;
+	numOfThreads = (threads>0) ? threads : 1;
+	timeout=timeoutSecs;
+}
+
+/*!	\param [in] attempts The maximum number of attempts to upload a file in each call to UploadPending(), at least one.
+ * \param [in] initialDelaySecs The delay before the first retry, in seconds.
+ * \param [in] maxDelaySecs The maximum delay between two retries, in seconds.
+ */
+void DataUploader::SetRetryParameters(const unsigned int attempts, const unsigned int initialDelaySecs, const unsigned int maxDelaySecs)
+{
+	attemptsPerPass = (attempts>0) ? attempts : 1;
+	initialDelay=initialDelaySecs;
+	maxDelay=maxDelaySecs;
+}
+
+/*!	\param [in] numOfAttempts The number of consecutive failed attempts.	*/
+unsigned int DataUploader::GetBackoffDelay(const unsigned int numOfAttempts) const
+{
+	unsigned int delay=initialDelay;
+	for(unsigned int i=1; i<numOfAttempts && delay<maxDelay; i++)
+		delay *= 2;
+
+	return std::min(delay, maxDelay);
+}
+
+/*!	\param [in] filename The name of the file, which must be in the uploads folder.	*/
+void DataUploader::Enqueue(const std::string & filename)
+{
+	pthread_mutex_lock(&mutex);
+	try
+	{
+		if( queue.Push(filename) )
+			queue.Save();
+	}
+	catch(std::exception & exc)
+	{
+		pthread_mutex_unlock(&mutex);
+		throw;
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+/*!	\param [in] filename The name of the file.	*/
+void DataUploader::Dequeue(const std::string & filename)
+{
+	pthread_mutex_lock(&mutex);
+	try
+	{
+		queue.Remove(filename);
+		queue.Save();
+	}
+	catch(std::exception & exc)
+	{
+		pthread_mutex_unlock(&mutex);
+		throw;
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+std::vector<std::string> DataUploader::GetPendingFiles()
+{
+	std::vector<std::string> filenames;
+
+	pthread_mutex_lock(&mutex);
+	for(const auto & entry : queue.GetEntries())
+		filenames.push_back(entry.filename);
+	pthread_mutex_unlock(&mutex);
+
+	return filenames;
+}
+
+/*!	The server is asked how many bytes of the file it already has, and the file is sent from that offset in chunks,
+ * each one with its CRC32, waiting the confirmation of each chunk. Finally, the server is told the file is complete.
+ * \param [in] filename The name of the file, in the uploads folder.
+ */
+void DataUploader::UploadFile(const std::string & filename)
+{
+	const std::string filePath = uploadsPath + '/' + filename;
+	int fd = open(filePath.c_str(), O_RDONLY);
+	if(fd < 0)
+		throw rfims_exception("the file " + filePath + " could not be opened to be uploaded.");
+
+	std::uint64_t startOffset=0;
+	try
+	{
+		struct stat fileStatus;
+		if( fstat(fd, &fileStatus)!=0 )
+			throw rfims_exception("the size of the file " + filePath + " could not be known.");
+		const std::uint64_t fileSize = fileStatus.st_size;
+
+		UploadConnection connection;
+		connection.Connect(host, port, timeout);
+
+		std::string reply;
+		connection.SendLine("STAT " + filename + ' ' + std::to_string(fileSize));
+		reply = connection.ReceiveLine();
+		std::istringstream iss(reply);
+		std::string status;
+		if( !(iss >> status >> startOffset) || status!="OK" || startOffset>fileSize )
+			throw rfims_exception("the upload server replied to the command STAT with: " + reply);
+
+		if(startOffset > 0)
+		{
+			pthread_mutex_lock(&mutex);
+			stats.numOfResumes++;
+			pthread_mutex_unlock(&mutex);
+		}
+
+		std::vector<char> chunk(chunkSize);
+		std::uint64_t offset=startOffset;
+		while(offset < fileSize)
+		{
+			const std::size_t length = std::min<std::uint64_t>(chunkSize, fileSize - offset);
+			std::size_t readBytes=0;
+			while(readBytes < length)
+			{
+				ssize_t ret = pread(fd, chunk.data() + readBytes, length - readBytes, offset + readBytes);
+				if(ret < 0 && errno==EINTR)
+					continue;
+				if(ret <= 0)
+					throw rfims_exception("the file " + filePath + " could not be read to be uploaded.");
+				readBytes += ret;
+			}
+
+			std::ostringstream command;
+			command << "PUT " << filename << ' ' << offset << ' ' << length << ' ' << std::hex
+					<< lzma_crc32( (const std::uint8_t*) chunk.data(), length, 0 );
+			connection.SendLine( command.str() );
+			connection.Send(chunk.data(), length);
+
+			reply = connection.ReceiveLine();
+			iss.clear();
+			iss.str(reply);
+			std::uint64_t newOffset;
+			if( !(iss >> status >> newOffset) || status!="OK" || newOffset!=offset+length )
+				throw rfims_exception("the upload server replied to the command PUT with: " + reply);
+			offset = newOffset;
+
+			pthread_mutex_lock(&mutex);
+			stats.numOfBytes += length;
+			UploadQueue::Entry * entry = queue.Find(filename);
+			if(entry!=nullptr)
+				entry->confirmedOffset = offset;
+			pthread_mutex_unlock(&mutex);
+		}
+
+		connection.SendLine("DONE " + filename + ' ' + std::to_string(fileSize));
+		reply = connection.ReceiveLine();
+		if( reply.compare(0, 2, "OK")!=0 )
+			throw rfims_exception("the upload server replied to the command DONE with: " + reply);
+	}
+	catch(std::exception & exc)
+	{
+		close(fd);
+		throw;
+	}
+
+	close(fd);
+}
+
+/*!	Each thread takes the first file of the queue which is ready and tries to upload it. If the uploading fails, it is
+ * retried after a delay which doubles after each failure, until the attempts of this pass are exhausted. Then, the file
+ * is left in the queue with the time of the next attempt, which grows with the number of consecutive failures, and
+ * the thread takes another file.
+ */
+void DataUploader::ProcessQueue()
+{
+	pthread_mutex_lock(&mutex);
+	UploadQueue::Entry * entry;
+	while( (entry = queue.GetNextReady( std::time(nullptr) ))!=nullptr )
+	{
+		entry->flagInProgress=true;
+		const std::string filename = entry->filename;
+		pthread_mutex_unlock(&mutex);
+
+		//The files which were removed by other means are forgotten
+		if( !boost::filesystem::exists(uploadsPath + '/' + filename) )
+		{
+			cerr << "\nWarning: the file " << filename << " is in the upload queue but it does not exist, so it is removed from the queue." << endl;
+			pthread_mutex_lock(&mutex);
+			queue.Remove(filename);
+			try
+			{
+				queue.Save();
+			}
+			catch(std::exception & exc)
+			{
+				errorMessages.push_back( exc.what() );
+			}
+			continue;
+		}
+
+		unsigned int attemptsInPass=0;
+		bool flagDone=false;
+		while(!flagDone)
+		{
+			std::string errorMsg;
+			try
+			{
+				UploadFile(filename);
+			}
+			catch(std::exception & exc)
+			{
+				errorMsg = exc.what();
+			}
+
+			pthread_mutex_lock(&mutex);
+			attemptsInPass++;
+			try
+			{
+				if( errorMsg.empty() )
+				{
+					stats.numOfFiles++;
+					queue.Remove(filename);
+					flagDone=true;
+					queue.Save();
+					if( flagRemoveUploaded && std::remove( (uploadsPath + '/' + filename).c_str() )!=0 )
+						errorMessages.push_back("the file " + filename + " was uploaded but it could not be removed.");
+				}
+				else
+				{
+					stats.numOfFailures++;
+					entry = queue.Find(filename);
+					entry->numOfAttempts++;
+					if(attemptsInPass >= attemptsPerPass)
+					{
+						entry->nextAttemptTime = std::time(nullptr) + GetBackoffDelay(entry->numOfAttempts);
+						entry->flagInProgress=false;
+						errorMessages.push_back(filename + ": " + errorMsg);
+						flagDone=true;
+						queue.Save();
+					}
+				}
+			}
+			catch(std::exception & exc)
+			{
+				errorMessages.push_back( exc.what() );
+			}
+
+			if(!flagDone)
+			{
+				pthread_mutex_unlock(&mutex);
+				sleep( GetBackoffDelay(attemptsInPass) );
+			}
+		}
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+/*!	Several threads are created, at most the number which was set with the method SetTransferParameters(), and this
+ * method waits for all of them to finish. If any file could not be uploaded, an exception is thrown once all the
+ * threads finished, but the file remains in the queue to be retried.
+ */
+void DataUploader::UploadPending()
+{
+	if( !IsEnabled() )
+		throw rfims_exception("the files were asked to be uploaded but there is no upload server.");
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	pthread_mutex_lock(&mutex);
+	stats.Clear();
+	errorMessages.clear();
+	std::size_t numOfReadyFiles=0;
+	const std::time_t now = std::time(nullptr);
+	for(const auto & entry : queue.GetEntries())
+		if(entry.nextAttemptTime <= now)
+			numOfReadyFiles++;
+	pthread_mutex_unlock(&mutex);
+
+	std::vector<pthread_t> threads;
+	for(std::size_t i=0; i < std::min<std::size_t>(numOfThreads, numOfReadyFiles); i++)
+	{
+		pthread_t thread;
+		if( pthread_create(&thread, NULL, UploaderThreadFunc, (void*)this)==0 )
+			threads.push_back(thread);
+	}
+
+	//If no thread could be created, the files are uploaded by this thread
+	if( threads.empty() && numOfReadyFiles>0 )
+		ProcessQueue();
+
+	for(auto & thread : threads)
+		pthread_join(thread, NULL);
+
+	stats.elapsedTime = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count();
+
+	if( !errorMessages.empty() )
+	{
+		rfims_exception exc( std::to_string( errorMessages.size() ) + " file(s) could not be uploaded and they will be retried later" );
+		exc.Append( errorMessages.front() );
+		throw(exc);
+	}
+}
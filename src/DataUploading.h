@@ -0,0 +1,196 @@
+/*!	\file DataUploading.h
+ * 	\brief This header file contains the declarations of the classes which are responsible for the uploading of the
+ * 	archives with the measurements to the remote server.
+ *
+ * 	The tasks which are performed by the classes defined here are the following:
+ * 	- Persistence of the queue of archives which remain to be uploaded, so they are not forgotten when the software is restarted.
+ * 	- Communication with an upload server through a TCP connection, with a simple line-based protocol.
+ * 	- Uploading of the archives in chunks, resuming the transfers from the offset the server already has, retrying
+ * 	the failed transfers with an exponential backoff and uploading several archives at the same time.
+ *
+ * 	The protocol is the following, where each command is a line of text ended by '\\n' and each command receives a
+ * 	line as reply, which starts with "OK" or "ERR" followed by a description:
+ * 	- `STAT name size`: the server replies `OK offset`, where _offset_ is the number of bytes of the file it already has.
+ * 	- `PUT name offset length crc32`: the command is followed by _length_ bytes, which the server writes at the given
+ * 	offset of the partial file if their CRC32 (hexadecimal) is correct, and then it replies `OK new_offset`.
+ * 	- `DONE name size`: the server checks the partial file has the given size and it makes the file visible, with its name.
+ * 	\author Mauro Diamantino
+ */
+
+#ifndef DATAUPLOADING_H_
+#define DATAUPLOADING_H_
+
+// Inclusion of the header file which has the declarations of the global functions, global classes, etc. and the inclusions of the global libraries.
+#include "Basics.h"
+
+#include <deque> //This library allows the use of the `std::deque` container
+#include <netdb.h> //This header declares the function getaddrinfo(), which resolves the name of the upload server
+#include <sys/socket.h> //This header declares the functions to manage the sockets
+#include <netinet/in.h> //This header declares the structures of the internet addresses
+#include <netinet/tcp.h> //This header declares the options of the TCP sockets
+
+
+//! A structure which stores the statistics of the uploading of files.
+struct UploadStatistics
+{
+	unsigned int numOfFiles; //!< The number of files which were uploaded completely.
+	unsigned int numOfFailures; //!< The number of transfers which failed and must be retried.
+	unsigned int numOfResumes; //!< The number of transfers which were resumed from an offset greater than zero.
+	std::uint64_t numOfBytes; //!< The number of bytes which were sent, not including the bytes the server already had.
+	double elapsedTime; //!< The elapsed time, in milliseconds.
+	//! The default constructor, which clears the statistics.
+	UploadStatistics() {	Clear();	}
+	//! This method clears all the statistics.
+	void Clear() {	numOfFiles=0; numOfFailures=0; numOfResumes=0; numOfBytes=0; elapsedTime=0.0;	}
+	//! This method returns the throughput, in bytes per second.
+	double GetThroughput() const {	return( elapsedTime>0.0 ? numOfBytes*1000.0/elapsedTime : 0.0 );	}
+};
+
+
+//! The aim of this class is to keep a queue of files which remain to be uploaded, saved in a file so it survives the restarts of the software.
+/*!	The queue file has one line per file, with the following fields separated by spaces: the filename, the number of
+ * bytes the server confirmed the last time, the number of consecutive failed attempts and the time (UNIX time) before
+ * which the uploading must not be retried. The file is replaced atomically each time the queue changes, so it is
+ * always valid even if the power is cut while it is written. This class is not thread safe.
+ */
+class UploadQueue
+{
+public:
+	//! A structure which stores the information of a file which remains to be uploaded.
+	struct Entry
+	{
+		std::string filename; //!< The name of the file, in the uploads folder.
+		std::uint64_t confirmedOffset; //!< The number of bytes the server confirmed the last time.
+		unsigned int numOfAttempts; //!< The number of consecutive failed attempts.
+		std::time_t nextAttemptTime; //!< The time before which the uploading must not be retried.
+		bool flagInProgress; //!< A flag which indicates if the file is being uploaded. It is not saved.
+		//! The default constructor.
+		Entry(const std::string & name="") : filename(name) {	confirmedOffset=0; numOfAttempts=0; nextAttemptTime=0; flagInProgress=false;	}
+	};
+private:
+	//Attributes//
+	std::string path; //!< The path of the queue file.
+	std::deque<Entry> entries; //!< The files which remain to be uploaded, in the order they were inserted.
+public:
+	//Class interface//
+	//! This method loads the queue from the given file, if it exists.
+	void Load(const std::string & queuePath);
+	//! This method saves the queue to its file, atomically.
+	void Save() const;
+	//! This method inserts a file at the end of the queue, if it is not already there.
+	bool Push(const std::string & filename);
+	//! This method removes a file from the queue.
+	void Remove(const std::string & filename);
+	//! This method returns a pointer to the entry of the given file, or `nullptr` if the file is not in the queue.
+	Entry * Find(const std::string & filename);
+	//! This method returns a pointer to the first entry which is ready to be uploaded, i.e. it is not in progress and its backoff has elapsed, or `nullptr`.
+	Entry * GetNextReady(const std::time_t now);
+	//! This method returns the entries of the queue.
+	const std::deque<Entry> & GetEntries() const {	return entries;	}
+	//! This method returns the number of files in the queue.
+	std::size_t Size() const {	return entries.size();	}
+	//! This method states if the queue is empty.
+	bool Empty() const {	return entries.empty();	}
+};
+
+
+//! The aim of this class is to manage a TCP connection which is used to send the lines and the data of the upload protocol.
+class UploadConnection
+{
+	//Attributes//
+	int fd; //!< The file descriptor of the socket, or -1 if there is no connection.
+	std::string inBuffer; //!< The data which were received but not read yet.
+public:
+	//Class interface//
+	//! The default constructor, which does not create any connection.
+	UploadConnection() {	fd=-1;	}
+	//! A constructor which takes a socket which is already connected, for example one which was accepted by a server.
+	explicit UploadConnection(const int socketFd, const unsigned int timeout=60);
+	//! The destructor closes the connection.
+	~UploadConnection() {	Close();	}
+	//! This method connects to the given host and port, with the given timeout in seconds for all the operations.
+	void Connect(const std::string & host, const std::uint16_t port, const unsigned int timeout=60);
+	//! This method sends the given bytes.
+	void Send(const void * data, const std::size_t numOfBytes);
+	//! This method sends a line, adding the character '\\n'.
+	void SendLine(const std::string & line) {	std::string str(line); str.push_back('\n'); Send( str.data(), str.size() );	}
+	//! This method receives the given number of bytes.
+	void Receive(void * data, const std::size_t numOfBytes);
+	//! This method receives a line, without the character '\\n'.
+	std::string ReceiveLine();
+	//! This method closes the connection.
+	void Close();
+	//! This method states if there is a connection.
+	bool IsConnected() const {	return( fd>=0 );	}
+};
+
+
+//! The aim of this class is to upload the files which are in the uploads folder to an upload server, keeping a persistent queue of the pending files.
+/*!	Each file is sent in chunks, and the server confirms each one, so when a transfer is interrupted it is resumed
+ * from the last confirmed offset, which the server reports with the command STAT. When the uploading of a file fails,
+ * the file is retried with an exponential backoff: the first retries are done in the same call to UploadPending(), and
+ * if the file still fails, it is kept in the queue and it is not retried until its backoff time elapses, in another
+ * call. The files are uploaded by several threads at the same time, each one with its own connection, and a failure
+ * of a file does not stop the uploading of the others. Once a file has been uploaded, it is removed from the queue
+ * and, by default, from the uploads folder.
+ */
+class DataUploader
+{
+	//Attributes//
+	//Constants
+	const std::string QUEUE_FILENAME = "upload_queue.txt"; //!< The name of the queue file, in the uploads folder.
+	//Variables
+	std::string uploadsPath; //!< The path of the folder where the files to be uploaded are.
+	UploadQueue queue; //!< The persistent queue of files which remain to be uploaded.
+	std::string host; //!< The name or the IP address of the upload server.
+	std::uint16_t port; //!< The TCP port of the upload server.
+	std::size_t chunkSize; //!< The size of the chunks, in bytes.
+	unsigned int numOfThreads; //!< The maximum number of files which are uploaded at the same time.
+	unsigned int timeout; //!< The timeout of the network operations, in seconds.
+	unsigned int attemptsPerPass; //!< The maximum number of attempts to upload a file in each call to UploadPending().
+	unsigned int initialDelay; //!< The delay before the first retry, in seconds, which is doubled after each failure.
+	unsigned int maxDelay; //!< The maximum delay between two retries, in seconds.
+	bool flagRemoveUploaded; //!< A flag which indicates if the files are removed from the uploads folder once they were uploaded.
+	UploadStatistics stats; //!< The statistics of the last call to UploadPending().
+	std::vector<std::string> errorMessages; //!< The messages of the failures of the last call to UploadPending().
+	pthread_mutex_t mutex; //!< The mutex which protects the queue, the statistics and the error messages from the concurrent access of the upload threads.
+	//Private methods//
+	//! This method uploads a file through a new connection, resuming the transfer from the offset the server already has.
+	void UploadFile(const std::string & filename);
+	//! This method takes files from the queue and uploads them until there is no file ready. It is run by each upload thread.
+	void ProcessQueue();
+	//! This method returns the delay, in seconds, before the next retry of a file which failed the given number of times.
+	unsigned int GetBackoffDelay(const unsigned int numOfAttempts) const;
+public:
+	//Class interface//
+	//! The default constructor.
+	DataUploader();
+	//! The destructor.
+	~DataUploader();
+	//! This method sets the folder where the files to be uploaded are and loads the queue of pending files, adding the archives which are in the folder but not in the queue.
+	void Open(const std::string & folderPath);
+	//! This method sets the upload server. If the host is empty the native uploading is disabled.
+	void SetServer(const std::string & serverHost, const std::uint16_t serverPort) {	host=serverHost; port=serverPort;	}
+	//! This method sets the parameters of the transfers: the size of the chunks, the number of simultaneous transfers and the timeout of the network operations.
+	void SetTransferParameters(const std::size_t chunkBytes, const unsigned int threads, const unsigned int timeoutSecs=60);
+	//! This method sets the parameters of the retries: the attempts per call to UploadPending(), the delay before the first retry and the maximum delay, in seconds.
+	void SetRetryParameters(const unsigned int attempts, const unsigned int initialDelaySecs, const unsigned int maxDelaySecs);
+	//! This method defines if the files are removed once they were uploaded. By default they are removed.
+	void SetRemoveUploaded(const bool flagRemove) {	flagRemoveUploaded=flagRemove;	}
+	//! This method states if the native uploading is enabled, i.e. an upload server was set.
+	bool IsEnabled() const {	return !host.empty();	}
+	//! This method inserts a file of the uploads folder in the persistent queue.
+	void Enqueue(const std::string & filename);
+	//! This method removes a file from the persistent queue, for example when it was uploaded by other means.
+	void Dequeue(const std::string & filename);
+	//! This method returns the names of the files which remain to be uploaded.
+	std::vector<std::string> GetPendingFiles();
+	//! This method uploads the pending files whose backoff has elapsed and returns when all of them were uploaded or they failed.
+	void UploadPending();
+	//! This method returns the statistics of the last call to UploadPending().
+	const UploadStatistics & GetStatistics() const {	return stats;	}
+
+	friend void *UploaderThreadFunc(void *);
+};
+
+#endif /* DATAUPLOADING_H_ */
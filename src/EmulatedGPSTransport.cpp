@@ -0,0 +1,438 @@
+/*! \file EmulatedGPSTransport.cpp
+ * 	\brief This file contains the definitions of several methods of the class _EmulatedGPSTransport_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "AntennaPositioning.h"
+
+const std::int64_t EmulatedGPSTransport::READ_TIMEOUT;
+
+/*!	\param [in] dataRt The number of sets of sensor replies per second which are sent with the streaming enabled. If it
+ * is zero, the value of the variable DATARATE which is set by the class _GPSInterface_ is used, as the logger does.
+ * \param [in] jitter The maximum random delay of each group of replies, in seconds.
+ * \param [in] recordingPath The path of a recorded output of the logger which must be replayed. If it is empty, the
+ * replies are synthetic and their UTC time is the system time.
+ */
+EmulatedGPSTransport::EmulatedGPSTransport(const unsigned int dataRt, const double jitter, const std::string & recordingPath) :
+		randomGenerator(2019)
+{
+	if( !recordingPath.empty() )
+		LoadRecording(recordingPath);
+
+	dataRate=dataRt;
+	variableDataRate=4;
+	maxJitter = std::max( std::llround(jitter * 1e9), 0LL );
+	nextRecordedEpoch=0;
+
+	timespec realTime;
+	clock_gettime(CLOCK_REALTIME, &realTime);
+	const std::int64_t time = GPSClock::MonotonicTime();
+	utcOffset = std::int64_t(realTime.tv_sec) * 1000000000 + realTime.tv_nsec - time;
+
+	flagStreaming=false;
+	nextEpochTime=0;
+	epochStartTime=time;
+	epochUTCTime=time + utcOffset;
+	lineFreeTime=0;
+	rxPos=0;
+	std::fill(gprmcTimes, gprmcTimes + NUM_OF_GPRMC_TIMES, 0);
+	numOfGPRMCReplies=0;
+	numOfReplies=0;
+
+	pthread_mutex_init(&mutex, NULL);
+}
+
+/*!	Each epoch starts with a GPRMC reply whose time and date can be interpreted; the replies which precede the first
+ * one are discarded.
+ * \param [in] recordingPath The path of the recorded output of the logger.
+ */
+void EmulatedGPSTransport::LoadRecording(const std::string & recordingPath)
+{
+	std::ifstream ifs(recordingPath, std::ios::binary);
+	if( !ifs.is_open() )
+		throw rfims_exception("the recording " + recordingPath + " could not be opened.");
+
+	std::string reply;
+	while( std::getline(ifs, reply) )
+	{
+		if( !reply.empty() && reply.back()=='\r' )
+			reply.pop_back();
+		if( reply.empty() )
+			continue;
+		reply += "\r\n";
+
+		GPSSentence fields;
+		if( SentenceParser::Parse(reply.data(), reply.size(), fields) && fields.type==GPSSentence::GPRMC )
+		{
+			RecordedEpoch epoch;
+			epoch.utcTime = GPSClock::ToUTCTime(fields.year, fields.month, fields.day, fields.hour, fields.minute, fields.second,
+					fields.nanosecond);
+			recording.push_back(epoch);
+		}
+
+		if( !recording.empty() )
+			recording.back().replies.push_back(reply);
+	}
+
+	if( recording.empty() )
+		throw rfims_exception("the recording " + recordingPath + " does not have any valid GPRMC reply.");
+}
+
+/*!	\param [in] body The characters between the symbol '$' and the asterisk.
+ * 	\return The whole reply, with the checksum and the final characters "\r\n".
+ */
+std::string EmulatedGPSTransport::FormatReply(const std::string & body)
+{
+	unsigned int checksum=0;
+	for(const char c : body)
+		checksum ^= (unsigned char) c;
+
+	char tail[8];
+	std::snprintf(tail, sizeof(tail), "*%02X\r\n", checksum);
+	return( '$' + body + tail );
+}
+
+/*!	The position and the attitude of the emulated logger are fixed and the sensor data have a small random noise.
+ * 	\param [in] type The type of the reply. The type `GPSSentence::UNKNOWN` gives a GPVTG reply, which is not interpreted.
+ * 	\param [in] utcTime The UTC time of the reply, in nanoseconds since 01-01-1970T00:00:00.
+ */
+std::string EmulatedGPSTransport::BuildSyntheticReply(const GPSSentence::SentenceType type, const std::int64_t utcTime)
+{
+	const time_t seconds = utcTime / 1000000000;
+	struct tm dateTime;
+	gmtime_r(&seconds, &dateTime);
+
+	char time[16];
+	std::snprintf(time, sizeof(time), "%02d%02d%02d.%03u", dateTime.tm_hour, dateTime.tm_min, dateTime.tm_sec,
+			unsigned( (utcTime % 1000000000) / 1000000 ));
+
+	std::uniform_int_distribution<int> noiseDistrib(-8, 8);
+	const int noise[3] = { noiseDistrib(randomGenerator), noiseDistrib(randomGenerator), noiseDistrib(randomGenerator) };
+
+	char body[128];
+	switch(type)
+	{
+		case GPSSentence::GPRMC:
+			std::snprintf(body, sizeof(body), "GPRMC,%s,A,3150.7412,S,06413.2046,W,0.02,87.35,%02d%02d%02d,,,A", time,
+					dateTime.tm_mday, dateTime.tm_mon + 1, dateTime.tm_year % 100);
+			break;
+		case GPSSentence::GPGGA:
+			std::snprintf(body, sizeof(body), "GPGGA,%s,3150.7412,S,06413.2046,W,1,09,0.9,431.5,M,21.3,M,,", time);
+			break;
+		case GPSSentence::PAAG_GYRO:
+			std::snprintf(body, sizeof(body), "PAAG,DATA,G,%s,%d,%d,%d,A", time, -12 + noise[0], 34 + noise[1], 5 + noise[2]);
+			break;
+		case GPSSentence::PAAG_COMPASS:
+			std::snprintf(body, sizeof(body), "PAAG,DATA,C,%s,%d,%d,%d,A", time, -210 + noise[0], 118 + noise[1], -402 + noise[2]);
+			break;
+		case GPSSentence::PAAG_ACCELER:
+			std::snprintf(body, sizeof(body), "PAAG,DATA,T,%s,%d,%d,%d,A", time, 63 + noise[0], -41 + noise[1], 8190 + noise[2]);
+			break;
+		case GPSSentence::PAAG_BAROM:
+			std::snprintf(body, sizeof(body), "PAAG,DATA,B,%s,%.2f,A", time, 965.12 + noise[0]/100.0);
+			break;
+		default:
+			std::snprintf(body, sizeof(body), "GPVTG,87.35,T,,M,0.02,N,0.04,K,A");
+	}
+
+	return FormatReply(body);
+}
+
+/*!	The set has a reply of each interpreted type and a GPVTG reply. When a recording is replayed, the replies are taken
+ * from its next epoch and the types which it does not have are synthetic.
+ * \param [in] time The instant of the monotonic clock when the command was received, in nanoseconds.
+ * \param [out] replies The vector where the replies are appended.
+ */
+void EmulatedGPSTransport::BuildDataSet(const std::int64_t time, std::vector<std::string> & replies)
+{
+	const GPSSentence::SentenceType types[] = { GPSSentence::GPRMC, GPSSentence::GPGGA, GPSSentence::PAAG_GYRO,
+			GPSSentence::PAAG_COMPASS, GPSSentence::PAAG_ACCELER, GPSSentence::PAAG_BAROM, GPSSentence::UNKNOWN };
+
+	const RecordedEpoch * epoch = nullptr;
+	if( !recording.empty() )
+	{
+		epoch = &recording[nextRecordedEpoch];
+		nextRecordedEpoch = (nextRecordedEpoch + 1) % recording.size();
+	}
+
+	for(const auto type : types)
+	{
+		bool flagFound=false;
+		if(epoch!=nullptr && type!=GPSSentence::UNKNOWN)
+			for(const auto & reply : epoch->replies)
+			{
+				GPSSentence fields;
+				SentenceParser::Parse(reply.data(), reply.size(), fields);
+				if(fields.type==type)
+				{
+					replies.push_back(reply);
+					flagFound=true;
+					break;
+				}
+			}
+
+		if(!flagFound)
+			replies.push_back( BuildSyntheticReply( type, epoch!=nullptr ? epoch->utcTime : time + utcOffset ) );
+	}
+}
+
+/*!	The group is sent after a random delay, up to the maximum jitter, but the replies are never overlapped: each one
+ * is transmitted when the serial line is free and it is received after its transmission time.
+ * \param [in] replies The replies of the group, which are sent in order.
+ * \param [in] time The instant of the monotonic clock when the group must be sent, without the delay, in nanoseconds.
+ */
+void EmulatedGPSTransport::ScheduleReplies(const std::vector<std::string> & replies, const std::int64_t time)
+{
+	std::int64_t sendTime = time;
+	if(maxJitter > 0)
+		sendTime += std::uniform_int_distribution<std::int64_t>(0, maxJitter)(randomGenerator);
+
+	for(const auto & reply : replies)
+	{
+		const std::int64_t transmissionTime = std::int64_t( reply.size() ) * 11 * 1000000000 / std::int64_t(BAUD_RATE);
+		lineFreeTime = std::max(lineFreeTime, sendTime) + transmissionTime;
+
+		pendingReplies.push_back( PendingReply{ lineFreeTime, reply } );
+		if( reply.compare(0, 6, "$GPRMC")==0 )
+			gprmcTimes[ numOfGPRMCReplies++ % NUM_OF_GPRMC_TIMES ] = lineFreeTime;
+	}
+}
+
+/*!	The synthetic epochs send the GPRMC and GPGGA replies at the start and the sets of sensor replies at the data rate.
+ * The recorded epochs are replayed in order, repeating the recording when it ends, and their replies are spread over
+ * the second.
+ * \param [in] time The instant of the monotonic clock when the epoch starts, in nanoseconds.
+ */
+void EmulatedGPSTransport::ScheduleEpoch(const std::int64_t time)
+{
+	epochStartTime=time;
+	std::vector<std::string> replies;
+
+	if( recording.empty() )
+	{
+		epochUTCTime = time + utcOffset;
+		replies.push_back( BuildSyntheticReply(GPSSentence::GPRMC, epochUTCTime) );
+		replies.push_back( BuildSyntheticReply(GPSSentence::GPGGA, epochUTCTime) );
+		ScheduleReplies(replies, time);
+
+		const unsigned int rate = GetDataRate();
+		for(unsigned int n=0; n<rate; n++)
+		{
+			const std::int64_t sampleOffset = std::int64_t(n) * 1000000000 / rate;
+			replies.clear();
+			replies.push_back( BuildSyntheticReply(GPSSentence::PAAG_GYRO, epochUTCTime + sampleOffset) );
+			replies.push_back( BuildSyntheticReply(GPSSentence::PAAG_COMPASS, epochUTCTime + sampleOffset) );
+			replies.push_back( BuildSyntheticReply(GPSSentence::PAAG_ACCELER, epochUTCTime + sampleOffset) );
+			if(n==0)
+				replies.push_back( BuildSyntheticReply(GPSSentence::PAAG_BAROM, epochUTCTime + sampleOffset) );
+			ScheduleReplies(replies, time + sampleOffset);
+		}
+	}
+	else
+	{
+		const RecordedEpoch & epoch = recording[nextRecordedEpoch];
+		nextRecordedEpoch = (nextRecordedEpoch + 1) % recording.size();
+		epochUTCTime = epoch.utcTime;
+
+		const std::size_t numOfEpochReplies = epoch.replies.size();
+		for(std::size_t i=0; i<numOfEpochReplies; i++)
+		{
+			replies.assign(1, epoch.replies[i]);
+			ScheduleReplies( replies, time + std::int64_t(i) * 1000000000 / std::int64_t(numOfEpochReplies) );
+		}
+	}
+}
+
+/*!	\param [in] time The current instant of the monotonic clock, in nanoseconds. */
+void EmulatedGPSTransport::Update(const std::int64_t time)
+{
+	while(flagStreaming && nextEpochTime <= time)
+	{
+		ScheduleEpoch(nextEpochTime);
+		nextEpochTime += 1000000000;
+	}
+
+	//The bytes which were read are discarded before the buffer grows too much
+	if( rxPos > 4096 && rxPos > rxBytes.size()/2 )
+	{
+		rxBytes.erase(0, rxPos);
+		rxPos=0;
+	}
+
+	while( !pendingReplies.empty() && pendingReplies.front().receptionTime <= time )
+	{
+		rxBytes += pendingReplies.front().text;
+		pendingReplies.pop_front();
+		numOfReplies++;
+	}
+}
+
+/*!	The commands which are not known, as `PAAG,FILE,STOP,`, are ignored without reply.
+ * 	\param [in] command The command, without the final characters "\r\n".
+ * 	\param [in] time The instant of the monotonic clock when the command was received, in nanoseconds.
+ */
+void EmulatedGPSTransport::ProcessCommand(const std::string & command, const std::int64_t time)
+{
+	std::vector<std::string> replies;
+
+	if(command=="$PAAG,ID")
+		replies.push_back( FormatReply("PAAG,ID,EMULATOR,1.0,1.0") );
+	else if( command.compare(0, 10, "$PAAG,VAR,")==0 )
+	{
+		//The reply states the current value of the variable, which is the given one
+		const std::size_t valuePos = command.find(',', 10);
+		if(valuePos!=std::string::npos)
+		{
+			const std::string variable = command.substr(10, valuePos - 10);
+			const std::string value = command.substr(valuePos + 1);
+			if(variable=="DATARATE")
+				variableDataRate = std::strtoul(value.c_str(), NULL, 10);
+			replies.push_back( FormatReply("PAAG,VAR," + variable + ',' + value) );
+		}
+	}
+	else if(command=="$PAAG,MODE,READONE")
+		BuildDataSet(time, replies);
+	else if(command=="$PAAG,MODE,START")
+	{
+		if(!flagStreaming)
+		{
+			//The first epoch starts at the next UTC second
+			flagStreaming=true;
+			nextEpochTime = time + 1000000000 - (time + utcOffset) % 1000000000;
+		}
+	}
+	else if(command=="$PAAG,MODE,STOP")
+	{
+		//The replies which were not received yet are not sent
+		flagStreaming=false;
+		while( !pendingReplies.empty() && pendingReplies.back().receptionTime > time )
+			pendingReplies.pop_back();
+		lineFreeTime = std::min(lineFreeTime, time);
+	}
+
+	if( !replies.empty() )
+		ScheduleReplies(replies, time);
+}
+
+/*!	The replies of the commands are scheduled as soon as each command is complete, i.e. when its character '\n' is
+ * received.
+ * \param [in] data The bytes which must be sent.
+ * \param [in] numOfBytes The number of bytes which must be sent.
+ * \return The number of written bytes, which are always all of them.
+ */
+std::size_t EmulatedGPSTransport::Write(const char * data, const std::size_t numOfBytes)
+{
+	pthread_mutex_lock(&mutex);
+
+	const std::int64_t time = GPSClock::MonotonicTime();
+	Update(time);
+	commandBuffer.append(data, numOfBytes);
+
+	std::size_t endPos;
+	while( (endPos = commandBuffer.find('\n')) != std::string::npos )
+	{
+		std::string command = commandBuffer.substr(0, endPos);
+		commandBuffer.erase(0, endPos + 1);
+		if( !command.empty() && command.back()=='\r' )
+			command.pop_back();
+		ProcessCommand(command, time);
+	}
+
+	pthread_mutex_unlock(&mutex);
+	return numOfBytes;
+}
+
+/*!	Unlike the function FT_Read(), this method returns as soon as there is at least one byte, because the class
+ * _GPSInterface_ never requests more bytes than the available ones. While it waits, the mutex is unlocked and the thread
+ * sleeps until the next reply is received or the next epoch starts.
+ * \param [out] buffer The buffer where the received bytes are written.
+ * \param [in] numOfBytes The maximum number of bytes which must be received.
+ * \return The number of received bytes, which is zero if the read timeout expired before any byte was received.
+ */
+std::size_t EmulatedGPSTransport::Read(char * buffer, const std::size_t numOfBytes)
+{
+	const std::int64_t deadline = GPSClock::MonotonicTime() + READ_TIMEOUT;
+	while(1)
+	{
+		pthread_mutex_lock(&mutex);
+
+		const std::int64_t time = GPSClock::MonotonicTime();
+		Update(time);
+		const std::size_t numOfRxBytes = std::min( numOfBytes, rxBytes.size() - rxPos );
+		if(numOfRxBytes > 0 || time >= deadline)
+		{
+			std::memcpy(buffer, rxBytes.data() + rxPos, numOfRxBytes);
+			rxPos += numOfRxBytes;
+			pthread_mutex_unlock(&mutex);
+			return numOfRxBytes;
+		}
+
+		std::int64_t wakeTime = deadline;
+		if( !pendingReplies.empty() )
+			wakeTime = std::min( wakeTime, pendingReplies.front().receptionTime );
+		if(flagStreaming)
+			wakeTime = std::min(wakeTime, nextEpochTime);
+
+		pthread_mutex_unlock(&mutex);
+
+		const timespec wakeTimespec = { time_t(wakeTime / 1000000000), long(wakeTime % 1000000000) };
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTimespec, NULL);
+	}
+}
+
+std::size_t EmulatedGPSTransport::Available()
+{
+	pthread_mutex_lock(&mutex);
+	Update( GPSClock::MonotonicTime() );
+	const std::size_t numOfRxBytes = rxBytes.size() - rxPos;
+	pthread_mutex_unlock(&mutex);
+	return numOfRxBytes;
+}
+
+/*!	As with the FTDI chip, the replies which are being transmitted are not discarded: they are received later. */
+void EmulatedGPSTransport::Purge()
+{
+	pthread_mutex_lock(&mutex);
+	Update( GPSClock::MonotonicTime() );
+	rxBytes.clear();
+	rxPos=0;
+	commandBuffer.clear();
+	pthread_mutex_unlock(&mutex);
+}
+
+/*!	The UTC time of each epoch is the one of the instant when it started, without the jitter, so the returned time is
+ * the one which a perfect timestamp of the given instant would have.
+ * \param [in] monotonicTime An instant of the monotonic clock, after the start of the last epoch, in nanoseconds.
+ * \return The UTC time of the given instant, in nanoseconds since 01-01-1970T00:00:00.
+ */
+std::int64_t EmulatedGPSTransport::GetUTCTime(const std::int64_t monotonicTime) const
+{
+	pthread_mutex_lock(&mutex);
+	const std::int64_t utcTime = epochUTCTime + (monotonicTime - epochStartTime);
+	pthread_mutex_unlock(&mutex);
+	return utcTime;
+}
+
+/*!	\param [in] monotonicTime An instant of the monotonic clock, in nanoseconds.
+ * 	\return The instant when the last byte of the last GPRMC reply was received before the given instant, in nanoseconds,
+ * 	or zero if none was received.
+ */
+std::int64_t EmulatedGPSTransport::GetLastGPRMCTime(const std::int64_t monotonicTime) const
+{
+	pthread_mutex_lock(&mutex);
+	std::int64_t lastTime=0;
+	const unsigned int numOfTimes = unsigned( std::min<std::uint64_t>(numOfGPRMCReplies, NUM_OF_GPRMC_TIMES) );
+	for(unsigned int i=0; i<numOfTimes; i++)
+		if(gprmcTimes[i] <= monotonicTime && gprmcTimes[i] > lastTime)
+			lastTime = gprmcTimes[i];
+	pthread_mutex_unlock(&mutex);
+	return lastTime;
+}
+
+std::uint64_t EmulatedGPSTransport::GetNumOfReplies() const
+{
+	pthread_mutex_lock(&mutex);
+	const std::uint64_t replies = numOfReplies;
+	pthread_mutex_unlock(&mutex);
+	return replies;
+}
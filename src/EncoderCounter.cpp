@@ -0,0 +1,88 @@
+/*! \file EncoderCounter.cpp
+ * 	\brief This file contains the definitions of several methods of the class _EncoderCounter_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "AntennaPositioning.h"
+
+const std::int64_t EncoderCounter::COUNTS_PER_DEGREE;
+
+/*!	The atomic operations of 64 bits are lock-free in the ARMv7 and ARMv8 processors of the Raspberry Pi, but not in the
+ * older ones, where the interrupt service routines could wait for each other. */
+EncoderCounter::EncoderCounter()
+{
+	Reset();
+	if( !count.is_lock_free() )
+		cerr << "\nWarning: the atomic integers of 64 bits are not lock-free in this processor, so the encoder count is protected by a lock." << endl;
+}
+
+/*!	This method is called by the interrupt service routines, concurrently. The count is modified with just one atomic
+ * addition and the statistics with atomic exchanges, so no edge is lost and the routines never wait for each other.
+ * \param [in] channel The channel of the edge.
+ * \param [in] direction The direction of the edge: 1 or -1.
+ */
+void EncoderCounter::AddEdge(const Channel channel, const int direction)
+{
+	const std::int64_t time = GPSClock::MonotonicTime();
+	count.fetch_add(direction, std::memory_order_release);
+	numOfEdges[channel].fetch_add(1, std::memory_order_relaxed);
+
+	//When the direction changes, the channel of the last edge gives the next one, so only the edges in the same direction are compared
+	const int edge = 2*channel + ( direction > 0 ? 1 : 0 );
+	if( lastEdge.exchange(edge, std::memory_order_relaxed)==edge )
+		numOfRepeatedEdges.fetch_add(1, std::memory_order_relaxed);
+
+	const std::int64_t previousTime = lastEdgeTime.exchange(time, std::memory_order_relaxed);
+	if(previousTime!=0)
+	{
+		const std::int64_t interval = std::max( time - previousTime, std::int64_t(0) );
+		std::int64_t minInterval = minEdgeInterval.load(std::memory_order_relaxed);
+		while( ( minInterval < 0 || interval < minInterval ) &&
+				!minEdgeInterval.compare_exchange_weak(minInterval, interval, std::memory_order_relaxed) );
+	}
+}
+
+/*!	Each value is read atomically, but the values are not read at the same time, so they may differ by the edges which
+ * were counted meanwhile. */
+EncoderStatistics EncoderCounter::GetStatistics() const
+{
+	EncoderStatistics statistics;
+	statistics.numOfEdges[CHANNEL_A] = numOfEdges[CHANNEL_A].load(std::memory_order_relaxed);
+	statistics.numOfEdges[CHANNEL_B] = numOfEdges[CHANNEL_B].load(std::memory_order_relaxed);
+	statistics.numOfRepeatedEdges = numOfRepeatedEdges.load(std::memory_order_relaxed);
+	statistics.minEdgeInterval = minEdgeInterval.load(std::memory_order_relaxed);
+	statistics.lastEdgeTime = lastEdgeTime.load(std::memory_order_relaxed);
+	return statistics;
+}
+
+void EncoderCounter::Reset()
+{
+	count=0;
+	numOfEdges[CHANNEL_A]=0;
+	numOfEdges[CHANNEL_B]=0;
+	numOfRepeatedEdges=0;
+	lastEdge=-1;
+	lastEdgeTime=0;
+	minEdgeInterval=-1;
+}
+
+/*!	The subtraction is performed with unsigned integers, whose overflow is defined (modulo 2^64), so the difference is
+ * correct as long as it fits in a signed integer of 64 bits.
+ * \param [in] count The final count.
+ * \param [in] startCount The initial count.
+ * \return The number of counts between both.
+ */
+std::int64_t EncoderCounter::CountDifference(const std::int64_t count, const std::int64_t startCount)
+{
+	return std::int64_t( std::uint64_t(count) - std::uint64_t(startCount) );
+}
+
+/*!	The whole degrees and the remaining counts are converted separately, so the result does not lose the fraction of a
+ * degree when the number of counts is larger than the precision of a `double` (2^53).
+ * \param [in] counts A number of counts.
+ * \return The equivalent angle, in degrees.
+ */
+double EncoderCounter::ToDegrees(const std::int64_t counts)
+{
+	return( double(counts / COUNTS_PER_DEGREE) + double(counts % COUNTS_PER_DEGREE) / COUNTS_PER_DEGREE );
+}
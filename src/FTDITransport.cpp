@@ -0,0 +1,135 @@
+/*! \file FTDITransport.cpp
+ * 	\brief This file contains the definitions of several methods of the class _FTDITransport_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "AntennaPositioning.h"
+
+/*! The constructor has to include the custom VID and PID combination of Aaronia GPS receiver within the allowed
+ * values, then it has to open the communication with the GPS receiver and set up the UART port on the
+ * FTDI chip.
+ */
+FTDITransport::FTDITransport()
+{
+	ftHandle=0;
+	ftStatus=0;
+
+	ftStatus=FT_SetVIDPID(VID, PID);
+	if(ftStatus!=FT_OK)
+	{
+		rfims_exception exc("the custom VID and PID combinations of the Aaronia GPS receiver could not be included.");
+		throw(exc);
+	}
+
+	ftStatus=FT_OpenEx((PVOID)DEVICE_DESCRIPTION.c_str(), FT_OPEN_BY_DESCRIPTION, &ftHandle);
+	if (ftStatus!=FT_OK)
+	{
+		rfims_exception exc;
+		switch(ftStatus)
+		{
+		case 2:
+			exc.SetMessage("the Aaronia GPS receiver was not found.");
+			throw(exc);
+		case 3:
+			exc.SetMessage("the Aaronia GPS receiver could not be opened.");
+			throw(exc);
+		default:
+			std::ostringstream oss;
+			oss << "the function FT_OpenEx() returned a FT_STATUS value of " << ftStatus << '.';
+			exc.SetMessage( oss.str() );
+			throw(exc);
+		}
+	}
+
+	try
+	{
+		ftStatus=FT_SetTimeouts(ftHandle, RD_TIMEOUT_MS, WR_TIMEOUT_MS);
+		if(ftStatus!=FT_OK)
+			throw rfims_exception("the read and write timeouts could not be set up.");
+
+		ftStatus=FT_SetBaudRate(ftHandle, BAUD_RATE);
+		if(ftStatus!=FT_OK)
+		{
+			if(ftStatus==7)
+				throw rfims_exception("the given value of baud rate is not valid.");
+			else
+				throw rfims_exception("the baud rate could not be set up");
+		}
+
+		ftStatus = FT_SetDataCharacteristics(ftHandle, FT_BITS_8, FT_STOP_BITS_2, FT_PARITY_NONE);
+		if(ftStatus!=FT_OK)
+			throw rfims_exception("the data characteristics could not be set up.");
+
+		ftStatus = FT_SetFlowControl(ftHandle, FT_FLOW_NONE, 0, 0);
+		if(ftStatus!=FT_OK)
+			throw rfims_exception("the flow control could not be set up.");
+
+		//The FTDI chip sends the received bytes when its buffer is full or when the latency timer expires
+		ftStatus = FT_SetLatencyTimer(ftHandle, LATENCY_TIMER_MS);
+		if(ftStatus!=FT_OK)
+			throw rfims_exception("the latency timer could not be set up.");
+	}
+	catch(rfims_exception & exc)
+	{
+		//The destructor is not called when the constructor fails, so the device is closed here
+		FT_Close(ftHandle);
+		throw;
+	}
+}
+
+FTDITransport::~FTDITransport()
+{
+	ftStatus=FT_Close(ftHandle);
+	if(ftStatus!=FT_OK)
+	{
+		cerr << "Error: the communication with the Aaronia GPS receiver could not be closed." << endl;
+	}
+}
+
+/*!	\param [in] data The bytes which must be sent.
+ * 	\param [in] numOfBytes The number of bytes which must be sent.
+ * 	\return The number of bytes which were written before the write timeout expired.
+ */
+std::size_t FTDITransport::Write(const char * data, const std::size_t numOfBytes)
+{
+	DWORD writtenBytes=0;
+	ftStatus=FT_Write(ftHandle, (LPVOID) data, numOfBytes, &writtenBytes);
+	if(ftStatus!=FT_OK)
+		throw rfims_exception("the function FT_Write() returned an error value.");
+
+	return writtenBytes;
+}
+
+/*!	The function FT_Read() returns when the requested bytes are received or when the read timeout expires.
+ * 	\param [out] buffer The buffer where the received bytes are written.
+ * 	\param [in] numOfBytes The maximum number of bytes which must be received.
+ * 	\return The number of received bytes, which is zero if the read timeout expired before any byte was received.
+ */
+std::size_t FTDITransport::Read(char * buffer, const std::size_t numOfBytes)
+{
+	DWORD receivedBytes=0;
+	ftStatus=FT_Read(ftHandle, buffer, numOfBytes, &receivedBytes);
+	if(ftStatus!=FT_OK)
+		throw rfims_exception("the function FT_Read() returned an error value.");
+
+	return receivedBytes;
+}
+
+/*! It uses the function FT_GetStatus() of the D2XX library. */
+std::size_t FTDITransport::Available()
+{
+	DWORD numOfInputBytes, numOfOutputBytes, numOfEvents;
+	//ftStatus=FT_GetQueueStatus(ftHandle, &numOfInputBytes);
+	ftStatus=FT_GetStatus(ftHandle, &numOfInputBytes, &numOfOutputBytes, &numOfEvents);
+	if(ftStatus!=FT_OK)
+		throw rfims_exception("the function FT_GetStatus() returned an error value.");
+
+	return numOfInputBytes;
+}
+
+void FTDITransport::Purge()
+{
+	ftStatus=FT_Purge(ftHandle, FT_PURGE_RX | FT_PURGE_TX);
+	if (ftStatus!=FT_OK)
+		throw rfims_exception("the function FT_Purge() returned an error value.");
+}
@@ -0,0 +1,235 @@
+/*! \file GPSClock.cpp
+ * 	\brief This file contains the definitions of several methods of the class _GPSClock_ and the structure _GPSTimestamp_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "AntennaPositioning.h"
+
+const std::int64_t GPSTimestamp::LOCAL_TIME_OFFSET;
+const unsigned int GPSClock::NUM_OF_SAMPLES;
+const unsigned int GPSClock::SAMPLES_PER_ANCHOR;
+const unsigned int GPSClock::NUM_OF_ANCHORS;
+const std::int64_t GPSClock::MAX_STEP;
+const std::int64_t GPSClock::HOLDOVER_TIME;
+const std::int64_t GPSClock::INITIAL_ERROR;
+
+/*!	The local time is got adding the offset LOCAL_TIME_OFFSET to the UTC time, so the date changes correctly at midnight. */
+TimeData GPSTimestamp::GetTimeData() const
+{
+	return GPSClock::ToTimeData(utcTime + LOCAL_TIME_OFFSET);
+}
+
+/*!	The times are taken relative to the reference instant, in seconds, so the sums do not lose precision. The
+ * uncertainty of the drift is the standard error of the slope of the regression.
+ * \param [in] syncSamples A pointer to the samples, whose order does not matter.
+ * \param [in] numOfSyncSamples The number of samples.
+ * \param [in] refMonotonicTime The reference instant of the monotonic clock, in nanoseconds.
+ * \param [out] drift The estimated drift, in seconds per second.
+ * \param [out] driftError The uncertainty of the drift, in seconds per second.
+ * \return `true` if there are at least four samples which span at least eight seconds, so the drift could be estimated.
+ */
+bool GPSClock::EstimateDrift(const SyncSample * syncSamples, const unsigned int numOfSyncSamples, const std::int64_t refMonotonicTime,
+		double & drift, double & driftError)
+{
+	if(numOfSyncSamples < 4)
+		return false;
+
+	const std::int64_t refOffset = syncSamples[0].utcTime - syncSamples[0].monotonicTime;
+	double sumT=0.0, sumO=0.0, sumTT=0.0, sumTO=0.0, minT=0.0, maxT=0.0;
+	for(unsigned int i=0; i<numOfSyncSamples; i++)
+	{
+		const double t = (syncSamples[i].monotonicTime - refMonotonicTime) * 1e-9;
+		const double o = ( (syncSamples[i].utcTime - syncSamples[i].monotonicTime) - refOffset ) * 1e-9;
+		sumT+=t; sumO+=o; sumTT+=t*t; sumTO+=t*o;
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+
+	const double n = numOfSyncSamples;
+	const double sxx = sumTT - sumT*sumT/n;
+	if( maxT - minT < 8.0 || sxx <= 0.0 )
+		return false;
+
+	drift = (sumTO - sumT*sumO/n) / sxx;
+	const double intercept = (sumO - drift*sumT) / n;
+
+	double sumResiduals=0.0;
+	for(unsigned int i=0; i<numOfSyncSamples; i++)
+	{
+		const double t = (syncSamples[i].monotonicTime - refMonotonicTime) * 1e-9;
+		const double o = ( (syncSamples[i].utcTime - syncSamples[i].monotonicTime) - refOffset ) * 1e-9;
+		const double residual = o - intercept - drift*t;
+		sumResiduals += residual*residual;
+	}
+	driftError = std::sqrt( sumResiduals / (n - 2.0) / sxx );
+	return true;
+}
+
+/*!	When the sample is farther than MAX_STEP from the time which is predicted by the current model, for example
+ * because the GPS time or the monotonic clock jumped, the previous samples and anchors are discarded. The least delayed
+ * sample of each block of SAMPLES_PER_ANCHOR samples becomes an anchor. Then, the drift is estimated with the anchors
+ * or, while there are fewer than four, with the last samples, and the offset at the instant of the new sample is
+ * estimated as the largest one of the corrected offsets. Finally, the new model is published. This method must be
+ * called by just one thread.
+ * \param [in] monotonicTime The instant of the monotonic clock when the GPRMC reply started to be received, in nanoseconds.
+ * \param [in] utcTime The UTC time of the GPRMC reply, in nanoseconds since 01-01-1970T00:00:00.
+ */
+void GPSClock::AddSample(const std::int64_t monotonicTime, const std::int64_t utcTime)
+{
+	if( numOfStoredSamples > 0 )
+	{
+		const std::int64_t predictedTime = monotonicTime + lastModel.refOffset +
+				std::llround( lastModel.drift * (monotonicTime - lastModel.refMonotonicTime) );
+		if( std::llabs(utcTime - predictedTime) > MAX_STEP )
+			numOfStoredSamples=nextSample=numOfStoredAnchors=nextAnchor=numOfBlockSamples=0;
+	}
+
+	const SyncSample newSample = { monotonicTime, utcTime };
+	samples[nextSample] = newSample;
+	nextSample = (nextSample + 1) % NUM_OF_SAMPLES;
+	if(numOfStoredSamples < NUM_OF_SAMPLES)
+		numOfStoredSamples++;
+
+	//The least delayed sample is the one with the largest offset
+	if( numOfBlockSamples==0 || utcTime - monotonicTime > blockBestSample.utcTime - blockBestSample.monotonicTime )
+		blockBestSample = newSample;
+	if( ++numOfBlockSamples == SAMPLES_PER_ANCHOR )
+	{
+		anchors[nextAnchor] = blockBestSample;
+		nextAnchor = (nextAnchor + 1) % NUM_OF_ANCHORS;
+		if(numOfStoredAnchors < NUM_OF_ANCHORS)
+			numOfStoredAnchors++;
+		numOfBlockSamples=0;
+	}
+
+	double drift=0.0, driftError=MAX_DRIFT;
+	if( EstimateDrift(anchors, numOfStoredAnchors, monotonicTime, drift, driftError) ||
+			EstimateDrift(samples, numOfStoredSamples, monotonicTime, drift, driftError) )
+	{
+		if( std::fabs(drift) > MAX_DRIFT )
+		{
+			drift = std::copysign(MAX_DRIFT, drift);
+			driftError = MAX_DRIFT;
+		}
+		else
+			driftError = std::min(driftError, MAX_DRIFT);
+	}
+
+	//The offsets of the samples are taken to the instant of the new sample, and the least delayed one is used
+	std::int64_t correctedOffsets[NUM_OF_SAMPLES] = {};
+	for(unsigned int i=0; i<numOfStoredSamples; i++)
+		correctedOffsets[i] = (samples[i].utcTime - samples[i].monotonicTime) + std::llround( drift * (monotonicTime - samples[i].monotonicTime) );
+	std::sort(correctedOffsets, correctedOffsets + numOfStoredSamples);
+
+	const std::int64_t bestOffset = correctedOffsets[numOfStoredSamples-1];
+	std::int64_t offsetError = bestOffset - correctedOffsets[(numOfStoredSamples-1)/2];
+	if(numOfStoredSamples < 4)
+		offsetError = std::max(offsetError, INITIAL_ERROR);
+
+	lastModel.numOfSamples++;
+	lastModel.refMonotonicTime = monotonicTime;
+	lastModel.refOffset = bestOffset;
+	lastModel.drift = drift;
+	lastModel.driftError = driftError;
+	lastModel.offsetError = offsetError;
+	sharedModel.Store(lastModel);
+}
+
+/*!	The UTC time is the monotonic time plus the offset of the model, corrected with the drift since the last sample.
+ * When the clock was never synchronized, the time of the system clock (`CLOCK_REALTIME`) is given instead, with a
+ * negative error, which means it is unknown. This method can be called by any thread.
+ * \param [in] monotonicTime An instant of the monotonic clock, in nanoseconds, as the ones returned by MonotonicTime().
+ * \return The timestamp of the given instant.
+ */
+GPSTimestamp GPSClock::GetTimestamp(const std::int64_t monotonicTime) const
+{
+	const ClockModel model = sharedModel.Load();
+	GPSTimestamp timestamp;
+
+	if(model.numOfSamples==0)
+	{
+		struct timespec realTime;
+		clock_gettime(CLOCK_REALTIME, &realTime);
+		timestamp.utcTime = std::int64_t(realTime.tv_sec)*1000000000 + realTime.tv_nsec;
+		timestamp.estimatedError = -1;
+		timestamp.flagSynchronized = false;
+		return timestamp;
+	}
+
+	const std::int64_t elapsedTime = monotonicTime - model.refMonotonicTime;
+	timestamp.utcTime = monotonicTime + model.refOffset + std::llround( model.drift * elapsedTime );
+	timestamp.estimatedError = model.offsetError + std::llround( model.driftError * std::llabs(elapsedTime) );
+	timestamp.flagSynchronized = ( std::llabs(elapsedTime) <= HOLDOVER_TIME );
+	return timestamp;
+}
+
+void GPSClock::Reset()
+{
+	numOfStoredSamples=nextSample=numOfStoredAnchors=nextAnchor=numOfBlockSamples=0;
+	lastModel = ClockModel();
+	sharedModel.Store(lastModel);
+}
+
+std::int64_t GPSClock::MonotonicTime()
+{
+	struct timespec monotonicTime;
+	clock_gettime(CLOCK_MONOTONIC, &monotonicTime);
+	return( std::int64_t(monotonicTime.tv_sec)*1000000000 + monotonicTime.tv_nsec );
+}
+
+/*!	The number of days since 01-01-1970 is calculated with the proleptic Gregorian calendar, taking the years from
+ * March, so the leap day is the last one of the year. The leap seconds are not taken into account, as in the Unix time.
+ * \param [in] year The year, with four digits.
+ * \param [in] month The month, from 1 to 12.
+ * \param [in] day The day of the month, from 1 to 31.
+ * \param [in] hour The hour, from 0 to 23.
+ * \param [in] minute The minute, from 0 to 59.
+ * \param [in] second The second, from 0 to 59.
+ * \param [in] nanosecond The fraction of the second, in nanoseconds.
+ * \return The time in nanoseconds since 01-01-1970T00:00:00.
+ */
+std::int64_t GPSClock::ToUTCTime(const unsigned int year, const unsigned int month, const unsigned int day, const unsigned int hour,
+		const unsigned int minute, const unsigned int second, const unsigned int nanosecond)
+{
+	const std::int64_t y = std::int64_t(year) - (month <= 2 ? 1 : 0);
+	const std::int64_t era = ( y >= 0 ? y : y - 399 ) / 400;
+	const std::int64_t yearOfEra = y - era*400;
+	const std::int64_t dayOfYear = ( 153*( month > 2 ? month - 3 : month + 9 ) + 2 )/5 + day - 1;
+	const std::int64_t dayOfEra = yearOfEra*365 + yearOfEra/4 - yearOfEra/100 + dayOfYear;
+	const std::int64_t days = era*146097 + dayOfEra - 719468;
+
+	return( ( days*86400 + hour*3600 + minute*60 + second )*1000000000 + nanosecond );
+}
+
+/*!	\param [in] time A time in nanoseconds since 01-01-1970T00:00:00.
+ * 	\return The date and the time, with the fraction of the second.
+ */
+TimeData GPSClock::ToTimeData(const std::int64_t time)
+{
+	const std::int64_t NANOSECONDS_PER_DAY = 86400LL*1000000000;
+	std::int64_t days = time / NANOSECONDS_PER_DAY, dayTime = time % NANOSECONDS_PER_DAY;
+	if(dayTime < 0)
+	{
+		days--;
+		dayTime += NANOSECONDS_PER_DAY;
+	}
+
+	const std::int64_t z = days + 719468;
+	const std::int64_t era = ( z >= 0 ? z : z - 146096 ) / 146097;
+	const std::int64_t dayOfEra = z - era*146097;
+	const std::int64_t yearOfEra = ( dayOfEra - dayOfEra/1460 + dayOfEra/36524 - dayOfEra/146096 ) / 365;
+	const std::int64_t dayOfYear = dayOfEra - ( 365*yearOfEra + yearOfEra/4 - yearOfEra/100 );
+	const std::int64_t monthIndex = ( 5*dayOfYear + 2 )/153;
+
+	TimeData timeData;
+	timeData.day = dayOfYear - ( 153*monthIndex + 2 )/5 + 1;
+	timeData.month = ( monthIndex < 10 ? monthIndex + 3 : monthIndex - 9 );
+	timeData.year = yearOfEra + era*400 + ( timeData.month <= 2 ? 1 : 0 );
+
+	const std::int64_t seconds = dayTime / 1000000000;
+	timeData.hour = seconds / 3600;
+	timeData.minute = (seconds / 60) % 60;
+	timeData.second = seconds % 60;
+	timeData.nanosecond = dayTime % 1000000000;
+	return timeData;
+}
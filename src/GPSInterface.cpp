@@ -11,7 +11,8 @@ void *StreamingThread(void * arg)
 {
 	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
 
-	std::string reply;
+	const char * reply;
+	std::size_t length;
 	unsigned int numOfSerialErrors=0;
 
 	auto gpsInterfacePtr = (GPSInterface*) arg;
@@ -20,45 +21,10 @@ void *StreamingThread(void * arg)
 	{
 		try
 		{
-			gpsInterfacePtr->Read(reply, 42); //Read a reply with at least 42 bytes
+			gpsInterfacePtr->Read(reply, length, 42); //Read a reply with at least 42 bytes
 
-			if( reply.find("$GPRMC") != std::string::npos )
-			{
-				if( gpsInterfacePtr->ControlChecksum(reply) && gpsInterfacePtr->ControlStatus(reply) )
-					gpsInterfacePtr->ExtractGPRMCData(reply);
-			}
-			else if( reply.find("$GPGGA") != std::string::npos )
-			{
-				if( gpsInterfacePtr->ControlChecksum(reply) )
-					gpsInterfacePtr->ExtractGPGGAData(reply);
-			}
-			else if( reply.find("$PAAG,DATA,G") != std::string::npos )
-			{
-				if( gpsInterfacePtr->ControlChecksum(reply) && gpsInterfacePtr->ControlStatus(reply) )
-					gpsInterfacePtr->ExtractGyroData(reply);
-			}
-			else if( reply.find("$PAAG,DATA,C") != std::string::npos )
-			{
-				if( gpsInterfacePtr->ControlChecksum(reply) && gpsInterfacePtr->ControlStatus(reply) )
-				{
-					gpsInterfacePtr->ExtractCompassData(reply);
-					gpsInterfacePtr->CalculateYaw();
-				}
-			}
-			else if( reply.find("$PAAG,DATA,B") != std::string::npos )
-			{
-				if( gpsInterfacePtr->ControlChecksum(reply) && gpsInterfacePtr->ControlStatus(reply) )
-					gpsInterfacePtr->ExtractBarometerData(reply);
-			}
-			else if( reply.find("$PAAG,DATA,T") != std::string::npos )
-			{
-				if( gpsInterfacePtr->ControlChecksum(reply) && gpsInterfacePtr->ControlStatus(reply) )
-				{
-					gpsInterfacePtr->ExtractAccelerData(reply);
-					gpsInterfacePtr->CalculateRoll();
-					gpsInterfacePtr->CalculatePitch();
-				}
-			}
+			//The reply is interpreted where it was received, without copying it, and a new snapshot is published
+			gpsInterfacePtr->ProcessDataReply(reply, length, gpsInterfacePtr->lastReceptionTime);
 
 			numOfSerialErrors=0;
 		}
@@ -84,15 +50,24 @@ void *StreamingThread(void * arg)
 
 ///////////////Implementations of the GPSInterface class' methods///////////////
 
-/*! The constructor has to include the custom VID and PID combination of Aaronia GPS receiver within the allowed
- * values, then it has to open the communication with the GPS receiver and set up the UART port on the
- * FTDI chip.
+const GPSSentence::SentenceType GPSInterface::ITEM_REPLIES[GPSInterface::NUM_OF_ITEMS] = { GPSSentence::GPRMC, GPSSentence::GPRMC,
+		GPSSentence::GPGGA, GPSSentence::GPGGA, GPSSentence::PAAG_GYRO, GPSSentence::PAAG_COMPASS, GPSSentence::PAAG_ACCELER,
+		GPSSentence::PAAG_BAROM, GPSSentence::PAAG_COMPASS, GPSSentence::PAAG_ACCELER, GPSSentence::PAAG_ACCELER };
+
+/*! The transport is created before the other attributes are initialized, so if the Aaronia GPS receiver cannot be
+ * opened, the exception of the class _FTDITransport_ is thrown and nothing else is done.
+ */
+GPSInterface::GPSInterface() : GPSInterface( *new FTDITransport )
+{
+	ownedTransport.reset(&transport);
+}
+
+/*!	The given transport is not owned by the object, so it must exist while the object exists.
+ * \param [in] transp The transport through which the commands are sent and the replies are received.
  */
-GPSInterface::GPSInterface()
+GPSInterface::GPSInterface(GPSTransport & transp) : transport(transp)
 {
 	//Initialization of attributes
-	ftHandle=0;
-	ftStatus=0;
 	flagConnected=false;
 	coordinates={ 0.0, 0.0 };
 	numOfSatellites=0;
@@ -102,67 +77,20 @@ GPSInterface::GPSInterface()
 	pressure=0.0;
 	presElevation=0.0;
 
-	flagNewGPRMCData=flagNewGPGGAData=flagNewBaromData=false;
-	flagNewGyroData=flagNewCompassData=flagNewAccelerData=false;
-	flagNewTimeData=flagNewCoordinates=flagNewNumOfSatellites=false;
-	flagNewGPSElevation=flagNewYaw=flagNewRoll=flagNewPitch=false;
+	lastSnapshot = GPSSnapshot();
+	std::fill(readCounts, readCounts + NUM_OF_ITEMS, 0);
+
+	lastReceptionTime=0;
+	recorder=nullptr;
 
 	threadID=0;
 	flagStreamingEnabled=false;
 	streamingRetVal=0;
-
-	ftStatus=FT_SetVIDPID(VID, PID);
-	if(ftStatus!=FT_OK)
-	{
-		rfims_exception exc("the custom VID and PID combinations of the Aaronia GPS receiver could not be included.");
-		throw(exc);
-	}
-
-	ftStatus=FT_OpenEx((PVOID)DEVICE_DESCRIPTION.c_str(), FT_OPEN_BY_DESCRIPTION, &ftHandle);
-	if (ftStatus!=FT_OK)
-	{
-		rfims_exception exc;
-		switch(ftStatus)
-		{
-		case 2:
-			exc.SetMessage("the Aaronia GPS receiver was not found.");
-			throw(exc);
-		case 3:
-			exc.SetMessage("the Aaronia GPS receiver could not be opened.");
-			throw(exc);
-		default:
-			std::ostringstream oss;
-			oss << "the function FT_OpenEx() returned a FT_STATUS value of " << ftStatus << '.';
-			exc.SetMessage( oss.str() );
-			throw(exc);
-		}
-	}
-
-	ftStatus=FT_SetTimeouts(ftHandle, RD_TIMEOUT_MS, WR_TIMEOUT_MS);
-	if(ftStatus!=FT_OK)
-		throw rfims_exception("the read and write timeouts could not be set up.");
-
-	ftStatus=FT_SetBaudRate(ftHandle, 625000);
-	if(ftStatus!=FT_OK)
-	{
-		if(ftStatus==7)
-			throw rfims_exception("the given value of baud rate is not valid.");
-		else
-			throw rfims_exception("the baud rate could not be set up");
-	}
-
-	ftStatus = FT_SetDataCharacteristics(ftHandle, FT_BITS_8, FT_STOP_BITS_2, FT_PARITY_NONE);
-	if(ftStatus!=FT_OK)
-		throw rfims_exception("the data characteristics could not be set up.");
-
-	ftStatus = FT_SetFlowControl(ftHandle, FT_FLOW_NONE, 0, 0);
-	if(ftStatus!=FT_OK)
-		throw rfims_exception("the flow control could not be set up.");
 }
 
 
 /*! The destructor has to make sure that the data streaming and the data logging into the microSD card are stopped,
- * and then it closes the communication with the Aaronia GPS receiver.
+ * and then the communication with the Aaronia GPS receiver is closed when the owned transport is destroyed.
  */
 GPSInterface::~GPSInterface()
 {
@@ -199,127 +127,208 @@ GPSInterface::~GPSInterface()
 		cerr << "Warning: " << exc.what();
 	}
 
-	//Closing the communication with the Aaronia GPS receiver
-	ftStatus=FT_Close(ftHandle);
-	if(ftStatus!=FT_OK)
-	{
-		cerr << "Error: the communication with the Aaronia GPS receiver could not be closed." << endl;
-	}
+	//The communication with the Aaronia GPS receiver is closed by the destructor of the owned transport, if it exists
 }
 
-/*! This method takes a command and sends it to the Aaronia GPS receiver, using the D2XX library.
+/*! This method takes a command and sends it to the Aaronia GPS receiver, through the transport.
  * After the writing was performed, the method checks if there were errors and if all bytes were written.
  * \param [in] command A `std::string` object which contains the command to be sent.
  */
 inline void GPSInterface::Write(const std::string& command)
 {
-	DWORD writtenBytes;
-	DWORD numOfBytes = command.size();
-	char txBuffer[numOfBytes];
-
-	strcpy(txBuffer, command.c_str());
+	std::size_t writtenBytes;
+	try
+	{
+		writtenBytes = transport.Write( command.data(), command.size() );
+	}
+	catch(rfims_exception & exc)
+	{
+		exc.Prepend("the GPS interface tried to send a command");
+		throw;
+	}
 
-	ftStatus=FT_Write(ftHandle, txBuffer, numOfBytes, &writtenBytes);
-	if(ftStatus!=FT_OK)
-		throw rfims_exception("the GPS interface tried to send a command but the function FT_Write() returned an error value.");
-	else if(writtenBytes!=numOfBytes)
+	if( writtenBytes!=command.size() )
 		throw rfims_exception("the GPS interface tried to send a command but not all bytes were written.");
 }
 
-/*! This method reads a reply from the Aaronia GPS receiver, using the D2XX library, and stores it in a `std::string`
- * object which is passed as a non-const reference.
+/*! This method reads a reply from the Aaronia GPS receiver, through the transport, and gives it as a pointer to the
+ * reception buffer (an object of the class _SentenceBuffer_) and a length, without copying it.
  *
- * This method has two parameters: the first one is a `std::string` object where the reply will be stored and the second
- * one is the minimum number of bytes the reply would have. The second parameter is compared with the number of available
- * bytes in an internal loop to ensure the reading does not fail. That query of available bytes is performed every 10 ms.
- * The loop ends when the needed bytes are available, and then a small interval time of 30 ms is waited as a precaution,
- * or it ends when a determined number of iterations is reached, what it is interpreted as an error. When the number of
- * bytes is not given, i.e. the second parameter takes the value zero, the method will just wait a fixed interval time
- * of 150 ms to ensure the needed bytes are available. After of that, the reading operation is performed inside a loop
- * where it is read one byte at a time until the '\n' character is read.
- * \param [in] reply A `std::string` object where the will store the reply of the GPS receiver.
+ * If the reception buffer already has a complete reply, it is given immediately. Otherwise, the third parameter, the
+ * minimum number of bytes the reply would have, is compared with the number of received bytes (the ones in the
+ * reception buffer plus the available ones in the input buffer of the USB interface) in an internal loop to ensure the
+ * reading does not fail. That query of available bytes is performed every 10 ms. The loop ends when the needed bytes are
+ * available or when a determined number of iterations is reached, what it is interpreted as an error. When the number
+ * of bytes is not given, i.e. the third parameter takes the value zero, the method will just wait a fixed interval time
+ * of 150 ms to ensure the needed bytes are available. After of that, all the available bytes are read with just one
+ * call to the method GPSTransport::Read(), and this is repeated until a complete reply, ended by the '\n' character, is received.
+ * The bytes which follow that reply remain in the reception buffer, for the next reading.
+ * \param [out] reply A pointer to the first character of the reply, which is valid until the next reading.
+ * \param [out] length The number of characters of the reply, including the final characters "\r\n".
  * \param [in] numOfBytes The minimum number of bytes the reply would have.
  */
-inline void GPSInterface::Read(std::string& reply, const unsigned int numOfBytes)
+inline void GPSInterface::Read(const char * & reply, std::size_t & length, const unsigned int numOfBytes)
 {
-	DWORD receivedBytes;
-	char rxBuffer;
-
-	reply.clear();
+	if( rxBuffer.NextSentence(reply, length) )
+		return;
 
 	if(numOfBytes!=0)
 	{
 		//Loop to wait for the bytes
 		unsigned int i=0;
-		while( Available() < numOfBytes && i++ < 200)
+		while( rxBuffer.Size() + Available() < numOfBytes && i++ < 200)
 			usleep(10000); //10ms
 
 		if(i>=20)
 			throw rfims_exception("the data set (GPRMC, GPGGA and PAAG replies) was waited too much time."); // 2s
-
-		//usleep(30000); //An additional delay to wait for some additional bytes
 	}
 	else
 		usleep(150000); //A fixed time interval to wait for the bytes
 
-	//Loop where the characters are read until a '\n' character is read
+	//Loop where all the available bytes are read until a complete reply is received
 	unsigned int numOfSerialErrors=0;
-	do
+	while( !rxBuffer.NextSentence(reply, length) )
 	{
-		ftStatus=FT_Read(ftHandle, &rxBuffer, 1, &receivedBytes);
+		std::size_t freeSpace;
+		char * writePtr = rxBuffer.GetWriteBuffer(freeSpace);
 
-		if(ftStatus!=FT_OK)
+		//At least one byte is requested, so the transport waits for it until the timeout expires
+		std::size_t receivedBytes=0;
+		const std::size_t bytesToRead = std::min( std::size_t( std::max( Available(), 1U ) ), freeSpace );
+		try
+		{
+			receivedBytes = transport.Read(writePtr, bytesToRead);
+		}
+		catch(rfims_exception & exc)
 		{
 			if(++numOfSerialErrors > 5)
-				throw rfims_exception("the GPS interface tried to read a reply, but the function FT_Read() returned an error value.");
+			{
+				exc.Prepend("the GPS interface tried to read a reply");
+				throw;
+			}
+			continue;
 		}
-		else if(receivedBytes!=1)
+
+		if(receivedBytes==0)
 		{
 			if(++numOfSerialErrors > 5)
-				throw rfims_exception("the GPS interface tried to read a reply, but one character could not be read.");
+				throw rfims_exception("the GPS interface tried to read a reply, but no character could be read.");
 		}
 		else
 		{
 			numOfSerialErrors=0;
-			reply += rxBuffer;
+			rxBuffer.Commit(receivedBytes);
+			lastReceptionTime = GPSClock::MonotonicTime();
 		}
+	}
+}
 
-	}while(rxBuffer!='\n');
+/*! This method reads a reply from the Aaronia GPS receiver, as the other version of the method, and copies it in a
+ * `std::string` object which is passed as a non-const reference.
+ * \param [out] reply A `std::string` object where the reply of the GPS receiver will be stored.
+ * \param [in] numOfBytes The minimum number of bytes the reply would have.
+ */
+inline void GPSInterface::Read(std::string& reply, const unsigned int numOfBytes)
+{
+	const char * sentence;
+	std::size_t length;
+
+	reply.clear();
+	Read(sentence, length, numOfBytes);
+	reply.assign(sentence, length);
 }
 
 /*! The checksum is at the end of each reply, after an asterisk (*), and it is a 2 character hexadecimal
  *	representation of the XOR combination of all characters between the $ (all replies and commands start
- *	with this symbol) and the * (as defined by the	NMEA protocol).
+ *	with this symbol) and the * (as defined by the	NMEA protocol). The checking is done by the class _SentenceParser_.
  * 	\param [in] reply The reply to be checked.
  */
 inline bool GPSInterface::ControlChecksum(const std::string& reply)
 {
-	unsigned int receivedChecksum, calculChecksum = 0;
-	unsigned int i=1; //the operation starts with the second element
+	return SentenceParser::ControlChecksum( reply.data(), reply.size() );
+}
 
-	while(reply[i]!='*')
-		calculChecksum ^= reply[i++];
+/*!	The reply is interpreted with the class _SentenceParser_, which checks the checksum and extracts all the fields in
+ * just one scan. The GPRMC replies and the PAAG,DATA replies must have a valid status too (the character 'A' before
+ * the asterisk).
+ * \param [in] reply A pointer to the reply, which is not copied.
+ * \param [in] length The number of characters of the reply.
+ * \param [in] receptionTime The instant of the monotonic clock when the reply was received, in nanoseconds, or zero if
+ * it is unknown. When it is given, the GPRMC replies are used to discipline the GPS clock.
+ * \return The type of the reply whose data were extracted, or `GPSSentence::UNKNOWN` if the reply was not valid or it
+ * was not a data reply.
+ */
+GPSSentence::SentenceType GPSInterface::ProcessDataReply(const char * reply, const std::size_t length, const std::int64_t receptionTime)
+{
+	GPSSentence fields;
+	if( !SentenceParser::Parse(reply, length, fields) )
+		return GPSSentence::UNKNOWN;
 
-	size_t checksumPos = reply.find('*') + 1;
-	std::string checksumString = reply.substr(checksumPos, 2);
-	sscanf(checksumString.c_str(), "%x", &receivedChecksum);
+	if( fields.type!=GPSSentence::GPGGA && fields.status!='A' && fields.status!='a' )
+		return GPSSentence::UNKNOWN;
 
-	if(receivedChecksum==calculChecksum)
-		return true;
+	//The samples of the sensors are given to the attitude filter with the instant when they were received
+	const std::int64_t sampleTime = ( receptionTime!=0 ? receptionTime : GPSClock::MonotonicTime() );
 
-	return false;
+	switch(fields.type)
+	{
+		case GPSSentence::GPRMC:
+			ExtractGPRMCData(fields);
+			if(receptionTime!=0)
+			{
+				//The reply started to be received one transmission time (11 bits per byte) before its last byte
+				const std::int64_t transmissionTime = std::int64_t(length) * 11 * 1000000000 / std::int64_t( transport.GetBaudRate() );
+				clock.AddSample( receptionTime - transmissionTime, GPSClock::ToUTCTime(fields.year, fields.month, fields.day,
+						fields.hour, fields.minute, fields.second, fields.nanosecond) );
+			}
+			break;
+		case GPSSentence::GPGGA:		ExtractGPGGAData(fields);		break;
+		case GPSSentence::PAAG_GYRO:
+			ExtractGyroData(fields);
+			attitudeFilter.AddGyroData(sampleTime, gyroData.x, gyroData.y, gyroData.z);
+			break;
+		case GPSSentence::PAAG_COMPASS:
+			ExtractCompassData(fields);
+			CalculateYaw();
+			attitudeFilter.AddYaw(sampleTime, yaw);
+			break;
+		case GPSSentence::PAAG_ACCELER:
+			ExtractAccelerData(fields);
+			CalculateRoll();
+			CalculatePitch();
+			attitudeFilter.AddTilt( sampleTime, pitch, roll, std::sqrt(accelData.x*accelData.x + accelData.y*accelData.y + accelData.z*accelData.z) );
+			break;
+		case GPSSentence::PAAG_BAROM:	ExtractBarometerData(fields);	break;
+		default:						break;
+	}
+
+	PublishSnapshot(fields.type);
+	if(recorder!=nullptr && receptionTime!=0)
+		RecordSnapshot(fields.type, receptionTime);
+	return fields.type;
 }
 
-inline bool GPSInterface::ControlStatus(const std::string & reply)
+/*!	While the streaming is enabled, the methods Update*() do not send commands to the GPS receiver, which would
+ * interfere with the streaming: they wait, at most two seconds, for the streaming thread to publish a snapshot with a
+ * new reply of the corresponding type.
+ * \param [in] replyType The type of reply which must be waited.
+ * \param [in] dataName The name of the data which are being updated, which is used in the message of the exception.
+ */
+void GPSInterface::WaitForStreamedReply(const GPSSentence::SentenceType replyType, const std::string & dataName)
 {
-	size_t statusCharPos = reply.find('*') - 1;
-
-	if( reply.at(statusCharPos)=='A' || reply.at(statusCharPos)=='a' )
-		return true;
-
-	return false;
+	const std::uint64_t numOfReplies = GetSnapshot().numOfReplies[replyType];
+	for(unsigned int i=0; i<200; i++)
+	{
+		usleep(10000); //10ms
+		if( GetSnapshot().numOfReplies[replyType] != numOfReplies )
+			return;
+		if(!flagStreamingEnabled)
+			throw rfims_exception("the updating of " + dataName + " failed because the streaming was disabled while a reply was waited.");
+	}
+	throw rfims_exception("the updating of " + dataName + " failed because no reply of the streaming was received in 2 s.");
 }
 
+
 /*! This method simplifies the operation of set an internal variable of the GPS variable. The possible
  * 	variables are the following:
  * 	- ACCRANGE: accelerometer range, 2g, 4g or 8g.
@@ -381,174 +390,161 @@ inline void GPSInterface::CalculateYaw()
 
 	if( (yaw+=180.0) >= 360.0 )
 		yaw -= 360.0;
-
-	flagNewYaw=true;
 }
 
 
 inline void GPSInterface::CalculatePitch()
 {
 	pitch = -atan2( accelData.y, sqrt(pow(accelData.x,2) + pow(accelData.z,2)) ) * 180.0/M_PI;
-
-	flagNewPitch=true;
 }
 
 
 void GPSInterface::CalculateRoll()
 {
 	roll = atan2( -accelData.x, (accelData.z<0 ? -1 : 1) * sqrt(pow(accelData.y,2) + pow(accelData.z,2)) ) * 180.0/M_PI;
-
-	flagNewRoll=true;
 }
 
 
-void GPSInterface::ExtractGPRMCData(const std::string & reply)
+void GPSInterface::ExtractGPRMCData(const GPSSentence & reply)
 {
-	nmea_s * data;
+	timeData.day = reply.day; timeData.month = reply.month; timeData.year = reply.year;
+	timeData.hour = reply.hour-3; timeData.minute = reply.minute; timeData.second = reply.second;
 
-	//Copying the reply to an auxiliary string to avoid destroying the original string
-	char * auxString = new char[ reply.size() + 10 ];
-	strcpy( auxString, reply.c_str() );
-
-	//Parsing GPRMC reply
-	data = nmea_parse(auxString, reply.size(), 0);
-	if(data==NULL)
-		throw rfims_exception("it was not possible to parse a GPRMC reply.");
-
-	nmea_gprmc_s * gprmc = (nmea_gprmc_s*) data;
-
-	timeData.day = gprmc->time.tm_mday; timeData.month = gprmc->time.tm_mon+1; timeData.year = gprmc->time.tm_year+1900;
-	timeData.hour = gprmc->time.tm_hour-3; timeData.minute = gprmc->time.tm_min; timeData.second = gprmc->time.tm_sec;
-
-	coordinates.latitude = double(gprmc->latitude.degrees + gprmc->latitude.minutes/60.0) * (gprmc->latitude.cardinal=='S' ? -1.0 : 1.0);
-	coordinates.longitude = double(gprmc->longitude.degrees + gprmc->longitude.minutes/60.0) * (gprmc->longitude.cardinal=='W' ? -1.0 : 1.0);
-
-	delete[] auxString;
-	nmea_free(data);
-
-	flagNewGPRMCData=true;
-	flagNewTimeData=true;
-	flagNewCoordinates=true;
+	coordinates.latitude = reply.latitude;
+	coordinates.longitude = reply.longitude;
 }
 
 
-void GPSInterface::ExtractGPGGAData(const std::string & reply)
+void GPSInterface::ExtractGPGGAData(const GPSSentence & reply)
 {
-	nmea_s * data;
-
-	//Copying the reply to an auxiliary string to avoid destroying the original string
-	char * auxString = new char[ reply.size() + 10 ];
-	strcpy( auxString, reply.c_str() );
-
-	//Parsing GPGGA reply
-	data = nmea_parse(auxString, reply.size(), 0);
-	if(data==NULL)
-		throw rfims_exception("it was not possible to parse a GPGGA reply.");
-
-	nmea_gpgga_s * gpgga = (nmea_gpgga_s*) data;
-	gpsElevation = gpgga->altitude;
-	numOfSatellites = gpgga->n_satellites;
-
-	delete[] auxString;
-	nmea_free(data);
-
-	flagNewGPGGAData=true;
-	flagNewGPSElevation=true;
-	flagNewNumOfSatellites=true;
+	gpsElevation = reply.altitude;
+	numOfSatellites = reply.numOfSatellites;
 }
 
 
-void GPSInterface::ExtractGyroData(const std::string & reply)
+void GPSInterface::ExtractGyroData(const GPSSentence & reply)
 {
-	std::stringstream ss;
-	std::string aux;
-	char delimiter[2];
-
-	//Extracting the 3D values (x,y,z)
-	size_t statusPos = reply.find('*') - 1;
-	size_t xPos = reply.find(',', 13) + 1;
-	aux = reply.substr(xPos, statusPos-xPos-1);
-	ss.str( aux );
-	ss >> gyroData.x >> delimiter[0] >> gyroData.y >> delimiter[1] >> gyroData.z;
+	gyroData.sensor = Data3D::GYROSCOPE;
+	gyroData.time.assign(reply.time, reply.timeLength);
 
 	//Scaling the gyroscope data so they are in degrees/s
-	gyroData.x /= 14.375;
-	gyroData.y /= 14.375;
-	gyroData.z /= 14.375;
-
-	flagNewGyroData=true;
+	gyroData.x = reply.x / 14.375;
+	gyroData.y = reply.y / 14.375;
+	gyroData.z = reply.z / 14.375;
 }
 
 
-void GPSInterface::ExtractCompassData(const std::string & reply)
+void GPSInterface::ExtractCompassData(const GPSSentence & reply)
 {
-	std::stringstream ss;
-	std::string aux;
-	char delimiter[2];
-
-	//Extracting the 3D values (x,y,z)
-	auto statusPos = reply.find('*') - 1;
-	auto xPos = reply.find(',', 13) + 1;
-	aux = reply.substr(xPos, statusPos-xPos-1);
-	ss.str( aux );
-	ss >> compassData.x >> delimiter[0] >> compassData.y >> delimiter[1] >> compassData.z;
+	compassData.sensor = Data3D::COMPASS;
+	compassData.time.assign(reply.time, reply.timeLength);
 
 	//Scaling the compass data so they are in Gauss
-	compassData.x /= 1090.0;
-	compassData.y /= 1090.0;
-	compassData.z /= 1090.0;
-
-	flagNewCompassData=true;
+	compassData.x = reply.x / 1090.0;
+	compassData.y = reply.y / 1090.0;
+	compassData.z = reply.z / 1090.0;
 }
 
 
-void GPSInterface::ExtractAccelerData(const std::string & reply)
+void GPSInterface::ExtractAccelerData(const GPSSentence & reply)
 {
-	std::stringstream ss;
-	std::string aux;
-	char delimiter[2];
-
-	//Extracting the 3D values (x,y,z)
-	auto statusPos = reply.find('*') - 1;
-	auto xPos = reply.find(',', 13) + 1;
-	aux = reply.substr(xPos, statusPos-xPos-1);
-	ss.str( aux );
-	ss >> accelData.x >> delimiter[0] >> accelData.y >> delimiter[1] >> accelData.z;
+	accelData.sensor = Data3D::ACCELEROMETER;
+	accelData.time.assign(reply.time, reply.timeLength);
 
 	//Scaling the accelerometer data
-	accelData.x /= 8192.0;
-	accelData.y /= 8192.0;
-	accelData.z /= 8192.0;
-
-	flagNewAccelerData=true;
+	accelData.x = reply.x / 8192.0;
+	accelData.y = reply.y / 8192.0;
+	accelData.z = reply.z / 8192.0;
 }
 
 
-void GPSInterface::ExtractBarometerData(const std::string & reply)
+void GPSInterface::ExtractBarometerData(const GPSSentence & reply)
 {
-	std::stringstream ss;
-	std::string aux;
-
-	//Extracting the pressure value
-	auto valuePos = reply.find(',', 13) + 1;
-	auto nextDelimPos = reply.find(',', valuePos);
-	aux = reply.substr(valuePos, nextDelimPos-valuePos);
-	ss.str( aux );
-	ss >> pressure;
+	pressure = reply.pressure;
 
 	//Applying the formula from the Portland State Aerospace Society (PSAS) to calculate the elevation from atmosphere pressure.
 	presElevation = ( pow( pressure/1013.25, -(-6.5e-3 * 287.053)/9.8 ) - 1.0 ) * 295.0 / -6.5e-3;
+}
+
 
-	flagNewBaromData=true;
+/*!	The current data are copied in the snapshot which is only used by the thread which extracts them and then this one
+ * is stored in the seqlock, so the readers always get the data of a whole reply, never half of them.
+ * \param [in] replyType The type of the reply whose data were extracted, whose number of replies is incremented.
+ */
+void GPSInterface::PublishSnapshot(const GPSSentence::SentenceType replyType)
+{
+	lastSnapshot.generation++;
+	if(replyType < GPSSentence::UNKNOWN)
+		lastSnapshot.numOfReplies[replyType]++;
+
+	lastSnapshot.year=timeData.year; lastSnapshot.month=timeData.month; lastSnapshot.day=timeData.day;
+	lastSnapshot.hour=timeData.hour; lastSnapshot.minute=timeData.minute; lastSnapshot.second=timeData.second;
+	lastSnapshot.coordinates=coordinates;
+	lastSnapshot.numOfSatellites=numOfSatellites;
+	lastSnapshot.gpsElevation=gpsElevation;
+
+	const Data3D * sensorsData[] = { &gyroData, &compassData, &accelData };
+	GPSSnapshot::Values3D * snapshotValues[] = { &lastSnapshot.gyroData, &lastSnapshot.compassData, &lastSnapshot.accelData };
+	for(unsigned int i=0; i<3; i++)
+	{
+		snapshotValues[i]->x = sensorsData[i]->x;
+		snapshotValues[i]->y = sensorsData[i]->y;
+		snapshotValues[i]->z = sensorsData[i]->z;
+		const std::size_t timeLength = std::min( sensorsData[i]->time.size(), sizeof(snapshotValues[i]->time) - 1 );
+		std::memcpy(snapshotValues[i]->time, sensorsData[i]->time.data(), timeLength);
+		snapshotValues[i]->time[timeLength] = '\0';
+	}
+
+	lastSnapshot.yaw=yaw; lastSnapshot.pitch=pitch; lastSnapshot.roll=roll;
+	lastSnapshot.pressure=pressure;
+	lastSnapshot.presElevation=presElevation;
+	lastSnapshot.attitude=attitudeFilter.GetEstimate();
+
+	sharedSnapshot.Store(lastSnapshot);
+}
+
+/*!	The records are only appended once the GPS clock is synchronized, so their times are UTC times which can be compared
+ * with the timestamps of the sweeps.
+ * \param [in] replyType The type of the reply whose data were extracted.
+ * \param [in] receptionTime The instant of the monotonic clock when the reply was received, in nanoseconds.
+ */
+void GPSInterface::RecordSnapshot(const GPSSentence::SentenceType replyType, const std::int64_t receptionTime)
+{
+	const GPSTimestamp timestamp = clock.GetTimestamp(receptionTime);
+	if(!timestamp.flagSynchronized)
+		return;
+
+	const AttitudeEstimate & attitude = lastSnapshot.attitude;
+	GPSRecord record;
+	std::memset(&record, 0, sizeof(record));
+	record.utcTime = timestamp.utcTime;
+	record.latitude = std::int32_t( std::lround(lastSnapshot.coordinates.latitude * 1e7) );
+	record.longitude = std::int32_t( std::lround(lastSnapshot.coordinates.longitude * 1e7) );
+	record.gpsElevation = lastSnapshot.gpsElevation;
+	record.pressure = lastSnapshot.pressure;
+	record.presElevation = lastSnapshot.presElevation;
+	record.yaw = attitude.yaw; record.pitch = attitude.pitch; record.roll = attitude.roll;
+	record.yawDeviation = attitude.yawDeviation; record.pitchDeviation = attitude.pitchDeviation; record.rollDeviation = attitude.rollDeviation;
+	record.replyType = replyType;
+	record.numOfSatellites = std::min(lastSnapshot.numOfSatellites, 255U);
+	record.flagAttitudeValid = attitude.flagValid;
+	recorder->Append(record);
 }
 
 
 void GPSInterface::Purge()
 {
-	//The input and output buffers are purged
-	ftStatus=FT_Purge(ftHandle, FT_PURGE_RX | FT_PURGE_TX);
-	if (ftStatus!=FT_OK)
-		throw rfims_exception("the GPS interface failed when it tried to purge the input and output buffers.");
+	//The input and output buffers are purged, and also the bytes which were read but were not given as replies
+	rxBuffer.Clear();
+	try
+	{
+		transport.Purge();
+	}
+	catch(rfims_exception & exc)
+	{
+		exc.Prepend("the GPS interface failed when it tried to purge the input and output buffers");
+		throw;
+	}
 }
 
 /*! First, this method tries the communication with an ID command, and if the reply is right it shows the hardware
@@ -685,9 +681,7 @@ void GPSInterface::Initialize()
 			else
 				flagReplyFound=false;
 
-		}while( !flagReplyFound || !ControlChecksum(gpggaReply) );
-
-		ExtractGPGGAData(gpggaReply);
+		}while( !flagReplyFound || ProcessDataReply( gpggaReply.data(), gpggaReply.size() )!=GPSSentence::GPGGA );
 
 	}while( numOfSatellites < MIN_NUM_OF_SATELLITES );
 
@@ -697,16 +691,18 @@ void GPSInterface::Initialize()
 	flagConnected=true;
 }
 
-/*! It uses the function FT_GetQueueStatus() of the D2XX library. */
+/*! It uses the method GPSTransport::Available(). */
 unsigned int GPSInterface::Available()
 {
-	DWORD numOfInputBytes, numOfOutputBytes, numOfEvents;
-	//ftStatus=FT_GetQueueStatus(ftHandle, &numOfInputBytes);
-	ftStatus=FT_GetStatus(ftHandle, &numOfInputBytes, &numOfOutputBytes, &numOfEvents);
-	if(ftStatus!=FT_OK)
-		throw rfims_exception("the GPS interface failed when it tried to determine the number of bytes in the input buffer.");
-
-	return numOfInputBytes;
+	try
+	{
+		return transport.Available();
+	}
+	catch(rfims_exception & exc)
+	{
+		exc.Prepend("the GPS interface failed when it tried to determine the number of bytes in the input buffer");
+		throw;
+	}
 }
 
 void GPSInterface::ReadOneDataSet(std::vector<std::string> & dataReplies)
@@ -773,14 +769,12 @@ TimeData GPSInterface::UpdateTimeData()
 			else
 				flagReplyFound=false;
 
-		}while( !flagReplyFound || !ControlChecksum(gprmcReply) || !ControlStatus(gprmcReply) );
-
-		ExtractGPRMCData(gprmcReply);
+		}while( !flagReplyFound || ProcessDataReply( gprmcReply.data(), gprmcReply.size() )!=GPSSentence::GPRMC );
 	}
 	else
-		cerr << "\nWarning: it was tried to manually update the time data while the streaming was enabled." << endl;
+		WaitForStreamedReply(GPSSentence::GPRMC, "the time data");
 
-	return timeData;
+	return GetSnapshot().GetTimeData();
 }
 
 
@@ -817,14 +811,12 @@ Data3D GPSInterface::UpdateCompassData()
 			else
 				flagReplyFound=false;
 
-		}while( !flagReplyFound || !ControlChecksum(compassReply) || !ControlStatus(compassReply) );
-
-		ExtractCompassData(compassReply);
+		}while( !flagReplyFound || ProcessDataReply( compassReply.data(), compassReply.size() )!=GPSSentence::PAAG_COMPASS );
 	}
 	else
-		cerr << "\nWarning: it was tried to manually update the compass data while the streaming was enabled." << endl;
+		WaitForStreamedReply(GPSSentence::PAAG_COMPASS, "the compass data");
 
-	return compassData;
+	return GetSnapshot().GetData3D(Data3D::COMPASS);
 }
 
 
@@ -861,14 +853,12 @@ Data3D GPSInterface::UpdateGyroData()
 			else
 				flagReplyFound=false;
 
-		}while( !flagReplyFound || !ControlChecksum(gyroReply) || !ControlStatus(gyroReply) );
-
-		ExtractGyroData(gyroReply);
+		}while( !flagReplyFound || ProcessDataReply( gyroReply.data(), gyroReply.size() )!=GPSSentence::PAAG_GYRO );
 	}
 	else
-		cerr << "\nWarning: it was tried to manually update the gyro data while the streaming was enabled." << endl;
+		WaitForStreamedReply(GPSSentence::PAAG_GYRO, "the gyro data");
 
-	return gyroData;
+	return GetSnapshot().GetData3D(Data3D::GYROSCOPE);
 }
 
 
@@ -905,14 +895,12 @@ Data3D GPSInterface::UpdateAccelerData()
 			else
 				flagReplyFound=false;
 
-		}while( !flagReplyFound || !ControlChecksum(accelReply) || !ControlStatus(accelReply) );
-
-		ExtractAccelerData(accelReply);
+		}while( !flagReplyFound || ProcessDataReply( accelReply.data(), accelReply.size() )!=GPSSentence::PAAG_ACCELER );
 	}
 	else
-		cerr << "\nWarning: it was tried to manually update the accelerometer data while the streaming was enabled." << endl;
+		WaitForStreamedReply(GPSSentence::PAAG_ACCELER, "the accelerometer data");
 
-	return accelData;
+	return GetSnapshot().GetData3D(Data3D::ACCELEROMETER);
 }
 
 
@@ -929,13 +917,11 @@ double GPSInterface::UpdateYaw()
 			exc.Prepend("the updating of the yaw angle failed");
 			throw;
 		}
-
-		CalculateYaw();
 	}
 	else
-		cerr << "\nWarning: it was tried to manually update the yaw angle while the streaming was enabled." << endl;
+		WaitForStreamedReply(GPSSentence::PAAG_COMPASS, "the yaw angle");
 
-	return yaw;
+	return GetSnapshot().yaw;
 }
 
 
@@ -952,13 +938,11 @@ double GPSInterface::UpdateRoll()
 			exc.Prepend("the updating of the roll angle failed");
 			throw;
 		}
-
-		CalculateRoll();
 	}
 	else
-		cerr << "\nWarning: it was tried to manually update the roll angle while the streaming was enabled." << endl;
+		WaitForStreamedReply(GPSSentence::PAAG_ACCELER, "the roll angle");
 
-	return roll;
+	return GetSnapshot().roll;
 }
 
 double GPSInterface::UpdatePitch()
@@ -974,15 +958,49 @@ double GPSInterface::UpdatePitch()
 			exc.Prepend("the updating of the pitch angle failed");
 			throw;
 		}
-
-		CalculatePitch();
 	}
 	else
-		cerr << "\nWarning: it was tried to manually update the pitch angle while the streaming was enabled." << endl;
+		WaitForStreamedReply(GPSSentence::PAAG_ACCELER, "the pitch angle");
 
-	return pitch;
+	return GetSnapshot().pitch;
 }
 
+/*!	The yaw angle is taken from the attitude filter, which fuses the data of the gyroscope, the compass and the
+ * accelerometer, so it is not needed to wait a fixed time for the antenna to be still: it is waited until the filter
+ * has processed a new compass reply and the standard deviation of the yaw angle is small enough. When the streaming is
+ * disabled, the compass data are updated in each iteration. If the timeout expires, the current estimate is returned.
+ * \param [in] maxDeviation The maximum standard deviation of the yaw angle, in degrees.
+ * \param [in] timeout The maximum time to wait, in milliseconds.
+ * \return The estimated yaw angle, in degrees.
+ */
+double GPSInterface::WaitForSteadyYaw(const double maxDeviation, const unsigned int timeout)
+{
+	const std::int64_t startTime = GPSClock::MonotonicTime();
+	const std::uint64_t numOfCompassReplies = GetSnapshot().numOfReplies[GPSSentence::PAAG_COMPASS];
+	GPSSnapshot snapshot;
+	while(1)
+	{
+		if(!flagStreamingEnabled)
+			UpdateCompassData();
+		else
+			usleep(10000); //10ms
+
+		snapshot = GetSnapshot();
+		if( snapshot.numOfReplies[GPSSentence::PAAG_COMPASS]!=numOfCompassReplies && snapshot.attitude.flagValid &&
+				snapshot.attitude.yawDeviation <= maxDeviation )
+			break;
+
+		if( GPSClock::MonotonicTime() - startTime >= std::int64_t(timeout)*1000000 )
+		{
+			cerr << "\nWarning: the yaw angle did not become steady in " << timeout << " ms, its standard deviation is " << snapshot.attitude.yawDeviation << "°." << endl;
+			break;
+		}
+	}
+
+	return snapshot.attitude.yaw;
+}
+
+
 void GPSInterface::UpdatePressAndElevat()
 {
 	if(!flagStreamingEnabled)
@@ -1016,12 +1034,10 @@ void GPSInterface::UpdatePressAndElevat()
 			else
 				flagReplyFound=false;
 
-		}while( !flagReplyFound || !ControlChecksum(baromReply) || !ControlStatus(baromReply) );
-
-		ExtractBarometerData(baromReply);
+		}while( !flagReplyFound || ProcessDataReply( baromReply.data(), baromReply.size() )!=GPSSentence::PAAG_BAROM );
 	}
 	else
-		cerr << "\nWarning: it was tried to manually update the barometer data while the streaming was enabled." << endl;
+		WaitForStreamedReply(GPSSentence::PAAG_BAROM, "the barometer data");
 }
 
 
@@ -1058,14 +1074,12 @@ unsigned int GPSInterface::UpdateNumOfSatellites()
 			else
 				flagReplyFound=false;
 
-		}while( !flagReplyFound || !ControlChecksum(gpggaReply) );
-
-		ExtractGPGGAData(gpggaReply);
+		}while( !flagReplyFound || ProcessDataReply( gpggaReply.data(), gpggaReply.size() )!=GPSSentence::GPGGA );
 	}
 	else
-		cerr << "\nWarning: it was tried to manually update the number of satellites while the streaming was enabled." << endl;
+		WaitForStreamedReply(GPSSentence::GPGGA, "the number of satellites");
 
-	return numOfSatellites;
+	return GetSnapshot().numOfSatellites;
 }
 
 
@@ -1091,62 +1105,23 @@ void GPSInterface::UpdateAll()
 			}
 
 			for(const std::string & reply : dataReplies)
-			{
-				if( reply.find("$GPRMC") != std::string::npos )
+				switch( ProcessDataReply( reply.data(), reply.size() ) )
 				{
-					if( ControlChecksum(reply) && ControlStatus(reply) )
-					{
-						ExtractGPRMCData(reply);
-						flagGPRMCReply=true;
-					}
+					case GPSSentence::GPRMC:		flagGPRMCReply=true;	break;
+					case GPSSentence::GPGGA:		flagGPGGAReply=true;	break;
+					case GPSSentence::PAAG_GYRO:	flagGyroReply=true;		break;
+					case GPSSentence::PAAG_COMPASS:	flagCompassReply=true;	break;
+					case GPSSentence::PAAG_ACCELER:	flagAccelerReply=true;	break;
+					case GPSSentence::PAAG_BAROM:	flagBaromReply=true;	break;
+					default:						break;
 				}
-				else if( reply.find("$GPGGA") != std::string::npos )
-				{
-					if( ControlChecksum(reply) )
-					{
-						ExtractGPGGAData(reply);
-						flagGPGGAReply=true;
-					}
-				}
-				else if( reply.find("$PAAG,DATA,G") != std::string::npos )
-				{
-					if( ControlChecksum(reply) && ControlStatus(reply) )
-					{
-						ExtractGyroData(reply);
-						flagGyroReply=true;
-					}
-				}
-				else if( reply.find("$PAAG,DATA,C") != std::string::npos )
-				{
-					if( ControlChecksum(reply) && ControlStatus(reply) )
-					{
-						ExtractCompassData(reply);
-						flagCompassReply=true;
-					}
-				}
-				else if( reply.find("$PAAG,DATA,B") != std::string::npos )
-				{
-					if( ControlChecksum(reply) && ControlStatus(reply) )
-					{
-						ExtractBarometerData(reply);
-						flagBaromReply=true;
-					}
-				}
-				else if( reply.find("$PAAG,DATA,T") != std::string::npos )
-				{
-					if( ControlChecksum(reply) && ControlStatus(reply) )
-					{
-						ExtractAccelerData(reply);
-						flagAccelerReply=true;
-					}
-				}
-			}
 
 		}while(!flagGPRMCReply || !flagGPGGAReply || !flagBaromReply ||
 				!flagGyroReply || !flagCompassReply || !flagAccelerReply);
 	}
 	else
-		cerr << "\nWarning: it was tried to manually update all attributes while the streaming was enabled." << endl;
+		for(unsigned int type=GPSSentence::GPRMC; type<GPSSentence::UNKNOWN; type++)
+			WaitForStreamedReply(GPSSentence::SentenceType(type), "all attributes");
 }
 
 /*! After the streaming has been enable the method CaptureStreamData() must be used to get the stream data
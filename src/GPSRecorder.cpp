@@ -0,0 +1,374 @@
+/*! \file GPSRecorder.cpp
+ * 	\brief This file contains the definitions of several methods of the class _GPSRecorder_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "AntennaPositioning.h"
+
+const char GPSRecorder::MAGIC[8] = { 'R', 'F', 'I', 'M', 'S', 'G', 'P', 'S' };
+const std::uint32_t GPSRecorder::VERSION;
+const std::uint64_t GPSRecorder::MIN_NUM_OF_RECORDS;
+
+//The records are copied as eight words of 64 bits, the last of which is the sequence number
+static_assert( offsetof(GPSRecord, sequence)==56, "The sequence number must be the last word of the records." );
+
+/*!	The number of records is the largest one which fits in the disk budget, with the header. If the file exists and it has
+ * the same number of records, it is reused and the records which were appended before are kept. Otherwise, it is created
+ * again, reserving its disk space, so the appending of the records never fails because the storage device is full.
+ * \param [in] path The path of the file.
+ * \param [in] maxSize The maximum size of the file, in bytes.
+ */
+GPSRecorder::GPSRecorder(const std::string & path, const std::uint64_t maxSize) : filePath(path)
+{
+	fileDescriptor=-1;
+	flagReadOnly=false;
+	mapAddr=nullptr;
+	mapSize=0;
+	header=nullptr;
+	records=nullptr;
+	capacity=0;
+	numOfRecords=0;
+	lastTime=std::numeric_limits<std::int64_t>::min();
+
+	const std::uint64_t numOfRecs = ( maxSize > sizeof(FileHeader) ? (maxSize - sizeof(FileHeader)) / sizeof(GPSRecord) : 0 );
+	if(numOfRecs < MIN_NUM_OF_RECORDS)
+		throw rfims_exception("the disk budget of the GPS recorder is too small.");
+
+	fileDescriptor = open( path.c_str(), O_RDWR | O_CREAT, 0644 );
+	if(fileDescriptor < 0)
+	{
+		rfims_exception exc("the file " + path + " of the GPS recorder could not be opened");
+		exc.Append( strerror(errno) );
+		throw(exc);
+	}
+
+	try
+	{
+		struct stat fileStatus;
+		if( fstat(fileDescriptor, &fileStatus)!=0 )
+			throw rfims_exception("the size of the file " + path + " of the GPS recorder could not be read.");
+
+		if( !MapFile(numOfRecs) )
+		{
+			if(fileStatus.st_size > 0)
+				cerr << "\nWarning: the file " << path << " of the GPS recorder was not valid or its disk budget changed, so it will be overwritten." << endl;
+			CreateFile(numOfRecs);
+			if( !MapFile(numOfRecs) )
+				throw rfims_exception("the file " + path + " of the GPS recorder could not be created.");
+		}
+	}
+	catch(rfims_exception & exc)
+	{
+		//The destructor is not called when the constructor fails, so the file is closed here
+		CloseFile();
+		throw;
+	}
+
+	//The records which were written after the last update of the header, if any, are recovered
+	std::uint64_t recs = header->numOfRecords;
+	GPSRecord record;
+	while( ReadRecord(recs+1, record) )
+		recs++;
+	header->numOfRecords = recs;
+	numOfRecords = recs;
+	if( recs > 0 && ReadRecord(recs, record) )
+		lastTime = record.utcTime;
+}
+
+/*!	The file is mapped just for reading, so it can be looked up while the main program is appending records to it.
+ * \param [in] path The path of the file.
+ */
+GPSRecorder::GPSRecorder(const std::string & path) : filePath(path)
+{
+	fileDescriptor=-1;
+	flagReadOnly=true;
+	mapAddr=nullptr;
+	mapSize=0;
+	header=nullptr;
+	records=nullptr;
+	capacity=0;
+	numOfRecords=0;
+	lastTime=std::numeric_limits<std::int64_t>::min();
+
+	fileDescriptor = open( path.c_str(), O_RDONLY );
+	if(fileDescriptor < 0)
+	{
+		rfims_exception exc("the file " + path + " of the GPS recorder could not be opened");
+		exc.Append( strerror(errno) );
+		throw(exc);
+	}
+
+	try
+	{
+		if( !MapFile(0) )
+			throw rfims_exception("the file " + path + " is not a valid file of the GPS recorder.");
+	}
+	catch(rfims_exception & exc)
+	{
+		CloseFile();
+		throw;
+	}
+}
+
+/*!	The file is truncated and then its disk space is reserved with the function posix_fallocate(), which fills it with
+ * zeros, so all the records are empty (their sequence numbers are zero). Finally, the header is written.
+ * \param [in] numOfRecs The number of records of the ring.
+ */
+void GPSRecorder::CreateFile(const std::uint64_t numOfRecs)
+{
+	const std::uint64_t fileSize = sizeof(FileHeader) + numOfRecs * sizeof(GPSRecord);
+	if( ftruncate(fileDescriptor, 0)!=0 )
+		throw rfims_exception("the file " + filePath + " of the GPS recorder could not be truncated.");
+
+	const int error = posix_fallocate(fileDescriptor, 0, fileSize);
+	if(error!=0)
+	{
+		rfims_exception exc("the disk budget of the GPS recorder could not be reserved in the file " + filePath);
+		exc.Append( strerror(error) );
+		throw(exc);
+	}
+
+	FileHeader newHeader;
+	std::memset( &newHeader, 0, sizeof(newHeader) );
+	std::memcpy( newHeader.magic, MAGIC, sizeof(MAGIC) );
+	newHeader.version = VERSION;
+	newHeader.recordSize = sizeof(GPSRecord);
+	newHeader.capacity = numOfRecs;
+	newHeader.numOfRecords = 0;
+	if( pwrite(fileDescriptor, &newHeader, sizeof(newHeader), 0)!=ssize_t(sizeof(newHeader)) )
+		throw rfims_exception("the header of the file " + filePath + " of the GPS recorder could not be written.");
+}
+
+/*!	The writable mapping is populated when it is created, so the first access to each page does not block the streaming
+ * thread.
+ * \param [in] expectedCapacity The number of records the file must have, or zero to accept any valid number.
+ * \return `false` if the file is too short, its header is not valid or it does not have the expected number of records.
+ */
+bool GPSRecorder::MapFile(const std::uint64_t expectedCapacity)
+{
+	struct stat fileStatus;
+	if( fstat(fileDescriptor, &fileStatus)!=0 || std::uint64_t(fileStatus.st_size) < sizeof(FileHeader) )
+		return false;
+
+	FileHeader fileHeader;
+	if( pread(fileDescriptor, &fileHeader, sizeof(fileHeader), 0)!=ssize_t(sizeof(fileHeader)) )
+		return false;
+
+	if( std::memcmp(fileHeader.magic, MAGIC, sizeof(MAGIC))!=0 || fileHeader.version!=VERSION || fileHeader.recordSize!=sizeof(GPSRecord) )
+		return false;
+	if( fileHeader.capacity < MIN_NUM_OF_RECORDS || ( expectedCapacity!=0 && fileHeader.capacity!=expectedCapacity ) )
+		return false;
+	if( std::uint64_t(fileStatus.st_size) < sizeof(FileHeader) + fileHeader.capacity * sizeof(GPSRecord) )
+		return false;
+
+	mapSize = sizeof(FileHeader) + fileHeader.capacity * sizeof(GPSRecord);
+	if(flagReadOnly)
+		mapAddr = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+	else
+		mapAddr = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fileDescriptor, 0);
+	if(mapAddr==MAP_FAILED)
+	{
+		mapAddr=nullptr;
+		rfims_exception exc("the file " + filePath + " of the GPS recorder could not be mapped into memory");
+		exc.Append( strerror(errno) );
+		throw(exc);
+	}
+	if(flagReadOnly)
+		madvise(mapAddr, mapSize, MADV_RANDOM);
+
+	header = (FileHeader*) mapAddr;
+	records = (GPSRecord*) ( (char*) mapAddr + sizeof(FileHeader) );
+	capacity = fileHeader.capacity;
+	return true;
+}
+
+void GPSRecorder::CloseFile()
+{
+	if(mapAddr!=nullptr)
+	{
+		munmap(mapAddr, mapSize);
+		mapAddr=nullptr;
+		header=nullptr;
+		records=nullptr;
+	}
+	if(fileDescriptor >= 0)
+	{
+		close(fileDescriptor);
+		fileDescriptor=-1;
+	}
+}
+
+/*!	The record is copied word by word between two reads of its sequence number, so the copy is only valid if both are
+ * the given sequence number: otherwise the slot holds other record or it was being overwritten.
+ * \param [in] sequence The sequence number of the record.
+ * \param [out] record The copy of the record.
+ * \return `true` if the copy is valid.
+ */
+bool GPSRecorder::ReadRecord(const std::uint64_t sequence, GPSRecord & record) const
+{
+	if(sequence==0)
+		return false;
+
+	const std::uint64_t * slot = (const std::uint64_t*) &records[ (sequence-1) % capacity ];
+	std::uint64_t words[8];
+	const std::uint64_t firstSequence = __atomic_load_n(&slot[7], __ATOMIC_ACQUIRE);
+	if(firstSequence!=sequence)
+		return false;
+	for(unsigned int i=0; i<7; i++)
+		words[i] = __atomic_load_n(&slot[i], __ATOMIC_RELAXED);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	words[7] = __atomic_load_n(&slot[7], __ATOMIC_RELAXED);
+	if(words[7]!=sequence)
+		return false;
+
+	std::memcpy(&record, words, sizeof(record));
+	return true;
+}
+
+std::uint64_t GPSRecorder::LoadNumOfRecords() const
+{
+	if(flagReadOnly)
+		return __atomic_load_n(&header->numOfRecords, __ATOMIC_ACQUIRE);
+	else
+		return numOfRecords.load(std::memory_order_acquire);
+}
+
+/*!	The time of the record is raised to the one of the previous record, if it is earlier, so the times never decrease and
+ * the binary search is valid. The sequence number of the slot is cleared before the other words are written and it is set
+ * after them, and then the number of records of the header is updated.
+ * \param [in] record The record to append. Its sequence number is ignored.
+ */
+void GPSRecorder::Append(const GPSRecord & record)
+{
+	if(flagReadOnly)
+		throw rfims_exception("the file " + filePath + " of the GPS recorder was opened just to look up the records.");
+
+	const std::uint64_t sequence = numOfRecords.load(std::memory_order_relaxed) + 1;
+	GPSRecord newRecord = record;
+	if(newRecord.utcTime < lastTime)
+		newRecord.utcTime = lastTime;
+	lastTime = newRecord.utcTime;
+	newRecord.sequence = sequence;
+
+	std::uint64_t words[8];
+	std::memcpy(words, &newRecord, sizeof(newRecord));
+	std::uint64_t * slot = (std::uint64_t*) &records[ (sequence-1) % capacity ];
+	__atomic_store_n(&slot[7], 0, __ATOMIC_RELAXED);
+	std::atomic_thread_fence(std::memory_order_release);
+	for(unsigned int i=0; i<7; i++)
+		__atomic_store_n(&slot[i], words[i], __ATOMIC_RELAXED);
+	__atomic_store_n(&slot[7], sequence, __ATOMIC_RELEASE);
+
+	__atomic_store_n(&header->numOfRecords, sequence, __ATOMIC_RELEASE);
+	numOfRecords.store(sequence, std::memory_order_release);
+}
+
+/*!	The search is a binary one over the sequence numbers of the records which can be looked up. The oldest record of a
+ * full ring is not used, since it could be overwritten during the search. If a record is overwritten anyway, because the
+ * search was slower than the appending of the whole ring, the search is repeated.
+ * \param [in] utcTime The UTC time, in nanoseconds since 01-01-1970T00:00:00.
+ * \param [out] record The found record.
+ * \return The sequence number of the found record, or zero if the time is earlier than the oldest record.
+ */
+std::uint64_t GPSRecorder::FindSequence(const std::int64_t utcTime, GPSRecord & record) const
+{
+	for(unsigned int attempt=0; attempt<3; attempt++)
+	{
+		const std::uint64_t lastSequence = LoadNumOfRecords();
+		if(lastSequence==0)
+			return 0;
+
+		std::uint64_t low = std::min( GetFirstSequence(lastSequence), lastSequence );
+		std::uint64_t high = lastSequence;
+		GPSRecord candidate, found;
+		if( !ReadRecord(low, found) )
+			continue;
+		if(found.utcTime > utcTime)
+			return 0;
+
+		//The record _low_ is always one whose time is not later than the given one
+		bool flagOverwritten=false;
+		while(low < high)
+		{
+			const std::uint64_t middle = low + (high - low + 1)/2;
+			if( !ReadRecord(middle, candidate) )
+			{
+				flagOverwritten=true;
+				break;
+			}
+			if(candidate.utcTime <= utcTime)
+			{
+				low=middle;
+				found=candidate;
+			}
+			else
+				high=middle-1;
+		}
+
+		if(!flagOverwritten)
+		{
+			record=found;
+			return low;
+		}
+	}
+
+	return 0;
+}
+
+/*!	\param [in] utcTime The UTC time, in nanoseconds since 01-01-1970T00:00:00.
+ * 	\param [out] record The found record.
+ * 	\return `false` if there is not any record whose time is not later than the given one.
+ */
+bool GPSRecorder::Find(const std::int64_t utcTime, GPSRecord & record) const
+{
+	return( FindSequence(utcTime, record)!=0 );
+}
+
+/*!	\param [out] record The oldest record.
+ * 	\return `false` if the file does not have records.
+ */
+bool GPSRecorder::GetOldestRecord(GPSRecord & record) const
+{
+	for(unsigned int attempt=0; attempt<3; attempt++)
+	{
+		const std::uint64_t lastSequence = LoadNumOfRecords();
+		if(lastSequence==0)
+			return false;
+		if( ReadRecord( std::min( GetFirstSequence(lastSequence), lastSequence ), record ) )
+			return true;
+	}
+	return false;
+}
+
+/*!	\param [in] startTime The UTC time of the beginning of the interval, in nanoseconds since 01-01-1970T00:00:00.
+ * 	\param [in] stopTime The UTC time of the end of the interval, in nanoseconds since 01-01-1970T00:00:00.
+ * 	\param [out] recs The vector where the records are appended.
+ * 	\return The number of appended records.
+ */
+std::size_t GPSRecorder::GetRecords(const std::int64_t startTime, const std::int64_t stopTime, std::vector<GPSRecord> & recs) const
+{
+	const std::size_t initialSize = recs.size();
+	const std::uint64_t lastSequence = LoadNumOfRecords();
+	if(lastSequence==0 || stopTime < startTime)
+		return 0;
+
+	GPSRecord record;
+	std::uint64_t sequence = FindSequence(startTime, record);
+	if(sequence==0)
+		sequence = std::min( GetFirstSequence(lastSequence), lastSequence );
+	else if(record.utcTime < startTime)
+		sequence++;
+
+	for( ; sequence <= lastSequence; sequence++)
+	{
+		//The records which were overwritten meanwhile are skipped
+		if( !ReadRecord(sequence, record) )
+			continue;
+		if(record.utcTime > stopTime)
+			break;
+		if(record.utcTime >= startTime)
+			recs.push_back(record);
+	}
+
+	return( recs.size() - initialSize );
+}
@@ -0,0 +1,127 @@
+/*! \file IncrementalArchiveWriter.cpp
+ * 	\brief This file contains the definitions of several methods of the class _IncrementalArchiveWriter_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataStorage.h"
+
+/*!	If there was an archive being built, it is discarded. The archive is always compressed with the XZ format, because
+ * it is the format which allows the concatenation of compressed streams, and with one thread, because the compression
+ * is spread over the time the files are generated.
+ * \param [in] path The path of the final archive.
+ * \param [in] sweepsFilename The name of the sweeps file inside the archive.
+ */
+void IncrementalArchiveWriter::Open(const std::string & path, const std::string & sweepsFilename)
+{
+	Abort();
+
+	archivePath = path;
+	sweepsName = sweepsFilename;
+
+	entries.SetCompression(CompressedFileWriter::XZ, preset, 1);
+	sweepsText.SetParameters(CompressedFileWriter::XZ, preset, 1);
+	trailer.SetParameters(CompressedFileWriter::XZ, preset, 1);
+
+	entries.Open( GetPartPath() );
+	try
+	{
+		sweepsText.Open( GetSweepsPartPath() );
+	}
+	catch(std::exception & exc)
+	{
+		entries.Abort();
+		throw;
+	}
+
+	flagOpen=true;
+}
+
+/*!	The compressed streams are concatenated in the following order: the stream with the complete entries, a stream with
+ * the header of the sweeps file, the stream with the text of the sweeps file and a stream with the padding of the sweeps
+ * file and the end of the archive. If something fails, the archive is discarded.
+ */
+void IncrementalArchiveWriter::Close()
+{
+	if(!flagOpen)
+		return;
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	try
+	{
+		entries.Close(false);
+		sweepsText.Close();
+		const std::uint64_t sweepsSize = sweepsText.GetStatistics().numOfInputBytes;
+
+		stats = entries.GetStatistics();
+		stats.numOfInputBytes += sweepsSize;
+		stats.numOfOutputBytes += sweepsText.GetStatistics().numOfOutputBytes;
+		stats.elapsedTime += sweepsText.GetStatistics().elapsedTime;
+
+		//Appending the header of the sweeps file
+		trailer.Open(GetPartPath(), true);
+		trailer.Write( TarArchiveWriter::MakeHeader(sweepsName, sweepsSize) );
+		trailer.Close();
+		stats.numOfInputBytes += trailer.GetStatistics().numOfInputBytes;
+		stats.numOfOutputBytes += trailer.GetStatistics().numOfOutputBytes;
+
+		//Appending the compressed text of the sweeps file, as it is
+		{
+			BufferedFileWriter archiveFile;
+			archiveFile.Open(GetPartPath(), true);
+			int fd = open(GetSweepsPartPath().c_str(), O_RDONLY);
+			if(fd < 0)
+				throw( rfims_exception("the temporary file " + GetSweepsPartPath() + " could not be opened.") );
+			std::vector<char> buffer(65536);
+			ssize_t readBytes;
+			while( (readBytes = read( fd, buffer.data(), buffer.size() )) != 0 )
+			{
+				if(readBytes < 0)
+				{
+					if(errno==EINTR)
+						continue;
+					close(fd);
+					throw( rfims_exception("the temporary file " + GetSweepsPartPath() + " could not be read.") );
+				}
+				archiveFile.Write(buffer.data(), readBytes);
+			}
+			close(fd);
+			archiveFile.Close();
+		}
+
+		//Appending the padding of the sweeps file and the end of the archive
+		trailer.Open(GetPartPath(), true);
+		trailer.Write( std::string(TarArchiveWriter::GetPaddingSize(sweepsSize) + 1024, '\0') );
+		trailer.Close();
+		stats.numOfInputBytes += trailer.GetStatistics().numOfInputBytes;
+		stats.numOfOutputBytes += trailer.GetStatistics().numOfOutputBytes;
+
+		if( std::rename( GetPartPath().c_str(), archivePath.c_str() )!=0 )
+			throw( rfims_exception("the archive " + GetPartPath() + " could not be renamed.") );
+		std::remove( GetSweepsPartPath().c_str() );
+	}
+	catch(std::exception & exc)
+	{
+		Abort();
+		throw;
+	}
+
+	flagOpen=false;
+
+	closingTime = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count();
+	stats.elapsedTime += closingTime;
+}
+
+/*!	If there is no archive being built, this method does nothing.	*/
+void IncrementalArchiveWriter::Abort()
+{
+	if(flagOpen)
+	{
+		entries.Abort();
+		sweepsText.Abort();
+		trailer.Abort();
+		std::remove( GetPartPath().c_str() );
+		std::remove( GetSweepsPartPath().c_str() );
+		flagOpen=false;
+	}
+}
@@ -0,0 +1,602 @@
+/*! \file MeasurementIndex.cpp
+ * 	\brief This file contains the definitions of several methods of the class _MeasurementIndex_ and of the structure
+ * 	_MeasurementQuery_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataStorage.h"
+
+////////////////////Friends functions////////////////////////
+
+//! The function which is executed by each thread which indexes or queries files concurrently.
+void *IndexThreadFunc(void *arg)
+{
+	auto * indexPtr = (MeasurementIndex*) arg;
+
+	indexPtr->ProcessTasks();
+
+	return NULL;
+}
+
+//////////////////Class' methods////////////////////
+
+MeasurementQuery::MeasurementQuery()
+{
+	stopTime.year=9999; stopTime.month=12; stopTime.day=31;
+	stopTime.hour=23; stopTime.minute=59; stopTime.second=59;
+	flagAzimuth=false;
+	azimuthAngle=0.0;
+	azimuthTolerance=1.0;
+	startFreq=0;
+	stopFreq=std::numeric_limits<std::uint64_t>::max();
+	flagOnlyRFI=false;
+}
+
+MeasurementIndex::MeasurementIndex()
+{
+	numOfThreads = std::max( sysconf(_SC_NPROCESSORS_ONLN), 1L );
+	numOfTasks=0;
+	nextTask=0;
+	pthread_mutex_init(&mutex, NULL);
+}
+
+/*!	If the index file cannot be interpreted, the index is left empty, so all the files are indexed again by the next call
+ * to Update().
+ * \param [in] folderPath The path of the folder where the measurements files are.
+ * \param [in] filePath The path of the index file.
+ */
+void MeasurementIndex::Open(const std::string & folderPath, const std::string & filePath)
+{
+	measurementsPath = folderPath;
+	indexPath = filePath;
+	files.clear();
+
+	std::ifstream ifs(indexPath);
+	if( !ifs.is_open() )
+		return;
+
+	try
+	{
+		std::string line;
+		std::size_t remainingRecords=0;
+		while( std::getline(ifs, line) )
+		{
+			std::istringstream iss(line);
+			char lineType;
+			iss >> lineType;
+
+			if(lineType=='F' && remainingRecords==0)
+			{
+				FileEntry fileEntry;
+				std::size_t numOfBands;
+				iss >> fileEntry.cycleTimestamp >> fileEntry.storeSize >> fileEntry.rfiSize >> fileEntry.version >> fileEntry.numOfPoints;
+				iss >> remainingRecords >> numOfBands;
+				for(std::size_t b=0; b<numOfBands; b++)
+				{
+					std::pair<float, float> band;
+					char colon;
+					iss >> band.first >> colon >> band.second;
+					fileEntry.bands.push_back(band);
+				}
+				if(!iss)
+					throw rfims_exception("a file line is not valid");
+				fileEntry.cycleTime.SetTimestamp(fileEntry.cycleTimestamp);
+				fileEntry.records.reserve(remainingRecords);
+				files.push_back( std::move(fileEntry) );
+			}
+			else if(lineType=='R' && remainingRecords>0)
+			{
+				RecordEntry recordEntry;
+				std::string timestamp;
+				unsigned int polarization, flagKey;
+				iss >> recordEntry.offset >> timestamp >> recordEntry.azimuthAngle >> polarization >> flagKey >> std::hex >> recordEntry.rfiBands;
+				if(!iss)
+					throw rfims_exception("a record line is not valid");
+				recordEntry.timeData.SetTimestamp(timestamp);
+				recordEntry.polarization = polarization;
+				recordEntry.flagKey = (flagKey!=0);
+				files.back().records.push_back(recordEntry);
+				remainingRecords--;
+			}
+			else
+				throw rfims_exception("the lines are not in the expected order");
+		}
+
+		if(remainingRecords > 0)
+			throw rfims_exception("the last file is incomplete");
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "\nWarning: the query index " << indexPath << " is not valid and it will be built again: " << exc.what() << endl;
+		files.clear();
+	}
+}
+
+/*!	The file is written to a temporary file, which is synchronized with the storage device and then renamed, so the index
+ * file is always complete.
+ */
+void MeasurementIndex::Save() const
+{
+	if( indexPath.empty() )
+		throw rfims_exception("the query index was asked to be saved but it has not a file.");
+
+	std::ostringstream oss;
+	oss << std::setprecision(9);
+	for(const auto & fileEntry : files)
+	{
+		oss << "F " << fileEntry.cycleTimestamp << ' ' << fileEntry.storeSize << ' ' << fileEntry.rfiSize << ' ' << fileEntry.version;
+		oss << ' ' << fileEntry.numOfPoints << ' ' << fileEntry.records.size() << ' ' << fileEntry.bands.size();
+		for(const auto & band : fileEntry.bands)
+			oss << ' ' << band.first << ':' << band.second;
+		oss << '\n';
+
+		for(const auto & recordEntry : fileEntry.records)
+		{
+			oss << "R " << recordEntry.offset << ' ' << recordEntry.timeData.GetTimestamp() << ' ' << recordEntry.azimuthAngle;
+			oss << ' ' << unsigned(recordEntry.polarization) << ' ' << (recordEntry.flagKey ? 1 : 0);
+			oss << ' ' << std::hex << recordEntry.rfiBands << std::dec << '\n';
+		}
+	}
+	const std::string text = oss.str();
+
+	const std::string tempPath = indexPath + ".tmp";
+	int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0)
+		throw rfims_exception("the query index file " + tempPath + " could not be created.");
+
+	std::size_t writtenBytes=0;
+	while( writtenBytes < text.size() )
+	{
+		ssize_t ret = write( fd, text.data() + writtenBytes, text.size() - writtenBytes );
+		if(ret < 0 && errno==EINTR)
+			continue;
+		if(ret < 0)
+		{
+			close(fd);
+			throw rfims_exception("the query index file " + tempPath + " could not be written.");
+		}
+		writtenBytes += ret;
+	}
+
+	if( fdatasync(fd)!=0 || close(fd)!=0 )
+		throw rfims_exception("the query index file " + tempPath + " could not be synchronized.");
+
+	if( std::rename( tempPath.c_str(), indexPath.c_str() )!=0 )
+		throw rfims_exception("the query index file " + tempPath + " could not be renamed.");
+}
+
+/*!	A file is indexed again when the size of its sweeps store or the size of its RFI file changed since it was indexed,
+ * what happens with the files of the measurement cycle which is being saved. The files which cannot be indexed are
+ * reported with a warning and they are tried again by the next call.
+ * \return The number of files which were indexed.
+ */
+std::size_t MeasurementIndex::Update()
+{
+	std::map<std::string, const FileEntry*> oldFiles;
+	for(const auto & fileEntry : files)
+		oldFiles[fileEntry.cycleTimestamp] = &fileEntry;
+
+	std::vector<FileEntry> newFiles;
+	std::vector<std::size_t> filesToIndex;
+	for( const auto & dirEntry : boost::filesystem::directory_iterator(measurementsPath) )
+	{
+		const std::string filename = dirEntry.path().filename().string();
+		if( filename.size() <= 11 || filename.compare(0, 7, "sweeps_")!=0 || filename.compare(filename.size()-4, 4, ".bin")!=0 )
+			continue;
+
+		FileEntry fileEntry;
+		fileEntry.cycleTimestamp = filename.substr(7, filename.size()-11);
+		boost::system::error_code errorCode;
+		fileEntry.storeSize = boost::filesystem::file_size( dirEntry.path(), errorCode );
+		if(errorCode)
+			continue;
+		fileEntry.rfiSize = boost::filesystem::file_size( GetRFIPath(fileEntry.cycleTimestamp), errorCode );
+		if(errorCode)
+			fileEntry.rfiSize=0;
+
+		auto oldFileIt = oldFiles.find(fileEntry.cycleTimestamp);
+		if( oldFileIt!=oldFiles.end() && oldFileIt->second->storeSize==fileEntry.storeSize && oldFileIt->second->rfiSize==fileEntry.rfiSize )
+			newFiles.push_back( *(oldFileIt->second) );
+		else
+		{
+			try
+			{
+				fileEntry.cycleTime.SetTimestamp(fileEntry.cycleTimestamp);
+			}
+			catch(std::exception & exc)
+			{
+				cerr << "\nWarning: the file " << filename << " does not have a valid timestamp and it will not be indexed." << endl;
+				continue;
+			}
+			filesToIndex.push_back( newFiles.size() );
+			newFiles.push_back( std::move(fileEntry) );
+		}
+	}
+
+	RunTasks( filesToIndex.size(), [this, &newFiles, &filesToIndex](std::size_t i)
+	{
+		FileEntry & fileEntry = newFiles[ filesToIndex[i] ];
+		try
+		{
+			IndexFile(fileEntry);
+		}
+		catch(std::exception & exc)
+		{
+			//The entry is kept without records and with a size which forces it to be indexed again the next time
+			fileEntry.storeSize=0;
+			fileEntry.records.clear();
+			rfims_exception indexExc("the sweeps store of the cycle " + fileEntry.cycleTimestamp + " could not be indexed");
+			indexExc.Append( exc.what() );
+			throw(indexExc);
+		}
+	});
+
+	for(const auto & message : errorMessages)
+		cerr << "\nWarning: " << message << endl;
+
+	std::stable_sort( newFiles.begin(), newFiles.end(), [](const FileEntry & lhs, const FileEntry & rhs) {	return( lhs.cycleTime < rhs.cycleTime );	} );
+	files = std::move(newFiles);
+	Save();
+
+	return filesToIndex.size();
+}
+
+/*!	Only the part of the sweeps store which existed when its size was taken is indexed, and the last record is ignored if
+ * it is incomplete. The records of the files whose power values are encoded are not decoded, they are just skipped
+ * with the sizes which are saved in their headers.
+ * \param [in,out] fileEntry The entry of the file, with its timestamp and sizes, where the records are saved.
+ */
+void MeasurementIndex::IndexFile(FileEntry & fileEntry) const
+{
+	const std::string storePath = GetStorePath(fileEntry.cycleTimestamp);
+	int fd = open(storePath.c_str(), O_RDONLY);
+	if(fd < 0)
+		throw rfims_exception("the sweeps store file " + storePath + " could not be opened.");
+
+	if( fileEntry.storeSize < sizeof(SweepStoreFileHeader) )
+	{
+		close(fd);
+		throw rfims_exception("the sweeps store file " + storePath + " is too short.");
+	}
+
+	void * addr = mmap(nullptr, fileEntry.storeSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(addr == MAP_FAILED)
+		throw rfims_exception("the sweeps store file " + storePath + " could not be mapped into memory.");
+	const char * mapAddr = (const char*) addr;
+	const std::size_t mapSize = fileEntry.storeSize;
+	auto header = (const SweepStoreFileHeader*) mapAddr;
+
+	const std::size_t rawRecordSize = sizeof(SweepStoreRecordHeader) + std::size_t(header->numOfPoints)*sizeof(float);
+	if( !std::equal(header->magic, header->magic+8, "RFIMSSWP") || (header->version!=1 && header->version!=2) ||
+			header->headerSize!=sizeof(SweepStoreFileHeader) + header->numOfBands*sizeof(SweepStoreBandRecord) + std::size_t(header->numOfPoints)*sizeof(std::uint64_t) ||
+			header->recordSize!=(header->version==1 ? rawRecordSize : 0) || mapSize < header->headerSize )
+	{
+		munmap(addr, mapSize);
+		throw rfims_exception("the file " + storePath + " is not a valid sweeps store file.");
+	}
+
+	fileEntry.version = header->version;
+	fileEntry.numOfPoints = header->numOfPoints;
+	fileEntry.bands.clear();
+	auto bandRecord = (const SweepStoreBandRecord*) ( mapAddr + sizeof(SweepStoreFileHeader) );
+	for(unsigned int b=0; b < header->numOfBands; b++, bandRecord++)
+		fileEntry.bands.push_back( std::make_pair(bandRecord->startFreq, bandRecord->stopFreq) );
+
+	fileEntry.records.clear();
+	std::size_t offset = header->headerSize;
+	while( mapSize - offset >= sizeof(SweepStoreRecordHeader) )
+	{
+		auto recordHeader = (const SweepStoreRecordHeader*) ( mapAddr + offset );
+		const std::size_t valuesOffset = offset + sizeof(SweepStoreRecordHeader);
+		const std::size_t valuesSize = (header->version==1) ? rawRecordSize - sizeof(SweepStoreRecordHeader) : recordHeader->reserved;
+		if( valuesSize > mapSize - valuesOffset || (header->version==2 && valuesSize==0) )
+			break;
+
+		RecordEntry recordEntry;
+		recordEntry.offset = offset;
+		recordEntry.timeData.year = recordHeader->year;
+		recordEntry.timeData.month = recordHeader->month;
+		recordEntry.timeData.day = recordHeader->day;
+		recordEntry.timeData.hour = recordHeader->hour;
+		recordEntry.timeData.minute = recordHeader->minute;
+		recordEntry.timeData.second = recordHeader->second;
+		recordEntry.azimuthAngle = recordHeader->azimuthAngle;
+		recordEntry.polarization = recordHeader->polarization;
+		recordEntry.flagKey = ( header->version==1 || std::uint8_t(mapAddr[valuesOffset])!=SweepCodec::INTER );
+		recordEntry.rfiBands = 0;
+		fileEntry.records.push_back(recordEntry);
+
+		offset = valuesOffset + valuesSize;
+	}
+
+	munmap(addr, mapSize);
+
+	if(fileEntry.rfiSize > 0)
+		IndexRFI( GetRFIPath(fileEntry.cycleTimestamp), fileEntry );
+}
+
+/*!	The RFI file of a cycle has a section per sweep with RFI, which starts with a line "#RFI_x.csv" and has a header line
+ * with the frequencies (MHz) where RFI was detected and a line whose first field is the RFI index _x_, i.e. the index of
+ * the sweep plus one. Each frequency sets the bit of the band which contains it. Only the part of the file which existed
+ * when its size was taken is read, and the sections which are not complete are ignored.
+ * \param [in] rfiPath The path of the RFI file.
+ * \param [in,out] fileEntry The entry of the file, whose records were already indexed.
+ */
+void MeasurementIndex::IndexRFI(const std::string & rfiPath, FileEntry & fileEntry) const
+{
+	std::ifstream ifs(rfiPath, std::ifstream::in | std::ifstream::binary);
+	if( !ifs.is_open() )
+		throw rfims_exception("the RFI file " + rfiPath + " could not be opened.");
+	std::string text( fileEntry.rfiSize, '\0' );
+	ifs.read( &text[0], text.size() );
+	text.resize( ifs.gcount() );
+
+	const double BAND_MARGIN = 1e3; //The band limits are saved as `float`, so a small margin is used
+	std::istringstream iss(text);
+	std::string line;
+	std::uint64_t sectionBands=0;
+	enum {NAME, HEADER, DATA} expectedLine = NAME;
+	while( std::getline(iss, line) )
+	{
+		if( !line.empty() && line.back()=='\r' )
+			line.pop_back();
+
+		if( !line.empty() && line[0]=='#' )
+		{
+			expectedLine = HEADER;
+			continue;
+		}
+
+		if(expectedLine==HEADER)
+		{
+			//The frequencies follow the fields "RFI Index,Timestamp,Azimuthal Angle,Polarization"
+			sectionBands=0;
+			std::size_t fieldIndex=0, start=0, comma;
+			do
+			{
+				comma = line.find(',', start);
+				if(fieldIndex >= 4)
+				{
+					const double frequency = std::strtod( line.c_str() + start, nullptr ) * 1e6;
+					for(std::size_t b=0; b < fileEntry.bands.size() && b < MAX_NUM_OF_BANDS; b++)
+						if( frequency >= fileEntry.bands[b].first - BAND_MARGIN && frequency <= fileEntry.bands[b].second + BAND_MARGIN )
+							sectionBands |= std::uint64_t(1) << b;
+				}
+				fieldIndex++;
+				start = comma + 1;
+			}while( comma!=std::string::npos );
+			expectedLine = DATA;
+		}
+		else if(expectedLine==DATA)
+		{
+			//The data line is only complete if it ends with "\r\n", i.e. it was followed by a line break
+			const unsigned long rfiIndex = std::strtoul( line.c_str(), nullptr, 10 );
+			if( !iss.eof() && rfiIndex>=1 && rfiIndex <= fileEntry.records.size() )
+				fileEntry.records[rfiIndex-1].rfiBands |= sectionBands;
+			expectedLine = NAME;
+		}
+	}
+}
+
+/*!	The file is only read if any record meets the conditions of the query. The values of the records are extracted
+ * directly from the mapped file, when they are not encoded, or decoded from the last key record before the first match.
+ * \param [in] fileEntry The entry of the file in the index.
+ * \param [in] query The conditions of the query.
+ * \param [out] result The records which met the conditions.
+ */
+void MeasurementIndex::QueryFile(const FileEntry & fileEntry, const MeasurementQuery & query, QueryResult & result) const
+{
+	result.cycleTimestamp = fileEntry.cycleTimestamp;
+
+	//The mask of the bands which overlap the frequency range of the query
+	std::uint64_t bandsMask=0;
+	for(std::size_t b=0; b < fileEntry.bands.size() && b < MAX_NUM_OF_BANDS; b++)
+		if( double(fileEntry.bands[b].second) >= double(query.startFreq) && double(fileEntry.bands[b].first) <= double(query.stopFreq) )
+			bandsMask |= std::uint64_t(1) << b;
+
+	//The records which meet the conditions are searched in the index
+	const char * polarizationNames[] = {"horizontal", "vertical", ""};
+	std::vector<std::size_t> matches;
+	for(std::size_t r=0; r < fileEntry.records.size(); r++)
+	{
+		const RecordEntry & recordEntry = fileEntry.records[r];
+		if( recordEntry.timeData < query.startTime || recordEntry.timeData > query.stopTime )
+			continue;
+		if( !query.polarization.empty() && query.polarization != polarizationNames[ std::min<unsigned int>(recordEntry.polarization, 2) ] )
+			continue;
+		if(query.flagAzimuth)
+		{
+			float difference = std::fmod( std::fabs( recordEntry.azimuthAngle - query.azimuthAngle ), 360.0f );
+			if( std::min(difference, 360.0f - difference) > query.azimuthTolerance )
+				continue;
+		}
+		if( query.flagOnlyRFI && (recordEntry.rfiBands & bandsMask)==0 )
+			continue;
+		matches.push_back(r);
+	}
+
+	if( matches.empty() )
+		return;
+
+	//The file is mapped and it is checked it was not changed since it was indexed
+	const std::string storePath = GetStorePath(fileEntry.cycleTimestamp);
+	int fd = open(storePath.c_str(), O_RDONLY);
+	if(fd < 0)
+		throw rfims_exception("the sweeps store file " + storePath + " could not be opened.");
+
+	struct stat fileStatus;
+	if( fstat(fd, &fileStatus) < 0 || std::uint64_t(fileStatus.st_size) < fileEntry.storeSize )
+	{
+		close(fd);
+		throw rfims_exception("the sweeps store file " + storePath + " is shorter than when it was indexed.");
+	}
+
+	void * addr = mmap(nullptr, fileEntry.storeSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(addr == MAP_FAILED)
+		throw rfims_exception("the sweeps store file " + storePath + " could not be mapped into memory.");
+	const char * mapAddr = (const char*) addr;
+	auto header = (const SweepStoreFileHeader*) mapAddr;
+	if( header->numOfPoints!=fileEntry.numOfPoints || header->numOfBands!=fileEntry.bands.size() )
+	{
+		munmap(addr, fileEntry.storeSize);
+		throw rfims_exception("the sweeps store file " + storePath + " changed since it was indexed.");
+	}
+	madvise(addr, fileEntry.storeSize, MADV_RANDOM);
+
+	//The frequency columns are selected
+	const std::size_t numOfPoints = fileEntry.numOfPoints;
+	auto frequencies = (const std::uint64_t*) ( mapAddr + sizeof(SweepStoreFileHeader) + header->numOfBands*sizeof(SweepStoreBandRecord) );
+	std::vector<std::size_t> columns;
+	if(query.startFreq == query.stopFreq)
+	{
+		std::size_t nearest=0;
+		for(std::size_t i=1; i<numOfPoints; i++)
+			if( std::llabs( std::int64_t(frequencies[i] - query.startFreq) ) < std::llabs( std::int64_t(frequencies[nearest] - query.startFreq) ) )
+				nearest=i;
+		if(numOfPoints > 0)
+			columns.push_back(nearest);
+	}
+	else
+		for(std::size_t i=0; i<numOfPoints; i++)
+			if( frequencies[i] >= query.startFreq && frequencies[i] <= query.stopFreq )
+				columns.push_back(i);
+
+	for(const auto column : columns)
+		result.frequencies.push_back( frequencies[column] );
+
+	//The values are extracted
+	SweepCodec codec;
+	std::vector<float> decodedValues( fileEntry.version==2 ? numOfPoints : 0 );
+	std::size_t nextRecord=0;
+	try
+	{
+		for(const auto r : matches)
+		{
+			const RecordEntry & recordEntry = fileEntry.records[r];
+			const char * recordValues = mapAddr + recordEntry.offset + sizeof(SweepStoreRecordHeader);
+			const float * values = (const float*) recordValues;
+
+			if(fileEntry.version==2)
+			{
+				//The decoding restarts at the last key record if it is after the last decoded record
+				std::size_t keyRecord = r;
+				while( keyRecord > nextRecord && !fileEntry.records[keyRecord].flagKey )
+					keyRecord--;
+				nextRecord = keyRecord;
+
+				for(; nextRecord <= r; nextRecord++)
+				{
+					const std::uint64_t offset = fileEntry.records[nextRecord].offset;
+					auto recordHeader = (const SweepStoreRecordHeader*) ( mapAddr + offset );
+					codec.Decode(mapAddr + offset + sizeof(SweepStoreRecordHeader), recordHeader->reserved, decodedValues.data(), numOfPoints);
+				}
+				values = decodedValues.data();
+			}
+
+			QueryResult::Record record;
+			record.index = r;
+			record.timeData = recordEntry.timeData;
+			record.azimuthAngle = recordEntry.azimuthAngle;
+			record.polarization = polarizationNames[ std::min<unsigned int>(recordEntry.polarization, 2) ];
+			record.rfiBands = recordEntry.rfiBands;
+			record.values.reserve( columns.size() );
+			for(const auto column : columns)
+				record.values.push_back( values[column] );
+			result.records.push_back( std::move(record) );
+		}
+	}
+	catch(std::exception & exc)
+	{
+		munmap(addr, fileEntry.storeSize);
+		throw;
+	}
+
+	munmap(addr, fileEntry.storeSize);
+}
+
+/*!	The files are queried by several threads. The files which cannot be queried are reported with a warning and their
+ * records are not returned.
+ * \param [in] query The conditions of the query.
+ * \return The records which met the conditions, grouped by measurement cycle and sorted by the timestamps of the cycles.
+ */
+std::vector<QueryResult> MeasurementIndex::Query(const MeasurementQuery & query)
+{
+	std::vector<QueryResult> results( files.size() );
+
+	RunTasks( files.size(), [this, &query, &results](std::size_t i)
+	{
+		try
+		{
+			QueryFile(files[i], query, results[i]);
+		}
+		catch(std::exception & exc)
+		{
+			results[i].records.clear();
+			throw;
+		}
+	});
+
+	for(const auto & message : errorMessages)
+		cerr << "\nWarning: " << message << endl;
+
+	auto newEnd = std::remove_if( results.begin(), results.end(), [](const QueryResult & result) {	return result.records.empty();	} );
+	results.erase( newEnd, results.end() );
+	return results;
+}
+
+/*!	If no thread could be created, the tasks are run by the calling thread. The errors of the tasks are saved in the
+ * attribute _errorMessages_, so a failure of a file does not stop the processing of the others.
+ * \param [in] numOfFiles The number of tasks.
+ * \param [in] function The function which is called with the index of each task.
+ */
+void MeasurementIndex::RunTasks(const std::size_t numOfFiles, const std::function<void(std::size_t)> & function)
+{
+	task = function;
+	numOfTasks = numOfFiles;
+	nextTask = 0;
+	errorMessages.clear();
+
+	std::vector<pthread_t> threads;
+	for(std::size_t i=0; i < std::min<std::size_t>(numOfThreads, numOfTasks); i++)
+	{
+		pthread_t thread;
+		if( pthread_create(&thread, NULL, IndexThreadFunc, (void*)this)==0 )
+			threads.push_back(thread);
+	}
+
+	if( threads.empty() )
+		ProcessTasks();
+
+	for(auto & thread : threads)
+		pthread_join(thread, NULL);
+
+	task = nullptr;
+}
+
+void MeasurementIndex::ProcessTasks()
+{
+	while(true)
+	{
+		pthread_mutex_lock(&mutex);
+		if(nextTask >= numOfTasks)
+		{
+			pthread_mutex_unlock(&mutex);
+			break;
+		}
+		const std::size_t taskIndex = nextTask++;
+		pthread_mutex_unlock(&mutex);
+
+		try
+		{
+			task(taskIndex);
+		}
+		catch(std::exception & exc)
+		{
+			pthread_mutex_lock(&mutex);
+			errorMessages.push_back( exc.what() );
+			pthread_mutex_unlock(&mutex);
+		}
+	}
+}
@@ -0,0 +1,313 @@
+/*! \file MeasurementJournal.cpp
+ * 	\brief This file contains the definitions of several methods of the class _MeasurementJournal_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataStorage.h"
+
+MeasurementJournal::MeasurementJournal()
+{
+	fd=-1;
+	numOfPendingRecords=0;
+	commitInterval=0;
+	lastCommitTime=std::chrono::steady_clock::now();
+	numOfCommits=0;
+	numOfCommittedRecords=0;
+	pthread_mutex_init(&mutex, NULL);
+}
+
+MeasurementJournal::~MeasurementJournal()
+{
+	try
+	{
+		Close();
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "\nWarning: " << exc.what() << endl;
+	}
+	pthread_mutex_destroy(&mutex);
+}
+
+/*!	\param [in] record The record to be serialized.
+ * \param [out] output The string where the serialized record is appended: the size of the body, the body and its CRC32.
+ */
+void MeasurementJournal::Serialize(const Record & record, std::string & output)
+{
+	const std::uint8_t type = record.type;
+	const std::uint8_t timestampLength = std::min<std::size_t>(record.timestamp.size(), 255);
+	const std::uint16_t filenameLength = std::min<std::size_t>(record.filename.size(), 65535);
+
+	std::string body;
+	body.append( (const char*) &type, sizeof(type) );
+	body.append( (const char*) &record.value, sizeof(record.value) );
+	body.append( (const char*) &timestampLength, sizeof(timestampLength) );
+	body.append( record.timestamp, 0, timestampLength );
+	body.append( (const char*) &filenameLength, sizeof(filenameLength) );
+	body.append( record.filename, 0, filenameLength );
+
+	const std::uint32_t bodySize = body.size();
+	const std::uint32_t crc = lzma_crc32( (const std::uint8_t*) body.data(), body.size(), 0 );
+	output.append( (const char*) &bodySize, sizeof(bodySize) );
+	output.append(body);
+	output.append( (const char*) &crc, sizeof(crc) );
+}
+
+/*!	\param [in] fileDesc The file descriptor.
+ * \param [in] data The bytes to be written.
+ */
+void MeasurementJournal::WriteToFile(const int fileDesc, const std::string & data) const
+{
+	std::size_t writtenBytes=0;
+	while( writtenBytes < data.size() )
+	{
+		ssize_t ret = write( fileDesc, data.data() + writtenBytes, data.size() - writtenBytes );
+		if(ret < 0 && errno==EINTR)
+			continue;
+		if(ret < 0)
+		{
+			rfims_exception exc("the journal file " + path + " could not be written");
+			exc.Append( strerror(errno) );
+			throw(exc);
+		}
+		writtenBytes += ret;
+	}
+}
+
+/*!	The records are read until the end of the file or until a record which is not complete or whose CRC32 is not correct,
+ * which is the last one the software was writing when the power was cut. In that case, the file is truncated after the
+ * last valid record, so the new records are appended after it. If the file does not exist, it is created. If there was a
+ * file open, it is closed before.
+ * \param [in] journalPath The path of the journal file.
+ * \return The valid records of the journal, in the order they were appended.
+ */
+std::vector<MeasurementJournal::Record> MeasurementJournal::Open(const std::string & journalPath)
+{
+	Close();
+
+	std::vector<Record> records;
+	std::uint64_t validSize=0;
+
+	std::ifstream ifs( journalPath, std::ifstream::in | std::ifstream::binary );
+	if( ifs.is_open() )
+	{
+		std::string data( (std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>() );
+		ifs.close();
+
+		if( data.compare(0, MAGIC.size(), MAGIC)==0 )
+		{
+			std::size_t pos = MAGIC.size();
+			validSize = pos;
+			while( data.size() - pos >= 2*sizeof(std::uint32_t) )
+			{
+				std::uint32_t bodySize, crc;
+				std::memcpy( &bodySize, data.data() + pos, sizeof(bodySize) );
+				if( bodySize > MAX_BODY_SIZE || data.size() - pos < bodySize + 2*sizeof(std::uint32_t) )
+					break;
+				const char * body = data.data() + pos + sizeof(bodySize);
+				std::memcpy( &crc, body + bodySize, sizeof(crc) );
+				if( lzma_crc32( (const std::uint8_t*) body, bodySize, 0 )!=crc )
+					break;
+
+				//The body is parsed, checking the lengths of the strings are consistent with its size
+				Record record;
+				std::uint8_t type, timestampLength;
+				std::uint16_t filenameLength;
+				const std::size_t fixedSize = sizeof(type) + sizeof(record.value) + sizeof(timestampLength) + sizeof(filenameLength);
+				if( bodySize < fixedSize )
+					break;
+				std::size_t bodyPos=0;
+				std::memcpy( &type, body + bodyPos, sizeof(type) );	bodyPos += sizeof(type);
+				std::memcpy( &record.value, body + bodyPos, sizeof(record.value) );	bodyPos += sizeof(record.value);
+				std::memcpy( &timestampLength, body + bodyPos, sizeof(timestampLength) );	bodyPos += sizeof(timestampLength);
+				if( bodyPos + timestampLength + sizeof(filenameLength) > bodySize )
+					break;
+				record.timestamp.assign( body + bodyPos, timestampLength );	bodyPos += timestampLength;
+				std::memcpy( &filenameLength, body + bodyPos, sizeof(filenameLength) );	bodyPos += sizeof(filenameLength);
+				if( bodyPos + filenameLength != bodySize )
+					break;
+				record.filename.assign( body + bodyPos, filenameLength );
+				record.type = (RecordType) type;
+				records.push_back(record);
+
+				pos += bodySize + 2*sizeof(std::uint32_t);
+				validSize = pos;
+			}
+
+			if( validSize < data.size() )
+				cerr << "\nWarning: the last " << ( data.size() - validSize ) << " bytes of the journal " << journalPath << " were incomplete or corrupt and they were discarded." << endl;
+		}
+		else if( !data.empty() )
+			cerr << "\nWarning: the file " << journalPath << " is not a valid journal and it will be overwritten." << endl;
+	}
+
+	fd = open( journalPath.c_str(), O_WRONLY | O_CREAT, 0644 );
+	if(fd < 0)
+	{
+		rfims_exception exc("the journal file " + journalPath + " could not be opened");
+		exc.Append( strerror(errno) );
+		throw(exc);
+	}
+	path = journalPath;
+
+	//The invalid tail is removed and, if the file is new or it was not valid, the magic bytes are written
+	if( ftruncate(fd, validSize)!=0 || lseek(fd, 0, SEEK_END) < 0 )
+	{
+		close(fd);
+		fd=-1;
+		throw rfims_exception("the journal file " + journalPath + " could not be truncated.");
+	}
+	if(validSize==0)
+	{
+		WriteToFile(fd, MAGIC);
+		if( fdatasync(fd)!=0 )
+			throw rfims_exception("the journal file " + journalPath + " could not be synchronized.");
+	}
+
+	lastCommitTime = std::chrono::steady_clock::now();
+	return records;
+}
+
+/*!	The records are written to a temporary file, which is synchronized with the storage device and then renamed, so the
+ * journal file is always complete. The records which were pending are discarded, because the given records replace the
+ * whole content of the journal.
+ * \param [in] records The new records of the journal.
+ */
+void MeasurementJournal::Rewrite(const std::vector<Record> & records)
+{
+	if( path.empty() )
+		throw rfims_exception("the journal was asked to be rewritten but it has not a file.");
+
+	std::string data(MAGIC);
+	for(const auto & record : records)
+		Serialize(record, data);
+
+	pthread_mutex_lock(&mutex);
+
+	const std::string tempPath = path + ".tmp";
+	int tempFd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(tempFd < 0)
+	{
+		pthread_mutex_unlock(&mutex);
+		throw rfims_exception("the journal file " + tempPath + " could not be created.");
+	}
+
+	try
+	{
+		WriteToFile(tempFd, data);
+	}
+	catch(std::exception & exc)
+	{
+		close(tempFd);
+		pthread_mutex_unlock(&mutex);
+		throw;
+	}
+
+	if( fdatasync(tempFd)!=0 || close(tempFd)!=0 || std::rename( tempPath.c_str(), path.c_str() )!=0 )
+	{
+		pthread_mutex_unlock(&mutex);
+		throw rfims_exception("the journal file " + tempPath + " could not be synchronized or renamed.");
+	}
+
+	//The new file is used from now on
+	if(fd >= 0)
+		close(fd);
+	fd = open( path.c_str(), O_WRONLY | O_APPEND );
+	pendingRecords.clear();
+	numOfPendingRecords=0;
+
+	pthread_mutex_unlock(&mutex);
+
+	if(fd < 0)
+		throw rfims_exception("the journal file " + path + " could not be opened again.");
+}
+
+/*!	The record is not written to the file until the next call to the method Commit(), so several records are written
+ * and synchronized with one system call of each type. If there is no journal file open, the record is ignored.
+ * \param [in] record The record to be appended.
+ */
+void MeasurementJournal::Append(const Record & record)
+{
+	pthread_mutex_lock(&mutex);
+	if(fd >= 0)
+	{
+		Serialize(record, pendingRecords);
+		numOfPendingRecords++;
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+/*!	\return `true` if there are records which were not committed and, at least, the commit interval has elapsed since the
+ * last commit. If the commit interval is 0, it always returns `false`, so the records are only committed when the user
+ * of the class decides it.
+ */
+bool MeasurementJournal::IsCommitDue()
+{
+	pthread_mutex_lock(&mutex);
+	const bool flagDue = commitInterval>0 && numOfPendingRecords>0 &&
+			std::chrono::steady_clock::now() - lastCommitTime >= std::chrono::milliseconds(commitInterval);
+	pthread_mutex_unlock(&mutex);
+	return flagDue;
+}
+
+/*!	The records which were appended since the last commit are written with a single call to write() and then the
+ * journal file is synchronized with the storage device. If there is no pending record, nothing is done.
+ */
+void MeasurementJournal::Commit()
+{
+	pthread_mutex_lock(&mutex);
+
+	lastCommitTime = std::chrono::steady_clock::now();
+	if( fd<0 || numOfPendingRecords==0 )
+	{
+		pthread_mutex_unlock(&mutex);
+		return;
+	}
+
+	//The pending records are cleared before, so they are not written twice if there is an error
+	std::string records;
+	records.swap(pendingRecords);
+	const std::size_t numOfRecords = numOfPendingRecords;
+	numOfPendingRecords=0;
+
+	try
+	{
+		WriteToFile(fd, records);
+		if( fdatasync(fd)!=0 )
+		{
+			rfims_exception exc("the journal file " + path + " could not be synchronized with the storage device");
+			exc.Append( strerror(errno) );
+			throw(exc);
+		}
+	}
+	catch(std::exception & exc)
+	{
+		pthread_mutex_unlock(&mutex);
+		throw;
+	}
+
+	numOfCommits++;
+	numOfCommittedRecords += numOfRecords;
+
+	pthread_mutex_unlock(&mutex);
+}
+
+void MeasurementJournal::Close()
+{
+	if(fd < 0)
+		return;
+
+	try
+	{
+		Commit();
+	}
+	catch(std::exception & exc)
+	{
+		close(fd);
+		fd=-1;
+		throw;
+	}
+
+	close(fd);
+	fd=-1;
+}
@@ -0,0 +1,52 @@
+/*! \file MotionProfile.cpp
+ * 	\brief This file contains the definitions of several methods of the class _MotionProfile_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "AntennaPositioning.h"
+
+MotionProfile::MotionProfile()
+{
+	parameters = {100.0, 100.0, 1000.0, 1000.0};
+	duration=0;
+}
+
+/*!	\param [in] param The parameters of the profile. The start rate must be at least one step per second and not larger
+ * than the cruise rate, and the acceleration and the deceleration must be positive.
+ */
+void MotionProfile::SetParameters(const MotionProfileParameters & param)
+{
+	if( !(param.startRate >= 1.0) || param.cruiseRate < param.startRate )
+		throw rfims_exception("the start rate of the motion profile must be at least 1 step/s and not larger than the cruise rate.");
+	if( !(param.acceleration > 0.0) || !(param.deceleration > 0.0) )
+		throw rfims_exception("the acceleration and the deceleration of the motion profile must be positive.");
+
+	parameters=param;
+	intervals.clear();
+	duration=0;
+}
+
+/*!	The step k of the movement covers the distance from k to k+1 steps. The time it takes is calculated with the three
+ * segments of the profile, as if each one was the whole movement: the acceleration from the start rate at the
+ * beginning, the deceleration to the start rate at the end, and the cruise rate. The longest of the three times is the
+ * one of the segment which limits the rate at that step, so the profile is triangular when the movement is too short
+ * to reach the cruise rate.
+ * \param [in] numOfSteps The number of steps of the movement.
+ */
+void MotionProfile::Build(const std::size_t numOfSteps)
+{
+	const double v0 = parameters.startRate;
+	//The time which is needed to cover the given distance, in steps, from the start rate with the given acceleration
+	auto TimeToCover = [v0](const double distance, const double accel) {	return( ( std::sqrt( v0*v0 + 2.0*accel*distance ) - v0 ) / accel );	};
+
+	intervals.resize(numOfSteps);
+	duration=0;
+	for(std::size_t k=0; k<numOfSteps; k++)
+	{
+		const double accelTime = TimeToCover(k+1, parameters.acceleration) - TimeToCover(k, parameters.acceleration);
+		const double decelTime = TimeToCover(numOfSteps-k, parameters.deceleration) - TimeToCover(numOfSteps-k-1, parameters.deceleration);
+		const double cruiseTime = 1.0 / parameters.cruiseRate;
+		intervals[k] = std::uint32_t( std::llround( std::max( std::max(accelTime, decelTime), cruiseTime ) * 1e9 ) );
+		duration += intervals[k];
+	}
+}
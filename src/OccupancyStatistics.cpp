@@ -0,0 +1,385 @@
+/*! \file OccupancyStatistics.cpp
+ * 	\brief This file contains the definitions of several methods of the class _OccupancyStatistics_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "SweepProcessing.h"
+
+//! The identifier which is written at the beginning of the checkpoint file.
+static const char CHECKPOINT_MAGIC[8] = {'R','F','I','M','S','O','C','C'};
+
+//! The header of the checkpoint file.
+/*!	The checkpoint file is just intended to be read by the same software, in the same machine, so the
+ * 	structures are written as they are stored in memory.
+ */
+struct CheckpointHeader
+{
+	char magic[8]; //!< The identifier of the file type.
+	std::uint32_t version; //!< The version of the file format.
+	std::uint32_t numOfAzimPos; //!< The number of azimuth positions.
+	std::uint64_t gridHash; //!< The hash of the frequency grid and the number of azimuth positions.
+	std::uint64_t numOfPoints; //!< The number of frequency bins of the grid.
+	std::uint32_t numOfSweeps; //!< The number of sweeps which were taken into account.
+	std::uint32_t firstSweepTime[6]; //!< The timestamp of the first sweep: year, month, day, hour, minute and second.
+	std::uint32_t lastSweepTime[6]; //!< The timestamp of the last sweep: year, month, day, hour, minute and second.
+};
+
+OccupancyStatistics::OccupancyStatistics()
+{
+	numOfAzimPos=6;
+	gridHash=0;
+	numOfSweeps=0;
+
+	try
+	{
+		if( !boost::filesystem::exists(STATISTICS_PATH) )
+			boost::filesystem::create_directory(STATISTICS_PATH);
+	}
+	catch(boost::filesystem::filesystem_error & exc)
+	{
+		rfims_exception rfimsExc("the creation of the statistics directory failed");
+		rfimsExc.Append( exc.what() );
+		throw(rfimsExc);
+	}
+}
+
+/*!	The statistics directory is not created by this constructor, since it is intended to query a checkpoint file which
+ * 	was saved by other object, maybe while the main program keeps running.
+ * 	\param [in] checkpointPath The path of the checkpoint file.
+ */
+OccupancyStatistics::OccupancyStatistics(const std::string & checkpointPath)
+{
+	numOfAzimPos=0;
+	gridHash=0;
+	numOfSweeps=0;
+
+	if( !boost::filesystem::exists(checkpointPath) )
+		throw rfims_exception("the checkpoint file " + checkpointPath + " does not exist.");
+
+	if( !ReadCheckpoint(checkpointPath, false) )
+		throw rfims_exception("the checkpoint file " + checkpointPath + " has a version which is not supported.");
+}
+
+/*!	If the number of azimuth positions changes, the statistics are discarded because they cannot be related
+ * 	to the new positions.
+ * 	\param [in] number The number of azimuth positions of the antenna positioning system.
+ */
+void OccupancyStatistics::SetNumOfAzimPos(const unsigned int number)
+{
+	if( number==0 )
+		throw rfims_exception("the occupancy statistics cannot work with zero azimuth positions.");
+
+	if( number!=numOfAzimPos )
+	{
+		numOfAzimPos=number;
+		if( !frequencies.empty() )
+		{
+			std::vector<std::uint_least64_t> freqs;
+			freqs.swap(frequencies);
+			SetGrid(freqs);
+		}
+	}
+}
+
+/*!	The memory for all bins is allocated here, once per frequency grid, and then the method tries to reload
+ * 	the statistics from the checkpoint file.
+ * 	\param [in] freqs The frequency values (Hz) of the new grid.
+ */
+void OccupancyStatistics::SetGrid(const std::vector<std::uint_least64_t> & freqs)
+{
+	frequencies = freqs;
+
+	gridHash = CalculateHash( frequencies.data(), frequencies.size()*sizeof(std::uint_least64_t) );
+	gridHash = CalculateHash( &numOfAzimPos, sizeof(numOfAzimPos), gridHash );
+
+	statistics.assign( std::size_t(numOfAzimPos) * 2 * frequencies.size(), BinStatistics() );
+	Reset();
+
+	try
+	{
+		LoadCheckpoint();
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "\nWarning: the occupancy statistics could not be reloaded: " << exc.what() << endl;
+		Reset();
+	}
+}
+
+void OccupancyStatistics::Reset()
+{
+	for(auto & bin : statistics)
+	{
+		bin.numOfSamples=0;
+		bin.numOfExceedances=0;
+		bin.maxHold=-std::numeric_limits<float>::infinity();
+		bin.mean=0.0;
+		bin.m2=0.0;
+	}
+	numOfSweeps=0;
+	firstSweepTime.Clear();
+	lastSweepTime.Clear();
+}
+
+/*!	\param [in] polarization The antenna polarization: "horizontal" or "vertical".	*/
+unsigned int OccupancyStatistics::GetPolIndex(const std::string & polarization) const
+{
+	if( polarization=="horizontal" )
+		return 0;
+	else if( polarization=="vertical" )
+		return 1;
+
+	throw rfims_exception("the occupancy statistics received an unknown polarization: \"" + polarization + "\".");
+}
+
+/*!	The given sweep should have been calibrated before. The running mean and variance are updated with the Welford's
+ * 	algorithm, which is numerically stable and it does not need to store the previous values. If the threshold curve is
+ * 	empty (the RFI detection is not enabled) or it does not match the sweep, the exceedances are not counted.
+ *
+ * 	If the frequency grid of the sweep is different from the current one, which happens when the bands parameters are
+ * 	reloaded, the statistics are restarted with the new grid.
+ *
+ * 	The azimuth position is given by its index, and not taken from the azimuth angle of the sweep, because the angle is
+ * 	not updated in the manual mode. The index which equals the number of positions, the one of the automatic mode after
+ * 	the last rotation, corresponds to the first position (a turn of 360°).
+ * 	\param [in] sweep A calibrated sweep.
+ * 	\param [in] azimPosIndex The index of the azimuth position where the sweep was captured, starting at zero.
+ * 	\param [in] threshCurve The threshold curve which is used by the RFI detector, in dBm.
+ */
+void OccupancyStatistics::Update(const Sweep & sweep, const unsigned int azimPosIndex, const FreqValues & threshCurve)
+{
+	if( sweep.Empty() )
+		throw rfims_exception("the occupancy statistics were asked to take into account an empty sweep.");
+
+	if( sweep.frequencies != frequencies )
+		SetGrid(sweep.frequencies);
+
+	const std::size_t numOfPoints = frequencies.size();
+	const bool flagThreshold = ( threshCurve.values.size()==numOfPoints );
+
+	BinStatistics * bin = &statistics[ GetOffset( azimPosIndex % numOfAzimPos, GetPolIndex(sweep.polarization) ) ];
+	const FreqValues::value_type * power = sweep.values.data();
+	const FreqValues::value_type * threshold = threshCurve.values.data();
+
+	for(std::size_t i=0; i<numOfPoints; i++, bin++)
+	{
+		const double delta = power[i] - bin->mean;
+		bin->numOfSamples++;
+		bin->mean += delta / bin->numOfSamples;
+		bin->m2 += delta * (power[i] - bin->mean);
+
+		if( power[i] > bin->maxHold )
+			bin->maxHold = power[i];
+
+		if( flagThreshold && power[i] > threshold[i] )
+			bin->numOfExceedances++;
+	}
+
+	if( numOfSweeps++ == 0 )
+		firstSweepTime = sweep.timeData;
+	lastSweepTime = sweep.timeData;
+}
+
+/*!	The statistics are written into a temporary file which then replaces the checkpoint file, so a power cut
+ * 	while the file is being written does not corrupt the last checkpoint.
+ */
+void OccupancyStatistics::SaveCheckpoint() const
+{
+	if( frequencies.empty() )
+		return;
+
+	boost::filesystem::path filePath(STATISTICS_PATH);
+	filePath /= CHECKPOINT_FILENAME;
+	boost::filesystem::path tempFilePath(filePath);
+	tempFilePath += ".tmp";
+
+	CheckpointHeader header;
+	std::copy(CHECKPOINT_MAGIC, CHECKPOINT_MAGIC+8, header.magic);
+	header.version = CHECKPOINT_VERSION;
+	header.numOfAzimPos = numOfAzimPos;
+	header.gridHash = gridHash;
+	header.numOfPoints = frequencies.size();
+	header.numOfSweeps = numOfSweeps;
+	const TimeData * times[2] = { &firstSweepTime, &lastSweepTime };
+	std::uint32_t * fields[2] = { header.firstSweepTime, header.lastSweepTime };
+	for(unsigned int i=0; i<2; i++)
+	{
+		fields[i][0]=times[i]->year; fields[i][1]=times[i]->month; fields[i][2]=times[i]->day;
+		fields[i][3]=times[i]->hour; fields[i][4]=times[i]->minute; fields[i][5]=times[i]->second;
+	}
+
+	std::ofstream ofs;
+	ofs.exceptions( std::ofstream::failbit | std::ofstream::badbit );
+	try
+	{
+		ofs.open( tempFilePath.string(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc );
+		ofs.write( (const char*) &header, sizeof(header) );
+		ofs.write( (const char*) frequencies.data(), frequencies.size()*sizeof(std::uint_least64_t) );
+		ofs.write( (const char*) statistics.data(), statistics.size()*sizeof(BinStatistics) );
+		ofs.close();
+	}
+	catch(std::ofstream::failure & exc)
+	{
+		rfims_exception rfimsExc("the checkpoint file of the occupancy statistics could not be written");
+		rfimsExc.Append( exc.what() );
+		throw(rfimsExc);
+	}
+
+	boost::filesystem::rename(tempFilePath, filePath);
+}
+
+/*!	The statistics are only reloaded if the checkpoint file was generated with the same frequency grid and the same
+ * 	number of azimuth positions, otherwise the current statistics are not modified.
+ * 	\return A `true` if the statistics were reloaded from the checkpoint file, or `false` otherwise.
+ */
+bool OccupancyStatistics::LoadCheckpoint()
+{
+	boost::filesystem::path filePath(STATISTICS_PATH);
+	filePath /= CHECKPOINT_FILENAME;
+
+	if( frequencies.empty() || !boost::filesystem::exists(filePath) )
+		return false;
+
+	return ReadCheckpoint(filePath.string(), true);
+}
+
+/*!	The size of the file is checked against the one which is stated by its header before reading the grid and the
+ * 	statistics, so a truncated or foreign file is rejected without allocating memory for it.
+ * 	\param [in] filePath The path of the checkpoint file.
+ * 	\param [in] flagKeepGrid If it is `true`, the file is only loaded if it corresponds to the current frequency grid and
+ * 	number of azimuth positions. Otherwise, they are taken from the file.
+ * 	\return A `true` if the statistics were loaded from the file, or `false` if the file has other version or, when the
+ * 	grid is kept, if it corresponds to other grid.
+ */
+bool OccupancyStatistics::ReadCheckpoint(const std::string & filePath, const bool flagKeepGrid)
+{
+	std::ifstream ifs( filePath, std::ifstream::in | std::ifstream::binary );
+	if( !ifs.is_open() )
+		throw rfims_exception("the checkpoint file of the occupancy statistics could not be opened.");
+
+	CheckpointHeader header;
+	if( !ifs.read( (char*) &header, sizeof(header) ) || !std::equal(CHECKPOINT_MAGIC, CHECKPOINT_MAGIC+8, header.magic) )
+		throw rfims_exception("the checkpoint file of the occupancy statistics has an unexpected format.");
+
+	if( header.version!=CHECKPOINT_VERSION )
+		return false;
+
+	if( flagKeepGrid && ( header.gridHash!=gridHash || header.numOfAzimPos!=numOfAzimPos || header.numOfPoints!=frequencies.size() ) )
+		return false;
+
+	const std::uint64_t numOfBins = std::uint64_t(header.numOfAzimPos) * 2 * header.numOfPoints;
+	if( header.numOfAzimPos==0 || header.numOfPoints==0 || boost::filesystem::file_size(filePath) !=
+			sizeof(header) + header.numOfPoints*sizeof(std::uint_least64_t) + numOfBins*sizeof(BinStatistics) )
+		throw rfims_exception("the checkpoint file of the occupancy statistics is truncated or corrupted.");
+
+	std::vector<std::uint_least64_t> freqs( header.numOfPoints );
+	ifs.read( (char*) freqs.data(), freqs.size()*sizeof(std::uint_least64_t) );
+	if( !ifs )
+		throw rfims_exception("the checkpoint file of the occupancy statistics is truncated.");
+	if( flagKeepGrid && freqs!=frequencies )
+		return false;
+
+	std::vector<BinStatistics> auxStatistics( numOfBins );
+	if( !ifs.read( (char*) auxStatistics.data(), auxStatistics.size()*sizeof(BinStatistics) ) )
+		throw rfims_exception("the checkpoint file of the occupancy statistics is truncated.");
+
+	statistics.swap(auxStatistics);
+	if(!flagKeepGrid)
+	{
+		frequencies.swap(freqs);
+		numOfAzimPos = header.numOfAzimPos;
+		gridHash = header.gridHash;
+	}
+	numOfSweeps = header.numOfSweeps;
+	TimeData * times[2] = { &firstSweepTime, &lastSweepTime };
+	const std::uint32_t * fields[2] = { header.firstSweepTime, header.lastSweepTime };
+	for(unsigned int i=0; i<2; i++)
+	{
+		times[i]->year=fields[i][0]; times[i]->month=fields[i][1]; times[i]->day=fields[i][2];
+		times[i]->hour=fields[i][3]; times[i]->minute=fields[i][4]; times[i]->second=fields[i][5];
+	}
+
+	return true;
+}
+
+/*!	\param [in] freq A frequency value in Hz. The nearest bin of the grid is taken.
+ * 	\param [in] azimPosIndex The index of the azimuth position, starting at zero.
+ * 	\param [in] polarization The antenna polarization: "horizontal" or "vertical".
+ */
+const OccupancyStatistics::BinStatistics & OccupancyStatistics::GetBinStatistics(const std::uint_least64_t freq,
+		const unsigned int azimPosIndex, const std::string & polarization) const
+{
+	if( frequencies.empty() )
+		throw rfims_exception("the occupancy statistics were queried before any sweep was taken into account.");
+
+	if( azimPosIndex >= numOfAzimPos )
+		throw rfims_exception("the occupancy statistics were queried with an azimuth position index out of range.");
+
+	auto itFreq = std::lower_bound(frequencies.begin(), frequencies.end(), freq);
+	if( itFreq==frequencies.end() )
+		--itFreq;
+	else if( itFreq!=frequencies.begin() && ( freq - *(itFreq-1) ) < ( *itFreq - freq ) )
+		--itFreq;
+
+	return statistics[ GetOffset( azimPosIndex, GetPolIndex(polarization) ) + (itFreq - frequencies.begin()) ];
+}
+
+/*!	\param [in] azimPosIndex The index of the azimuth position, starting at zero.
+ * 	\param [in] polarization The antenna polarization: "horizontal" or "vertical".
+ */
+FreqValues OccupancyStatistics::GetMeanCurve(const unsigned int azimPosIndex, const std::string & polarization) const
+{
+	if( azimPosIndex >= numOfAzimPos )
+		throw rfims_exception("the occupancy statistics were queried with an azimuth position index out of range.");
+
+	FreqValues curve("mean power");
+	curve.frequencies = frequencies;
+	curve.timeData = lastSweepTime;
+	curve.values.reserve( frequencies.size() );
+
+	auto itBin = statistics.begin() + GetOffset( azimPosIndex, GetPolIndex(polarization) );
+	for(std::size_t i=0; i<frequencies.size(); i++, ++itBin)
+		curve.values.push_back( itBin->mean );
+
+	return curve;
+}
+
+/*!	\param [in] azimPosIndex The index of the azimuth position, starting at zero.
+ * 	\param [in] polarization The antenna polarization: "horizontal" or "vertical".
+ */
+FreqValues OccupancyStatistics::GetMaxHoldCurve(const unsigned int azimPosIndex, const std::string & polarization) const
+{
+	if( azimPosIndex >= numOfAzimPos )
+		throw rfims_exception("the occupancy statistics were queried with an azimuth position index out of range.");
+
+	FreqValues curve("max-hold power");
+	curve.frequencies = frequencies;
+	curve.timeData = lastSweepTime;
+	curve.values.reserve( frequencies.size() );
+
+	auto itBin = statistics.begin() + GetOffset( azimPosIndex, GetPolIndex(polarization) );
+	for(std::size_t i=0; i<frequencies.size(); i++, ++itBin)
+		curve.values.push_back( itBin->maxHold );
+
+	return curve;
+}
+
+/*!	\param [in] azimPosIndex The index of the azimuth position, starting at zero.
+ * 	\param [in] polarization The antenna polarization: "horizontal" or "vertical".
+ */
+FreqValues OccupancyStatistics::GetDutyCycleCurve(const unsigned int azimPosIndex, const std::string & polarization) const
+{
+	if( azimPosIndex >= numOfAzimPos )
+		throw rfims_exception("the occupancy statistics were queried with an azimuth position index out of range.");
+
+	FreqValues curve("duty cycle");
+	curve.frequencies = frequencies;
+	curve.timeData = lastSweepTime;
+	curve.values.reserve( frequencies.size() );
+
+	auto itBin = statistics.begin() + GetOffset( azimPosIndex, GetPolIndex(polarization) );
+	for(std::size_t i=0; i<frequencies.size(); i++, ++itBin)
+		curve.values.push_back( itBin->DutyCycle() );
+
+	return curve;
+}
@@ -7,9 +7,30 @@
 
 /////////////////Implementations of the RFIDetector class' methods//////////////////////////////
 
+//! The identifier which is written at the beginning of the cache files of the thresholds curves.
+static const char THRESH_CACHE_MAGIC[8] = {'R','F','I','M','S','T','H','R'};
+
+//! The header of a cache file of a thresholds curve.
+/*!	After the header, the file contains the frequency values (`std::uint64_t`, Hz) and then the thresholds values (`float`, dBm).
+ * 	The cache files are just intended to be read by the same software, in the same machine.
+ */
+struct ThreshCacheHeader
+{
+	char magic[8]; //!< The identifier of the file type.
+	std::uint32_t version; //!< The version of the file format.
+	std::uint32_t numOfPoints; //!< The number of points of the curve.
+	std::uint64_t key; //!< The hash of all the inputs which were used to build the curve.
+	std::uint64_t payloadHash; //!< The hash of the frequency and thresholds values, which is used to detect corrupted files.
+};
+
 /*!	The threshold curve is loaded from one of the fileS in the path [BASE_PATH](\ref BASE_PATH)/thresholds/.
  * The argument determines which recommendation, protocol or norm must be taken as reference to determine
  * the threshold curve to be used, i.e. to determine from which file load that curve.
+ *
+ * The final curve, already adjusted to the frequency grid and converted to power, is cached in a binary file in the
+ * folder [BASE_PATH](\ref BASE_PATH)/thresholds/cache/. The cache file is keyed by the norm, the bands parameters, the
+ * antenna gain, the frequency grid and the last-modification time of the text file, so the parsing, the adjusting and
+ * the conversion are skipped when none of them changed, and the cache file is just mapped into memory.
  * \param [in] thrNorm The norm, recommendation or protocol that must be taken as reference.
  */
 void RFIDetector::LoadThreshCurve(const RFI::ThresholdsNorm thrNorm)
@@ -27,76 +48,297 @@ void RFIDetector::LoadThreshCurve(const RFI::ThresholdsNorm thrNorm)
 		pathAndFilename /= "ska_mode1.txt";
 		break;
 	case RFI::ThresholdsNorm::SKA_MODE2:
-	default:
 		pathAndFilename /= "ska_mode2.txt";
+		break;
+	default:
+		throw rfims_exception("the RFI detector was asked to load the thresholds curve of an unknown norm.");
 	}
 
-	if( thresholdsCurve.Empty() || threshFileLastWriteTime < boost::filesystem::last_write_time(pathAndFilename) )
-	{
-		//The threshold curve must be loaded by first time or the corresponding file has been changed
+	//Building the key of the curve with all the inputs which are used to get it
+	const std::uint32_t normCode = thrNorm;
+	const auto & gridFrequencies = adjuster.GetRefFrequencies();
+	threshFileLastWriteTime = boost::filesystem::last_write_time(pathAndFilename);
+	const std::int64_t fileTime = threshFileLastWriteTime;
+	std::uint64_t key = CalculateHash( &normCode, sizeof(normCode) );
+	key = CalculateHash( &ANTENNA_GAIN, sizeof(ANTENNA_GAIN), key );
+	key = CalculateHash( &fileTime, sizeof(fileTime), key );
+	const std::uint64_t bandsHash = CalculateHash(bandsParameters);
+	key = CalculateHash( &bandsHash, sizeof(bandsHash), key );
+	key = CalculateHash( gridFrequencies.data(), gridFrequencies.size()*sizeof(std::uint_least64_t), key );
 
-		//Saving the last write time of the corresponding file
-		threshFileLastWriteTime = boost::filesystem::last_write_time(pathAndFilename);
+	//Nothing has changed since the last load
+	if( !thresholdsCurve.Empty() && key==threshCurveKey )
+		return;
 
-		FreqValues fluxDensityThrCurve;
-		std::ifstream ifs( pathAndFilename.string() );
-		std::string line;
-		float freqMHz, fluxDensity;
-		char delimiter;
-		bool flagHeader=true;
+	boost::filesystem::path cachePath(THRESH_CACHE_PATH);
+	cachePath /= pathAndFilename.stem();
+	cachePath += ".bin";
 
-		//Extracting the header
-		while(flagHeader)
+	try
+	{
+		if( LoadCachedThreshCurve(cachePath, key) )
 		{
-			std::getline(ifs, line);
-			boost::algorithm::to_lower(line);
-			if( line.find("norm") == std::string::npos )
-				if( line.find("//") != std::string::npos )
-					flagHeader=false;
+			threshCurveKey = key;
+			return;
 		}
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "\nWarning: the cached thresholds curve could not be loaded: " << exc.what() << endl;
+	}
 
-		//////Values extraction loop///////
-		do
-		{
-			ifs >> freqMHz >> delimiter;
-			if( ifs.peek()==' ' )
-				ifs >> delimiter;
-			ifs >> fluxDensity;
-
-			//The frequency values are saved in Hz as an integer value
-			fluxDensityThrCurve.frequencies.push_back( (std::uint_least64_t) (freqMHz*1e6) );
-			//The flux density values are saved as-is, in dB[W*m^-2*Hz^-1]
-			fluxDensityThrCurve.values.push_back(fluxDensity);
-
-			ifs.get(); //The character '\n' is extracted
-			ifs.peek(); //This function ensures the 'eofbit' is updated
-		}while( !ifs.eof() );
-
-		//Adjusting the thresholds curve taking into account the bands parameters
-		fluxDensityThrCurve = adjuster.AdjustCurve(fluxDensityThrCurve);
-
-		//Converting from flux density (dB[W*m^-2*Hz^-1]) to power (dBm)
-		double antAperture, threshPower_w;
-		auto itFrequency = fluxDensityThrCurve.frequencies.begin();
-		auto itFluxDensity = fluxDensityThrCurve.values.begin();
-		auto itBandParam = bandsParameters.begin();
-		for( ; itFrequency != fluxDensityThrCurve.frequencies.end(), itFluxDensity != fluxDensityThrCurve.values.end();
-			++itFrequency, ++itFluxDensity)
-		{
-			if( *itFrequency > itBandParam->stopFreq )
-				if( ++itBandParam == bandsParameters.end() )
-					--itBandParam;
+	//The threshold curve must be loaded by first time or any of its inputs has been changed
+
+	FreqValues fluxDensityThrCurve;
+	std::ifstream ifs( pathAndFilename.string() );
+	std::string line;
+	float freqMHz, fluxDensity;
+	char delimiter;
+	bool flagHeader=true;
+
+	//Extracting the header
+	while(flagHeader)
+	{
+		std::getline(ifs, line);
+		boost::algorithm::to_lower(line);
+		if( line.find("norm") == std::string::npos )
+			if( line.find("//") != std::string::npos )
+				flagHeader=false;
+	}
+
+	//////Values extraction loop///////
+	do
+	{
+		ifs >> freqMHz >> delimiter;
+		if( ifs.peek()==' ' )
+			ifs >> delimiter;
+		ifs >> fluxDensity;
 
-			antAperture = pow(10.0, ANTENNA_GAIN/10.0) * pow(SPEED_OF_LIGHT, 2) / ( 4.0 * M_PI * pow(*itFrequency, 2) ); //m²
-			threshPower_w = pow(10.0, *itFluxDensity/10.0) * antAperture * itBandParam->rbw; //Watts
-			thresholdsCurve.values.push_back( 10.0*log10(threshPower_w) + 30.0 ); //Watts to dBm
+		//The frequency values are saved in Hz as an integer value
+		fluxDensityThrCurve.frequencies.push_back( (std::uint_least64_t) (freqMHz*1e6) );
+		//The flux density values are saved as-is, in dB[W*m^-2*Hz^-1]
+		fluxDensityThrCurve.values.push_back(fluxDensity);
+
+		ifs.get(); //The character '\n' is extracted
+		ifs.peek(); //This function ensures the 'eofbit' is updated
+	}while( !ifs.eof() );
+
+	//Adjusting the thresholds curve taking into account the bands parameters
+	fluxDensityThrCurve = adjuster.AdjustCurve(fluxDensityThrCurve);
+
+	//Converting from flux density (dB[W*m^-2*Hz^-1]) to power (dBm). The antenna aperture is G*c²/(4*pi*f²) (m²) and
+	//the threshold power is S*Ae*RBW (Watts), so, in decibels, the terms which do not depend on the frequency are calculated once.
+	const double apertureConstant_dB = ANTENNA_GAIN + 10.0*log10( SPEED_OF_LIGHT*SPEED_OF_LIGHT / (4.0*M_PI) );
+	thresholdsCurve.Clear();
+	thresholdsCurve.frequencies = fluxDensityThrCurve.frequencies;
+	thresholdsCurve.values.reserve( fluxDensityThrCurve.values.size() );
+
+	auto itFrequency = fluxDensityThrCurve.frequencies.begin();
+	auto itFluxDensity = fluxDensityThrCurve.values.begin();
+	auto itBandParam = bandsParameters.begin();
+	double rbw_dB = 10.0*log10(itBandParam->rbw);
+	for( ; itFrequency != fluxDensityThrCurve.frequencies.end(), itFluxDensity != fluxDensityThrCurve.values.end();
+		++itFrequency, ++itFluxDensity)
+	{
+		if( *itFrequency > itBandParam->stopFreq )
+		{
+			if( ++itBandParam == bandsParameters.end() )
+				--itBandParam;
+			rbw_dB = 10.0*log10(itBandParam->rbw);
 		}
+
+		const double threshPower_dBW = *itFluxDensity + apertureConstant_dB - 20.0*log10( double(*itFrequency) ) + rbw_dB;
+		thresholdsCurve.values.push_back( threshPower_dBW + 30.0 ); //dBW to dBm
+	}
+
+	threshCurveKey = key;
+
+	try
+	{
+		SaveCachedThreshCurve(cachePath, key);
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "\nWarning: the thresholds curve could not be cached: " << exc.what() << endl;
+	}
+}
+
+/*!	The cache file is mapped into memory and it is validated (format, key, size and hash of the values) before the values
+ * are copied to the thresholds curve.
+ * \param [in] cachePath The path of the cache file.
+ * \param [in] key The hash of all the inputs of the wished curve.
+ * \return A `true` value if the curve was loaded from the cache file, or `false` if the file does not exist or it does
+ * not correspond to the given key.
+ */
+bool RFIDetector::LoadCachedThreshCurve(const boost::filesystem::path & cachePath, const std::uint64_t key)
+{
+	if( !boost::filesystem::exists(cachePath) )
+		return false;
+
+	int fd = open(cachePath.c_str(), O_RDONLY);
+	if(fd < 0)
+		throw rfims_exception("the cache file " + cachePath.string() + " could not be opened.");
+
+	struct stat fileStatus;
+	if( fstat(fd, &fileStatus) < 0 || std::size_t(fileStatus.st_size) < sizeof(ThreshCacheHeader) )
+	{
+		close(fd);
+		return false;
+	}
+
+	const std::size_t fileSize = fileStatus.st_size;
+	void * mapAddr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(mapAddr == MAP_FAILED)
+		throw rfims_exception("the cache file " + cachePath.string() + " could not be mapped into memory.");
+
+	const ThreshCacheHeader * header = (const ThreshCacheHeader*) mapAddr;
+	const std::size_t numOfPoints = header->numOfPoints;
+	const std::size_t freqsSize = numOfPoints*sizeof(std::uint64_t);
+	const std::size_t valuesSize = numOfPoints*sizeof(float);
+	const char * payload = (const char*) mapAddr + sizeof(ThreshCacheHeader);
+
+	bool flagValid = std::equal(THRESH_CACHE_MAGIC, THRESH_CACHE_MAGIC+8, header->magic) && header->version==THRESH_CACHE_VERSION &&
+			header->key==key && fileSize==sizeof(ThreshCacheHeader)+freqsSize+valuesSize &&
+			header->payloadHash==CalculateHash(payload, freqsSize+valuesSize);
+
+	if(flagValid)
+	{
+		const std::uint64_t * freqs = (const std::uint64_t*) payload;
+		const float * values = (const float*) (payload + freqsSize);
+		thresholdsCurve.Clear();
+		thresholdsCurve.frequencies.assign(freqs, freqs + numOfPoints);
+		thresholdsCurve.values.assign(values, values + numOfPoints);
+	}
+
+	munmap(mapAddr, fileSize);
+
+	return flagValid;
+}
+
+/*!	The file is written with a temporary name and then it is renamed, so a cache file is never left half-written.
+ * \param [in] cachePath The path of the cache file.
+ * \param [in] key The hash of all the inputs of the current curve.
+ */
+void RFIDetector::SaveCachedThreshCurve(const boost::filesystem::path & cachePath, const std::uint64_t key) const
+{
+	if( !boost::filesystem::exists( cachePath.parent_path() ) )
+		boost::filesystem::create_directories( cachePath.parent_path() );
+
+	const std::vector<std::uint64_t> freqs( thresholdsCurve.frequencies.begin(), thresholdsCurve.frequencies.end() );
+	const std::size_t freqsSize = freqs.size()*sizeof(std::uint64_t);
+	const std::size_t valuesSize = thresholdsCurve.values.size()*sizeof(float);
+
+	ThreshCacheHeader header;
+	std::copy(THRESH_CACHE_MAGIC, THRESH_CACHE_MAGIC+8, header.magic);
+	header.version = THRESH_CACHE_VERSION;
+	header.numOfPoints = thresholdsCurve.values.size();
+	header.key = key;
+	header.payloadHash = CalculateHash(freqs.data(), freqsSize);
+	header.payloadHash = CalculateHash(thresholdsCurve.values.data(), valuesSize, header.payloadHash);
+
+	boost::filesystem::path tempPath(cachePath);
+	tempPath += ".tmp";
+
+	std::ofstream ofs;
+	ofs.exceptions( std::ofstream::failbit | std::ofstream::badbit );
+	try
+	{
+		ofs.open( tempPath.string(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc );
+		ofs.write( (const char*) &header, sizeof(header) );
+		ofs.write( (const char*) freqs.data(), freqsSize );
+		ofs.write( (const char*) thresholdsCurve.values.data(), valuesSize );
+		ofs.close();
+	}
+	catch(std::ofstream::failure & exc)
+	{
+		rfims_exception rfimsExc("the cache file " + tempPath.string() + " could not be written");
+		rfimsExc.Append( exc.what() );
+		throw(rfimsExc);
 	}
+
+	boost::filesystem::rename(tempPath, cachePath);
+}
+
+/*!	The noise floor of each sweep is estimated as a determined percentile (the median by default) of the power values
+ * which are inside a sliding window centered at each point, and the points which are more than a determined margin above
+ * the noise floor are considered RFI. This allows to detect interference which is well above the measured noise floor but
+ * below the harmful levels defined by the norms.
+ * \param [in] margin The margin, in dB, above the estimated noise floor from which a point is considered RFI.
+ * \param [in] windowSize The number of points of the sliding window. If it is even, the next odd number is used.
+ * \param [in] percentile The percentile, between 0 and 100, of the power values in the sliding window which is taken as the noise floor.
+ */
+void RFIDetector::EnableNoiseFloorDetection(const float margin, const unsigned int windowSize, const float percentile)
+{
+	if( margin < 0.0 )
+		throw rfims_exception("the margin above the noise floor to detect RFI cannot be negative.");
+	if( windowSize==0 )
+		throw rfims_exception("the sliding window to estimate the noise floor cannot have zero points.");
+	if( percentile < 0.0 || percentile > 100.0 )
+		throw rfims_exception("the percentile to estimate the noise floor must be between 0 and 100.");
+
+	nfMargin = margin;
+	nfWindowSize = windowSize | 1U;
+	nfPercentile = percentile;
+
+	//The histogram is allocated once here and then it is reused for all sweeps
+	const std::size_t numOfBins = std::size_t( std::round( (NF_MAX_POWER - NF_MIN_POWER) / NF_RESOLUTION ) ) + 1;
+	nfHistogram.assign(numOfBins + 1, 0);
+
+	flagNoiseFloorDetection = true;
 }
 
-/*!	The given sweep should have been calibrated before.
+/*!	The values which are out of the range [NF_MIN_POWER, NF_MAX_POWER] are saturated.
+ * \param [in] power A power value in dBm.
+ */
+std::uint16_t RFIDetector::QuantizePower(const float power) const
+{
+	if( !(power > NF_MIN_POWER) )
+		return 0;
+	if( power >= NF_MAX_POWER )
+		return std::uint16_t( nfHistogram.size() - 2 );
+
+	return std::uint16_t( std::lround( (power - NF_MIN_POWER) / NF_RESOLUTION ) );
+}
+
+/*!	\param [in] bin The index of the histogram bin, starting at zero.
+ * \param [in] value The value to be added to the count of the bin: 1 to insert a point or -1 to remove it.
+ */
+void RFIDetector::UpdateHistogram(std::size_t bin, const int value)
+{
+	for(++bin; bin < nfHistogram.size(); bin += bin & (~bin + 1))
+		nfHistogram[bin] += value;
+}
+
+/*!	The search goes down through the Fenwick tree, so it takes a logarithmic time with respect to the number of bins.
+ * \param [in] rank The rank of the wanted value, starting at one.
+ * \return The index of the histogram bin where the value with the given rank is.
+ */
+std::size_t RFIDetector::FindHistogramRank(std::uint32_t rank) const
+{
+	std::size_t step = 1;
+	while( (step << 1) < nfHistogram.size() )
+		step <<= 1;
+
+	std::size_t pos = 0;
+	for( ; step > 0; step >>= 1)
+		if( pos + step < nfHistogram.size() && nfHistogram[pos + step] < rank )
+		{
+			pos += step;
+			rank -= nfHistogram[pos];
+		}
+
+	return pos;
+}
+
+/*!	The given sweep should have been calibrated before. The sweep is compared with the threshold curve, if this one was
+ * loaded, and, if the detection relative to the noise floor is enabled, with the estimated noise floor plus the margin. Both
+ * detections are performed in the same pass through the sweep. The noise floor is estimated with a sliding percentile which
+ * is computed over a histogram of quantized power values, stored as a Fenwick tree, so each point takes a time proportional
+ * to the logarithm of the number of histogram bins and no memory is allocated once the internal buffers have grown.
  * \param [in] sweep A calibrated sweep.
- * \return A structure with the pairs of values (frequency,power) where it was detected RFI.
+ * \return A structure with the pairs of values (frequency,power) where it was detected RFI, relative to the threshold curve.
+ * The RFI which was detected relative to the noise floor can be got with the method GetNoiseFloorRFI().
  */
 const RFI & RFIDetector::DetectRFI(const Sweep & sweep)
 {
@@ -106,27 +348,83 @@ const RFI & RFIDetector::DetectRFI(const Sweep & sweep)
 	rfi.polarization=sweep.polarization;
 	rfi.timeData=sweep.timeData;
 
-	bool flagPreviousDetection=false;
-	auto itFrequency = sweep.frequencies.begin();
-	auto itPower = sweep.values.begin();
-	auto itThreshold = thresholdsCurve.values.begin();
+	const std::size_t numOfPoints = std::min( sweep.frequencies.size(), sweep.values.size() );
+	const std::size_t numOfNormPoints = std::min( numOfPoints, thresholdsCurve.values.size() );
+	const std::size_t halfWindow = nfWindowSize / 2;
 
-	for( ; itFrequency!=sweep.frequencies.end(), itPower!=sweep.values.end(), itThreshold!=thresholdsCurve.values.end();
-			itFrequency++, itPower++, itThreshold++)
+	if(flagNoiseFloorDetection)
 	{
-		if( *itPower > *itThreshold)
+		nfRFI.Clear();
+		nfRFI.azimuthAngle=sweep.azimuthAngle;
+		nfRFI.polarization=sweep.polarization;
+		nfRFI.timeData=sweep.timeData;
+
+		noiseFloor.frequencies.assign( sweep.frequencies.begin(), sweep.frequencies.begin() + numOfPoints );
+		noiseFloor.values.resize(numOfPoints);
+		noiseFloor.timeData=sweep.timeData;
+
+		nfQuantValues.resize(numOfPoints);
+		for(std::size_t i=0; i<numOfPoints; i++)
+			nfQuantValues[i] = QuantizePower( sweep.values[i] );
+
+		//Loading the first half of the sliding window
+		std::fill(nfHistogram.begin(), nfHistogram.end(), 0);
+		for(std::size_t i=0; i<halfWindow && i<numOfPoints; i++)
+			UpdateHistogram(nfQuantValues[i], 1);
+	}
+
+	bool flagPreviousDetection=false, flagPreviousNFDetection=false;
+	for(std::size_t i=0; i<numOfPoints; i++)
+	{
+		const FreqValues::value_type power = sweep.values[i];
+
+		if( i < numOfNormPoints )
+		{
+			if( power > thresholdsCurve.values[i] )
+			{
+				rfi.frequencies.push_back( sweep.frequencies[i] );
+				rfi.values.push_back(power);
+
+				if(!flagPreviousDetection)
+				{
+					++rfi.numOfRFIBands;
+					flagPreviousDetection=true;
+				}
+			}
+			else
+				flagPreviousDetection=false;
+		}
+
+		if(flagNoiseFloorDetection)
 		{
-			rfi.frequencies.push_back( *itFrequency );
-			rfi.values.push_back( *itPower );
+			//Sliding the window: the point which enters by the right side is inserted and the one which leaves by the left side is removed
+			if( i + halfWindow < numOfPoints )
+				UpdateHistogram(nfQuantValues[i + halfWindow], 1);
+			if( i > halfWindow )
+				UpdateHistogram(nfQuantValues[i - halfWindow - 1], -1);
 
-			if(!flagPreviousDetection)
+			const std::size_t firstIndex = ( i > halfWindow ? i - halfWindow : 0 );
+			const std::size_t lastIndex = std::min(i + halfWindow, numOfPoints - 1);
+			const std::size_t count = lastIndex - firstIndex + 1;
+			const std::uint32_t rank = std::uint32_t( nfPercentile / 100.0 * (count - 1) ) + 1;
+
+			const float floor = NF_MIN_POWER + FindHistogramRank(rank) * NF_RESOLUTION;
+			noiseFloor.values[i] = floor;
+
+			if( power > floor + nfMargin )
 			{
-				++rfi.numOfRFIBands;
-				flagPreviousDetection=true;
+				nfRFI.frequencies.push_back( sweep.frequencies[i] );
+				nfRFI.values.push_back(power);
+
+				if(!flagPreviousNFDetection)
+				{
+					++nfRFI.numOfRFIBands;
+					flagPreviousNFDetection=true;
+				}
 			}
+			else
+				flagPreviousNFDetection=false;
 		}
-		else
-			flagPreviousDetection=false;
 	}
 
 	return rfi;
@@ -0,0 +1,202 @@
+/*! \file RetentionIndex.cpp
+ * 	\brief This file contains the definitions of several methods of the class _RetentionIndex_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataStorage.h"
+
+/*!	\param [in] path The path of the file.
+ * \param [in] text The text to be written.
+ * \param [in] flagAppend If it is `true` the text is appended to the file, otherwise the file is truncated.
+ */
+void RetentionIndex::WriteFile(const std::string & path, const std::string & text, const bool flagAppend) const
+{
+	int fd = open( path.c_str(), O_WRONLY | O_CREAT | (flagAppend ? O_APPEND : O_TRUNC), 0644 );
+	if(fd < 0)
+		throw rfims_exception("the retention index file " + path + " could not be opened.");
+
+	std::size_t writtenBytes=0;
+	while( writtenBytes < text.size() )
+	{
+		ssize_t ret = write( fd, text.data() + writtenBytes, text.size() - writtenBytes );
+		if(ret < 0 && errno==EINTR)
+			continue;
+		if(ret < 0)
+		{
+			close(fd);
+			throw rfims_exception("the retention index file " + path + " could not be written.");
+		}
+		writtenBytes += ret;
+	}
+
+	if( fdatasync(fd)!=0 || close(fd)!=0 )
+		throw rfims_exception("the retention index file " + path + " could not be synchronized.");
+}
+
+/*!	The lines which cannot be interpreted, for example the last one if the power was cut while it was written, are
+ * ignored. If the index file has many more lines than files, it is rewritten atomically, with a temporary file, so it
+ * does not grow indefinitely.
+ * \param [in] path The path of the index file, which is also used by the method Commit().
+ * \return `true` if the index file existed or `false` if it did not exist, so the user of the class knows the files
+ * which already exist must be added.
+ */
+bool RetentionIndex::Open(const std::string & path)
+{
+	indexPath = path;
+	entries.clear();
+	totalSize=0;
+	numOfLines=0;
+	pendingLines.clear();
+
+	std::ifstream ifs(indexPath);
+	if( !ifs.is_open() )
+		return false;
+
+	std::string line;
+	while( std::getline(ifs, line) )
+	{
+		numOfLines++;
+
+		std::istringstream iss(line);
+		char operation;
+		std::string timestamp, filePath;
+		std::uint64_t size=0;
+		if( !(iss >> operation >> timestamp) || (operation=='+' && !(iss >> size)) || !(iss >> std::ws) || !std::getline(iss, filePath) )
+			continue;
+
+		TimeData cycleTime;
+		try
+		{
+			cycleTime.SetTimestamp(timestamp);
+		}
+		catch(std::exception & exc)
+		{
+			continue;
+		}
+
+		if(operation=='+')
+		{
+			entries.emplace( cycleTime, Entry{filePath, size} );
+			totalSize += size;
+		}
+		else if(operation=='-')
+		{
+			auto range = entries.equal_range(cycleTime);
+			for(auto entryIt = range.first; entryIt != range.second; entryIt++)
+				if(entryIt->second.path == filePath)
+				{
+					Pop(entryIt);
+					break;
+				}
+		}
+	}
+	ifs.close();
+	pendingLines.clear(); //The removals which were replayed are already in the file
+
+	//The index file is compacted if most of its lines are useless
+	if( numOfLines > 2*entries.size() + 64 )
+	{
+		std::ostringstream oss;
+		for(const auto & entry : entries)
+			oss << "+ " << entry.first.GetTimestamp() << ' ' << entry.second.size << ' ' << entry.second.path << '\n';
+
+		const std::string tempPath = indexPath + ".tmp";
+		WriteFile(tempPath, oss.str(), false);
+		if( std::rename( tempPath.c_str(), indexPath.c_str() )!=0 )
+			throw rfims_exception("the retention index file " + tempPath + " could not be renamed.");
+		numOfLines = entries.size();
+	}
+
+	return true;
+}
+
+/*!	If the file is already in the index, its size is updated. The size of a directory is the sum of the sizes of the
+ * files it contains.
+ * \param [in] cycleTime The timestamp of the measurement cycle the file belongs to.
+ * \param [in] path The path of the file or directory.
+ */
+void RetentionIndex::Add(const TimeData & cycleTime, const std::string & path)
+{
+	boost::system::error_code errorCode;
+	std::uint64_t size=0;
+	if( boost::filesystem::is_directory(path, errorCode) )
+	{
+		for( const auto & dirEntry : boost::filesystem::recursive_directory_iterator(path) )
+			if( boost::filesystem::is_regular_file( dirEntry.path() ) )
+				size += boost::filesystem::file_size( dirEntry.path() );
+	}
+	else
+	{
+		size = boost::filesystem::file_size(path, errorCode);
+		if(errorCode)
+			return;
+	}
+
+	auto range = entries.equal_range(cycleTime);
+	for(auto entryIt = range.first; entryIt != range.second; entryIt++)
+		if(entryIt->second.path == path)
+		{
+			Pop(entryIt);
+			break;
+		}
+
+	entries.emplace( cycleTime, Entry{path, size} );
+	totalSize += size;
+	pendingLines += "+ " + cycleTime.GetTimestamp() + ' ' + std::to_string(size) + ' ' + path + '\n';
+}
+
+/*!	\param [in] entryIt An iterator which points to the entry.
+ * \return The entry which was taken out of the index.
+ */
+RetentionIndex::Entry RetentionIndex::Pop(const std::multimap<TimeData, Entry>::iterator entryIt)
+{
+	Entry entry( std::move(entryIt->second) );
+	pendingLines += "- " + entryIt->first.GetTimestamp() + ' ' + entry.path + '\n';
+	totalSize -= std::min(totalSize, entry.size);
+	entries.erase(entryIt);
+	return entry;
+}
+
+/*!	\param [in] limitTime The files of the measurement cycles whose timestamps are before this time are taken out.
+ * \return The files which were taken out of the index, from the oldest to the newest.
+ */
+std::vector<RetentionIndex::Entry> RetentionIndex::PopOlderThan(const TimeData & limitTime)
+{
+	std::vector<Entry> oldEntries;
+	while( !entries.empty() && entries.begin()->first < limitTime )
+		oldEntries.push_back( Pop( entries.begin() ) );
+	return oldEntries;
+}
+
+/*!	The files of the last measurement cycle are never taken out, even if they alone exceed the quota, because they could
+ * be being archived yet. The files of the given cycles are skipped too, so the quota may not be reached until they are
+ * released.
+ * \param [in] quota The maximum total size of the files of the index, in bytes.
+ * \param [in] keptCycles The timestamps of the measurement cycles whose files must not be taken out, for example because
+ * they are waiting to be archived.
+ * \return The files which were taken out of the index, from the oldest to the newest.
+ */
+std::vector<RetentionIndex::Entry> RetentionIndex::PopToFitQuota(const std::uint64_t quota, const std::set<TimeData> & keptCycles)
+{
+	std::vector<Entry> oldEntries;
+	auto entryIt = entries.begin();
+	while( totalSize > quota && entryIt!=entries.end() && entryIt->first < entries.rbegin()->first )
+	{
+		if( keptCycles.count(entryIt->first) > 0 )
+			++entryIt;
+		else
+			oldEntries.push_back( Pop(entryIt++) );
+	}
+	return oldEntries;
+}
+
+void RetentionIndex::Commit()
+{
+	if( pendingLines.empty() || indexPath.empty() )
+		return;
+
+	std::string lines;
+	lines.swap(pendingLines);
+	WriteFile(indexPath, lines, true);
+	numOfLines += std::count( lines.begin(), lines.end(), '\n' );
+}
@@ -0,0 +1,57 @@
+/*! \file SentenceBuffer.cpp
+ * 	\brief This file contains the definitions of several methods of the class _SentenceBuffer_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "AntennaPositioning.h"
+
+/*!	When all the bytes have been given as sentences, the positions return to the start of the buffer. When the free
+ * space at the end is less than a quarter of the buffer, the incomplete sentence is moved to the start. The pointers
+ * which were given by the method NextSentence() are not valid after calling this method.
+ * \param [out] freeSpace The number of bytes which can be written at the returned position.
+ * \return A pointer to the position where the received bytes must be written.
+ */
+char * SentenceBuffer::GetWriteBuffer(std::size_t & freeSpace)
+{
+	if(readPos==writePos)
+		readPos=scanPos=writePos=0;
+	else if( readPos > 0 && buffer.size() - writePos < buffer.size()/4 )
+	{
+		std::memmove( buffer.data(), buffer.data() + readPos, writePos - readPos );
+		scanPos -= readPos;
+		writePos -= readPos;
+		readPos=0;
+	}
+
+	if( writePos==buffer.size() )
+	{
+		//The buffer is full and it does not contain any complete sentence, so the bytes cannot be interpreted
+		Clear();
+		throw rfims_exception("a sentence longer than the reception buffer was received, so it was discarded.");
+	}
+
+	freeSpace = buffer.size() - writePos;
+	return( buffer.data() + writePos );
+}
+
+/*!	The sentence is not copied: the returned pointer points to the buffer and it is valid until the next call to the
+ * method GetWriteBuffer().
+ * \param [out] sentence A pointer to the first character of the sentence.
+ * \param [out] length The number of characters of the sentence, including the final character '\n'.
+ * \return `true` if a complete sentence was found or `false` if the buffer only has an incomplete sentence or it is empty.
+ */
+bool SentenceBuffer::NextSentence(const char * & sentence, std::size_t & length)
+{
+	const char * endPtr = (const char*) std::memchr( buffer.data() + scanPos, '\n', writePos - scanPos );
+	if(endPtr==nullptr)
+	{
+		scanPos=writePos;
+		return false;
+	}
+
+	const std::size_t endPos = endPtr - buffer.data() + 1;
+	sentence = buffer.data() + readPos;
+	length = endPos - readPos;
+	readPos=scanPos=endPos;
+	return true;
+}
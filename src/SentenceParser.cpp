@@ -0,0 +1,331 @@
+/*! \file SentenceParser.cpp
+ * 	\brief This file contains the definitions of several methods of the class _SentenceParser_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "AntennaPositioning.h"
+
+/*!	\param [in] begin A pointer to the first character of the field.
+ * \param [in] end A pointer to the character after the last one of the field.
+ * \param [out] value The interpreted number.
+ * \return `true` if the field only has digits, at most nine, or it is empty.
+ */
+bool SentenceParser::ParseUnsigned(const char * begin, const char * end, unsigned int & value)
+{
+	if(end - begin > 9)
+		return false;
+
+	value=0;
+	for( ; begin<end; begin++)
+	{
+		if(*begin<'0' || *begin>'9')
+			return false;
+		value = value*10 + (*begin - '0');
+	}
+	return true;
+}
+
+/*!	The digits are accumulated in an integer, up to 15 significant digits, and it is divided by the corresponding power
+ * of ten. Both numbers are exactly represented as `double`, so the result of that only division is the nearest
+ * `double` to the decimal number, the same value which is given by the streams. The following digits are ignored.
+ * \param [in] begin A pointer to the first character of the field.
+ * \param [in] end A pointer to the character after the last one of the field.
+ * \param [out] value The interpreted number.
+ * \return `true` if the field is a decimal number or it is empty.
+ */
+bool SentenceParser::ParseDecimal(const char * begin, const char * end, double & value)
+{
+	static const double POWERS_OF_TEN[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+
+	value=0.0;
+	if(begin==end)
+		return true;
+
+	bool flagNegative=false;
+	if(*begin=='-' || *begin=='+')
+		flagNegative = ( *begin++ == '-' );
+
+	std::uint64_t mantissa=0;
+	int exponent=0;
+	bool flagPoint=false, flagDigits=false;
+	for( ; begin<end; begin++)
+	{
+		if(*begin>='0' && *begin<='9')
+		{
+			flagDigits=true;
+			if( mantissa < 100000000000000ULL )
+			{
+				mantissa = mantissa*10 + (*begin - '0');
+				if(flagPoint)
+					exponent--;
+			}
+			else if(!flagPoint)
+				exponent++;
+		}
+		else if(*begin=='.' && !flagPoint)
+			flagPoint=true;
+		else
+			return false;
+	}
+
+	if(!flagDigits)
+		return false;
+
+	if(exponent >= 0)
+		value = double(mantissa) * ( exponent < 16 ? POWERS_OF_TEN[exponent] : std::pow(10.0, exponent) );
+	else
+		value = double(mantissa) / POWERS_OF_TEN[-exponent];
+
+	if(flagNegative)
+		value = -value;
+
+	return true;
+}
+
+/*!	\param [in] begin A pointer to the first character of the field.
+ * \param [in] end A pointer to the character after the last one of the field.
+ * \param [out] first The number of the first two digits (hours or day).
+ * \param [out] second The number of the following two digits (minutes or month).
+ * \param [out] third The number of the last two digits (seconds or year).
+ * \param [out] nanosecond An optional pointer where the fractional part is saved in nanoseconds. The digits after the
+ * ninth one are ignored.
+ * \return `true` if the field has six digits, optionally followed by a point and more digits, or it is empty.
+ */
+bool SentenceParser::ParseTriplet(const char * begin, const char * end, unsigned int & first, unsigned int & second, unsigned int & third,
+		unsigned int * nanosecond)
+{
+	first=second=third=0;
+	if(nanosecond!=nullptr)
+		*nanosecond=0;
+	if(begin==end)
+		return true;
+
+	if( end - begin < 6 || !ParseUnsigned(begin, begin+2, first) || !ParseUnsigned(begin+2, begin+4, second) ||
+			!ParseUnsigned(begin+4, begin+6, third) )
+		return false;
+
+	begin += 6;
+	if(begin==end)
+		return true;
+	if(*begin++!='.')
+		return false;
+
+	unsigned int fraction=0, scale=1000000000;
+	for( ; begin<end; begin++)
+	{
+		if(*begin<'0' || *begin>'9')
+			return false;
+		if(scale > 1)
+		{
+			scale /= 10;
+			fraction += (*begin - '0') * scale;
+		}
+	}
+
+	if(nanosecond!=nullptr)
+		*nanosecond=fraction;
+	return true;
+}
+
+/*!	The minutes are the two digits before the point and the following decimal digits, as the library libnmea
+ * interpreted them, and the degrees are the previous digits.
+ * \param [in] begin A pointer to the first character of the field.
+ * \param [in] end A pointer to the character after the last one of the field.
+ * \param [out] angle The angle in decimal degrees, always positive.
+ * \return `true` if the field is a valid coordinate or it is empty.
+ */
+bool SentenceParser::ParseCoordinate(const char * begin, const char * end, double & angle)
+{
+	angle=0.0;
+	if(begin==end)
+		return true;
+
+	const char * pointPtr = (const char*) std::memchr(begin, '.', end - begin);
+	if(pointPtr==nullptr)
+		pointPtr=end;
+	if(pointPtr - begin < 2)
+		return false;
+
+	unsigned int degrees;
+	double minutes;
+	if( !ParseUnsigned(begin, pointPtr-2, degrees) || !ParseDecimal(pointPtr-2, end, minutes) || minutes < 0.0 )
+		return false;
+
+	angle = degrees + minutes/60.0;
+	return true;
+}
+
+/*!	The fields which are not used by the class _GPSInterface_ are not validated.
+ * \param [in,out] fields The structure where the field is saved, whose member _type_ must be already set.
+ * \param [in] fieldIndex The position of the field in the sentence, where the first one (for example "GPRMC") is zero.
+ * \param [in] begin A pointer to the first character of the field.
+ * \param [in] end A pointer to the character after the last one of the field.
+ * \return `true` if the field could be interpreted.
+ */
+bool SentenceParser::ParseField(GPSSentence & fields, const unsigned int fieldIndex, const char * begin, const char * end)
+{
+	switch(fields.type)
+	{
+		case GPSSentence::GPRMC:
+			switch(fieldIndex)
+			{
+				case 1:
+					fields.time=begin;
+					fields.timeLength = end - begin;
+					return ParseTriplet(begin, end, fields.hour, fields.minute, fields.second, &fields.nanosecond);
+				case 3:		return ParseCoordinate(begin, end, fields.latitude);
+				case 4:		if(begin<end && *begin=='S') fields.latitude *= -1.0;	return true;
+				case 5:		return ParseCoordinate(begin, end, fields.longitude);
+				case 6:		if(begin<end && *begin=='W') fields.longitude *= -1.0;	return true;
+				case 9:
+				{
+					//The years with two digits are interpreted as the function strptime() does: 69-99 are 1969-1999
+					unsigned int shortYear;
+					if( !ParseTriplet(begin, end, fields.day, fields.month, shortYear) )
+						return false;
+					fields.year = shortYear + ( shortYear < 69 ? 2000 : 1900 );
+					return true;
+				}
+				default:	return true;
+			}
+
+		case GPSSentence::GPGGA:
+			switch(fieldIndex)
+			{
+				case 1:
+					fields.time=begin;
+					fields.timeLength = end - begin;
+					return ParseTriplet(begin, end, fields.hour, fields.minute, fields.second, &fields.nanosecond);
+				case 2:		return ParseCoordinate(begin, end, fields.latitude);
+				case 3:		if(begin<end && *begin=='S') fields.latitude *= -1.0;	return true;
+				case 4:		return ParseCoordinate(begin, end, fields.longitude);
+				case 5:		if(begin<end && *begin=='W') fields.longitude *= -1.0;	return true;
+				case 7:		return ParseUnsigned(begin, end, fields.numOfSatellites);
+				case 9:		return ParseDecimal(begin, end, fields.altitude);
+				default:	return true;
+			}
+
+		case GPSSentence::PAAG_BAROM:
+			switch(fieldIndex)
+			{
+				case 3:		fields.time=begin;	fields.timeLength = end - begin;	return true;
+				case 4:		return ParseDecimal(begin, end, fields.pressure);
+				default:	return true;
+			}
+
+		case GPSSentence::PAAG_GYRO:
+		case GPSSentence::PAAG_COMPASS:
+		case GPSSentence::PAAG_ACCELER:
+			switch(fieldIndex)
+			{
+				case 3:		fields.time=begin;	fields.timeLength = end - begin;	return true;
+				case 4:		return ParseDecimal(begin, end, fields.x);
+				case 5:		return ParseDecimal(begin, end, fields.y);
+				case 6:		return ParseDecimal(begin, end, fields.z);
+				default:	return true;
+			}
+
+		default:
+			return false;
+	}
+}
+
+int SentenceParser::HexValue(const char c)
+{
+	if(c>='0' && c<='9')
+		return( c - '0' );
+	if(c>='A' && c<='F')
+		return( c - 'A' + 10 );
+	if(c>='a' && c<='f')
+		return( c - 'a' + 10 );
+	return -1;
+}
+
+/*!	The type of the sentence is identified by its first characters. Then, the characters between the '$' and the '*'
+ * are scanned once: each one is combined in the checksum and each field is interpreted when its delimiter is found.
+ * The pointer _time_ of the structure points to the given sentence, so it is valid while the sentence is.
+ * \param [in] sentence A pointer to the sentence, which could be preceded by the rest of a corrupted sentence.
+ * \param [in] length The number of characters of the sentence.
+ * \param [out] fields The structure where the type of the sentence and its fields are saved.
+ * \return `true` if the sentence is of one of the interpreted types, its fields are valid and its checksum is right.
+ */
+bool SentenceParser::Parse(const char * sentence, const std::size_t length, GPSSentence & fields)
+{
+	fields = GPSSentence();
+	fields.type = GPSSentence::UNKNOWN;
+
+	const char * const end = sentence + length;
+	const char * charPtr = (const char*) std::memchr(sentence, '$', length);
+	if(charPtr==nullptr)
+		return false;
+	charPtr++;
+
+	//Identifying the type of the sentence
+	const std::size_t remainingChars = end - charPtr;
+	if( remainingChars >= 6 && std::memcmp(charPtr, "GPRMC,", 6)==0 )
+		fields.type = GPSSentence::GPRMC;
+	else if( remainingChars >= 6 && std::memcmp(charPtr, "GPGGA,", 6)==0 )
+		fields.type = GPSSentence::GPGGA;
+	else if( remainingChars >= 12 && std::memcmp(charPtr, "PAAG,DATA,", 10)==0 && charPtr[11]==',' )
+		switch(charPtr[10])
+		{
+			case 'G':	fields.type = GPSSentence::PAAG_GYRO;		break;
+			case 'C':	fields.type = GPSSentence::PAAG_COMPASS;	break;
+			case 'T':	fields.type = GPSSentence::PAAG_ACCELER;	break;
+			case 'B':	fields.type = GPSSentence::PAAG_BAROM;		break;
+		}
+
+	if(fields.type==GPSSentence::UNKNOWN)
+		return false;
+
+	//Scanning the sentence
+	unsigned int calculChecksum=0, fieldIndex=0;
+	bool flagValidFields=true;
+	const char * fieldBegin = charPtr;
+	for( ; charPtr<end && *charPtr!='*'; charPtr++)
+	{
+		calculChecksum ^= (unsigned char) *charPtr;
+		if(*charPtr==',')
+		{
+			if(flagValidFields)
+				flagValidFields = ParseField(fields, fieldIndex, fieldBegin, charPtr);
+			fieldIndex++;
+			fieldBegin = charPtr + 1;
+		}
+	}
+
+	//The asterisk must be followed by the two hexadecimal digits of the checksum
+	if(end - charPtr < 3)
+		return false;
+
+	if(flagValidFields)
+		flagValidFields = ParseField(fields, fieldIndex, fieldBegin, charPtr);
+	fields.status = charPtr[-1];
+
+	const int highDigit = HexValue(charPtr[1]), lowDigit = HexValue(charPtr[2]);
+	return( flagValidFields && highDigit>=0 && lowDigit>=0 && (unsigned int)(highDigit*16 + lowDigit)==calculChecksum );
+}
+
+/*!	The checksum is at the end of each sentence, after an asterisk (*), and it is a 2 character hexadecimal
+ * representation of the XOR combination of all characters between the $ and the *.
+ * \param [in] sentence A pointer to the sentence.
+ * \param [in] length The number of characters of the sentence.
+ * \return `true` if the checksum is right.
+ */
+bool SentenceParser::ControlChecksum(const char * sentence, const std::size_t length)
+{
+	const char * const end = sentence + length;
+	const char * charPtr = (const char*) std::memchr(sentence, '$', length);
+	if(charPtr==nullptr)
+		return false;
+
+	unsigned int calculChecksum=0;
+	for(charPtr++; charPtr<end && *charPtr!='*'; charPtr++)
+		calculChecksum ^= (unsigned char) *charPtr;
+
+	if(end - charPtr < 3)
+		return false;
+
+	const int highDigit = HexValue(charPtr[1]), lowDigit = HexValue(charPtr[2]);
+	return( highDigit>=0 && lowDigit>=0 && (unsigned int)(highDigit*16 + lowDigit)==calculChecksum );
+}
@@ -0,0 +1,172 @@
+/*! \file SimulatedEncoder.cpp
+ * 	\brief This file contains the definitions of several methods of the class _SimulatedEncoder_, and the functions
+ * 	which are executed by its threads.
+ * 	\author Mauro Diamantino
+ */
+
+#include "AntennaPositioning.h"
+
+/*!	The thread of each channel takes the posted edge, if any, and calls the method of the counter, as the interrupt
+ * service routine canalA() or canalB() does with the level of the other channel which it reads.
+ * \param [in] arg A pointer to the structure _ChannelThreadArg_ of the channel.
+ */
+void *SimulatedChannelThread(void * arg)
+{
+	const SimulatedEncoder::ChannelThreadArg & threadArg = *(SimulatedEncoder::ChannelThreadArg*) arg;
+	SimulatedEncoder & encoder = *threadArg.encoder;
+	std::atomic<int> & postedEdge = encoder.postedEdges[threadArg.channel];
+
+	while( encoder.flagEnabled.load(std::memory_order_relaxed) )
+	{
+		const int otherPhaseLevel = postedEdge.exchange(-1, std::memory_order_acquire);
+		if(otherPhaseLevel < 0)
+		{
+			sched_yield();
+			continue;
+		}
+
+		if(threadArg.channel==EncoderCounter::CHANNEL_A)
+			encoder.counter.AddEdgeA(otherPhaseLevel==1);
+		else
+			encoder.counter.AddEdgeB(otherPhaseLevel==1);
+		encoder.numOfHandledEdges.fetch_add(1, std::memory_order_release);
+	}
+
+	return nullptr;
+}
+
+/*!	The thread of the motor generates two transitions per count, equally spaced in time, one of which is a rising edge of
+ * a channel. It waits for each transition sleeping while the remaining time is long and polling the monotonic clock
+ * after that, so it reaches edge rates of hundreds of kHz. The movement finishes when all the posted edges were handled
+ * or lost.
+ * \param [in] arg A pointer to the _SimulatedEncoder_ object.
+ */
+void *SimulatedMotorThread(void * arg)
+{
+	SimulatedEncoder & encoder = *(SimulatedEncoder*) arg;
+	const int direction = ( encoder.numOfCountsToMove >= 0 ? 1 : -1 );
+	const std::uint64_t numOfTransitions = 2 * std::uint64_t( std::llabs(encoder.numOfCountsToMove) );
+	const double transitionPeriod = 1e9 / (2.0 * encoder.edgeRate);
+	const std::int64_t startTime = GPSClock::MonotonicTime();
+
+	for(std::uint64_t k=0; k<numOfTransitions && encoder.flagEnabled.load(std::memory_order_relaxed); k++)
+	{
+		const std::int64_t transitionTime = startTime + std::int64_t(k * transitionPeriod);
+		std::int64_t time;
+		while( ( time=GPSClock::MonotonicTime() ) < transitionTime )
+			if(transitionTime - time > 200000)
+				usleep( (transitionTime - time - 100000) / 1000 );
+
+		//The states follow the sequence 0 (A and B low), 1 (A high), 2 (A and B high), 3 (B high) in the positive direction
+		const unsigned int oldState = encoder.phaseState;
+		const unsigned int newState = ( oldState + ( direction > 0 ? 1 : 3 ) ) % 4;
+		encoder.phaseState = newState;
+		const bool oldPhaseA = ( oldState==1 || oldState==2 ), newPhaseA = ( newState==1 || newState==2 );
+		const bool oldPhaseB = ( oldState >= 2 ), newPhaseB = ( newState >= 2 );
+		if(!oldPhaseA && newPhaseA)
+			encoder.PostEdge(EncoderCounter::CHANNEL_A, newPhaseB, direction);
+		else if(!oldPhaseB && newPhaseB)
+			encoder.PostEdge(EncoderCounter::CHANNEL_B, newPhaseA, direction);
+		else
+			continue;
+		encoder.generatedCount += direction;
+	}
+
+	while( encoder.flagEnabled.load(std::memory_order_relaxed) &&
+			encoder.numOfHandledEdges.load(std::memory_order_acquire) + encoder.numOfLostEdges.load(std::memory_order_relaxed) < encoder.numOfPostedEdges )
+		sched_yield();
+
+	encoder.flagMoving.store(false, std::memory_order_release);
+	return nullptr;
+}
+
+/*!	\param [in] encoderCounter The counter whose methods are called for each edge, as the interrupt service routines do. */
+SimulatedEncoder::SimulatedEncoder(EncoderCounter & encoderCounter) : counter(encoderCounter)
+{
+	postedEdges[EncoderCounter::CHANNEL_A]=-1;
+	postedEdges[EncoderCounter::CHANNEL_B]=-1;
+	flagEnabled=true;
+	flagMoving=false;
+	motorThreadID=0;
+	flagMotorThread=false;
+	phaseState=0;
+	numOfCountsToMove=0;
+	edgeRate=0.0;
+	generatedCount=counter.GetCount();
+	numOfPostedEdges=0;
+	numOfHandledEdges=0;
+	numOfLostEdges=0;
+	lostCount=0;
+
+	for(int i=0; i<2; i++)
+	{
+		channelThreadArgs[i] = { this, EncoderCounter::Channel(i) };
+		if( pthread_create(&channelThreadIDs[i], NULL, SimulatedChannelThread, &channelThreadArgs[i])!=0 )
+		{
+			//The destructor is not called when the constructor fails, so the created thread is stopped here
+			flagEnabled=false;
+			if(i==1)
+				pthread_join(channelThreadIDs[0], NULL);
+			throw rfims_exception("the threads of the simulated encoder could not be created.");
+		}
+	}
+}
+
+SimulatedEncoder::~SimulatedEncoder()
+{
+	flagEnabled=false;
+	JoinMotorThread();
+	pthread_join(channelThreadIDs[EncoderCounter::CHANNEL_A], NULL);
+	pthread_join(channelThreadIDs[EncoderCounter::CHANNEL_B], NULL);
+}
+
+/*!	If the previous edge of the same channel was not handled yet, it is replaced, so one of both is lost. Both have the
+ * same direction, since the edges of the previous movement are handled before it finishes.
+ * \param [in] channel The channel of the rising edge.
+ * \param [in] flagOtherPhaseOn The level of the other channel at the instant of the edge.
+ * \param [in] direction The direction of the movement: 1 or -1.
+ */
+void SimulatedEncoder::PostEdge(const EncoderCounter::Channel channel, const bool flagOtherPhaseOn, const int direction)
+{
+	numOfPostedEdges++;
+	if( postedEdges[channel].exchange( ( flagOtherPhaseOn ? 1 : 0 ), std::memory_order_release ) >= 0 )
+	{
+		numOfLostEdges.fetch_add(1, std::memory_order_relaxed);
+		lostCount += direction;
+	}
+}
+
+void SimulatedEncoder::JoinMotorThread()
+{
+	if(flagMotorThread)
+	{
+		pthread_join(motorThreadID, NULL);
+		flagMotorThread=false;
+	}
+}
+
+/*!	If the previous movement has not finished yet, this method waits for it before starting the new one.
+ * \param [in] numOfCounts The number of counts to move, whose sign is the direction.
+ * \param [in] rate The rate of the rising edges, in edges per second.
+ */
+void SimulatedEncoder::StartMovement(const std::int64_t numOfCounts, const double rate)
+{
+	if( !(rate > 0.0) )
+		throw rfims_exception("the edge rate of the simulated encoder must be positive.");
+
+	JoinMotorThread();
+	numOfCountsToMove=numOfCounts;
+	edgeRate=rate;
+	flagMoving=true;
+	if( pthread_create(&motorThreadID, NULL, SimulatedMotorThread, this)!=0 )
+	{
+		flagMoving=false;
+		throw rfims_exception("the thread of the motor of the simulated encoder could not be created.");
+	}
+	flagMotorThread=true;
+}
+
+void SimulatedEncoder::WaitForMovement()
+{
+	JoinMotorThread();
+}
@@ -0,0 +1,62 @@
+/*! \file SimulatedStepperOutput.cpp
+ * 	\brief This file contains the definitions of several methods of the class _SimulatedStepperOutput_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "AntennaPositioning.h"
+
+/*!	\param [in] encoderCounter The counter of the edges of the simulated encoder.
+ * \param [in] maxRate The maximum step rate the motor follows, in steps per second, or zero if there is no limit.
+ */
+SimulatedStepperOutput::SimulatedStepperOutput(EncoderCounter & encoderCounter, const double maxRate) : counter(encoderCounter)
+{
+	maxStepRate=maxRate;
+	flagClockwise=true;
+	flagPulseHigh=false;
+	lastStepTime=0;
+	previousStepTime=0;
+	numOfSteps=0;
+	numOfLostSteps=0;
+}
+
+/*!	A rising edge of the step signal is a step, whose rate is the inverse of the mean of its last two intervals. A step which
+ * the motor follows rotates the antenna one degree, so the encoder generates the rising edges of both channels in the
+ * order of the direction: A with B low and B with A high in the clockwise direction, B with A low and A with B high in
+ * the counterclockwise one.
+ * \param [in] flagHigh The level of the step signal.
+ */
+void SimulatedStepperOutput::SetPulse(const bool flagHigh)
+{
+	const bool flagRisingEdge = ( flagHigh && !flagPulseHigh );
+	flagPulseHigh=flagHigh;
+	if(!flagRisingEdge)
+		return;
+
+	numOfSteps++;
+	const std::int64_t time = GPSClock::MonotonicTime();
+	double rate=0.0;
+	if(previousStepTime!=0)
+		rate = 2e9 / std::max( time - previousStepTime, std::int64_t(1) );
+	else if(lastStepTime!=0)
+		rate = 1e9 / std::max( time - lastStepTime, std::int64_t(1) );
+	previousStepTime=lastStepTime;
+	lastStepTime=time;
+
+	if( maxStepRate > 0.0 && rate > maxStepRate )
+	{
+		numOfLostSteps++;
+		return;
+	}
+
+	for(std::int64_t i=0; i<EncoderCounter::COUNTS_PER_DEGREE/2; i++)
+		if(flagClockwise)
+		{
+			counter.AddEdgeA(false);
+			counter.AddEdgeB(true);
+		}
+		else
+		{
+			counter.AddEdgeB(false);
+			counter.AddEdgeA(true);
+		}
+}
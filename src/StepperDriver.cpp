@@ -0,0 +1,79 @@
+/*! \file StepperDriver.cpp
+ * 	\brief This file contains the definitions of several methods of the class _StepperDriver_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "AntennaPositioning.h"
+
+const std::int64_t StepperDriver::STEPS_PER_DEGREE;
+const std::int64_t StepperDriver::COUNTS_PER_STEP;
+const std::int64_t StepperDriver::MAX_COUNT_ERROR;
+
+/*!	The thread sleeps while the remaining time is long and polls the monotonic clock after that, so the instant is
+ * reached with a precision of microseconds, without using a processor core during the whole wait.
+ * \param [in] time The instant of the monotonic clock, in nanoseconds.
+ * \return The time between the given instant and the end of the wait, in nanoseconds.
+ */
+std::int64_t StepperDriver::WaitUntil(const std::int64_t time)
+{
+	std::int64_t currTime;
+	while( ( currTime=GPSClock::MonotonicTime() ) < time )
+		if(time - currTime > 200000)
+			usleep( (time - currTime - 100000) / 1000 );
+
+	return( currTime - time );
+}
+
+/*!	The step pulse is high during the first half of the interval, as the motor rests after the step. */
+void StepperDriver::Step()
+{
+	const std::int64_t interval = std::llround( 1e9 / profile.GetParameters().startRate );
+	const std::int64_t startTime = GPSClock::MonotonicTime();
+
+	output.SetPulse(true);
+	WaitUntil(startTime + interval/2);
+	output.SetPulse(false);
+	WaitUntil(startTime + interval);
+}
+
+/*!	The motion profile is built for the steps of the given angle and the steps are given until the encoder reaches the
+ * angle. If the motor lost steps, the missing ones are given at the start rate, up to the half of the planned steps,
+ * so the movement finishes even if the motor or the encoder fail. The step pulse is high during the first half of each
+ * interval.
+ * \param [in] degrees The angle to rotate, in degrees. It is clockwise (seen from above) if it is positive.
+ * \return The statistics of the movement, with the counts of the encoder and the ones of the given steps.
+ */
+MoveStatistics StepperDriver::Move(const double degrees)
+{
+	const bool flagClockwise = ( degrees >= 0.0 );
+	const std::size_t numOfPlannedSteps = std::size_t( std::llround( std::abs(degrees) * STEPS_PER_DEGREE ) );
+	const std::size_t maxNumOfSteps = numOfPlannedSteps + numOfPlannedSteps/2 + 2;
+	profile.Build(numOfPlannedSteps);
+	output.SetDirection(flagClockwise);
+
+	MoveStatistics statistics = {};
+	statistics.numOfPlannedSteps = numOfPlannedSteps;
+	const std::int64_t startCount = encoder.GetCount();
+	const std::int64_t startTime = GPSClock::MonotonicTime();
+	std::int64_t stepTime = startTime;
+	while( statistics.numOfSteps < maxNumOfSteps )
+	{
+		const double rotatedDegrees = encoder.GetDegreesSince(startCount);
+		if( flagClockwise ? rotatedDegrees >= degrees : rotatedDegrees <= degrees )
+			break;
+
+		const std::int64_t interval = profile.GetInterval(statistics.numOfSteps);
+		statistics.maxLateness = std::max( statistics.maxLateness, WaitUntil(stepTime) );
+		output.SetPulse(true);
+		WaitUntil(stepTime + interval/2);
+		output.SetPulse(false);
+		stepTime += interval;
+		statistics.numOfSteps++;
+	}
+	statistics.duration = GPSClock::MonotonicTime() - startTime;
+
+	statistics.counts = EncoderCounter::CountDifference( encoder.GetCount(), startCount );
+	statistics.expectedCounts = std::int64_t(statistics.numOfSteps) * COUNTS_PER_STEP * ( flagClockwise ? 1 : -1 );
+	statistics.degrees = EncoderCounter::ToDegrees(statistics.counts);
+	return statistics;
+}
@@ -0,0 +1,173 @@
+/*! \file SweepCodec.cpp
+ * 	\brief This file contains the definitions of several methods of the class _SweepCodec_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataStorage.h"
+
+/*!	The zigzag mapping interleaves the negative and positive integers (0, -1, 1, -2, 2...) so the small differences
+ * use few bytes whatever their sign is. Each byte carries 7 bits and the most significant one states if there are more bytes.
+ * \param [out] output The string where the bytes are appended.
+ * \param [in] value The integer to be packed.
+ */
+void SweepCodec::PutVarint(std::string & output, const std::int32_t value)
+{
+	std::uint32_t zigzag = ( std::uint32_t(value) << 1 ) ^ std::uint32_t(value >> 31);
+	while(zigzag >= 0x80)
+	{
+		output.push_back( char( (zigzag & 0x7F) | 0x80 ) );
+		zigzag >>= 7;
+	}
+	output.push_back( char(zigzag) );
+}
+
+/*!	\param [in] data A pointer to the first byte of the varint.
+ * \param [in] end A pointer to the end of the available data.
+ * \param [out] value The decoded integer.
+ * \return A pointer to the byte which follows the varint or `nullptr` if the varint is incomplete or too long.
+ */
+const char * SweepCodec::GetVarint(const char * data, const char * end, std::int32_t & value)
+{
+	std::uint32_t zigzag=0;
+	for(unsigned int shift=0; shift<35 && data<end; shift+=7)
+	{
+		const std::uint8_t byte = *data++;
+		zigzag |= std::uint32_t(byte & 0x7F) << shift;
+		if( (byte & 0x80)==0 )
+		{
+			value = std::int32_t(zigzag >> 1) ^ -std::int32_t(zigzag & 1);
+			return data;
+		}
+	}
+	return nullptr;
+}
+
+/*!	\param [in] value The integer whose packed size is calculated.	*/
+std::size_t SweepCodec::GetVarintSize(const std::int32_t value)
+{
+	std::uint32_t zigzag = ( std::uint32_t(value) << 1 ) ^ std::uint32_t(value >> 31);
+	std::size_t size=1;
+	while(zigzag >= 0x80)
+	{
+		zigzag >>= 7;
+		size++;
+	}
+	return size;
+}
+
+/*!	The values are quantized multiplying them by 10 and rounding them to the nearest integer, with the ties rounded to
+ * the even integer, what is the same rounding which is done when the values are formatted with one decimal digit. The
+ * multiplication is exact because a float multiplied by 10 always fits in a double. If any value cannot be quantized,
+ * the sweep is encoded as RAW and the next sweep does not use it as reference.
+ * \param [in] values A pointer to the power values, in dBm.
+ * \param [in] numOfPoints The number of power values.
+ * \param [out] output The string where the encoded data are appended.
+ * \return The encoding which was used.
+ */
+SweepCodec::Encoding SweepCodec::Encode(const float * values, const std::size_t numOfPoints, std::string & output)
+{
+	bool flagQuantizable=true;
+	quantValues.resize(numOfPoints);
+	for(std::size_t i=0; i<numOfPoints && flagQuantizable; i++)
+	{
+		const double scaledValue = double(values[i]) * 10.0;
+		if( !std::isfinite(scaledValue) || std::fabs(scaledValue) > MAX_QUANT_VALUE )
+			flagQuantizable=false;
+		else
+		{
+			quantValues[i] = std::int32_t( std::nearbyint(scaledValue) );
+			//The negative values which are rounded to zero are formatted as "-0.0", so they must be kept as-is
+			if( quantValues[i]==0 && std::signbit(scaledValue) )
+				flagQuantizable=false;
+		}
+	}
+
+	if(!flagQuantizable)
+	{
+		output.push_back( char(RAW) );
+		output.append( (const char*) values, numOfPoints*sizeof(float) );
+		reference.clear();
+		return RAW;
+	}
+
+	//The encoding which gives the smaller size is chosen
+	Encoding encoding = INTRA;
+	if( reference.size()==numOfPoints )
+	{
+		std::size_t intraSize=0, interSize=0;
+		std::int32_t previous=0;
+		for(std::size_t i=0; i<numOfPoints; i++)
+		{
+			intraSize += GetVarintSize( quantValues[i] - previous );
+			interSize += GetVarintSize( quantValues[i] - reference[i] );
+			previous = quantValues[i];
+		}
+		if(interSize < intraSize)
+			encoding = INTER;
+	}
+
+	output.push_back( char(encoding) );
+	std::int32_t previous=0;
+	for(std::size_t i=0; i<numOfPoints; i++)
+	{
+		const std::int32_t prediction = (encoding==INTER) ? reference[i] : previous;
+		PutVarint( output, quantValues[i] - prediction );
+		previous = quantValues[i];
+	}
+
+	reference.swap(quantValues);
+	return encoding;
+}
+
+/*!	The decoded values are the nearest floats to the quantized values divided by 10, so they are formatted with one
+ * decimal digit exactly as the original values.
+ * \param [in] data A pointer to the encoded data of a sweep.
+ * \param [in] size The number of available bytes, which may be more than the ones of the sweep.
+ * \param [out] values A pointer to the array where the power values are written.
+ * \param [in] numOfPoints The number of power values.
+ * \return The number of bytes of the encoded sweep.
+ */
+std::size_t SweepCodec::Decode(const char * data, const std::size_t size, float * values, const std::size_t numOfPoints)
+{
+	if(size==0)
+		throw rfims_exception("an empty sweep was tried to be decoded.");
+
+	const char * const end = data + size;
+	const char * pos = data + 1;
+	const std::uint8_t encoding = data[0];
+
+	if(encoding==RAW)
+	{
+		if( std::size_t(end-pos) < numOfPoints*sizeof(float) )
+			throw rfims_exception("an incomplete sweep was tried to be decoded.");
+		std::memcpy( values, pos, numOfPoints*sizeof(float) );
+		reference.clear();
+		return 1 + numOfPoints*sizeof(float);
+	}
+
+	if( encoding!=INTRA && encoding!=INTER )
+		throw rfims_exception("a sweep with an unknown encoding was tried to be decoded.");
+
+	if( encoding==INTER && reference.size()!=numOfPoints )
+		throw rfims_exception("a sweep which depends on a missing previous sweep was tried to be decoded.");
+
+	quantValues.resize(numOfPoints);
+	std::int32_t previous=0;
+	for(std::size_t i=0; i<numOfPoints; i++)
+	{
+		std::int32_t difference;
+		pos = GetVarint(pos, end, difference);
+		if(pos==nullptr)
+			throw rfims_exception("an incomplete or corrupt sweep was tried to be decoded.");
+
+		const std::int64_t value = std::int64_t( (encoding==INTER) ? reference[i] : previous ) + difference;
+		if( value > MAX_QUANT_VALUE || value < -MAX_QUANT_VALUE )
+			throw rfims_exception("a corrupt sweep was tried to be decoded.");
+		quantValues[i] = value;
+		values[i] = float( quantValues[i] / 10.0 );
+		previous = quantValues[i];
+	}
+
+	reference.swap(quantValues);
+	return pos - data;
+}
@@ -7,6 +7,7 @@
  * 	- Adjusting (interpolation) of frequency curves.
  * 	- Front end calibration.
  * 	- RFI detection.
+ * 	- Spectrum occupancy statistics.
  * 	- Data logging.
  * 	\author Mauro Diamantino
  */
@@ -16,9 +17,14 @@
 
 // Inclusion of the header file which has the declarations of the global functions, global classes, etc. and the inclusions of the global libraries.
 #include "Basics.h"
+// Inclusion of the header file which has the declarations of the classes which implement the storage formats of the measurements.
+#include "DataStorage.h"
+// Inclusion of the header file which has the declarations of the classes which upload the measurements to the remote server.
+#include "DataUploading.h"
 
 #include "gnuplot_i.hpp" //A C++ interface to gnuplot
 #include <queue> //This library allows the use the `std::queue` container
+#include <map> //This library allows the use the `std::map` container
 
 
 //! The class _RFPlotter_ is intended to plot sweeps, RF interference (RFI) and any frequency curve.
@@ -189,6 +195,8 @@ public:
 	const FreqValues& AdjustCurve(const FreqValues & curve);
 	//! This method returns the last adjusted curve.
 	const FreqValues& GetAdjustedCurve() const {	return adjCurve;	}
+	//! This method returns the frequency values (Hz) of the reference sweep, i.e. the frequency grid of the adjusted curves.
+	const std::vector<std::uint_least64_t> & GetRefFrequencies() const {	return refSweep.frequencies;	}
 };
 
 //! The aim of this class is to calculate the total gain and total noise figure curves versus frequency of the RF front end.
@@ -298,21 +306,50 @@ class RFIDetector
 	//Class' attributes//
 	//Constants
 	const std::string THRESHOLDS_PATH = BASE_PATH + "/thresholds"; //!< The path were there are the files wit the thresholds curve.
+	const std::string THRESH_CACHE_PATH = THRESHOLDS_PATH + "/cache"; //!< The path where the adjusted thresholds curves are cached in binary files.
+	const std::uint32_t THRESH_CACHE_VERSION = 1; //!< The version of the format of the cache files.
 	const double ANTENNA_GAIN = 5.0; //!< The gain of the Aaronia HyperLOG 60100 antenna, measured in dBi.
 	const double SPEED_OF_LIGHT = 2.99792e8; //!< The speed of light in vacuum, measured in m/s.
+	const float NF_MIN_POWER = -200.0; //!< The lowest power value (dBm) which is taken into account by the noise floor estimation.
+	const float NF_MAX_POWER = 50.0; //!< The highest power value (dBm) which is taken into account by the noise floor estimation.
+	const float NF_RESOLUTION = 0.1; //!< The resolution (dB) with which the power values are quantized to estimate the noise floor.
 	//Variables
 	CurveAdjuster & adjuster; //!< A reference to the _CurveAdjuster_ object, which is used here to adjust some internal curves.
 	std::vector<BandParameters> bandsParameters; //!< A vector with the parameters of all frequency bands.
 	RFI rfi; //!< A structure which stores the last detected RFI.
 	FreqValues thresholdsCurve; //!< A structure which stores the thresholds curve.
 	time_t threshFileLastWriteTime; //!< The last-modification time (seconds from the Unix epoch) of the file with the threshold curve.
+	std::uint64_t threshCurveKey; //!< A hash of all the inputs (norm, bands parameters, antenna gain, frequency grid and file time) of the loaded thresholds curve.
+	bool flagNoiseFloorDetection; //!< A flag which indicates if the detection relative to the noise floor is enabled.
+	float nfMargin; //!< The margin (dB) above the estimated noise floor from which a point is considered RFI.
+	unsigned int nfWindowSize; //!< The number of points of the sliding window which is used to estimate the noise floor.
+	float nfPercentile; //!< The percentile (between 0 and 100) of the power values in the sliding window which is taken as the noise floor.
+	RFI nfRFI; //!< A structure which stores the last RFI detected relative to the noise floor.
+	FreqValues noiseFloor; //!< A structure which stores the last estimated noise floor.
+	std::vector<std::uint32_t> nfHistogram; //!< A Fenwick tree with the histogram of the quantized power values of the sliding window. It is reused between sweeps.
+	std::vector<std::uint16_t> nfQuantValues; //!< The quantized power values of the last sweep. It is reused between sweeps.
+	//Private methods//
+	//! This method tries to load the thresholds curve from the cache file, returning `true` if it was possible.
+	bool LoadCachedThreshCurve(const boost::filesystem::path & cachePath, const std::uint64_t key);
+	//! This method saves the thresholds curve into a cache file.
+	void SaveCachedThreshCurve(const boost::filesystem::path & cachePath, const std::uint64_t key) const;
+	//! This method quantizes a power value (dBm) to an index of the noise floor histogram.
+	std::uint16_t QuantizePower(const float power) const;
+	//! This method adds a value to the count of a bin of the noise floor histogram.
+	void UpdateHistogram(std::size_t bin, const int value);
+	//! This method returns the bin of the noise floor histogram where the cumulative count reaches the given rank.
+	std::size_t FindHistogramRank(std::uint32_t rank) const;
 public:
 	//Class interface//
 	//! The unique class constructor.
 	/*!	At instantiation the programmer must provide a reference to a _CurveAdjuster_ object.
 	 * \param [in] adj A _CurveAdjuster_ object.
 	 */
-	RFIDetector(CurveAdjuster & adj) : adjuster(adj), thresholdsCurve("threshold curve") { threshFileLastWriteTime=0; }
+	RFIDetector(CurveAdjuster & adj) : adjuster(adj), thresholdsCurve("threshold curve"), noiseFloor("noise floor")
+	{
+		threshFileLastWriteTime=0; threshCurveKey=0; flagNoiseFloorDetection=false; nfMargin=10.0; nfWindowSize=101; nfPercentile=50.0;
+		nfRFI.threshNorm=RFI::NOISE_FLOOR;
+	}
 	//! The class destructor.
 	/*!	Its implementation is empty because the attributes destruction is implicitly. However, the
 	 * destructor is defined here to allow this one to be called explicitly in any part of the code,
@@ -324,6 +361,10 @@ public:
 	void SetBandsParameters(const std::vector<BandParameters> & bandsParam) {	bandsParameters=bandsParam;	}
 	//! This method loads a determined thresholds curve from the corresponding file.
 	void LoadThreshCurve(const RFI::ThresholdsNorm thrNorm);
+	//! This method enables the detection of RFI relative to the noise floor, which is performed alongside the detection relative to the threshold curve.
+	void EnableNoiseFloorDetection(const float margin, const unsigned int windowSize=101, const float percentile=50.0);
+	//! This method disables the detection of RFI relative to the noise floor.
+	void DisableNoiseFloorDetection() {	flagNoiseFloorDetection=false; nfRFI.Clear(); noiseFloor.Clear();	}
 	//! This method detects RFI in a calibrated sweep.
 	const RFI & DetectRFI(const Sweep & sweep);
 	//! This method returns the threshold curve which has been loaded.
@@ -332,6 +373,105 @@ public:
 	unsigned int GetNumOfRFIBands() const {		return rfi.numOfRFIBands;	}
 	//! This method returns the last detected RFI.
 	const RFI & GetRFI() const {	return rfi;		}
+	//! This method returns the number of RFI bands which were detected relative to the noise floor in the last sweep.
+	unsigned int GetNumOfNoiseFloorRFIBands() const {	return nfRFI.numOfRFIBands;	}
+	//! This method returns the last RFI which was detected relative to the noise floor.
+	const RFI & GetNoiseFloorRFI() const {	return nfRFI;	}
+	//! This method returns the noise floor which was estimated in the last sweep.
+	const FreqValues & GetNoiseFloor() const {	return noiseFloor;	}
+};
+
+//! The aim of this class is to accumulate the spectrum occupancy statistics of each frequency bin, in each azimuth position and polarization, as the calibrated sweeps are produced.
+/*!	The statistics are updated online, sweep by sweep, so the raw files of the measurements do not need to be read again
+ * 	to know the spectrum occupancy. For each frequency bin, azimuth position and polarization, the running mean and variance
+ * 	(Welford's algorithm), the max-hold value and the number of times the threshold curve was exceeded (from which the duty
+ * 	cycle is got) are kept. The memory used is fixed once the frequency grid is known and it does not grow with the number
+ * 	of sweeps. The statistics are saved into a checkpoint file at the end of each measurement cycle and they are reloaded
+ * 	from it at start-up, provided that the frequency grid and the number of azimuth positions did not change.
+ */
+class OccupancyStatistics
+{
+public:
+	//Class data types//
+	//! This structure stores the statistics of one frequency bin, in a determined azimuth position and polarization.
+	struct BinStatistics
+	{
+		std::uint32_t numOfSamples; //!< The number of power values which were taken into account.
+		std::uint32_t numOfExceedances; //!< The number of power values which were above the threshold curve.
+		float maxHold; //!< The maximum power value, in dBm.
+		double mean; //!< The running mean of the power values, in dBm.
+		double m2; //!< The running sum of the squared differences from the mean (Welford's algorithm).
+		//! This method returns the variance of the power values, in dB².
+		double Variance() const {	return( numOfSamples > 1 ? m2/(numOfSamples-1) : 0.0 );	}
+		//! This method returns the fraction of the power values which were above the threshold curve, between 0 and 1.
+		double DutyCycle() const {	return( numOfSamples > 0 ? double(numOfExceedances)/numOfSamples : 0.0 );	}
+	};
+private:
+	//Attributes//
+	//Constants
+	const std::string STATISTICS_PATH = BASE_PATH + "/statistics"; //!< The path where the checkpoint file is saved.
+	const std::string CHECKPOINT_FILENAME = "occupancy.bin"; //!< The name of the checkpoint file.
+	const std::uint32_t CHECKPOINT_VERSION = 1; //!< The version of the checkpoint file format.
+	//Variables
+	std::vector<BinStatistics> statistics; //!< The statistics of all bins, ordered by azimuth position, then polarization and then frequency.
+	std::vector<std::uint_least64_t> frequencies; //!< The frequency values (Hz) of the grid.
+	unsigned int numOfAzimPos; //!< The number of azimuth positions.
+	std::uint64_t gridHash; //!< A hash of the frequency grid and the number of azimuth positions, which is used to validate the checkpoint file.
+	std::uint32_t numOfSweeps; //!< The number of sweeps which were taken into account.
+	TimeData firstSweepTime; //!< The timestamp of the first sweep which was taken into account.
+	TimeData lastSweepTime; //!< The timestamp of the last sweep which was taken into account.
+	//Private methods//
+	//! This method prepares the internal structures for a new frequency grid, trying to reload the statistics from the checkpoint file.
+	void SetGrid(const std::vector<std::uint_least64_t> & freqs);
+	//! This method returns the index of the first bin which corresponds to the given azimuth position and polarization.
+	std::size_t GetOffset(const unsigned int azimPosIndex, const unsigned int polIndex) const {	return( (azimPosIndex*2 + polIndex) * frequencies.size() );	}
+	//! This method determines the polarization index (0 for horizontal and 1 for vertical) from the polarization string.
+	unsigned int GetPolIndex(const std::string & polarization) const;
+	//! This method reads the statistics from a checkpoint file, either only if it corresponds to the current frequency grid or taking the grid of the file.
+	bool ReadCheckpoint(const std::string & filePath, const bool flagKeepGrid);
+public:
+	//Class interface//
+	//! The unique class constructor.
+	OccupancyStatistics();
+	//! A constructor which loads the statistics of a checkpoint file, with its frequency grid and its number of azimuth positions, so they can be queried.
+	explicit OccupancyStatistics(const std::string & checkpointPath);
+	//! The class destructor.
+	/*!	Its implementation is empty because the attributes destruction is implicitly. However, the
+	 * destructor is defined here to allow this one to be called explicitly in any part of the code,
+	 * what is used by the signals handler to destroy the objects when a signal to finish the execution
+	 * of the software is received.
+	 */
+	~OccupancyStatistics() {}
+	//! This method allows to set the number of azimuth positions.
+	void SetNumOfAzimPos(const unsigned int number);
+	//! This method updates the statistics with a calibrated sweep.
+	void Update(const Sweep & sweep, const unsigned int azimPosIndex, const FreqValues & threshCurve);
+	//! This method saves the statistics into the checkpoint file.
+	void SaveCheckpoint() const;
+	//! This method loads the statistics from the checkpoint file, if it corresponds to the current frequency grid.
+	bool LoadCheckpoint();
+	//! This method clears all the statistics, but the frequency grid is kept.
+	void Reset();
+	//! This method returns the statistics of the bin which is the nearest one to the given frequency, in the given azimuth position and polarization.
+	const BinStatistics & GetBinStatistics(const std::uint_least64_t freq, const unsigned int azimPosIndex, const std::string & polarization) const;
+	//! This method returns a curve with the mean power values versus frequency, in the given azimuth position and polarization.
+	FreqValues GetMeanCurve(const unsigned int azimPosIndex, const std::string & polarization) const;
+	//! This method returns a curve with the max-hold power values versus frequency, in the given azimuth position and polarization.
+	FreqValues GetMaxHoldCurve(const unsigned int azimPosIndex, const std::string & polarization) const;
+	//! This method returns a curve with the duty cycle (between 0 and 1) versus frequency, in the given azimuth position and polarization.
+	FreqValues GetDutyCycleCurve(const unsigned int azimPosIndex, const std::string & polarization) const;
+	//! This method returns the number of azimuth positions.
+	unsigned int GetNumOfAzimPos() const {	return numOfAzimPos;	}
+	//! This method returns the frequency values (Hz) of the grid.
+	const std::vector<std::uint_least64_t> & GetFrequencies() const {	return frequencies;	}
+	//! This method returns the number of sweeps which were taken into account.
+	unsigned int GetNumOfSweeps() const {	return numOfSweeps;	}
+	//! This method returns the timestamp of the first sweep which was taken into account.
+	const TimeData & GetFirstSweepTime() const {	return firstSweepTime;	}
+	//! This method returns the timestamp of the last sweep which was taken into account.
+	const TimeData & GetLastSweepTime() const {	return lastSweepTime;	}
+	//! This method states if the statistics are empty, i.e. no sweep has been taken into account.
+	bool Empty() const {	return( numOfSweeps==0 );	}
 };
 
 //! The class _DataLogger_ is intended to handle the storing of the generated data into memory, following the CSV (comma-separated values) format.
@@ -343,9 +483,16 @@ class DataLogger
 	const std::string FRONT_END_PARAM_PATH = BASE_PATH + "/calibration/frontendparam"; //!< The path were the files with the front end parameters must be saved.
 	const std::string BANDS_PARAM_CSV_PATH = BASE_PATH + "/parameters/csv"; //!< The path were the file with the parameters of all frequency bands is saved, with CSV format.
 	const std::string UPLOADS_PATH = BASE_PATH + "/uploads"; //!< The path were the files to be uploaded must be put.
+	const std::string JOURNAL_PATH = BASE_PATH + "/journal.bin"; //!< The path of the journal of the operations over the measurements.
+	const std::string RETENTION_INDEX_PATH = BASE_PATH + "/retention_index.txt"; //!< The path of the index of the files of the measurement cycles, which is used to remove the old files.
+	const unsigned int RETENTION_DAYS = 30; //!< The number of days the files of the measurement cycles are kept.
 	//const unsigned int NUM_OF_POSITIONS = 6; //!< The number of azimuth positions of the antenna positioning system.
 	//Variables
-	std::ofstream ofs; //!< This object is used to write the data into the different files, following a specific format.
+	std::ostringstream oss; //!< This object is used to format the text of the CSV files, before it is written to the files.
+	CSVFormatter csvFormatter; //!< This object is used to format the rows of the sweeps and RFI files, which are written once per sweep, in a buffer which is reused.
+	SweepStoreWriter sweepStore; //!< This object is used to append the sweeps of the current measurement cycle to a binary sweeps store file.
+	BufferedFileWriter rfiFile; //!< This object is used to append the RFI of the current measurement cycle to a single file, which is kept open during the cycle.
+	std::vector<BandParameters> bandsParameters; //!< The last bands parameters which were given to the object, which are saved in the header of the sweeps store files.
 	unsigned int sweepIndex; //!< An index which allows to know which is the current sweep in the entire measurement cycle, and how many sweeps remain until the end.
 	unsigned int numOfSweeps; //!< Total number of sweeps
 	std::string currMeasCycleTimestamp; //!< The timestamp of the current measurement cycle, which is taken as the date at the beginning.
@@ -353,11 +500,110 @@ class DataLogger
 	bool flagNewFrontEndParam; //!< A flag which indicates if new front end parameters were estimated and inserted to this object to save them into memory, in the current measurement cycle.
 	bool flagStoredRFI; //!< A flag which indicates if the object was asked to store RFI in the current measurement cycle.
 	bool flagUseSweepTimestamp;
-	std::queue<std::string> filesToUpload; //!< A structure which contains the names of the files which remain to be uploaded.
-	pthread_t uploadThread; //!< A variable which saves the ID of the thread created to upload the data to remote server, in parallel with the capture of a new sweep.
-	char threadMsg[100]; //!< An array which saves a message the thread can returned when there was an error.
+	DataUploader uploader; //!< The object which keeps the persistent queue of the files which remain to be uploaded, and which uploads them when an upload server was set.
+	pthread_t uploadThread; //!< The ID of the thread which archives and uploads the data of the finished measurement cycles, in parallel with the capture of new sweeps.
+	IOStatistics cycleIOStats; //!< The counters of the input/output operations of the current measurement cycle.
+	IOStatistics lastCycleIOStats; //!< The counters of the input/output operations of the last finished measurement cycle.
+	TarArchiveWriter archiveWriter; //!< The object which archives and compresses the data files of a measurement cycle.
+	CompressedFileWriter::Format archiveFormat; //!< The compression format of the archives.
+	CompressionStatistics lastArchiveStats; //!< The statistics of the compression of the last archive.
+	IncrementalArchiveWriter cycleArchive; //!< The object which builds the archive of the current measurement cycle while the data are saved.
+	bool flagIncrementalArchive; //!< A flag which indicates if the archive of each measurement cycle must be built while the data are saved.
+	std::string readyArchiveName; //!< The name of the archive which was built incrementally for the last finished measurement cycle, or an empty string.
+	MeasurementJournal journal; //!< The journal of the operations over the measurements, which allows to recover the data after a power cut.
+	//! A structure which stores the data of a measurement cycle which was recovered from the journal and which remains to be archived.
+	struct RecoveredCycle
+	{
+		std::string timestamp; //!< The timestamp of the measurement cycle.
+		bool flagNewFrontEndParam; //!< A flag which indicates if front end parameters were estimated in the measurement cycle.
+		bool flagNewBandsParam; //!< A flag which indicates if the bands parameters were loaded in the measurement cycle.
+		bool flagRFI; //!< A flag which indicates if RFI were stored in the measurement cycle.
+	};
+	std::vector<RecoveredCycle> recoveredCycles; //!< The measurement cycles which were recovered from the journal and which remain to be archived.
+	RetentionIndex retentionIndex; //!< The index of the files of the measurement cycles, ordered by their timestamps, which allows to remove the old files without scanning the folders.
+	std::uint64_t storageQuota; //!< The maximum total size of the files of the measurement cycles, in bytes, or 0 if there is no quota.
 public:
 	enum TimestampSource {SWEEP, FRONTENDPARAM};
+	//! An enumeration with the policies which define when the data are synchronized with the storage device: after each sweep, at the end of each measurement cycle or periodically.
+	enum DurabilityPolicy {SYNC_PER_SWEEP, SYNC_PER_CYCLE, SYNC_PERIODIC};
+	//! An enumeration with the policies which define what happens when the logging queue is full: the producer waits, or the plotting is skipped since the queue is half full to give time to the logging thread.
+	enum QueueFullPolicy {BLOCK, SKIP_PLOTS};
+private:
+	DurabilityPolicy durabilityPolicy; //!< The policy which defines when the data are synchronized with the storage device.
+	unsigned int syncPeriod; //!< The period, in seconds, of the synchronization when the policy is SYNC_PERIODIC.
+	std::chrono::steady_clock::time_point lastSyncTime; //!< The last time the data were synchronized with the storage device.
+	//! A structure which stores a sweep or a RFI which is waiting in the logging queue to be saved.
+	struct LogElement
+	{
+		bool flagRFI; //!< A flag which indicates if the element is a RFI or a sweep.
+		Sweep sweep; //!< The sweep to be saved, if the element is a sweep.
+		RFI rfi; //!< The RFI to be saved, if the element is a RFI.
+		std::chrono::steady_clock::time_point queueTime; //!< The time the element was inserted in the queue.
+	};
+	std::queue<LogElement> logQueue; //!< The queue of sweeps and RFI which are waiting to be saved by the logging thread.
+	unsigned int queueCapacity; //!< The maximum number of elements of the logging queue.
+	QueueFullPolicy queueFullPolicy; //!< The policy which defines what happens when the logging queue is full.
+	QueueStatistics queueStats; //!< The statistics of the logging queue.
+	pthread_t loggingThread; //!< The ID of the thread which saves the elements of the logging queue.
+	bool flagLoggingThread; //!< A flag which indicates if the logging thread is running. If it is not, the data are saved synchronously.
+	bool flagStopLogging; //!< A flag which asks the logging thread to finish, once the queue is empty.
+	bool flagSavingElement; //!< A flag which indicates the logging thread is saving an element which was already taken from the queue.
+	std::string loggingErrorMsg; //!< The message of the last error which happened in the logging thread and which has not been reported yet.
+	pthread_mutex_t queueMutex; //!< The mutex which protects the logging queue and its related attributes.
+	pthread_cond_t queueNotEmptyCond; //!< The condition the logging thread waits for when the queue is empty.
+	pthread_cond_t queueNotFullCond; //!< The condition the producer waits for when the queue is full.
+	pthread_cond_t queueDrainedCond; //!< The condition which is signaled when the queue is empty and no element is being saved.
+	//! A structure which stores the data of a finished measurement cycle which must be archived and uploaded by the upload thread. They are taken when the job is queued, so the thread does not depend on the state of the next cycles.
+	struct UploadJob
+	{
+		std::string timestamp; //!< The timestamp of the measurement cycle.
+		std::string readyArchiveName; //!< The name of the archive which was built incrementally, or an empty string if the data must be archived.
+		CompressionStatistics archiveStats; //!< The statistics of the archive which was built incrementally.
+		std::vector< std::pair<std::string, boost::filesystem::path> > paramFiles; //!< The names and the paths of the parameters files which must be archived.
+		bool flagRFI; //!< A flag which indicates if RFI were stored in the measurement cycle.
+	};
+	std::queue<UploadJob> uploadJobs; //!< The queue of measurement cycles which are waiting to be archived and uploaded by the upload thread.
+	std::multiset<std::string> pendingJobTimestamps; //!< The timestamps of the measurement cycles whose jobs are queued or being done, whose files must not be removed to fit the storage quota.
+	bool flagUploadThread; //!< A flag which indicates if the upload thread is running. If it is not, the jobs are done synchronously.
+	bool flagStopUploading; //!< A flag which asks the upload thread to finish, once the pending jobs have been archived.
+	unsigned int uploadRetryPeriod; //!< The period, in seconds, with which the upload thread retries the uploading of the pending files when it has no job, if the files are uploaded natively.
+	pthread_mutex_t jobsMutex; //!< The mutex which protects the queue of upload jobs and its related attributes.
+	pthread_cond_t jobsCond; //!< The condition the upload thread waits for when there is no job.
+	//Private methods//
+	//! This method saves a sweep immediately, in the thread which calls it.
+	void WriteSweep(const Sweep& sweep);
+	//! This method saves a RFI immediately, in the thread which calls it.
+	void WriteRFI(const RFI& rfi);
+	//! This method inserts an element in the logging queue, waiting if the queue is full.
+	void QueueElement(LogElement && element);
+	//! This method is executed by the logging thread to save the elements of the logging queue, in the same order they were inserted.
+	void ProcessLogQueue();
+	//! This method waits until the logging queue is empty and returns the message of the last error of the logging thread, if there was one.
+	std::string WaitForLogQueue();
+	//! This method synchronizes the open files with the storage device if the durability policy requires it.
+	void ApplyDurabilityPolicy();
+	//! This method writes the text which was formatted in the attribute _oss_ to a new file.
+	void SaveTextFile(const boost::filesystem::path & filePath);
+	//! This method returns the names and the paths of the files with the front end and bands parameters which must be archived with a measurement cycle.
+	std::vector< std::pair<std::string, boost::filesystem::path> > GetParamFilesToArchive(const std::string & timestamp, const bool flagFrontEndParam, const bool flagBandsParam) const;
+	//! This method returns the names and the paths of the files with the front end and bands parameters which must be archived with the current measurement cycle.
+	std::vector< std::pair<std::string, boost::filesystem::path> > GetParamFilesToArchive() const
+	{
+		return GetParamFilesToArchive(currMeasCycleTimestamp, flagNewFrontEndParam, flagNewBandsParam);
+	}
+	//! This method reads the journal, repairs the data files of the measurement cycles which were interrupted and compacts the journal.
+	void RecoverFromJournal();
+	//! This method adds the files which are in the folders of measurements and front end parameters to the retention index, when the index is created.
+	void IndexExistingFiles();
+	//! The aim of this method is to prepare, archive and compress, the files of a measurement cycle which will be send to the remote server.
+	void ArchiveAndCompress(const UploadJob & job);
+	//! This method archives and uploads the data of a measurement cycle, reporting the errors as warnings.
+	void DoUploadJob(const UploadJob & job, const bool flagUploading);
+	//! This method is executed by the upload thread to do the upload jobs, in the same order they were queued, and to retry the failed uploads.
+	void ProcessUploadJobs();
+	//! This method inserts a job in the queue of the upload thread, or it does the job if there is no upload thread.
+	void QueueUploadJob(UploadJob && job);
+public:
 	//Class interface//
 	//! The unique class constructor.
 	DataLogger();
@@ -375,16 +621,52 @@ public:
 	void SaveSweep(const Sweep& sweep);
 	//! This method is intended to save the detected RFI in the last sweep, into the non-volatile memory.
 	void SaveRFI(const RFI& rfi);
+	//! This method inserts a calibrated sweep in the logging queue, so it is saved into the non-volatile memory by the logging thread.
+	void QueueSweep(Sweep&& sweep);
+	//! This method inserts the detected RFI in the last sweep in the logging queue, so it is saved into the non-volatile memory by the logging thread.
+	void QueueRFI(RFI&& rfi);
+	//! This method waits until all the elements of the logging queue have been saved.
+	void Drain();
+	//! This method sets the maximum number of elements of the logging queue and the policy which defines what happens when the queue is full.
+	void SetQueueParameters(const unsigned int capacity, const QueueFullPolicy policy);
+	//! This method states if the logging queue is congested, so the plotting should be skipped to give time to the logging thread.
+	bool IsCongested();
+	//! This method returns the statistics of the logging queue.
+	QueueStatistics GetQueueStatistics();
+	//! This method sets the policy which defines when the data are synchronized with the storage device.
+	void SetDurabilityPolicy(const DurabilityPolicy policy, const unsigned int period=60) {	durabilityPolicy=policy; syncPeriod=period;	}
+	//! This method synchronizes and closes the files of the current measurement cycle, so they are ready to be archived.
+	void FinishMeasCycle();
+	//! This method sets the format and the preset of the compression of the archives which are uploaded.
+	void SetCompression(const CompressedFileWriter::Format format, const std::uint32_t preset)
+	{
+		archiveFormat=format; archiveWriter.SetCompression(format, preset); cycleArchive.SetCompression(preset);
+	}
+	//! This method enables or disables the building of the archive of each measurement cycle while the data are saved. It is only possible with the XZ format.
+	void EnableIncrementalArchive(const bool flagEnable) {	flagIncrementalArchive=flagEnable;	}
+	//! This method defines if the power values of the sweeps are saved in the binary store as quantized differences. It takes effect with the next sweeps file.
+	void SetSweepEncoding(const bool flagEnable) {	sweepStore.SetEncoding(flagEnable);	}
+	//! This method sets the server where the archives are uploaded natively and the number of archives which are uploaded at the same time. If the host is empty, the script client.py is used.
+	void SetUploadServer(const std::string & host, const std::uint16_t port, const unsigned int numOfThreads);
+	//! This method sets the maximum interval, in milliseconds, between two commits of the journal, or 0 to commit the journal only when the data are synchronized according to the durability policy.
+	void SetJournalCommitInterval(const unsigned int interval) {	journal.SetCommitInterval(interval);	}
+	//! This method queues the measurement cycles which were recovered from the journal, and which were not archived, to be archived and uploaded.
+	std::size_t QueueRecoveredCycles();
+	//! This method returns the counters of the input/output operations of the last finished measurement cycle.
+	const IOStatistics & GetLastCycleIOStatistics() const {		return lastCycleIOStats;	}
+	//! This method sets the maximum total size, in bytes, of the files of the measurement cycles, or 0 if there is no quota.
+	void SetStorageQuota(const std::uint64_t quota) {	storageQuota=quota;	}
 	//! The aim of this method is to delete the old files.
-	void DeleteOldFiles() const;
-	//! The aim of this method is to prepare, archive and compress, the files which will be send to the remote server.
-	void ArchiveAndCompress();
+	void DeleteOldFiles();
 	//! This method is responsible for the uploading of the data files to the remote server.
 	void UploadData();
-	//! This method creates a thread where the data files will be uploaded, in parallel with the capture of a new sweep.
+	//! This method queues the data of the last measurement cycle to be archived and uploaded by the upload thread, without waiting.
 	void PrepareAndUploadData();
+	//! This method returns the number of measurement cycles which are waiting to be archived and uploaded.
+	std::size_t GetNumOfUploadJobs();
 	//Friend functions//
 	friend void *UploadThreadFunc(void*);
+	friend void *LoggingThreadFunc(void*);
 };
 
 #endif /* SWEEPPROCESSING_H_ */
@@ -0,0 +1,274 @@
+/*! \file SweepStoreReader.cpp
+ * 	\brief This file contains the definitions of several methods of the class _SweepStoreReader_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataStorage.h"
+
+/*!	If there was a file mapped, it is unmapped before. If the last record is incomplete, because the file is being
+ * written or the writing was interrupted, this one is ignored. The files whose power values are encoded (version 2) are
+ * decoded completely when they are opened.
+ * \param [in] path The path of the binary sweeps store file.
+ */
+void SweepStoreReader::Open(const std::string & path)
+{
+	Close();
+
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0)
+		throw rfims_exception("the sweeps store file " + path + " could not be opened.");
+
+	struct stat fileStatus;
+	if( fstat(fd, &fileStatus) < 0 || std::size_t(fileStatus.st_size) < sizeof(SweepStoreFileHeader) )
+	{
+		close(fd);
+		throw rfims_exception("the sweeps store file " + path + " is too short.");
+	}
+
+	void * addr = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(addr == MAP_FAILED)
+		throw rfims_exception("the sweeps store file " + path + " could not be mapped into memory.");
+
+	mapAddr = (const char*) addr;
+	mapSize = fileStatus.st_size;
+	header = (const SweepStoreFileHeader*) mapAddr;
+
+	const std::size_t rawRecordSize = sizeof(SweepStoreRecordHeader) + std::size_t(header->numOfPoints)*sizeof(float);
+	if( !std::equal(header->magic, header->magic+8, "RFIMSSWP") || (header->version!=1 && header->version!=2) ||
+			header->headerSize!=sizeof(SweepStoreFileHeader) + header->numOfBands*sizeof(SweepStoreBandRecord) + std::size_t(header->numOfPoints)*sizeof(std::uint64_t) ||
+			header->recordSize!=(header->version==1 ? rawRecordSize : 0) || mapSize < header->headerSize )
+	{
+		Close();
+		throw rfims_exception("the file " + path + " is not a valid sweeps store file.");
+	}
+
+	if(header->version==1)
+		numOfRecords = (mapSize - header->headerSize) / header->recordSize;
+	else
+		DecodeRecords();
+
+	madvise( (void*) mapAddr, mapSize, MADV_SEQUENTIAL );
+}
+
+void SweepStoreReader::Close()
+{
+	if(mapAddr!=nullptr)
+		munmap( (void*) mapAddr, mapSize );
+
+	mapAddr=nullptr;
+	mapSize=0;
+	header=nullptr;
+	numOfRecords=0;
+	recordOffsets.clear();
+	decodedValues.clear();
+}
+
+/*!	The records are decoded in order, because each one may depend on the previous one. The decoding stops at the first
+ * record which is incomplete or corrupt, as it happens with an incomplete record of the version 1.
+ */
+void SweepStoreReader::DecodeRecords()
+{
+	const std::size_t numOfPoints = header->numOfPoints;
+	SweepCodec codec;
+	std::size_t offset = header->headerSize;
+	std::vector<float> values(numOfPoints);
+
+	while( mapSize - offset >= sizeof(SweepStoreRecordHeader) )
+	{
+		auto recordHeader = (const SweepStoreRecordHeader*) ( mapAddr + offset );
+		const std::size_t valuesOffset = offset + sizeof(SweepStoreRecordHeader);
+		if( recordHeader->reserved > mapSize - valuesOffset )
+			break;
+
+		try
+		{
+			if( codec.Decode(mapAddr + valuesOffset, recordHeader->reserved, values.data(), numOfPoints)!=recordHeader->reserved )
+				break;
+		}
+		catch(rfims_exception & exc)
+		{
+			break;
+		}
+
+		recordOffsets.push_back(offset);
+		decodedValues.insert( decodedValues.end(), values.begin(), values.end() );
+		offset = valuesOffset + recordHeader->reserved;
+	}
+
+	numOfRecords = recordOffsets.size();
+}
+
+/*!	\param [in] index The index of the record, starting at zero.	*/
+const SweepStoreRecordHeader * SweepStoreReader::GetRecordHeader(const std::size_t index) const
+{
+	if( index >= numOfRecords )
+		throw rfims_exception("a sweeps store record out of range was requested.");
+
+	if(header->version==1)
+		return (const SweepStoreRecordHeader*) ( mapAddr + header->headerSize + index*header->recordSize );
+	else
+		return (const SweepStoreRecordHeader*) ( mapAddr + recordOffsets[index] );
+}
+
+/*!	\param [in] index The index of the record, starting at zero.	*/
+const float * SweepStoreReader::GetValues(const std::size_t index) const
+{
+	if(header->version==1)
+		return (const float*) ( GetRecordHeader(index) + 1 );
+
+	if( index >= numOfRecords )
+		throw rfims_exception("a sweeps store record out of range was requested.");
+	return decodedValues.data() + index*header->numOfPoints;
+}
+
+std::vector<BandParameters> SweepStoreReader::GetBandsParameters() const
+{
+	std::vector<BandParameters> bandsParameters;
+	auto bandRecord = (const SweepStoreBandRecord*) ( mapAddr + sizeof(SweepStoreFileHeader) );
+
+	for(unsigned int i=0; i < header->numOfBands; i++, bandRecord++)
+	{
+		BandParameters band;
+		band.bandNumber = bandRecord->bandNumber;
+		band.flagEnable = bandRecord->flagEnable;
+		band.startFreq = bandRecord->startFreq;
+		band.stopFreq = bandRecord->stopFreq;
+		band.rbw = bandRecord->rbw;
+		band.vbw = bandRecord->vbw;
+		band.sweepTime = bandRecord->sweepTime;
+		band.flagDefaultSamplePoints = bandRecord->flagDefaultSamplePoints;
+		band.samplePoints = bandRecord->samplePoints;
+		band.detector = bandRecord->detector;
+		bandsParameters.push_back(band);
+	}
+
+	return bandsParameters;
+}
+
+/*!	\param [in] index The index of the record, starting at zero.	*/
+TimeData SweepStoreReader::GetTimeData(const std::size_t index) const
+{
+	const SweepStoreRecordHeader * recordHeader = GetRecordHeader(index);
+	TimeData timeData;
+	timeData.year = recordHeader->year;
+	timeData.month = recordHeader->month;
+	timeData.day = recordHeader->day;
+	timeData.hour = recordHeader->hour;
+	timeData.minute = recordHeader->minute;
+	timeData.second = recordHeader->second;
+	return timeData;
+}
+
+/*!	\param [in] index The index of the record, starting at zero.	*/
+std::string SweepStoreReader::GetPolarization(const std::size_t index) const
+{
+	switch( GetRecordHeader(index)->polarization )
+	{
+	case 0:
+		return "horizontal";
+	case 1:
+		return "vertical";
+	default:
+		return "";
+	}
+}
+
+/*!	\param [in] index The index of the record, starting at zero.	*/
+Sweep SweepStoreReader::GetSweep(const std::size_t index) const
+{
+	Sweep sweep;
+	const float * values = GetValues(index);
+	sweep.values.assign(values, values + header->numOfPoints);
+	sweep.frequencies.assign( GetFrequencies(), GetFrequencies() + header->numOfPoints );
+	sweep.timeData = GetTimeData(index);
+	sweep.azimuthAngle = GetAzimuthAngle(index);
+	sweep.polarization = GetPolarization(index);
+	return sweep;
+}
+
+/*!	The CSV layout is the following: a header row with the labels "Timestamp", "Azimuthal Angle" and "Polarization"
+ * followed by the frequency values in MHz (4 decimal digits), and then one row per sweep with the timestamp, the azimuth
+ * angle (1 decimal digit), the polarization and the power values in dBm (1 decimal digit). The rows end with "\r\n".
+ * \param [in] os The output stream where the CSV text is written.
+ */
+void SweepStoreReader::ExportCSV(std::ostream & os) const
+{
+	if( !IsOpen() )
+		throw rfims_exception("a sweeps store which is not open was asked to be exported to CSV.");
+
+	const std::size_t numOfPoints = header->numOfPoints;
+
+	//Each row is formatted in the same buffer and then it is given to the stream
+	CSVFormatter formatter;
+	WriteCSVHeader(formatter, GetFrequencies(), numOfPoints);
+	os.write( formatter.Data(), formatter.Size() );
+
+	for(std::size_t r=0; r<numOfRecords; r++)
+	{
+		formatter.Clear();
+		WriteCSVRow(formatter, GetTimeData(r).GetTimestamp(), GetAzimuthAngle(r), GetPolarization(r), GetValues(r), numOfPoints);
+		os.write( formatter.Data(), formatter.Size() );
+	}
+}
+
+/*!	\param [in,out] formatter The object where the CSV text is appended.
+ * \param [in] frequencies A pointer to the frequency values, in Hz.
+ * \param [in] numOfPoints The number of frequency values.
+ */
+void SweepStoreReader::WriteCSVHeader(CSVFormatter & formatter, const std::uint64_t * frequencies, const std::size_t numOfPoints)
+{
+	//Writing header with frequency values
+	formatter.Append("Timestamp,Azimuthal Angle,Polarization");
+	for(std::size_t i=0; i<numOfPoints; i++)
+	{
+		formatter.Append(',');
+		formatter.AppendFrequency( frequencies[i] ); //The frequency values are saved in MHz
+	}
+	formatter.Append("\r\n");
+}
+
+/*!	\param [in,out] formatter The object where the CSV text is appended.
+ * \param [in] timestamp The timestamp of the sweep.
+ * \param [in] azimuthAngle The azimuth angle of the antenna, in degrees.
+ * \param [in] polarization The antenna polarization: "horizontal", "vertical" or an empty string.
+ * \param [in] values A pointer to the power values, in dBm.
+ * \param [in] numOfPoints The number of power values.
+ */
+void SweepStoreReader::WriteCSVRow(CSVFormatter & formatter, const std::string & timestamp, const float azimuthAngle, const std::string & polarization,
+		const float * values, const std::size_t numOfPoints)
+{
+	//Writing the extra data
+	formatter.Append(timestamp);
+	formatter.Append(',');
+	formatter.AppendOneDecimal(azimuthAngle);
+	formatter.Append(',');
+	formatter.Append(polarization);
+
+	//Writing sweep's power values
+	for(std::size_t i=0; i<numOfPoints; i++)
+	{
+		formatter.Append(',');
+		formatter.AppendOneDecimal( values[i] ); //The power values are saved in dBm with just one decimal digit
+	}
+	formatter.Append("\r\n");
+}
+
+/*!	\param [in] csvPath The path of the CSV file, which is overwritten if it exists.	*/
+void SweepStoreReader::ExportCSV(const std::string & csvPath) const
+{
+	std::ofstream ofs;
+	ofs.exceptions( std::ofstream::failbit | std::ofstream::badbit );
+	try
+	{
+		ofs.open(csvPath, std::ofstream::out | std::ofstream::trunc);
+		ExportCSV(ofs);
+		ofs.close();
+	}
+	catch(std::ofstream::failure & exc)
+	{
+		rfims_exception rfimsExc("the CSV file " + csvPath + " could not be written");
+		rfimsExc.Append( exc.what() );
+		throw(rfimsExc);
+	}
+}
@@ -0,0 +1,108 @@
+/*! \file SweepStoreWriter.cpp
+ * 	\brief This file contains the definitions of several methods of the class _SweepStoreWriter_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataStorage.h"
+
+/*!	If there was a file open, it is closed before. If the given file exists, it is overwritten. If the encoding is
+ * enabled, the file is written with the version 2 of the format and the first sweep is encoded without reference.
+ * \param [in] path The path of the new file.
+ * \param [in] bandsParameters The parameters of the frequency bands, which are saved in the file header.
+ * \param [in] frequencies The frequency values (Hz) of the grid, which all the sweeps of the file must have.
+ */
+void SweepStoreWriter::Open(const std::string & path, const std::vector<BandParameters> & bandsParameters,
+		const std::vector<std::uint_least64_t> & frequencies)
+{
+	if( frequencies.empty() )
+		throw rfims_exception("the sweeps store was asked to be created with an empty frequency grid.");
+
+	Close();
+
+	SweepStoreFileHeader header;
+	std::copy_n("RFIMSSWP", 8, header.magic);
+	header.version = flagEncoding ? VERSION_ENCODED : VERSION;
+	header.numOfBands = bandsParameters.size();
+	header.numOfPoints = frequencies.size();
+	header.headerSize = sizeof(SweepStoreFileHeader) + header.numOfBands*sizeof(SweepStoreBandRecord) + header.numOfPoints*sizeof(std::uint64_t);
+	header.recordSize = flagEncoding ? 0 : sizeof(SweepStoreRecordHeader) + header.numOfPoints*sizeof(float);
+	header.reserved = 0;
+
+	std::vector<SweepStoreBandRecord> bandRecords;
+	bandRecords.reserve( bandsParameters.size() );
+	for(const auto & band : bandsParameters)
+	{
+		SweepStoreBandRecord record;
+		record.bandNumber = band.bandNumber;
+		record.flagEnable = band.flagEnable;
+		record.startFreq = band.startFreq;
+		record.stopFreq = band.stopFreq;
+		record.rbw = band.rbw;
+		record.vbw = band.vbw;
+		record.sweepTime = band.sweepTime;
+		record.flagDefaultSamplePoints = band.flagDefaultSamplePoints;
+		record.samplePoints = band.samplePoints;
+		record.detector = band.detector;
+		bandRecords.push_back(record);
+	}
+
+	const std::vector<std::uint64_t> freqs( frequencies.begin(), frequencies.end() );
+
+	file.Open(path);
+	file.Write( &header, sizeof(header) );
+	file.Write( bandRecords.data(), bandRecords.size()*sizeof(SweepStoreBandRecord) );
+	file.Write( freqs.data(), freqs.size()*sizeof(std::uint64_t) );
+
+	numOfPoints = header.numOfPoints;
+	numOfRecords = 0;
+	recordBuffer.resize( sizeof(SweepStoreRecordHeader) + header.numOfPoints*sizeof(float) );
+	codec.Reset();
+}
+
+/*!	The sweep must have the same number of points as the frequency grid of the file, so, if the bands parameters change,
+ * a new file must be created.
+ * \param [in] sweep The sweep to be appended.
+ */
+void SweepStoreWriter::Append(const Sweep & sweep)
+{
+	if( !file.IsOpen() )
+		throw rfims_exception("a sweep was appended to a sweeps store which is not open.");
+
+	if( sweep.values.size()!=numOfPoints )
+		throw rfims_exception("a sweep whose number of points does not match the frequency grid was appended to the sweeps store.");
+
+	SweepStoreRecordHeader recordHeader;
+	recordHeader.year = sweep.timeData.year;
+	recordHeader.month = sweep.timeData.month;
+	recordHeader.day = sweep.timeData.day;
+	recordHeader.hour = sweep.timeData.hour;
+	recordHeader.minute = sweep.timeData.minute;
+	recordHeader.second = sweep.timeData.second;
+	if( sweep.polarization=="horizontal" )
+		recordHeader.polarization = 0;
+	else if( sweep.polarization=="vertical" )
+		recordHeader.polarization = 1;
+	else
+		recordHeader.polarization = 2;
+	recordHeader.azimuthAngle = sweep.azimuthAngle;
+	recordHeader.reserved = 0;
+
+	if(flagEncoding)
+	{
+		encodedValues.clear();
+		codec.Encode(sweep.values.data(), numOfPoints, encodedValues);
+		recordHeader.reserved = encodedValues.size();
+
+		file.Write( &recordHeader, sizeof(recordHeader) );
+		file.Write( encodedValues.data(), encodedValues.size() );
+	}
+	else
+	{
+		std::memcpy( recordBuffer.data(), &recordHeader, sizeof(recordHeader) );
+		std::memcpy( recordBuffer.data() + sizeof(recordHeader), sweep.values.data(), numOfPoints*sizeof(float) );
+
+		file.Write( recordBuffer.data(), recordBuffer.size() );
+	}
+
+	numOfRecords++;
+}
@@ -0,0 +1,142 @@
+/*! \file TarArchiveWriter.cpp
+ * 	\brief This file contains the definitions of several methods of the class _TarArchiveWriter_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataStorage.h"
+
+/*!	The header is built with the ustar format, which is understood by any implementation of the utility 'tar'. The
+ * owner of the entry is the user who runs the software, as it happened when the utility 'tar' was called.
+ * \param [in] name The name of the entry, including the path inside the archive. The directories must end with '/'.
+ * \param [in] size The size of the entry content, in bytes. It must be zero for directories.
+ * \param [in] typeflag The type of the entry: '0' for regular files or '5' for directories.
+ * \param [in] mtime The modification time of the entry.
+ * \return A string of 512 bytes with the header.
+ */
+std::string TarArchiveWriter::MakeHeader(const std::string & name, const std::uint64_t size, const char typeflag, const std::time_t mtime)
+{
+	std::string header(BLOCK_SIZE, '\0');
+	char * h = &header[0];
+
+	//The names which are longer than 100 characters are split in a prefix and a name, at a '/'
+	std::size_t splitPos = 0;
+	if( name.size() > 100 )
+	{
+		splitPos = name.rfind('/', 155);
+		if( splitPos==std::string::npos || name.size()-splitPos-1 > 100 )
+			throw( rfims_exception("the name " + name + " is too long to be archived.") );
+		name.copy(h+345, splitPos);
+		splitPos++;
+	}
+	name.copy(h, name.size()-splitPos, splitPos);
+
+	std::snprintf(h+100, 8, "%07o", typeflag=='5' ? 0755 : 0644);
+	std::snprintf(h+108, 8, "%07o", (unsigned int) getuid() & 07777777);
+	std::snprintf(h+116, 8, "%07o", (unsigned int) getgid() & 07777777);
+	std::snprintf(h+124, 12, "%011llo", (unsigned long long) size);
+	std::snprintf(h+136, 12, "%011llo", (unsigned long long) mtime);
+	h[156] = typeflag;
+	std::memcpy(h+257, "ustar", 6);
+	std::memcpy(h+263, "00", 2);
+
+	//The checksum is calculated considering its own field is filled with spaces
+	std::memset(h+148, ' ', 8);
+	unsigned int checksum=0;
+	for(const auto c : header)
+		checksum += (unsigned char) c;
+	std::snprintf(h+148, 8, "%06o", checksum);
+
+	return header;
+}
+
+/*!	\param [in] entrySize The size of the entry content, in bytes.	*/
+void TarArchiveWriter::WritePadding(const std::uint64_t entrySize)
+{
+	static const char zeros[BLOCK_SIZE] = {0};
+	std::size_t paddingSize = GetPaddingSize(entrySize);
+	if(paddingSize>0)
+		compFile.Write(zeros, paddingSize);
+}
+
+/*!	\param [in] name The name of the directory inside the archive.	*/
+void TarArchiveWriter::AddDirectory(const std::string & name)
+{
+	compFile.Write( MakeHeader( (name.back()=='/' ? name : name + '/'), 0, '5' ) );
+}
+
+/*!	The file is read in blocks which are given directly to the compressor.
+ * \param [in] name The name of the file inside the archive.
+ * \param [in] sourcePath The path of the file which must be archived.
+ */
+void TarArchiveWriter::AddFile(const std::string & name, const std::string & sourcePath)
+{
+	int fd = open(sourcePath.c_str(), O_RDONLY);
+	if(fd < 0)
+	{
+		rfims_exception exc("the file " + sourcePath + " could not be opened to be archived");
+		exc.Append( strerror(errno) );
+		throw(exc);
+	}
+
+	struct stat fileStatus;
+	if( fstat(fd, &fileStatus)!=0 )
+	{
+		close(fd);
+		throw( rfims_exception("the size of the file " + sourcePath + " could not be known.") );
+	}
+
+	try
+	{
+		compFile.Write( MakeHeader(name, fileStatus.st_size, '0', fileStatus.st_mtime) );
+
+		std::uint64_t remainingBytes = fileStatus.st_size;
+		while(remainingBytes > 0)
+		{
+			ssize_t readBytes = read( fd, readBuffer.data(), std::min<std::uint64_t>(readBuffer.size(), remainingBytes) );
+			if(readBytes < 0 && errno==EINTR)
+				continue;
+			if(readBytes <= 0)
+				throw( rfims_exception("the file " + sourcePath + " could not be read to be archived.") );
+
+			compFile.Write(readBuffer.data(), readBytes);
+			remainingBytes -= readBytes;
+		}
+
+		WritePadding(fileStatus.st_size);
+	}
+	catch(std::exception & exc)
+	{
+		close(fd);
+		throw;
+	}
+
+	close(fd);
+}
+
+/*!	\param [in] name The name of the file inside the archive.
+ * \param [in] data A pointer to the content of the file.
+ * \param [in] numOfBytes The size of the content, in bytes.
+ */
+void TarArchiveWriter::AddData(const std::string & name, const void * data, const std::size_t numOfBytes)
+{
+	compFile.Write( MakeHeader(name, numOfBytes) );
+	compFile.Write(data, numOfBytes);
+	WritePadding(numOfBytes);
+}
+
+/*!	The end of a tar archive is marked with two blocks of zeros.
+ * \param [in] flagEndOfArchive If it is `false` the end of the archive is not written, because more entries will be
+ * appended to the archive in another compressed stream.
+ */
+void TarArchiveWriter::Close(const bool flagEndOfArchive)
+{
+	if( compFile.IsOpen() )
+	{
+		if(flagEndOfArchive)
+		{
+			const std::string endOfArchive(2*BLOCK_SIZE, '\0');
+			compFile.Write(endOfArchive);
+		}
+		compFile.Close();
+	}
+}
@@ -21,6 +21,17 @@ std::string TimeData::GetTime() const
 	return oss.str();
 }
 
+/*!	The fraction of the second is truncated to microseconds, which is enough to distinguish the timestamps given by the
+ * 	class _GPSClock_. The method GetTimestamp() is still used in the files, whose format has a resolution of one second.
+ */
+std::string TimeData::GetPreciseTimestamp() const
+{
+	std::ostringstream oss;
+	oss.fill('0'); oss.setf(std::ios::right, std::ios::adjustfield);
+	oss << GetTimestamp() << '.' << std::setw(6) << (nanosecond/1000);
+	return oss.str();
+}
+
 /*!	\param [in] date A date given as a `std::string` object, or even it can be inserted as `char` pointer.	*/
 void TimeData::SetDate(const std::string & date)
 {
@@ -35,6 +46,7 @@ void TimeData::SetTime(const std::string & time)
 	std::istringstream iss(time);
 	char colon;
 	iss >> hour >> colon >> minute >> colon >> second;
+	nanosecond=0;
 }
 
 /*!	\param [in] timestamp A timestamp given as a `std::string` object, or even it can be inserted as `char` pointer.	*/
@@ -67,6 +79,7 @@ const TimeData& TimeData::operator=(const TimeData& anotherTimeData)
 {
 	year=anotherTimeData.year; month=anotherTimeData.month; day=anotherTimeData.day;
 	hour=anotherTimeData.hour; minute=anotherTimeData.minute; second=anotherTimeData.second;
+	nanosecond=anotherTimeData.nanosecond;
 	return *this;
 }
 
@@ -109,8 +122,11 @@ bool operator<(const TimeData & lhs, const TimeData & rhs)
 						//minutes are equals
 						if( lhs.second<rhs.second )
 							return true;
-						else
+						else if( lhs.second>rhs.second )
 							return false;
+						else
+							//seconds are equals
+							return( lhs.nanosecond<rhs.nanosecond );
 }
 
 /*!	\param [in] lhs The left-hand side operand.
@@ -150,8 +166,11 @@ bool operator>(const TimeData & lhs, const TimeData & rhs)
 						//minutes are equals
 						if( lhs.second>rhs.second )
 							return true;
-						else
+						else if( lhs.second<rhs.second )
 							return false;
+						else
+							//seconds are equals
+							return( lhs.nanosecond>rhs.nanosecond );
 }
 
 /*!	\param [in] lhs The left-hand side operand.
@@ -165,7 +184,7 @@ bool operator==(const TimeData & lhs, const TimeData & rhs)
 				if( lhs.hour==rhs.hour )
 					if( lhs.minute==rhs.minute )
 						if( lhs.second==rhs.second )
-							return true;
+							return( lhs.nanosecond==rhs.nanosecond );
 
 	return false;
 }
@@ -18,6 +18,10 @@ bool flagPlot = false;
 bool flagInfiniteLoop = true;
 //! The declaration of a flag which defines if the software has to perform RFI detection or not. By this task is not performed.
 bool flagRFI = false;
+//! The declaration of a flag which defines if the software has to perform RFI detection relative to the noise floor or not. By default this task is not performed.
+bool flagRFINoiseFloor = false;
+//! A variable which saves the margin, in dB, above the estimated noise floor from which a point is considered RFI.
+float rfiNoiseFloorMargin = 10.0;
 //! The declaration of a flag which defines if the software has to upload the measurements or not. By default the uploading is performed.
 bool flagUpload = true;
 //! A variable which saves the number of measurements cycles which left to be done. It is used when the user wishes a finite number of measurements cycles.
@@ -26,6 +30,32 @@ unsigned int numOfMeasCycles = 1;
 unsigned int numOfAzimPos = DEF_NUM_AZIM_POS;
 //! A variable which saves the norm which defines the harmful RF interference levels: ska-mode1, ska-mode2, itu-ra769-2-vlbi.
 RFI::ThresholdsNorm rfiNorm = RFI::SKA_MODE1;
+//! A variable which saves the policy which defines when the saved data are synchronized with the storage device. By default the data are synchronized periodically.
+DataLogger::DurabilityPolicy durabilityPolicy = DataLogger::SYNC_PERIODIC;
+//! A variable which saves the period, in seconds, of the synchronization of the saved data with the storage device, when the policy is periodic.
+unsigned int durabilityPeriod = 60;
+//! A variable which saves the policy which defines what happens when the logging queue is full. By default the main thread just waits.
+DataLogger::QueueFullPolicy queueFullPolicy = DataLogger::BLOCK;
+//! A variable which saves the format of the compressed archives which are uploaded. By default the XZ format is used.
+CompressedFileWriter::Format compressionFormat = CompressedFileWriter::XZ;
+//! A variable which saves the compression preset of the archives which are uploaded, between 0 (the fastest) and 9 (the best compression).
+unsigned int compressionPreset = 6;
+//! A flag which defines if the power values of the sweeps are saved in the binary store as quantized differences (delta) or as-is (raw). By default they are saved as-is.
+bool flagSweepEncoding = false;
+//! A variable which saves the name or the IP address of the server where the archives are uploaded natively. If it is empty, the script client.py is used.
+std::string uploadServerHost;
+//! A variable which saves the TCP port of the upload server.
+unsigned int uploadServerPort = 0;
+//! A variable which saves the maximum number of archives which are uploaded at the same time, when they are uploaded natively.
+unsigned int numOfUploadThreads = 2;
+//! A variable which saves the maximum interval, in milliseconds, between two commits of the journal. If it is 0, the journal is committed when the data are synchronized according to the durability policy.
+unsigned int journalCommitInterval = 0;
+//! A variable which saves the maximum total size, in MiB, of the files of the measurement cycles. If it is 0, there is no quota and the files are just removed when they are 30 days old.
+unsigned int storageQuota = 0;
+//! A variable which saves the disk budget, in MiB, of the file where the position and the attitude of the GPS receiver are recorded. If it is 0, they are not recorded.
+unsigned int gpsRecordSize = 64;
+//! A variable which saves the motion profile of the azimuth rotations: the start and cruise step rates, in steps per second, and the acceleration and deceleration, in steps per second squared. By default all the steps are given at 100 steps/s, the rate of the previous versions, since a faster one has not been checked with the real motor.
+MotionProfileParameters motorProfile = {100.0, 100.0, 1.0, 1.0};
 //! A timer which is used to measure the execution time when the number of iterations is finite.
 boost::timer::cpu_timer timer;
 
@@ -58,9 +88,14 @@ RFPlotter * SignalHandler::nfPlotterPtr=nullptr;
 //#////////////////////////////////////////////////////////////////
 
 
+void PrintUsage()
+{
+	cout << "Usage: rfmis-cart [--plot] [--no-frontend-cal] [--rfi={ska-mode1,ska-mode2,itu-ra769}] [--rfi-noise-floor='margin'] [--num-meas-cycles='number'] [--no-upload] [--durability={sweep,cycle,'seconds'}] [--log-queue={block,skip-plots}] [--compression={xz,lzma}] [--compression-preset='number'] [--sweep-store={raw,delta}] [--upload-server='host:port'] [--upload-threads='number'] [--journal-commit='milliseconds'] [--storage-quota='MiB'] [--gps-record='MiB'] [--motor-profile='start,cruise,accel,decel'] [--num-azim-pos='number'] [--help | -h]" << endl;
+}
+
 void PrintHelp()
 {
-	cout << "Usage: rfmis-cart [--plot] [--no-frontend-cal] [--rfi={ska-mode1,ska-mode2,itu-ra769}] [--num-meas-cycles='number'] [--no-upload] [--num-azim-pos='number'] [--help | -h]" << endl;
+	PrintUsage();
 
 	cout << "\nThis software was designed to capture RF power measurements from a spectrum analyzer Aaronia Spectran V4, using an antenna" << endl;
 	cout << "which could be rotated to point the horizon in different azimuth angles and whose polarization could be changed between" << endl;
@@ -84,6 +119,10 @@ void PrintHelp()
 	cout << "\t\t\t\t\t\t\tThe SKA protocol Mode 1, The SKA protocol Mode 2 or the ITU's recommendation." << endl;
 	cout << "\t\t\t\t\t\t\tRA.769-2. If this argument is not given the RFI identifying is not performed." << endl;
 
+	cout << "\n\t--rfi-noise-floor='margin'\t\t\tEnable the identifying of RF interference (RFI) relative to the noise floor, which is" << endl;
+	cout << "\t\t\t\t\t\t\testimated in each sweep with a sliding median. The points which are more than 'margin' dB" << endl;
+	cout << "\t\t\t\t\t\t\tabove the noise floor are considered RFI. It can be used alongside the argument --rfi." << endl;
+
 	cout << "\n\t--num-meas-cycles='number'\t\t\tDetermine the number of measurements cycles which must be performed. A measurement" << endl;
 	cout << "\t\t\t\t\t\t\tcycle is formed by all the sweeps which are captured while the antenna goes over" << endl;
 	cout << "\t\t\t\t\t\t\tthe 360° of azimuth angle. If this argument is not given the measurement" << endl;
@@ -91,6 +130,52 @@ void PrintHelp()
 
 	cout << "\n\t--no-upload\t\t\t\t\tDisable the uploading of data, i.e., the sending of collected data to the remote server." << endl;
 
+	cout << "\n\t--durability={sweep,cycle,'seconds'}\t\tDetermine when the saved data are synchronized with the storage device: after each" << endl;
+	cout << "\t\t\t\t\t\t\tsweep, at the end of each measurement cycle or periodically, every 'seconds' seconds." << endl;
+	cout << "\t\t\t\t\t\t\tIf this argument is not given the data are synchronized every 60 seconds." << endl;
+
+	cout << "\n\t--log-queue={block,skip-plots}\t\t\tDetermine what happens when the queue of data which are waiting to be saved is full:" << endl;
+	cout << "\t\t\t\t\t\t\tthe capture waits, or also the plotting is skipped since the queue is half full. The data" << endl;
+	cout << "\t\t\t\t\t\t\tare never discarded. If this argument is not given the capture just waits." << endl;
+
+	cout << "\n\t--compression={xz,lzma}\t\t\t\tDetermine the format of the compressed archives which are uploaded: XZ (.tar.xz)," << endl;
+	cout << "\t\t\t\t\t\t\twhich is compressed with several threads, or the legacy LZMA format (.tar.lzma). If this" << endl;
+	cout << "\t\t\t\t\t\t\targument is not given the XZ format is used." << endl;
+
+	cout << "\n\t--compression-preset='number'\t\t\tDetermine the compression preset of the archives, from 0 (the fastest) to 9 (the best" << endl;
+	cout << "\t\t\t\t\t\t\tcompression). If this argument is not given the preset 6 is used." << endl;
+
+	cout << "\n\t--sweep-store={raw,delta}\t\t\tDetermine how the power values are saved in the binary sweeps store: as-is (raw)," << endl;
+	cout << "\t\t\t\t\t\t\tor quantized to 0.1 dB and encoded as differences from the previous sweep (delta), which" << endl;
+	cout << "\t\t\t\t\t\t\tgives the same CSV files. If this argument is not given the values are saved as-is." << endl;
+
+	cout << "\n\t--upload-server='host:port'\t\t\tDetermine the server where the archives are uploaded natively, in chunks which are" << endl;
+	cout << "\t\t\t\t\t\t\tresumed after an interruption. If this argument is not given the archives are uploaded" << endl;
+	cout << "\t\t\t\t\t\t\twith the script client.py." << endl;
+
+	cout << "\n\t--upload-threads='number'\t\t\tDetermine the maximum number of archives which are uploaded at the same time to the" << endl;
+	cout << "\t\t\t\t\t\t\tupload server. If this argument is not given 2 archives are uploaded at the same time." << endl;
+
+	cout << "\n\t--journal-commit='milliseconds'\t\t\tDetermine the maximum interval between two commits of the journal, which records the" << endl;
+	cout << "\t\t\t\t\t\t\tsaved data to recover them after a power cut. The data are synchronized with the storage" << endl;
+	cout << "\t\t\t\t\t\t\tdevice before each commit. If this argument is not given the journal is committed when the" << endl;
+	cout << "\t\t\t\t\t\t\tdata are synchronized according to the durability policy." << endl;
+
+	cout << "\n\t--storage-quota='MiB'\t\t\t\tDetermine the maximum total size of the files of the measurement cycles: when it is" << endl;
+	cout << "\t\t\t\t\t\t\texceeded, the files of the oldest cycles are removed. If this argument is not given the files" << endl;
+	cout << "\t\t\t\t\t\t\tare only removed when they are 30 days old." << endl;
+
+	cout << "\n\t--gps-record='MiB'\t\t\t\tDetermine the disk budget of the file where the position and the attitude of the GPS" << endl;
+	cout << "\t\t\t\t\t\t\treceiver are recorded, so they can be correlated with the sweeps afterwards: when it is full," << endl;
+	cout << "\t\t\t\t\t\t\tthe oldest records are overwritten. A value of 0 disables the recording. If this argument" << endl;
+	cout << "\t\t\t\t\t\t\tis not given the disk budget is 64 MiB." << endl;
+
+	cout << "\n\t--motor-profile='start,cruise,accel,decel'\tDetermine the motion profile of the azimuth rotations: the step rate" << endl;
+	cout << "\t\t\t\t\t\t\tat the beginning and at the end and the cruise step rate, in steps/s, and the" << endl;
+	cout << "\t\t\t\t\t\t\tacceleration and deceleration, in steps/s^2. If this argument is not given all the steps" << endl;
+	cout << "\t\t\t\t\t\t\tare given at 100 steps/s (the profile 100,100,1,1). A faster profile, like 100,300,400,400," << endl;
+	cout << "\t\t\t\t\t\t\tmust be checked first with the real motor, since it could lose steps." << endl;
+
 	cout << "\n\t--num-azim-pos='number'\t\t\t\tDetermine the number of azimuth positions, which defined the azimuth rotation angle." << endl;
 	cout << "\t\t\t\t\t\t\tThe number of sweeps which will be captured during a measurement cycle is the number" << endl;
 	cout << "\t\t\t\t\t\t\tof azimuth positions multiplied by 2. If this argument is not given, by default the number" << endl;
@@ -174,13 +259,28 @@ bool ProcessMainArguments (int argc, char * argv[])
 			else
 			{
 				cout << "rfims-cart: unrecognized argument '" << *argIter << '\'' << endl;
-				cout << "Usage: rfmis-cart [--plot] [--no-frontend-cal] [--rfi={ska-mode1,ska-mode2,itu-ra769}] [--num-meas-cycles='number'] [--no-upload] [--num-azim-pos='number'] [--help | -h]" << endl;
+				PrintUsage();
 				return false;
 			}
 
 			argList.erase(argIter);
 		}
 
+		//Searching the argument --rfi-noise-floor=xx
+		argIter = argList.cbegin();
+		while( argIter!=argList.cend() && argIter->find("--rfi-noise-floor=")==std::string::npos )	argIter++;
+		if( argIter!=argList.cend() )
+		{
+			//The argument was found
+			flagRFINoiseFloor=true;
+			equalSignPos = argIter->find('=');
+			std::istringstream iss;
+			std::string numString = argIter->substr(equalSignPos+1);
+			iss.str(numString);
+			iss >> rfiNoiseFloorMargin;
+			argList.erase(argIter);
+		}
+
 		//Searching the argument --num-meas-cycles=xx
 		argIter = argList.cbegin();
 		while( argIter!=argList.cend() && argIter->find("--num-meas-cycles=")==std::string::npos )		argIter++;
@@ -206,6 +306,217 @@ bool ProcessMainArguments (int argc, char * argv[])
 			argList.erase(argIter);
 		}
 
+		//Searching the argument --durability=xx
+		argIter = argList.cbegin();
+		while( argIter!=argList.cend() && argIter->find("--durability=")==std::string::npos )		argIter++;
+		if( argIter!=argList.cend() )
+		{
+			//The argument was found
+			equalSignPos = argIter->find('=');
+			std::string policyStr = argIter->substr(equalSignPos+1);
+			if( policyStr=="sweep" )
+				durabilityPolicy = DataLogger::SYNC_PER_SWEEP;
+			else if( policyStr=="cycle" )
+				durabilityPolicy = DataLogger::SYNC_PER_CYCLE;
+			else if( !policyStr.empty() && policyStr.find_first_not_of("0123456789")==std::string::npos )
+			{
+				durabilityPolicy = DataLogger::SYNC_PERIODIC;
+				durabilityPeriod = std::stoul(policyStr);
+			}
+			else
+			{
+				cout << "rfims-cart: unrecognized argument '" << *argIter << '\'' << endl;
+				PrintUsage();
+				return false;
+			}
+			argList.erase(argIter);
+		}
+
+		//Searching the argument --log-queue=xx
+		argIter = argList.cbegin();
+		while( argIter!=argList.cend() && argIter->find("--log-queue=")==std::string::npos )		argIter++;
+		if( argIter!=argList.cend() )
+		{
+			//The argument was found
+			equalSignPos = argIter->find('=');
+			std::string policyStr = argIter->substr(equalSignPos+1);
+			if( policyStr=="block" )
+				queueFullPolicy = DataLogger::BLOCK;
+			else if( policyStr=="skip-plots" )
+				queueFullPolicy = DataLogger::SKIP_PLOTS;
+			else
+			{
+				cout << "rfims-cart: unrecognized argument '" << *argIter << '\'' << endl;
+				PrintUsage();
+				return false;
+			}
+			argList.erase(argIter);
+		}
+
+		//Searching the argument --compression=xx
+		argIter = argList.cbegin();
+		while( argIter!=argList.cend() && argIter->find("--compression=")==std::string::npos )		argIter++;
+		if( argIter!=argList.cend() )
+		{
+			//The argument was found
+			equalSignPos = argIter->find('=');
+			std::string formatStr = argIter->substr(equalSignPos+1);
+			if( formatStr=="xz" )
+				compressionFormat = CompressedFileWriter::XZ;
+			else if( formatStr=="lzma" )
+				compressionFormat = CompressedFileWriter::LZMA_ALONE;
+			else
+			{
+				cout << "rfims-cart: unrecognized argument '" << *argIter << '\'' << endl;
+				PrintUsage();
+				return false;
+			}
+			argList.erase(argIter);
+		}
+
+		//Searching the argument --compression-preset=xx
+		argIter = argList.cbegin();
+		while( argIter!=argList.cend() && argIter->find("--compression-preset=")==std::string::npos )		argIter++;
+		if( argIter!=argList.cend() )
+		{
+			//The argument was found
+			equalSignPos = argIter->find('=');
+			std::string presetStr = argIter->substr(equalSignPos+1);
+			if( presetStr.size()==1 && presetStr.find_first_not_of("0123456789")==std::string::npos )
+				compressionPreset = presetStr[0] - '0';
+			else
+			{
+				cout << "rfims-cart: unrecognized argument '" << *argIter << '\'' << endl;
+				PrintUsage();
+				return false;
+			}
+			argList.erase(argIter);
+		}
+
+		//Searching the argument --sweep-store=xx
+		argIter = argList.cbegin();
+		while( argIter!=argList.cend() && argIter->find("--sweep-store=")==std::string::npos )		argIter++;
+		if( argIter!=argList.cend() )
+		{
+			//The argument was found
+			equalSignPos = argIter->find('=');
+			std::string encodingStr = argIter->substr(equalSignPos+1);
+			if( encodingStr=="raw" )
+				flagSweepEncoding = false;
+			else if( encodingStr=="delta" )
+				flagSweepEncoding = true;
+			else
+			{
+				cout << "rfims-cart: unrecognized argument '" << *argIter << '\'' << endl;
+				PrintUsage();
+				return false;
+			}
+			argList.erase(argIter);
+		}
+
+		//Searching the argument --upload-server=xx
+		argIter = argList.cbegin();
+		while( argIter!=argList.cend() && argIter->find("--upload-server=")==std::string::npos )		argIter++;
+		if( argIter!=argList.cend() )
+		{
+			//The argument was found
+			equalSignPos = argIter->find('=');
+			std::string serverStr = argIter->substr(equalSignPos+1);
+			std::size_t colonPos = serverStr.rfind(':');
+			if( colonPos!=std::string::npos && colonPos>0 && colonPos+1<serverStr.size() &&
+					serverStr.find_first_not_of("0123456789", colonPos+1)==std::string::npos )
+			{
+				uploadServerHost = serverStr.substr(0, colonPos);
+				uploadServerPort = std::stoul( serverStr.substr(colonPos+1) );
+			}
+			else
+			{
+				cout << "rfims-cart: unrecognized argument '" << *argIter << '\'' << endl;
+				PrintUsage();
+				return false;
+			}
+			argList.erase(argIter);
+		}
+
+		//Searching the argument --upload-threads=xx
+		argIter = argList.cbegin();
+		while( argIter!=argList.cend() && argIter->find("--upload-threads=")==std::string::npos )		argIter++;
+		if( argIter!=argList.cend() )
+		{
+			//The argument was found
+			equalSignPos = argIter->find('=');
+			std::istringstream iss;
+			std::string numString = argIter->substr(equalSignPos+1);
+			iss.str(numString);
+			iss >> numOfUploadThreads;
+			argList.erase(argIter);
+		}
+
+		//Searching the argument --journal-commit=xx
+		argIter = argList.cbegin();
+		while( argIter!=argList.cend() && argIter->find("--journal-commit=")==std::string::npos )		argIter++;
+		if( argIter!=argList.cend() )
+		{
+			//The argument was found
+			equalSignPos = argIter->find('=');
+			std::istringstream iss;
+			std::string numString = argIter->substr(equalSignPos+1);
+			iss.str(numString);
+			iss >> journalCommitInterval;
+			argList.erase(argIter);
+		}
+
+		//Searching the argument --storage-quota=xx
+		argIter = argList.cbegin();
+		while( argIter!=argList.cend() && argIter->find("--storage-quota=")==std::string::npos )		argIter++;
+		if( argIter!=argList.cend() )
+		{
+			//The argument was found
+			equalSignPos = argIter->find('=');
+			std::istringstream iss;
+			std::string numString = argIter->substr(equalSignPos+1);
+			iss.str(numString);
+			iss >> storageQuota;
+			argList.erase(argIter);
+		}
+
+		//Searching the argument --gps-record=xx
+		argIter = argList.cbegin();
+		while( argIter!=argList.cend() && argIter->find("--gps-record=")==std::string::npos )		argIter++;
+		if( argIter!=argList.cend() )
+		{
+			//The argument was found
+			equalSignPos = argIter->find('=');
+			std::istringstream iss;
+			std::string numString = argIter->substr(equalSignPos+1);
+			iss.str(numString);
+			iss >> gpsRecordSize;
+			argList.erase(argIter);
+		}
+
+		//Searching the argument --motor-profile=xx
+		argIter = argList.cbegin();
+		while( argIter!=argList.cend() && argIter->find("--motor-profile=")==std::string::npos )		argIter++;
+		if( argIter!=argList.cend() )
+		{
+			//The argument was found
+			equalSignPos = argIter->find('=');
+			std::istringstream iss( argIter->substr(equalSignPos+1) );
+			MotionProfileParameters profile;
+			char comma1=0, comma2=0, comma3=0;
+			iss >> profile.startRate >> comma1 >> profile.cruiseRate >> comma2 >> profile.acceleration >> comma3 >> profile.deceleration;
+			if( !iss.fail() && iss.peek()==EOF && comma1==',' && comma2==',' && comma3==',' && profile.startRate >= 1.0 &&
+					profile.cruiseRate >= profile.startRate && profile.acceleration > 0.0 && profile.deceleration > 0.0 )
+				motorProfile = profile;
+			else
+			{
+				cout << "rfims-cart: unrecognized argument '" << *argIter << '\'' << endl;
+				PrintUsage();
+				return false;
+			}
+			argList.erase(argIter);
+		}
+
 		//Searching the argument --num-azim-pos=xx
 		argIter = argList.cbegin();
 		while( argIter!=argList.cend() && argIter->find("--num-azim-pos=")==std::string::npos )		argIter++;
@@ -228,7 +539,7 @@ bool ProcessMainArguments (int argc, char * argv[])
 			for(argIter = argList.cbegin(); argIter != argList.cend(); argIter++)
 				cout << " \'" << *argIter << '\'';
 			cout << endl;
-			cout << "Usage: rfmis-cart [--plot] [--no-frontend-cal] [--rfi={ska-mode1,ska-mode2,itu-ra769}] [--num-meas-cycles='number'] [--no-upload] [--num-azim-pos='number'] [--help | -h]" << endl;
+			PrintUsage();
 			return false;
 		}
 	}
@@ -244,3 +555,35 @@ std::string GetTimeAsString(boost::timer::cpu_timer & timer)
 	boost::posix_time::time_duration td = boost::posix_time::microseconds(times.wall/1000);
 	return boost::posix_time::to_simple_string(td);
 }
+
+
+/*!	The movement overlaps the processing of the last sweep, so the time which is waited is only the part of the movement
+ * which was not overlapped. If the movement failed, a warning is shown, as its errors do not stop the measurements.
+ * \param [in,out] positioningFuture The future which was returned by AntennaPositioner::StartNextPosition(). It becomes invalid.
+ * \param [in] antPositioner The object which is responsible for the antenna positioning system.
+ * \return The time which was waited, in seconds.
+ */
+double WaitForPositioning(std::future<bool> & positioningFuture, const AntennaPositioner & antPositioner)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+	const bool flagSuccess = positioningFuture.get();
+	const double waitTime = std::chrono::duration<double>( std::chrono::steady_clock::now() - startTime ).count();
+
+	if(!flagSuccess)
+		cerr << "\nWarning: the antenna could not be moved to the next position correctly." << endl;
+
+	cout << "\nThe new antenna position is:" << endl;
+	cout << "\tPosition number: " << (antPositioner.GetPositionIndex() + 1) << '/' << numOfAzimPos << endl;
+	cout << "\tAzimuth: " << antPositioner.GetAzimPosition() << "° N" << endl;
+	cout << "\tPolarization: " << antPositioner.GetPolarizationString() << endl;
+	cout << "The movement took " << std::setprecision(4) << antPositioner.GetLastMoveTime() << " s, " << waitTime << " s of which were waited after the processing" << endl;
+
+	const MoveStatistics & rotation = antPositioner.GetLastRotationStatistics();
+	if(rotation.numOfPlannedSteps > 0)
+	{
+		cout << "The azimuth rotation took " << rotation.duration*1e-9 << " s: " << rotation.numOfSteps << " steps (" << rotation.numOfPlannedSteps << " planned), ";
+		cout << rotation.GetTimePerStep() << " ms per step, " << rotation.GetCountError() << " counts of difference with the encoder" << endl;
+	}
+
+	return waitTime;
+}
@@ -31,10 +31,25 @@ extern bool flagCalEnabled;
 extern bool flagPlot;
 extern bool flagInfiniteLoop;
 extern bool flagRFI;
+extern bool flagRFINoiseFloor;
+extern float rfiNoiseFloorMargin;
 extern bool flagUpload;
 extern unsigned int numOfMeasCycles;
 extern RFI::ThresholdsNorm rfiNorm;
 extern unsigned int numOfAzimPos;
+extern DataLogger::DurabilityPolicy durabilityPolicy;
+extern unsigned int durabilityPeriod;
+extern DataLogger::QueueFullPolicy queueFullPolicy;
+extern CompressedFileWriter::Format compressionFormat;
+extern unsigned int compressionPreset;
+extern bool flagSweepEncoding;
+extern std::string uploadServerHost;
+extern unsigned int uploadServerPort;
+extern unsigned int numOfUploadThreads;
+extern unsigned int journalCommitInterval;
+extern unsigned int storageQuota;
+extern unsigned int gpsRecordSize;
+extern MotionProfileParameters motorProfile;
 extern boost::timer::cpu_timer timer;
 
 ////////////////////////////////////////////////////////////////
@@ -42,6 +57,9 @@ extern boost::timer::cpu_timer timer;
 
 ///////////////////GLOBAL FUNCTIONS/////////////////////////
 
+//! This function prints, in the `stdout`, the line which shows the syntax of the software's arguments.
+void PrintUsage();
+
 //! This function prints a message, in the `stdout`, with a software description and the descriptions of its arguments.
 void PrintHelp();
 
@@ -51,6 +69,9 @@ bool ProcessMainArguments(int argc, char * argv[]);
 //! A function which extracts data from a timer and returns it as a string in a human-readable format.
 std::string GetTimeAsString(boost::timer::cpu_timer & timer);
 
+//! A function which waits for the movement of the antenna which was started after the capture of the last sweep, shows the new position and returns the time which was waited.
+double WaitForPositioning(std::future<bool> & positioningFuture, const AntennaPositioner & antPositioner);
+
 ///////////////////////////////////////////////////////////////
 
 
@@ -129,10 +150,11 @@ public:
 			rfiDetectorPtr->~RFIDetector();
 		if(dataLoggerPtr!=nullptr)
 			dataLoggerPtr->~DataLogger();
-		if(gpsInterfacePtr!=nullptr)
-			gpsInterfacePtr->~GPSInterface();
+		//The antenna positioner is destroyed before the GPS interface, since its move thread could be using it
 		if(antPositionerPtr!=nullptr)
 			antPositionerPtr->~AntennaPositioner();
+		if(gpsInterfacePtr!=nullptr)
+			gpsInterfacePtr->~GPSInterface();
 		if(sweepPlotterPtr!=nullptr)
 			sweepPlotterPtr->~RFPlotter();
 		if(gainPlotterPtr!=nullptr)
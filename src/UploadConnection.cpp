@@ -0,0 +1,170 @@
+/*! \file UploadConnection.cpp
+ * 	\brief This file contains the definitions of several methods of the class _UploadConnection_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataUploading.h"
+
+/*!	\param [in] socketFd The file descriptor of a socket which is connected. The object takes its ownership.
+ * \param [in] timeout The timeout of the sending and receiving operations, in seconds.
+ */
+UploadConnection::UploadConnection(const int socketFd, const unsigned int timeout)
+{
+	fd = socketFd;
+
+	struct timeval tv;
+	tv.tv_sec = timeout;
+	tv.tv_usec = 0;
+	setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv) );
+	setsockopt( fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv) );
+}
+
+/*!	All the addresses of the host are tried, until the connection is established with one of them. If there was a
+ * connection, it is closed before.
+ * \param [in] host The name or the IP address of the server.
+ * \param [in] port The TCP port of the server.
+ * \param [in] timeout The timeout of the sending and receiving operations, in seconds.
+ */
+void UploadConnection::Connect(const std::string & host, const std::uint16_t port, const unsigned int timeout)
+{
+	Close();
+
+	struct addrinfo hints;
+	std::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	struct addrinfo * addrList;
+	int ret = getaddrinfo( host.c_str(), std::to_string(port).c_str(), &hints, &addrList );
+	if(ret!=0)
+	{
+		rfims_exception exc("the address of the upload server " + host + " could not be resolved");
+		exc.Append( gai_strerror(ret) );
+		throw(exc);
+	}
+
+	struct timeval tv;
+	tv.tv_sec = timeout;
+	tv.tv_usec = 0;
+
+	for(struct addrinfo * addr = addrList; addr!=nullptr && fd<0; addr = addr->ai_next)
+	{
+		fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+		if(fd < 0)
+			continue;
+
+		//The timeout of the sending operations also limits the time the connection establishment takes
+		setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv) );
+		setsockopt( fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv) );
+
+		if( connect(fd, addr->ai_addr, addr->ai_addrlen)!=0 )
+		{
+			close(fd);
+			fd=-1;
+		}
+	}
+	freeaddrinfo(addrList);
+
+	if(fd < 0)
+		throw rfims_exception("the connection with the upload server " + host + ':' + std::to_string(port) + " could not be established.");
+
+	inBuffer.clear();
+}
+
+/*!	\param [in] data A pointer to the bytes to be sent.
+ * \param [in] numOfBytes The number of bytes to be sent.
+ */
+void UploadConnection::Send(const void * data, const std::size_t numOfBytes)
+{
+	if(fd < 0)
+		throw rfims_exception("data were tried to be sent through a connection which is closed.");
+
+	auto bytes = (const char*) data;
+	std::size_t sentBytes=0;
+	while(sentBytes < numOfBytes)
+	{
+		//The signal SIGPIPE is not generated when the server closes the connection, the error is returned instead
+		ssize_t ret = send(fd, bytes + sentBytes, numOfBytes - sentBytes, MSG_NOSIGNAL);
+		if(ret < 0 && errno==EINTR)
+			continue;
+		if(ret < 0)
+		{
+			rfims_exception exc("the sending of data to the upload server failed");
+			exc.Append( (errno==EAGAIN || errno==EWOULDBLOCK) ? "timeout." : strerror(errno) );
+			throw(exc);
+		}
+		sentBytes += ret;
+	}
+}
+
+/*!	\param [out] data A pointer to the array where the bytes are written.
+ * \param [in] numOfBytes The number of bytes to be received.
+ */
+void UploadConnection::Receive(void * data, const std::size_t numOfBytes)
+{
+	if(fd < 0)
+		throw rfims_exception("data were tried to be received through a connection which is closed.");
+
+	auto bytes = (char*) data;
+	std::size_t receivedBytes = std::min( numOfBytes, inBuffer.size() );
+	inBuffer.copy(bytes, receivedBytes);
+	inBuffer.erase(0, receivedBytes);
+
+	while(receivedBytes < numOfBytes)
+	{
+		ssize_t ret = recv(fd, bytes + receivedBytes, numOfBytes - receivedBytes, 0);
+		if(ret < 0 && errno==EINTR)
+			continue;
+		if(ret < 0)
+		{
+			rfims_exception exc("the receiving of data from the upload connection failed");
+			exc.Append( (errno==EAGAIN || errno==EWOULDBLOCK) ? "timeout." : strerror(errno) );
+			throw(exc);
+		}
+		if(ret==0)
+			throw rfims_exception("the upload connection was closed by the other side.");
+		receivedBytes += ret;
+	}
+}
+
+/*!	The lines longer than 1024 characters are considered an error, because the protocol lines are short. */
+std::string UploadConnection::ReceiveLine()
+{
+	if(fd < 0)
+		throw rfims_exception("a line was tried to be received through a connection which is closed.");
+
+	std::size_t endPos;
+	while( (endPos = inBuffer.find('\n'))==std::string::npos )
+	{
+		if( inBuffer.size() > 1024 )
+			throw rfims_exception("a too long line was received through the upload connection.");
+
+		char buffer[1024];
+		ssize_t ret = recv(fd, buffer, sizeof(buffer), 0);
+		if(ret < 0 && errno==EINTR)
+			continue;
+		if(ret < 0)
+		{
+			rfims_exception exc("the receiving of a line from the upload connection failed");
+			exc.Append( (errno==EAGAIN || errno==EWOULDBLOCK) ? "timeout." : strerror(errno) );
+			throw(exc);
+		}
+		if(ret==0)
+			throw rfims_exception("the upload connection was closed by the other side.");
+		inBuffer.append(buffer, ret);
+	}
+
+	std::string line = inBuffer.substr(0, endPos);
+	inBuffer.erase(0, endPos+1);
+	return line;
+}
+
+void UploadConnection::Close()
+{
+	if(fd >= 0)
+	{
+		close(fd);
+		fd=-1;
+	}
+	inBuffer.clear();
+}
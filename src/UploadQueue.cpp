@@ -0,0 +1,116 @@
+/*! \file UploadQueue.cpp
+ * 	\brief This file contains the definitions of several methods of the class _UploadQueue_.
+ * 	\author Mauro Diamantino
+ */
+
+#include "DataUploading.h"
+
+/*!	If the file does not exist, the queue is left empty. The lines which cannot be interpreted are ignored, with a warning.
+ * \param [in] queuePath The path of the queue file, which is also used by the method Save().
+ */
+void UploadQueue::Load(const std::string & queuePath)
+{
+	path = queuePath;
+	entries.clear();
+
+	std::ifstream ifs(path);
+	if( !ifs.is_open() )
+		return;
+
+	std::string line;
+	while( std::getline(ifs, line) )
+	{
+		if( line.empty() )
+			continue;
+
+		std::istringstream iss(line);
+		Entry entry;
+		long long nextTime;
+		if( iss >> entry.filename >> entry.confirmedOffset >> entry.numOfAttempts >> nextTime )
+		{
+			entry.nextAttemptTime = nextTime;
+			if( Find(entry.filename)==nullptr )
+				entries.push_back(entry);
+		}
+		else
+			cerr << "\nWarning: a line of the upload queue file " << path << " could not be interpreted: " << line << endl;
+	}
+}
+
+/*!	The queue is written to a temporary file, which is synchronized with the storage device and then renamed, so the
+ * queue file is always complete.
+ */
+void UploadQueue::Save() const
+{
+	if( path.empty() )
+		throw rfims_exception("the upload queue was asked to be saved but it has not a file.");
+
+	std::ostringstream oss;
+	for(const auto & entry : entries)
+		oss << entry.filename << ' ' << entry.confirmedOffset << ' ' << entry.numOfAttempts << ' ' << (long long) entry.nextAttemptTime << '\n';
+	const std::string text = oss.str();
+
+	const std::string tempPath = path + ".tmp";
+	int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0)
+		throw rfims_exception("the upload queue file " + tempPath + " could not be created.");
+
+	std::size_t writtenBytes=0;
+	while( writtenBytes < text.size() )
+	{
+		ssize_t ret = write( fd, text.data() + writtenBytes, text.size() - writtenBytes );
+		if(ret < 0 && errno==EINTR)
+			continue;
+		if(ret < 0)
+		{
+			close(fd);
+			throw rfims_exception("the upload queue file " + tempPath + " could not be written.");
+		}
+		writtenBytes += ret;
+	}
+
+	if( fdatasync(fd)!=0 || close(fd)!=0 )
+		throw rfims_exception("the upload queue file " + tempPath + " could not be synchronized.");
+
+	if( std::rename( tempPath.c_str(), path.c_str() )!=0 )
+		throw rfims_exception("the upload queue file " + tempPath + " could not be renamed.");
+}
+
+/*!	\param [in] filename The name of the file.
+ * \return `true` if the file was inserted or `false` if it was already in the queue.
+ */
+bool UploadQueue::Push(const std::string & filename)
+{
+	if( Find(filename)!=nullptr )
+		return false;
+
+	entries.emplace_back(filename);
+	return true;
+}
+
+/*!	\param [in] filename The name of the file.	*/
+void UploadQueue::Remove(const std::string & filename)
+{
+	auto it = std::find_if( entries.begin(), entries.end(), [&](const Entry & e){	return e.filename==filename;	} );
+	if( it!=entries.end() )
+		entries.erase(it);
+}
+
+/*!	\param [in] filename The name of the file.	*/
+UploadQueue::Entry * UploadQueue::Find(const std::string & filename)
+{
+	auto it = std::find_if( entries.begin(), entries.end(), [&](const Entry & e){	return e.filename==filename;	} );
+	return( it!=entries.end() ? &(*it) : nullptr );
+}
+
+/*!	The files are taken in the order they were inserted in the queue, so the oldest measurements are uploaded first.
+ * \param [in] now The current time.
+ */
+UploadQueue::Entry * UploadQueue::GetNextReady(const std::time_t now)
+{
+	for(auto & entry : entries)
+		if( !entry.flagInProgress && entry.nextAttemptTime <= now )
+			return &entry;
+
+	return nullptr;
+}
@@ -33,6 +33,11 @@ int main(int argc, char * argv[])
 	// A variable which represents the number of the current sweep (like an index but this starts in one). The sweeps got for the calibration are not taking into account.
 	unsigned int sweepNumber = 1;
 	unsigned int measCycleIndex = 0;
+	// The future of the movement of the antenna to the next position, which is started after the capture of a sweep and waited before the capture of the next one.
+	std::future<bool> positioningFuture;
+	// The total duration of the movements of the antenna and the part of them which was waited, since the last measurement cycle finished, in seconds.
+	double positioningTime = 0.0, positioningWaitTime = 0.0;
+	unsigned int numOfMovements = 0;
 	//#/////////////////////////////////////
 
 	// The checking of the program's arguments.
@@ -63,6 +68,8 @@ int main(int argc, char * argv[])
 		FrontEndCalibrator frontEndCalibrator(curveAdjuster);
 		RFIDetector rfiDetector(curveAdjuster);
 		DataLogger dataLogger;
+		OccupancyStatistics occupancyStats;
+		std::unique_ptr<GPSRecorder> gpsRecorder;
 		GPSInterface gpsInterface;
 		AntennaPositioner antPositioner(gpsInterface);
 
@@ -80,12 +87,58 @@ int main(int argc, char * argv[])
 		gpsInterface.Initialize();
 		cout << "The GPS receiver was initialize successfully" << endl;
 
+		//Opening the recorder of the position and the attitude, so they can be correlated with the sweeps afterwards
+		if(gpsRecordSize>0)
+		{
+			try
+			{
+				gpsRecorder.reset( new GPSRecorder( BASE_PATH + "/gps_track.bin", std::uint64_t(gpsRecordSize)*1048576 ) );
+				gpsInterface.SetRecorder( gpsRecorder.get() );
+			}
+			catch(rfims_exception & exc)
+			{
+				cerr << "\nWarning: the position and the attitude of the GPS receiver will not be recorded: " << exc.what() << endl;
+			}
+		}
+
+		//Enabling the data streaming, so the GPS clock is disciplined with the GPRMC replies and the sweeps can be timestamped without waiting for the GPS receiver
+		gpsInterface.EnableStreaming();
+
 		//Setting the total number of sweeps per measurement cycle in the data logger
 		dataLogger.SetNumOfSweeps(2*numOfAzimPos);
 
+		//Setting the policy which defines when the data logger synchronizes the data with the storage device
+		dataLogger.SetDurabilityPolicy(durabilityPolicy, durabilityPeriod);
+		dataLogger.SetQueueParameters(2*numOfAzimPos, queueFullPolicy);
+		dataLogger.SetCompression(compressionFormat, compressionPreset);
+		dataLogger.EnableIncrementalArchive(flagUpload);
+		dataLogger.SetSweepEncoding(flagSweepEncoding);
+		if(flagUpload)
+			dataLogger.SetUploadServer(uploadServerHost, uploadServerPort, numOfUploadThreads);
+		dataLogger.SetJournalCommitInterval(journalCommitInterval);
+		dataLogger.SetStorageQuota( std::uint64_t(storageQuota)*1048576 );
+
+		//The measurement cycles which were interrupted, or which were not archived, before the last restart are archived and uploaded
+		if(flagUpload)
+		{
+			const std::size_t numOfRecoveredCycles = dataLogger.QueueRecoveredCycles();
+			if(numOfRecoveredCycles>0)
+				cout << "\n" << numOfRecoveredCycles << " measurement cycle(s) of the journal were queued to be archived and uploaded" << endl;
+		}
+
 		//Setting the number of azimuth positions in the antenna positioner
 		antPositioner.SetNumOfAzimPos(numOfAzimPos);
 
+		//Setting the motion profile of the azimuth rotations
+		antPositioner.SetMotionProfile(motorProfile);
+
+		//Enabling the RFI detection relative to the noise floor
+		if(flagRFINoiseFloor)
+			rfiDetector.EnableNoiseFloorDetection(rfiNoiseFloorMargin);
+
+		//Setting the number of azimuth positions in the occupancy statistics
+		occupancyStats.SetNumOfAzimPos(numOfAzimPos);
+
 		//Putting the antenna in the initial position and polarization
 #ifdef RASPBERRY_PI
 		digitalWrite(piPins.LED_INIT_POS, pinsValues.LED_INIT_POS_ON);
@@ -146,13 +199,34 @@ int main(int argc, char * argv[])
 			}
 
 
+			//#//////////////////////////WAITING FOR THE ANTENNA POSITIONING///////////////////////////////////////
+
+			//The antenna was moved to the current position while the last sweep was processed, so the movement is only waited
+			//just before the capture of the next sweep
+			if( positioningFuture.valid() )
+			{
+				positioningWaitTime += WaitForPositioning(positioningFuture, antPositioner);
+				positioningTime += antPositioner.GetLastMoveTime();
+				numOfMovements++;
+			}
+
 			//#//////////////////////////CAPTURING THE ANTENNA'S POSITION AND THE TIME DATA///////////////////////////
 
-			//The timestamp of each sweep is taking at the beginning. Also, the antenna position data are
-			//saved in the Sweep object here.
-			uncalSweep.timeData = gpsInterface.UpdateTimeData();
+			//The timestamp of each sweep is taking at the beginning, from the GPS clock, which does not wait for the GPS
+			//receiver. Only if the clock has not been synchronized yet, the time of the next GPRMC reply is waited. Also, the
+			//antenna position data are saved in the Sweep object here.
+			const GPSTimestamp sweepTimestamp = gpsInterface.GetClock().Now();
+			if(sweepTimestamp.flagSynchronized)
+				uncalSweep.timeData = sweepTimestamp.GetTimeData();
+			else
+			{
+				cerr << "\nWarning: the GPS clock is not synchronized, so the sweep is timestamped with the time of the next GPRMC reply." << endl;
+				uncalSweep.timeData = gpsInterface.UpdateTimeData();
+			}
 			uncalSweep.azimuthAngle = antPositioner.GetAzimPosition();
 			uncalSweep.polarization = antPositioner.GetPolarizationString();
+			//The index of the azimuth position is kept for the occupancy statistics, since the antenna is moved while the sweep is processed
+			const unsigned int azimPosIndex = antPositioner.GetPositionIndex();
 
 			//#///////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -167,6 +241,9 @@ int main(int argc, char * argv[])
 				else
 					cout << "\nStarting the capturing of the sweep " << sweepNumber++ << '/' << (numOfAzimPos*2) << ", in the measurement cycle " << (measCycleIndex + 1) << '/' << numOfMeasCycles << endl;
 
+			if(sweepTimestamp.flagSynchronized)
+				cout << "Timestamp: " << uncalSweep.timeData.GetPreciseTimestamp() << " (error < " << (sweepTimestamp.estimatedError/1e6) << " ms)" << endl;
+
 #ifdef RASPBERRY_PI
 			digitalWrite(piPins.LED_SWEEP_CAPTURE, pinsValues.LED_SWP_CAPT_ON);
 #endif
@@ -189,7 +266,9 @@ int main(int argc, char * argv[])
 						cout << "Fstart=" << (currBandParam.startFreq/1e6) << " MHz, Fstop=" << (currBandParam.stopFreq/1e6) << " MHz, ";
 						cout << "RBW=" << (currBandParam.rbw/1e3) << " KHz, Sweep time=" << currBandParam.sweepTime << " ms" << endl;
 
+						const GPSTimestamp bandTimestamp = gpsInterface.GetClock().Now();
 						currFreqBand = sweepBuilder.CaptureSweep(currBandParam);
+						currFreqBand.timeData = ( bandTimestamp.flagSynchronized ? bandTimestamp.GetTimeData() : uncalSweep.timeData );
 
 						flagSuccess=true;
 					}
@@ -240,6 +319,21 @@ int main(int argc, char * argv[])
 			specInterface.SoundNewSweep();
 			cout << "\nThe capturing of a whole sweep finished" << endl;
 
+			//#//////////////////////////////ANTENNA POSITIONING////////////////////////////////////////
+
+			//The antenna is moved to the next position (polarization and, if needed, azimuth) as soon as the capture finishes,
+			//so the movement overlaps the processing, the logging and the archiving of the sweep. The sweeps of the calibration
+			//are captured without moving the antenna.
+			const bool flagCalibSweep = frontEndCalibrator.IsCalibStarted();
+			const bool flagLastSweepOfCycle = ( antPositioner.IsLastPosition() && antPositioner.GetPolarization()==Polarization::VERTICAL );
+			if(!flagCalibSweep)
+			{
+				cout << "\nThe antenna position will be changed while the sweep is processed" << endl;
+				positioningFuture = antPositioner.StartNextPosition();
+			}
+
+			//#/////////////////////////END OF THE ANTENNA POSITIONING/////////////////////////////////////
+
 			//Showing the max power in the input of the spectrum analyzer
 			auto sweepIter = std::max_element( uncalSweep.values.begin(), uncalSweep.values.end() );
 			auto maxElemPos = std::distance( uncalSweep.values.begin(), sweepIter );
@@ -302,7 +396,7 @@ int main(int argc, char * argv[])
 
 			//#///////////////////////////////////////SWEEP PROCESSING////////////////////////////////////////////
 
-			if( frontEndCalibrator.IsCalibStarted() )
+			if(flagCalibSweep)
 			{
 				//#//////////////////////////FRONT END CALIBRATION////////////////////////////////////
 
@@ -373,19 +467,31 @@ int main(int argc, char * argv[])
 				Sweep calSweep = frontEndCalibrator.CalibrateSweep(uncalSweep);
 				cout << "The sweep calibration finished" << endl;
 
-				RFI detectedRFI;
-				if(flagRFI)
+				RFI detectedRFI, detectedNFRFI;
+				if(flagRFI || flagRFINoiseFloor)
 				{
-					//Detecting RFI
+					//Detecting RFI, relative to the norm and/or relative to the noise floor in the same pass
 					cout << "\nThe RFI which is present in the current calibrated sweep is being detected" << endl;
 					detectedRFI = rfiDetector.DetectRFI(calSweep);
-					if( rfiDetector.GetNumOfRFIBands()==0 )
-						cout << "No RFI was detected" << endl;
-					else
-						cout << "It were detected " << rfiDetector.GetNumOfRFIBands() << " RFI bands." << endl;
+					if(flagRFI)
+					{
+						if( rfiDetector.GetNumOfRFIBands()==0 )
+							cout << "No RFI was detected" << endl;
+						else
+							cout << "It were detected " << rfiDetector.GetNumOfRFIBands() << " RFI bands." << endl;
+					}
+					if(flagRFINoiseFloor)
+					{
+						detectedNFRFI = rfiDetector.GetNoiseFloorRFI();
+						cout << "It were detected " << rfiDetector.GetNumOfNoiseFloorRFIBands() << " RFI bands above the noise floor." << endl;
+					}
 				}
 
-				if(flagPlot)
+				//Updating the spectrum occupancy statistics with the calibrated sweep
+				occupancyStats.Update(calSweep, azimPosIndex, rfiDetector.GetThreshCurve());
+
+				//The plotting is skipped if the data logger is congested, so the saving of the data is given priority
+				if( flagPlot && !dataLogger.IsCongested() )
 					try
 					{
 						//Plotting the current sweep and the detected RFI
@@ -403,10 +509,12 @@ int main(int argc, char * argv[])
 						cerr << "\nWarning: " << exc.what();
 					}
 
-				//Transferring the sweep and detected RFI to the data logger in order to this component saves the data in memory
-				dataLogger.SaveSweep(calSweep);
+				//Transferring the sweep and detected RFI to the logging queue, so the data logger saves the data in memory while the next sweep is captured
+				dataLogger.QueueSweep( std::move(calSweep) );
 				if(flagRFI)
-					dataLogger.SaveRFI(detectedRFI);
+					dataLogger.QueueRFI( std::move(detectedRFI) );
+				if( flagRFINoiseFloor && !detectedNFRFI.Empty() )
+					dataLogger.QueueRFI( std::move(detectedNFRFI) );
 
 #ifdef RASPBERRY_PI
 				digitalWrite(piPins.LED_SWEEP_PROCESS, pinsValues.LED_SWP_PROC_OFF);
@@ -415,7 +523,7 @@ int main(int argc, char * argv[])
 
 
 				//Checking if the current measurement cycle has finished and if the software should or not starts a new one.
-				if( antPositioner.IsLastPosition() && antPositioner.GetPolarization()==Polarization::VERTICAL)
+				if(flagLastSweepOfCycle)
 				{
 					if( !flagInfiniteLoop && ++measCycleIndex >= numOfMeasCycles )
 					{
@@ -425,13 +533,46 @@ int main(int argc, char * argv[])
 					else
 						flagNewMeasCycle = true;
 
+					//Closing the files of the measurement cycle
+					try
+					{
+						dataLogger.FinishMeasCycle();
+						const IOStatistics & ioStats = dataLogger.GetLastCycleIOStatistics();
+						cout << "\nThe data of the measurement cycle were saved: " << ioStats.numOfBytes << " bytes, ";
+						cout << ioStats.numOfSyscalls << " system calls (" << ioStats.numOfWrites << " writes, " << ioStats.numOfSyncs << " syncs)" << endl;
+						const QueueStatistics queueStats = dataLogger.GetQueueStatistics();
+						cout << "Logging queue: max depth " << queueStats.maxDepth << ", " << queueStats.numOfBlockings << " waits, write latency ";
+						cout << queueStats.meanWriteLatency << " ms (mean), " << queueStats.maxWriteLatency << " ms (max)" << endl;
+					}
+					catch(std::exception & exc)
+					{
+						cerr << "\nWarning: " << exc.what() << endl;
+					}
+
+					//Showing the time of the antenna positioning, and the part of it which was not overlapped with the processing
+					cout << "\nAntenna positioning: " << numOfMovements << " movements, " << positioningTime << " s in total, ";
+					cout << positioningWaitTime << " s waited, " << (positioningTime - positioningWaitTime) << " s overlapped with the processing" << endl;
+					positioningTime = positioningWaitTime = 0.0;
+					numOfMovements = 0;
+
+					//Saving the occupancy statistics, so they survive a restart of the software
+					try
+					{
+						occupancyStats.SaveCheckpoint();
+					}
+					catch(std::exception & exc)
+					{
+						cerr << "\nWarning: " << exc.what() << endl;
+					}
+
 					//Uploading
 					if(flagUpload)
 					{
-						cout << "\nCreating a thread to prepare and upload data in parallel" << endl;
 						try
 						{
 							dataLogger.PrepareAndUploadData();
+							cout << "\nThe data of the measurement cycle were queued to be archived and uploaded in parallel (";
+							cout << dataLogger.GetNumOfUploadJobs() << " pending job(s))" << endl;
 						}
 						catch(std::exception & exc)
 						{
@@ -450,39 +591,13 @@ int main(int argc, char * argv[])
 						cerr << "\nWarning: " << exc.what() << endl;
 					}
 				}
-
-				//#//////////////////////////////ANTENNA POSITIONING////////////////////////////////////////
-
-				//Changing the antenna position
-				cout << "\nThe antenna position will be changed" << endl;
-#ifdef RASPBERRY_PI
-				digitalWrite(piPins.LED_POLARIZ, pinsValues.LED_POL_ON);
-#endif
-				antPositioner.ChangePolarization();
-#ifdef RASPBERRY_PI
-				digitalWrite(piPins.LED_POLARIZ, pinsValues.LED_POL_OFF);
-#endif
-
-				if( antPositioner.GetPolarization()==Polarization::HORIZONTAL )
-				{
-#ifdef RASPBERRY_PI
-					digitalWrite(piPins.LED_NEXT_POS, pinsValues.LED_NEXT_POS_ON);
-#endif
-					antPositioner.NextAzimPosition();
-#ifdef RASPBERRY_PI
-					digitalWrite(piPins.LED_NEXT_POS, pinsValues.LED_NEXT_POS_OFF);
-#endif
-				}
-
-				cout << "The new antenna position is:" << endl;
-				cout << "\tPosition number: " << (antPositioner.GetPositionIndex() + 1) << '/' << numOfAzimPos << endl;
-				cout <<	"\tAzimuth: " << antPositioner.GetAzimPosition() << "° N" << endl;
-				cout << "\tPolarization: " << antPositioner.GetPolarizationString() << endl;
-
-				//#/////////////////////////END OF THE ANTENNA POSITIONING/////////////////////////////////////
 			}
 		}
 		//#///////////////////////////////END OF THE GENERAL LOOP////////////////////////////////////
+
+		//The last movement of the antenna, to the initial position, is waited before finishing
+		if( positioningFuture.valid() )
+			WaitForPositioning(positioningFuture, antPositioner);
 	}
 	catch(std::exception & exc)
 	{
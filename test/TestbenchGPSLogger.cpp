@@ -14,21 +14,65 @@ const unsigned int WAITING_TIME_S = 20;
 const unsigned int NUM_OF_TRIES = WAITING_TIME_S / (double(DELAY_US) / 1e6);
 
 
-int main()
+int main(int argc, char * argv[])
 {
 	//! An object which is responsible of the handling of the received signals.
 	SignalHandler signalHandler;
 
+	if( argc>1 && ( std::string(argv[1])=="--help" || std::string(argv[1])=="-h" ) )
+	{
+		cout << "Uso: test-gps [--emulated | --replay='salida grabada del GPS Logger']" << endl;
+		cout << "Con --emulated, el testbench se comunica con un GPS Logger emulado, que envia respuestas sinteticas, en lugar" << endl;
+		cout << "del dispositivo, por lo que puede ejecutarse en cualquier maquina Linux. Con --replay, el GPS Logger emulado" << endl;
+		cout << "reproduce la salida grabada de un dispositivo real. En ambos casos se omiten las pruebas que requieren mover" << endl;
+		cout << "el dispositivo y las que esperan respuestas del usuario." << endl;
+		return 1;
+	}
+
+	bool flagEmulated=false;
+	std::string recordingPath;
+	for(int i=1; i<argc; i++)
+	{
+		std::string arg(argv[i]);
+		if(arg=="--emulated")
+			flagEmulated=true;
+		else if( arg.compare(0, 9, "--replay=")==0 )
+		{
+			recordingPath = arg.substr(9);
+			flagEmulated=true;
+		}
+		else
+		{
+			cerr << "test-gps: argumento no reconocido '" << arg << "'" << endl;
+			cout << "Uso: test-gps [--emulated | --replay='salida grabada del GPS Logger']" << endl;
+			return 1;
+		}
+	}
+
 	cout << "\n\t\t\tTestbench del dispositivo Aaronia GPS Logger " << endl;
 
 	cout << "\nNotas:" << endl;
-	cout << "- Asegurese de realizar una calibracion del dispositivo (ver manual en el maletin) antes de realizar este test." << endl;
-	cout << "- Cuando se le solicite alguna accion al usuario, el programa esperara a lo sumo " << WAITING_TIME_S << "s a que el usuario haga lo solicitado." << endl;
+	if(flagEmulated)
+		cout << "- El GPS Logger es emulado" << ( recordingPath.empty() ? "" : ", reproduciendo la salida grabada " + recordingPath ) << '.' << endl;
+	else
+	{
+		cout << "- Asegurese de realizar una calibracion del dispositivo (ver manual en el maletin) antes de realizar este test." << endl;
+		cout << "- Cuando se le solicite alguna accion al usuario, el programa esperara a lo sumo " << WAITING_TIME_S << "s a que el usuario haga lo solicitado." << endl;
+	}
 
 	try
 	{
 		unsigned int i=0;
-		GPSInterface gpsInterface;
+		std::unique_ptr<EmulatedGPSTransport> emulatedTransport;
+		std::unique_ptr<GPSInterface> gpsInterfaceOwner;
+		if(flagEmulated)
+		{
+			emulatedTransport.reset( new EmulatedGPSTransport(0, 0.0, recordingPath) );
+			gpsInterfaceOwner.reset( new GPSInterface(*emulatedTransport) );
+		}
+		else
+			gpsInterfaceOwner.reset( new GPSInterface() );
+		GPSInterface & gpsInterface = *gpsInterfaceOwner;
 
 		SignalHandler::gpsInterfacePtr = &gpsInterface;
 
@@ -36,106 +80,121 @@ int main()
 		gpsInterface.Initialize();
 		cout << "La comunicacion fue inicializada con exito" << endl;
 
-		cout << "\nPresione una tecla para comenzar..." << endl;
-		WaitForEnter();
-
-		cout << "A continuacion se probara la recepcion a pedido de los datos de los sensores (streaming deshabilitado)" << endl;
-
-		//////////////////////PRUEBA 1//////////////////////
-		cout << "\nUbique el dispositivo sobre una superficie plana..." << endl;
-
-		//Analisis del angulo roll
-		do
+		if(!flagEmulated)
 		{
-			usleep(DELAY_US);
-			gpsInterface.UpdateRoll();
+			cout << "\nPresione una tecla para comenzar..." << endl;
+			WaitForEnter();
 		}
-		while( (gpsInterface.GetRoll() < -5.0 || gpsInterface.GetRoll() > 5.0) && ++i < NUM_OF_TRIES );
-
-		if(i>=NUM_OF_TRIES)
-			throw rfims_exception("se espero demasiado tiempo que el angulo roll este alrededor de cero.");
-
-		//Analisis del angulo pitch
-		do
-		{
-			usleep(DELAY_US);
-			gpsInterface.UpdatePitch();
-		}
-		while( (gpsInterface.GetPitch() < -5.0 || gpsInterface.GetPitch() > 5.0) && ++i < NUM_OF_TRIES );
-
-		if(i>=NUM_OF_TRIES)
-			throw rfims_exception("se espero demasiado tiempo que el angulo pitch este alrededor de cero.");
-
-		cout << "Excelente!" << endl;
-		/////////////////////////////////////////////////////
 
-		/////////////////////PRUEBA 2////////////////////////
-		cout << "\nRote el dispositivo sobre uno de sus costados, de modo que el angulo roll este alrededor de 90 grados (en valor absoluto)..." << endl;
+		cout << "A continuacion se probara la recepcion a pedido de los datos de los sensores (streaming deshabilitado)" << endl;
 
-		//Analisis del angulo roll
-		do
+		if(flagEmulated)
 		{
-			usleep(DELAY_US);
+			//El GPS Logger emulado no puede moverse, por lo que los angulos solo se leen a pedido
 			gpsInterface.UpdateRoll();
-		}
-		while( ( fabs(gpsInterface.GetRoll()) < 85.0 || fabs(gpsInterface.GetRoll()) > 95.0 ) && ++i < NUM_OF_TRIES );
-
-		if(i>=NUM_OF_TRIES)
-			throw rfims_exception("se espero demasiado tiempo que el angulo roll este alrededor de 90 grados.");
-
-		cout << "Excelente!" << endl;
-		////////////////////////////////////////////////////
-
-		////////////////////PRUEBA 3///////////////////////
-		cout << "\nColoque el dispositivo en forma vertical sobre el cable USB, de modo que el angulo pitch este alrededor de 90 grados (en valor absoluto)..." << endl;
-
-		//Analisis del angulo pitch
-		do
-		{
-			usleep(DELAY_US);
 			gpsInterface.UpdatePitch();
-		}
-		while( ( fabs(gpsInterface.GetPitch()) < 85.0 || fabs(gpsInterface.GetPitch()) > 95.0) && ++i < NUM_OF_TRIES );
-
-		if(i>=NUM_OF_TRIES)
-			throw rfims_exception("se espero demasiado tiempo que el angulo pitch este alrededor de 90 grados.");
-
-		cout << "Excelente!" << endl;
-		//////////////////////////////////////////////////////
-
-		///////////////////PRUEBA 4///////////////////////////
-		cout << "\nColoque el dispositivo sobre una superficie plana apuntando hacia el Este..." << endl;
-
-		//Analisis del angulo yaw
-		do
-		{
-			usleep(DELAY_US);
 			gpsInterface.UpdateYaw();
+			cout << "\nSe omiten las pruebas que requieren mover el dispositivo. Angulos leidos a pedido:" << endl;
+			cout << "\tyaw: " << gpsInterface.GetYaw() << " °\tpitch: " << gpsInterface.GetPitch() << " °\troll: " << gpsInterface.GetRoll() << " °" << endl;
 		}
-		while( (gpsInterface.GetYaw() < 80.0 || gpsInterface.GetYaw() > 100.0) && ++i < NUM_OF_TRIES );
-
-		if(i>=NUM_OF_TRIES)
-			throw rfims_exception("se espero demasiado tiempo que el angulo yaw este alrededor de 90 grados.");
-
-		cout << "Excelente!" << endl;
-		//////////////////////////////////////////////////////
-
-		///////////////////PRUEBA 5///////////////////////////
-		cout << "\nColoque el dispositivo sobre una superficie plana apuntando hacia el Sur..." << endl;
-
-		//Analisis del angulo yaw
-		do
+		else
 		{
-			usleep(DELAY_US);
-			gpsInterface.UpdateYaw();
+			//////////////////////PRUEBA 1//////////////////////
+			cout << "\nUbique el dispositivo sobre una superficie plana..." << endl;
+
+			//Analisis del angulo roll
+			do
+			{
+				usleep(DELAY_US);
+				gpsInterface.UpdateRoll();
+			}
+			while( (gpsInterface.GetRoll() < -5.0 || gpsInterface.GetRoll() > 5.0) && ++i < NUM_OF_TRIES );
+
+			if(i>=NUM_OF_TRIES)
+				throw rfims_exception("se espero demasiado tiempo que el angulo roll este alrededor de cero.");
+
+			//Analisis del angulo pitch
+			do
+			{
+				usleep(DELAY_US);
+				gpsInterface.UpdatePitch();
+			}
+			while( (gpsInterface.GetPitch() < -5.0 || gpsInterface.GetPitch() > 5.0) && ++i < NUM_OF_TRIES );
+
+			if(i>=NUM_OF_TRIES)
+				throw rfims_exception("se espero demasiado tiempo que el angulo pitch este alrededor de cero.");
+
+			cout << "Excelente!" << endl;
+			/////////////////////////////////////////////////////
+
+			/////////////////////PRUEBA 2////////////////////////
+			cout << "\nRote el dispositivo sobre uno de sus costados, de modo que el angulo roll este alrededor de 90 grados (en valor absoluto)..." << endl;
+
+			//Analisis del angulo roll
+			do
+			{
+				usleep(DELAY_US);
+				gpsInterface.UpdateRoll();
+			}
+			while( ( fabs(gpsInterface.GetRoll()) < 85.0 || fabs(gpsInterface.GetRoll()) > 95.0 ) && ++i < NUM_OF_TRIES );
+
+			if(i>=NUM_OF_TRIES)
+				throw rfims_exception("se espero demasiado tiempo que el angulo roll este alrededor de 90 grados.");
+
+			cout << "Excelente!" << endl;
+			////////////////////////////////////////////////////
+
+			////////////////////PRUEBA 3///////////////////////
+			cout << "\nColoque el dispositivo en forma vertical sobre el cable USB, de modo que el angulo pitch este alrededor de 90 grados (en valor absoluto)..." << endl;
+
+			//Analisis del angulo pitch
+			do
+			{
+				usleep(DELAY_US);
+				gpsInterface.UpdatePitch();
+			}
+			while( ( fabs(gpsInterface.GetPitch()) < 85.0 || fabs(gpsInterface.GetPitch()) > 95.0) && ++i < NUM_OF_TRIES );
+
+			if(i>=NUM_OF_TRIES)
+				throw rfims_exception("se espero demasiado tiempo que el angulo pitch este alrededor de 90 grados.");
+
+			cout << "Excelente!" << endl;
+			//////////////////////////////////////////////////////
+
+			///////////////////PRUEBA 4///////////////////////////
+			cout << "\nColoque el dispositivo sobre una superficie plana apuntando hacia el Este..." << endl;
+
+			//Analisis del angulo yaw
+			do
+			{
+				usleep(DELAY_US);
+				gpsInterface.UpdateYaw();
+			}
+			while( (gpsInterface.GetYaw() < 80.0 || gpsInterface.GetYaw() > 100.0) && ++i < NUM_OF_TRIES );
+
+			if(i>=NUM_OF_TRIES)
+				throw rfims_exception("se espero demasiado tiempo que el angulo yaw este alrededor de 90 grados.");
+
+			cout << "Excelente!" << endl;
+			//////////////////////////////////////////////////////
+
+			///////////////////PRUEBA 5///////////////////////////
+			cout << "\nColoque el dispositivo sobre una superficie plana apuntando hacia el Sur..." << endl;
+
+			//Analisis del angulo yaw
+			do
+			{
+				usleep(DELAY_US);
+				gpsInterface.UpdateYaw();
+			}
+			while( (gpsInterface.GetYaw() < 170.0 || gpsInterface.GetYaw() > 190.0) && ++i < NUM_OF_TRIES );
+
+			if(i>=NUM_OF_TRIES)
+				throw rfims_exception("se espero demasiado tiempo que el angulo yaw este alrededor de 180 grados.");
+
+			cout << "Excelente!" << endl;
+			//////////////////////////////////////////////////////
 		}
-		while( (gpsInterface.GetYaw() < 170.0 || gpsInterface.GetYaw() > 190.0) && ++i < NUM_OF_TRIES );
-
-		if(i>=NUM_OF_TRIES)
-			throw rfims_exception("se espero demasiado tiempo que el angulo yaw este alrededor de 180 grados.");
-
-		cout << "Excelente!" << endl;
-		//////////////////////////////////////////////////////
 
 		/////////////////PRUEBA 6/////////////////////////////
 		cout << "\nA continuacion se presenta la fecha y hora obtenida del GPS:" << endl;
@@ -146,6 +205,8 @@ int main()
 		{
 			auto timeData = gpsInterface.UpdateTimeData();
 			cout << '\t' << timeData.GetTimestamp() << endl;
+			if(flagEmulated)
+				break;
 			cout << "Es correcta la fecha y la hora? (Ingrese 's' por si o cualquier otra letra por no): ";
 			cin >> answer;
 
@@ -171,8 +232,11 @@ int main()
 		cout << "\nA continuacion se probara el streaming de datos del dispositivo" << endl;
 		cout << "La tasa de actualizacion para los datos de los sensores (no para los datos del GPS) sera: " << gpsInterface.GetDataRate() << " datos/s" << endl;
 
-		cout << "Presione una tecla para comenzar..." << endl;
-		WaitForEnter();
+		if(!flagEmulated)
+		{
+			cout << "Presione una tecla para comenzar..." << endl;
+			WaitForEnter();
+		}
 
 		gpsInterface.EnableStreaming();
 		cout << "\nStreaming habilitado!" << endl;
@@ -229,6 +293,26 @@ int main()
 			cout << "\tyaw: " << gpsInterface.GetYaw() << " °\tpitch: " << gpsInterface.GetPitch() << " °\troll: " << gpsInterface.GetRoll() << " °" << endl;
 		}
 
+		cout << "\nAngulos estimados por el filtro de actitud (giroscopo, magnetometro y acelerometro): 10 registros" << endl;
+		for(int i=0; i<10; i++)
+		{
+			usleep(250000);
+			const AttitudeEstimate attitude = gpsInterface.GetAttitude();
+			cout << "\tyaw: " << attitude.yaw << " ± " << attitude.yawDeviation << " °\tpitch: " << attitude.pitch << " ± " << attitude.pitchDeviation;
+			cout << " °\troll: " << attitude.roll << " ± " << attitude.rollDeviation << " °" << endl;
+		}
+
+		cout << "\nReloj disciplinado con el GPS: 5 registros, uno por segundo" << endl;
+		for(int i=0; i<5; i++)
+		{
+			sleep(1);
+			const GPSTimestamp timestamp = gpsInterface.GetClock().Now();
+			if(timestamp.flagSynchronized)
+				cout << "\tTimestamp: " << timestamp.GetTimeData().GetPreciseTimestamp() << "\tError estimado: " << (timestamp.estimatedError/1e6) << " ms" << endl;
+			else
+				cout << "\tEl reloj todavia no esta sincronizado" << endl;
+		}
+
 		gpsInterface.DisableStreaming();
 		cout << "\nStreaming deshabilitado!" << endl;
 
@@ -0,0 +1,185 @@
+/*! \file CSVFormatBenchmark.cpp
+ * 	\brief A command-line utility which compares the rows per second which are formatted to the CSV format of the sweeps
+ * 	files (sweeps_DD-MM-YYYYTHH:MM:SS.csv) with the streams, as it was done before, and with the class _CSVFormatter_.
+ * 	Both texts are compared, to verify the formatter gives exactly the same files.
+ * 	\author Mauro Diamantino
+ */
+
+#include "../src/DataStorage.h"
+
+#include <random> //This library allows to generate the synthetic power values
+
+//! The sweeps which are formatted, one after the other.
+struct BenchSweeps
+{
+	std::vector<std::uint64_t> frequencies; //!< The frequency values, in Hz.
+	std::vector<std::string> timestamps; //!< The timestamps of the sweeps.
+	std::vector<float> azimuthAngles; //!< The azimuth angles of the sweeps.
+	std::vector<std::string> polarizations; //!< The polarizations of the sweeps.
+	std::vector<float> values; //!< The power values of all the sweeps, one sweep after the other.
+};
+
+//! This function loads the sweeps of a binary sweeps store file.
+static void LoadSweepStore(const std::string & path, BenchSweeps & sweeps)
+{
+	SweepStoreReader reader;
+	reader.Open(path);
+	const std::size_t numOfPoints = reader.GetNumOfPoints();
+	sweeps.frequencies.assign( reader.GetFrequencies(), reader.GetFrequencies() + numOfPoints );
+	for(std::size_t r=0; r<reader.GetNumOfRecords(); r++)
+	{
+		sweeps.timestamps.push_back( reader.GetTimeData(r).GetTimestamp() );
+		sweeps.azimuthAngles.push_back( reader.GetAzimuthAngle(r) );
+		sweeps.polarizations.push_back( reader.GetPolarization(r) );
+		sweeps.values.insert( sweeps.values.end(), reader.GetValues(r), reader.GetValues(r) + numOfPoints );
+	}
+}
+
+//! This function generates synthetic sweeps, with noise around -100 dBm and some values which are difficult to round.
+static void GenerateSweeps(const std::size_t numOfSweeps, const std::size_t numOfPoints, BenchSweeps & sweeps)
+{
+	std::mt19937 generator(12345);
+	std::normal_distribution<float> noise(-100.0, 3.0);
+	std::uniform_int_distribution<int> tenths(-1500, 200);
+
+	for(std::size_t i=0; i<numOfPoints; i++)
+		sweeps.frequencies.push_back( 1000000000ULL + i*12350ULL ); //Some frequencies are exactly between two outputs
+
+	for(std::size_t s=0; s<numOfSweeps; s++)
+	{
+		sweeps.timestamps.push_back( "18-10-2026T01:" + std::to_string(10 + s%50) + ":00" );
+		sweeps.azimuthAngles.push_back( 30.0*(s%12) + 0.05 );
+		sweeps.polarizations.push_back( s%2 ? "vertical" : "horizontal" );
+		for(std::size_t i=0; i<numOfPoints; i++)
+		{
+			float value;
+			switch(i%8)
+			{
+				case 0:		value = tenths(generator)/10.0 + 0.05;	break; //Values near the ties
+				case 1:		value = -0.04;	break; //A negative value which is rounded to -0.0
+				default:	value = noise(generator);
+			}
+			sweeps.values.push_back(value);
+		}
+	}
+}
+
+//! This function formats the sweeps with a stream, as the sweeps files were formatted before the class _CSVFormatter_.
+static void FormatWithStream(const BenchSweeps & sweeps, std::ostringstream & oss)
+{
+	oss.setf(std::ios::fixed, std::ios::floatfield);
+	oss.setf( std::ios::dec | std::ios::left | std::ios::showpoint);
+
+	const std::size_t numOfPoints = sweeps.frequencies.size();
+	oss << "Timestamp,Azimuthal Angle,Polarization";
+	for(const auto & freq : sweeps.frequencies)
+		oss << ',' << std::setprecision(4) << double(freq)/1e6;
+	oss << "\r\n";
+
+	for(std::size_t s=0; s<sweeps.timestamps.size(); s++)
+	{
+		oss << sweeps.timestamps[s];
+		oss << ',' << std::setprecision(1) << sweeps.azimuthAngles[s];
+		oss << ',' << sweeps.polarizations[s];
+		for(std::size_t i=0; i<numOfPoints; i++)
+			oss << ',' << std::setprecision(1) << sweeps.values[s*numOfPoints + i];
+		oss << "\r\n";
+	}
+}
+
+//! This function formats the sweeps with the class _CSVFormatter_, as they are formatted by the class _SweepStoreReader_.
+static void FormatWithFormatter(const BenchSweeps & sweeps, std::string & text)
+{
+	const std::size_t numOfPoints = sweeps.frequencies.size();
+	CSVFormatter formatter;
+	SweepStoreReader::WriteCSVHeader(formatter, sweeps.frequencies.data(), numOfPoints);
+	text.assign( formatter.Data(), formatter.Size() );
+
+	for(std::size_t s=0; s<sweeps.timestamps.size(); s++)
+	{
+		formatter.Clear();
+		SweepStoreReader::WriteCSVRow(formatter, sweeps.timestamps[s], sweeps.azimuthAngles[s], sweeps.polarizations[s],
+				sweeps.values.data() + s*numOfPoints, numOfPoints);
+		text.append( formatter.Data(), formatter.Size() );
+	}
+}
+
+//! This function returns the milliseconds which have elapsed since the given time point.
+static double ElapsedTime(const std::chrono::steady_clock::time_point & startTime)
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count();
+}
+
+//! This function formats the given sweeps with both methods, prints the results and returns `true` if both texts are identical.
+static bool RunBenchmark(const std::string & name, const BenchSweeps & sweeps)
+{
+	const std::size_t numOfRows = sweeps.timestamps.size();
+	cout << '\n' << name << ": " << numOfRows << " sweeps of " << sweeps.frequencies.size() << " points" << endl;
+	cout << std::setw(16) << "Method" << std::setw(14) << "Size (B)" << std::setw(15) << "Time" << std::setw(16) << "Rows/s" << endl;
+
+	auto startTime = std::chrono::steady_clock::now();
+	std::ostringstream oss;
+	FormatWithStream(sweeps, oss);
+	const std::string streamText = oss.str();
+	const double streamTime = ElapsedTime(startTime);
+	cout << std::setw(16) << "Streams" << std::setw(14) << streamText.size() << std::setw(12) << std::setprecision(1) << streamTime << " ms";
+	cout << std::setw(16) << numOfRows*1000.0/streamTime << endl;
+
+	startTime = std::chrono::steady_clock::now();
+	std::string formatterText;
+	FormatWithFormatter(sweeps, formatterText);
+	const double formatterTime = ElapsedTime(startTime);
+	cout << std::setw(16) << "CSVFormatter" << std::setw(14) << formatterText.size() << std::setw(12) << formatterTime << " ms";
+	cout << std::setw(16) << numOfRows*1000.0/formatterTime << endl;
+	cout << "Speedup: " << std::setprecision(2) << streamTime/formatterTime << endl;
+
+	if( formatterText==streamText )
+	{
+		cout << "Both methods give the same CSV text, byte by byte." << endl;
+		return true;
+	}
+	else
+	{
+		cout << "The methods do NOT give the same CSV text." << endl;
+		return false;
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	if( argc>1 && ( std::string(argv[1])=="--help" || std::string(argv[1])=="-h" ) )
+	{
+		cout << "Usage: csvformat-bench ['sweeps store (.bin)'...]" << endl;
+		cout << "If no file is given, 100 synthetic sweeps of 20000 points are formatted." << endl;
+		return 1;
+	}
+
+	cout.setf(std::ios::fixed, std::ios::floatfield);
+	cout.setf(std::ios::right, std::ios::adjustfield);
+
+	bool flagMismatch=false;
+	try
+	{
+		if(argc<2)
+		{
+			BenchSweeps sweeps;
+			GenerateSweeps(100, 20000, sweeps);
+			flagMismatch = !RunBenchmark("Synthetic sweeps", sweeps);
+		}
+
+		for(int f=1; f<argc; f++)
+		{
+			BenchSweeps sweeps;
+			LoadSweepStore(argv[f], sweeps);
+			if( !RunBenchmark(argv[f], sweeps) )
+				flagMismatch=true;
+		}
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "csvformat-bench: " << exc.what() << endl;
+		return 1;
+	}
+
+	return flagMismatch ? 2 : 0;
+}
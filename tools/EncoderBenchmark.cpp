@@ -0,0 +1,117 @@
+/*! \file EncoderBenchmark.cpp
+ * 	\brief A command-line utility which stress-tests the counting of the edges of the encoder of the azimuth rotator (the
+ * 	class _EncoderCounter_) with a simulated encoder (the class _SimulatedEncoder_), on any Linux machine.
+ *
+ * 	The simulated encoder performs several movements of the given number of counts, alternating their direction, at the
+ * 	given edge rate, while the main thread reads the count continuously, as the control loop does, to measure:
+ * 	- The time of each read of the count and if the count ever went back during a movement.
+ * 	- The difference between the count which was generated and the one which was counted, which must be the edges which
+ * 	the simulated interrupt service routines could not handle in time (lost edges): any other difference is an edge
+ * 	which the counter lost.
+ * 	- The edges which were detected as repeated by the counter, which reveal the lost edges which broke the alternation
+ * 	of the channels, and the minimum interval between two edges.
+ * 	\author Mauro Diamantino
+ */
+
+#include "../src/AntennaPositioning.h"
+
+int main(int argc, char * argv[])
+{
+	if( argc>1 && ( std::string(argv[1])=="--help" || std::string(argv[1])=="-h" ) )
+	{
+		cout << "Usage: encoder-bench [--rate='edges/s'] [--counts='number'] [--movements='number']" << endl;
+		cout << "The simulated encoder performs the given number of movements (4 by default), alternating their direction," << endl;
+		cout << "of the given number of counts (1000000 by default) at the given rate of rising edges (100000 edges/s by" << endl;
+		cout << "default). Each channel is handled by its own thread, as the interrupt service routines of wiringPi, and" << endl;
+		cout << "the edges which arrive before the previous one of the same channel was handled are lost. The edges which" << endl;
+		cout << "are lost in pairs (one of each channel) keep the alternation of the channels, so the counter cannot detect" << endl;
+		cout << "them: they are only revealed by the error of the count. The simulation uses three processor cores, plus" << endl;
+		cout << "the one of the thread which reads the count, so the rate it reaches is lower on machines with less cores." << endl;
+		return 1;
+	}
+
+	cout.setf(std::ios::fixed, std::ios::floatfield);
+
+	try
+	{
+		double edgeRate=100000.0;
+		std::int64_t numOfCounts=1000000;
+		unsigned int numOfMovements=4;
+		for(int i=1; i<argc; i++)
+		{
+			std::string arg(argv[i]);
+			if( arg.compare(0, 7, "--rate=")==0 )
+				edgeRate = std::stod( arg.substr(7) );
+			else if( arg.compare(0, 9, "--counts=")==0 )
+				numOfCounts = std::stoll( arg.substr(9) );
+			else if( arg.compare(0, 12, "--movements=")==0 )
+				numOfMovements = std::stoul( arg.substr(12) );
+			else
+				throw rfims_exception("the argument " + arg + " is not valid.");
+		}
+
+		EncoderCounter counter;
+		SimulatedEncoder encoder(counter);
+
+		std::uint64_t numOfReads=0, numOfBackSteps=0;
+		double readTime=0.0;
+		for(unsigned int m=0; m<numOfMovements; m++)
+		{
+			const std::int64_t counts = ( m%2==0 ? numOfCounts : -numOfCounts );
+			const std::int64_t startCount = counter.GetCount();
+			cout << "\nMovement " << (m+1) << ": " << counts << " counts at " << std::setprecision(0) << edgeRate << " edges/s..." << endl;
+
+			encoder.StartMovement(counts, edgeRate);
+			const std::int64_t startTime = GPSClock::MonotonicTime();
+			std::uint64_t movementReads=0;
+			std::int64_t lastCount=startCount;
+			while( encoder.IsMoving() )
+			{
+				//The count is read in blocks, so the time of the clock does not hide the time of the reads
+				for(unsigned int i=0; i<1000; i++)
+				{
+					const std::int64_t currCount = counter.GetCount();
+					if( ( counts > 0 && currCount < lastCount ) || ( counts < 0 && currCount > lastCount ) )
+						numOfBackSteps++;
+					lastCount = currCount;
+				}
+				movementReads += 1000;
+				sched_yield();
+			}
+			const std::int64_t elapsedTime = GPSClock::MonotonicTime() - startTime;
+			encoder.WaitForMovement();
+
+			numOfReads += movementReads;
+			readTime += double(elapsedTime);
+			cout << "Counted: " << EncoderCounter::CountDifference( counter.GetCount(), startCount ) << " counts (";
+			cout << std::setprecision(1) << counter.GetDegreesSince(startCount) << " degrees) in " << std::setprecision(3) << elapsedTime*1e-9 << " s" << endl;
+		}
+
+		const EncoderStatistics statistics = counter.GetStatistics();
+		const std::int64_t countError = EncoderCounter::CountDifference( encoder.GetGeneratedCount(), counter.GetCount() );
+		const std::int64_t counterError = countError - encoder.GetLostCount();
+
+		cout << "\nGenerated count:          " << encoder.GetGeneratedCount() << endl;
+		cout << "Final count:              " << counter.GetCount() << " (error of " << countError << " counts)" << endl;
+		cout << "Edges of the channels:    A " << statistics.numOfEdges[EncoderCounter::CHANNEL_A] << ", B " << statistics.numOfEdges[EncoderCounter::CHANNEL_B] << endl;
+		cout << "Lost edges:               " << encoder.GetNumOfLostEdges() << " (" << encoder.GetLostCount() << " counts)" << endl;
+		cout << "Error of the counter:     " << counterError << " counts, besides the lost edges" << endl;
+		cout << "Detected repeated edges:  " << statistics.numOfRepeatedEdges << endl;
+		cout << "Minimum edge interval:    " << std::setprecision(3) << statistics.minEdgeInterval*1e-3 << " us" << endl;
+		cout << "Reads of the count:       " << numOfReads << ", " << std::setprecision(1) << ( numOfReads > 0 ? readTime/numOfReads : 0.0 ) << " ns per read" << endl;
+		cout << "The count went back during a movement " << numOfBackSteps << " time(s)." << endl;
+
+		if(counterError!=0)
+		{
+			cerr << "encoder-bench: the counter lost " << std::llabs(counterError) << " count(s) which were handled." << endl;
+			return 1;
+		}
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "encoder-bench: " << exc.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
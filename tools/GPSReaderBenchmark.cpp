@@ -0,0 +1,493 @@
+/*! \file GPSReaderBenchmark.cpp
+ * 	\brief A command-line utility which compares the sentences per second which are framed from a recorded output of the
+ * 	Aaronia GPS Logger reading one byte per call, as the class _GPSInterface_ did before, and reading all the available
+ * 	bytes per call with the class _SentenceBuffer_. The recording is read with the system call read(), whose cost per
+ * 	call plays the role of the D2XX function FT_Read(). Both sequences of sentences are compared, to verify they are
+ * 	identical.
+ *
+ * 	Then, the sentences per second which are parsed with the previous procedure (checksum with sscanf(), a copy of the
+ * 	GPRMC and GPGGA sentences which is split and converted as the library libnmea did, and streams for the PAAG
+ * 	sentences) and with the class _SentenceParser_ are compared, verifying both give the same values.
+ * 	\author Mauro Diamantino
+ */
+
+#include "../src/AntennaPositioning.h"
+
+#include <ctime> //The function strptime(), which was used by the library libnmea to interpret the time and date
+
+//! The results of the framing of a recording with one of the methods.
+struct FramingResult
+{
+	std::size_t numOfSentences; //!< The number of complete sentences.
+	std::size_t numOfBytes; //!< The total number of bytes of the complete sentences.
+	std::size_t numOfCalls; //!< The number of calls to the function read().
+	std::uint64_t hash; //!< A FNV-1a hash of all the sentences, to compare the methods.
+	double time; //!< The elapsed time, in milliseconds.
+};
+
+//! This function updates a FNV-1a hash with the given bytes.
+static void UpdateHash(std::uint64_t & hash, const char * data, const std::size_t length)
+{
+	for(std::size_t i=0; i<length; i++)
+	{
+		hash ^= (unsigned char) data[i];
+		hash *= 1099511628211ULL;
+	}
+}
+
+//! This function appends a sentence to the recording, with its checksum, as the GPS receiver sends it.
+static void AppendSentence(std::string & recording, const std::string & body)
+{
+	unsigned int checksum=0;
+	for(const char c : body)
+		checksum ^= (unsigned char) c;
+
+	char tail[8];
+	std::snprintf(tail, sizeof(tail), "*%02X\r\n", checksum);
+	recording += '$' + body + tail;
+}
+
+//! This function generates a synthetic recording with the sentences which are sent with the streaming enabled at 4 Hz.
+static void GenerateRecording(const unsigned int numOfSeconds, std::string & recording)
+{
+	const unsigned int dataRate=4;
+	for(unsigned int s=0; s<numOfSeconds; s++)
+	{
+		char time[16];
+		std::snprintf(time, sizeof(time), "%02u%02u%02u", (s/3600)%24, (s/60)%60, s%60);
+		AppendSentence(recording, std::string("GPRMC,") + time + ".000,A,3150.7412,S,06413.2046,W,0.02,87.35,181026,,,A");
+		AppendSentence(recording, std::string("GPGGA,") + time + ".000,3150.7412,S,06413.2046,W,1,09,0.9,431.5,M,21.3,M,,");
+		for(unsigned int n=0; n<dataRate; n++)
+		{
+			const std::string sample = std::string(time) + ".00" + std::to_string(n) + ',';
+			const int noise = int( (s*7 + n*13) % 17 ) - 8;
+			AppendSentence(recording, "PAAG,DATA,G," + sample + std::to_string(-12+noise) + ',' + std::to_string(34-noise) + ',' + std::to_string(5+noise) + ",A");
+			AppendSentence(recording, "PAAG,DATA,C," + sample + std::to_string(-210+noise) + ',' + std::to_string(118+noise) + ',' + std::to_string(-402-noise) + ",A");
+			AppendSentence(recording, "PAAG,DATA,T," + sample + std::to_string(63+noise) + ',' + std::to_string(-41+noise) + ',' + std::to_string(8190-noise) + ",A");
+			if(n==0)
+				AppendSentence(recording, "PAAG,DATA,B," + sample + std::to_string(965.12 + noise/100.0) + ",A");
+		}
+	}
+}
+
+//! This function returns the milliseconds which have elapsed since the given time point.
+static double ElapsedTime(const std::chrono::steady_clock::time_point & startTime)
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count();
+}
+
+//! This function frames the sentences reading one byte per call and appending it to a `std::string`, as it was done before.
+static FramingResult FrameByteByByte(const int fd)
+{
+	FramingResult result{0, 0, 0, 14695981039346656037ULL, 0.0};
+	lseek(fd, 0, SEEK_SET);
+	const auto startTime = std::chrono::steady_clock::now();
+
+	std::string reply;
+	char rxByte;
+	ssize_t ret;
+	while( (ret = read(fd, &rxByte, 1)) == 1 )
+	{
+		result.numOfCalls++;
+		reply += rxByte;
+		if(rxByte=='\n')
+		{
+			result.numOfSentences++;
+			result.numOfBytes += reply.size();
+			UpdateHash(result.hash, reply.data(), reply.size());
+			reply.clear();
+		}
+	}
+	result.numOfCalls++;
+	if(ret < 0)
+		throw rfims_exception("the recording could not be read.");
+
+	result.time = ElapsedTime(startTime);
+	return result;
+}
+
+//! This function frames the sentences reading up to _chunkSize_ bytes per call with the class _SentenceBuffer_.
+static FramingResult FrameWithBuffer(const int fd, const std::size_t chunkSize)
+{
+	FramingResult result{0, 0, 0, 14695981039346656037ULL, 0.0};
+	lseek(fd, 0, SEEK_SET);
+	const auto startTime = std::chrono::steady_clock::now();
+
+	SentenceBuffer rxBuffer;
+	const char * sentence;
+	std::size_t length, freeSpace;
+	ssize_t ret;
+	do
+	{
+		char * writePtr = rxBuffer.GetWriteBuffer(freeSpace);
+		ret = read( fd, writePtr, std::min(freeSpace, chunkSize) );
+		result.numOfCalls++;
+		if(ret < 0)
+			throw rfims_exception("the recording could not be read.");
+		rxBuffer.Commit(ret);
+
+		while( rxBuffer.NextSentence(sentence, length) )
+		{
+			result.numOfSentences++;
+			result.numOfBytes += length;
+			UpdateHash(result.hash, sentence, length);
+		}
+	}while(ret > 0);
+
+	result.time = ElapsedTime(startTime);
+	return result;
+}
+
+//! The values which are extracted from a sentence, to compare the parsing methods.
+struct ParsedValues
+{
+	GPSSentence::SentenceType type;
+	unsigned int hour, minute, second, day, month, year;
+	double latitude, longitude;
+	unsigned int numOfSatellites, elevation;
+	double x, y, z;
+	float pressure;
+
+	bool operator==(const ParsedValues & other) const
+	{
+		return( type==other.type && hour==other.hour && minute==other.minute && second==other.second && day==other.day &&
+				month==other.month && year==other.year && latitude==other.latitude && longitude==other.longitude &&
+				numOfSatellites==other.numOfSatellites && elevation==other.elevation && x==other.x && y==other.y &&
+				z==other.z && pressure==other.pressure );
+	}
+};
+
+//! This function checks the checksum of a sentence as the class _GPSInterface_ did before, with sscanf().
+static bool OldControlChecksum(const std::string & reply)
+{
+	unsigned int receivedChecksum, calculChecksum = 0;
+	unsigned int i=1;
+
+	while(reply[i]!='*')
+		calculChecksum ^= reply[i++];
+
+	size_t checksumPos = reply.find('*') + 1;
+	std::string checksumString = reply.substr(checksumPos, 2);
+	sscanf(checksumString.c_str(), "%x", &receivedChecksum);
+
+	return( receivedChecksum==calculChecksum );
+}
+
+//! This function checks the status of a sentence as the class _GPSInterface_ did before.
+static bool OldControlStatus(const std::string & reply)
+{
+	size_t statusCharPos = reply.find('*') - 1;
+	return( reply.at(statusCharPos)=='A' || reply.at(statusCharPos)=='a' );
+}
+
+//! This function interprets a GPRMC or GPGGA sentence as the library libnmea did: a copy of the sentence is split in fields, which are converted with strptime(), atoi() and atof().
+static bool OldParseNMEA(const std::string & reply, ParsedValues & values)
+{
+	char * auxString = new char[ reply.size() + 10 ];
+	strcpy( auxString, reply.c_str() );
+
+	std::vector<char*> fields;
+	char * cursor = auxString;
+	fields.push_back(cursor);
+	while( (cursor = std::strpbrk(cursor, ",*")) != nullptr )
+	{
+		*cursor++ = '\0';
+		fields.push_back(cursor);
+	}
+
+	struct tm time;
+	std::memset(&time, 0, sizeof(time));
+	const bool flagGPRMC = (values.type==GPSSentence::GPRMC);
+	const unsigned int firstPos = flagGPRMC ? 3 : 2;
+	if( fields.size() < 10 || strptime(fields[1], "%H%M%S", &time)==NULL || (flagGPRMC && strptime(fields[9], "%d%m%y", &time)==NULL) )
+	{
+		delete[] auxString;
+		return false;
+	}
+
+	double * angles[2] = { &values.latitude, &values.longitude };
+	for(unsigned int c=0; c<2; c++)
+	{
+		char * position = fields[firstPos + 2*c];
+		char * pointPtr = std::strchr(position, '.');
+		if(pointPtr==NULL || pointPtr - position < 2)
+		{
+			delete[] auxString;
+			return false;
+		}
+		const double minutes = atof(pointPtr - 2);
+		pointPtr[-2] = '\0';
+		const int degrees = atoi(position);
+		const char cardinal = fields[firstPos + 2*c + 1][0];
+		*angles[c] = double(degrees + minutes/60.0) * ( (cardinal=='S' || cardinal=='W') ? -1.0 : 1.0 );
+	}
+
+	values.hour = time.tm_hour; values.minute = time.tm_min; values.second = time.tm_sec;
+	if(flagGPRMC)
+	{
+		values.day = time.tm_mday; values.month = time.tm_mon+1; values.year = time.tm_year+1900;
+	}
+	else
+	{
+		values.numOfSatellites = atoi(fields[7]);
+		values.elevation = atoi(fields[9]);
+	}
+
+	delete[] auxString;
+	return true;
+}
+
+//! This function parses a sentence as the class _GPSInterface_ did before, returning `false` if the data are not extracted.
+static bool OldParse(const std::string & reply, ParsedValues & values)
+{
+	values = ParsedValues();
+	if( reply.find("$GPRMC") != std::string::npos )
+		values.type = GPSSentence::GPRMC;
+	else if( reply.find("$GPGGA") != std::string::npos )
+		values.type = GPSSentence::GPGGA;
+	else if( reply.find("$PAAG,DATA,G") != std::string::npos )
+		values.type = GPSSentence::PAAG_GYRO;
+	else if( reply.find("$PAAG,DATA,C") != std::string::npos )
+		values.type = GPSSentence::PAAG_COMPASS;
+	else if( reply.find("$PAAG,DATA,T") != std::string::npos )
+		values.type = GPSSentence::PAAG_ACCELER;
+	else if( reply.find("$PAAG,DATA,B") != std::string::npos )
+		values.type = GPSSentence::PAAG_BAROM;
+	else
+		return false;
+
+	if( !OldControlChecksum(reply) || (values.type!=GPSSentence::GPGGA && !OldControlStatus(reply)) )
+		return false;
+
+	if(values.type==GPSSentence::GPRMC || values.type==GPSSentence::GPGGA)
+		return OldParseNMEA(reply, values);
+
+	std::stringstream ss;
+	std::string aux;
+	if(values.type==GPSSentence::PAAG_BAROM)
+	{
+		auto valuePos = reply.find(',', 13) + 1;
+		auto nextDelimPos = reply.find(',', valuePos);
+		aux = reply.substr(valuePos, nextDelimPos-valuePos);
+		ss.str( aux );
+		ss >> values.pressure;
+	}
+	else
+	{
+		char delimiter[2];
+		size_t statusPos = reply.find('*') - 1;
+		size_t xPos = reply.find(',', 13) + 1;
+		aux = reply.substr(xPos, statusPos-xPos-1);
+		ss.str( aux );
+		ss >> values.x >> delimiter[0] >> values.y >> delimiter[1] >> values.z;
+	}
+	return true;
+}
+
+//! This function parses a sentence with the class _SentenceParser_, returning `false` if the data are not extracted.
+static bool NewParse(const std::string & reply, ParsedValues & values)
+{
+	values = ParsedValues();
+	GPSSentence fields;
+	if( !SentenceParser::Parse(reply.data(), reply.size(), fields) )
+		return false;
+	if( fields.type!=GPSSentence::GPGGA && fields.status!='A' && fields.status!='a' )
+		return false;
+
+	values.type = fields.type;
+	switch(fields.type)
+	{
+		case GPSSentence::GPRMC:
+			values.day = fields.day; values.month = fields.month; values.year = fields.year;
+			//no break
+		case GPSSentence::GPGGA:
+			values.hour = fields.hour; values.minute = fields.minute; values.second = fields.second;
+			values.latitude = fields.latitude;
+			values.longitude = fields.longitude;
+			if(fields.type==GPSSentence::GPGGA)
+			{
+				values.numOfSatellites = fields.numOfSatellites;
+				values.elevation = fields.altitude;
+			}
+			break;
+		case GPSSentence::PAAG_BAROM:
+			values.pressure = fields.pressure;
+			break;
+		default:
+			values.x = fields.x; values.y = fields.y; values.z = fields.z;
+	}
+	return true;
+}
+
+//! This function splits a recording in sentences, with the class _SentenceBuffer_.
+static void LoadSentences(const int fd, std::vector<std::string> & sentences)
+{
+	lseek(fd, 0, SEEK_SET);
+	SentenceBuffer rxBuffer;
+	const char * sentence;
+	std::size_t length, freeSpace;
+	ssize_t ret;
+	do
+	{
+		char * writePtr = rxBuffer.GetWriteBuffer(freeSpace);
+		if( (ret = read(fd, writePtr, freeSpace)) < 0 )
+			throw rfims_exception("the recording could not be read.");
+		rxBuffer.Commit(ret);
+		while( rxBuffer.NextSentence(sentence, length) )
+			sentences.emplace_back(sentence, length);
+	}while(ret > 0);
+}
+
+//! This function parses the sentences with both methods, prints the results and returns `true` if both give the same values.
+static bool RunParsingBenchmark(const std::vector<std::string> & sentences)
+{
+	std::vector<ParsedValues> oldValues( sentences.size() ), newValues( sentences.size() );
+	std::vector<char> oldFlags( sentences.size() ), newFlags( sentences.size() );
+
+	auto startTime = std::chrono::steady_clock::now();
+	for(std::size_t i=0; i<sentences.size(); i++)
+		oldFlags[i] = OldParse(sentences[i], oldValues[i]);
+	const double oldTime = ElapsedTime(startTime);
+
+	startTime = std::chrono::steady_clock::now();
+	for(std::size_t i=0; i<sentences.size(); i++)
+		newFlags[i] = NewParse(sentences[i], newValues[i]);
+	const double newTime = ElapsedTime(startTime);
+
+	std::size_t numOfExtracted=0, numOfDifferences=0;
+	for(std::size_t i=0; i<sentences.size(); i++)
+	{
+		numOfExtracted += oldFlags[i];
+		if( oldFlags[i]!=newFlags[i] || ( oldFlags[i] && !(oldValues[i]==newValues[i]) ) )
+		{
+			if(numOfDifferences++ < 5)
+				cout << "Different result: " << sentences[i];
+		}
+	}
+
+	cout << std::setw(16) << "Parsing" << std::setw(12) << "Sentences" << std::setw(12) << "Extracted" << std::setw(15) << "Time";
+	cout << std::setw(14) << "Sentences/s" << endl;
+	cout << std::setw(16) << "Previous" << std::setw(12) << sentences.size() << std::setw(12) << numOfExtracted;
+	cout << std::setw(12) << std::setprecision(1) << oldTime << " ms" << std::setw(14) << sentences.size()*1000.0/oldTime << endl;
+	cout << std::setw(16) << "SentenceParser" << std::setw(12) << sentences.size() << std::setw(12) << numOfExtracted;
+	cout << std::setw(12) << std::setprecision(1) << newTime << " ms" << std::setw(14) << sentences.size()*1000.0/newTime << endl;
+	cout << "Speedup: " << std::setprecision(2) << oldTime/newTime << endl;
+
+	if(numOfDifferences==0)
+	{
+		cout << "Both parsers extract the same values." << endl;
+		return true;
+	}
+	else
+	{
+		cout << "The parsers do NOT extract the same values in " << numOfDifferences << " sentence(s)." << endl;
+		return false;
+	}
+}
+
+//! This function prints the results of one method.
+static void PrintResult(const std::string & method, const FramingResult & result)
+{
+	cout << std::setw(16) << method << std::setw(12) << result.numOfSentences << std::setw(12) << result.numOfCalls;
+	cout << std::setw(12) << std::setprecision(1) << result.time << " ms" << std::setw(14) << result.numOfSentences*1000.0/result.time;
+	cout << std::setw(10) << std::setprecision(2) << result.numOfBytes/(result.time*1e3) << endl;
+}
+
+//! This function frames the given recording with both methods, prints the results and returns `true` if both give the same sentences.
+static bool RunBenchmark(const std::string & name, const int fd, const std::size_t chunkSize)
+{
+	cout << '\n' << name << " (" << chunkSize << " bytes per buffered read)" << endl;
+	cout << std::setw(16) << "Method" << std::setw(12) << "Sentences" << std::setw(12) << "Calls" << std::setw(15) << "Time";
+	cout << std::setw(14) << "Sentences/s" << std::setw(10) << "MB/s" << endl;
+
+	const FramingResult byteResult = FrameByteByByte(fd);
+	PrintResult("Byte by byte", byteResult);
+	const FramingResult bufferResult = FrameWithBuffer(fd, chunkSize);
+	PrintResult("SentenceBuffer", bufferResult);
+	cout << "Speedup: " << std::setprecision(2) << byteResult.time/bufferResult.time << endl;
+
+	bool flagSameResults=true;
+	if( byteResult.numOfSentences==bufferResult.numOfSentences && byteResult.numOfBytes==bufferResult.numOfBytes &&
+			byteResult.hash==bufferResult.hash )
+		cout << "Both methods give the same sentences, byte by byte." << endl;
+	else
+	{
+		cout << "The methods do NOT give the same sentences." << endl;
+		flagSameResults=false;
+	}
+
+	cout << endl;
+	std::vector<std::string> sentences;
+	LoadSentences(fd, sentences);
+	if( !RunParsingBenchmark(sentences) )
+		flagSameResults=false;
+
+	return flagSameResults;
+}
+
+int main(int argc, char * argv[])
+{
+	if( argc>1 && ( std::string(argv[1])=="--help" || std::string(argv[1])=="-h" ) )
+	{
+		cout << "Usage: gpsreader-bench [--chunk='bytes'] ['recorded output of the GPS Logger'...]" << endl;
+		cout << "If no file is given, a synthetic recording of one hour of streaming at 4 Hz is used. The option --chunk" << endl;
+		cout << "limits the bytes which are read per call with the buffer (the available bytes), 4096 by default." << endl;
+		cout << "Then, the sentences are parsed with the previous method and with the class SentenceParser." << endl;
+		return 1;
+	}
+
+	cout.setf(std::ios::fixed, std::ios::floatfield);
+	cout.setf(std::ios::right, std::ios::adjustfield);
+
+	bool flagMismatch=false;
+	try
+	{
+		std::size_t chunkSize=4096;
+		std::vector<std::string> paths;
+		for(int i=1; i<argc; i++)
+		{
+			std::string arg(argv[i]);
+			if( arg.compare(0, 8, "--chunk=")==0 )
+				chunkSize = std::max( std::stoul( arg.substr(8) ), 1UL );
+			else
+				paths.push_back(arg);
+		}
+
+		if( paths.empty() )
+		{
+			std::string recording;
+			GenerateRecording(3600, recording);
+
+			char tempPath[] = "/tmp/gpsreader-bench-XXXXXX";
+			const int fd = mkstemp(tempPath);
+			if(fd < 0)
+				throw rfims_exception("the temporary file of the synthetic recording could not be created.");
+			unlink(tempPath);
+			if( write(fd, recording.data(), recording.size()) != ssize_t( recording.size() ) )
+			{
+				close(fd);
+				throw rfims_exception("the synthetic recording could not be written.");
+			}
+
+			flagMismatch = !RunBenchmark("Synthetic recording", fd, chunkSize);
+			close(fd);
+		}
+
+		for(const auto & path : paths)
+		{
+			const int fd = open(path.c_str(), O_RDONLY);
+			if(fd < 0)
+				throw rfims_exception("the recording " + path + " could not be opened.");
+			if( !RunBenchmark(path, fd, chunkSize) )
+				flagMismatch=true;
+			close(fd);
+		}
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "gpsreader-bench: " << exc.what() << endl;
+		return 1;
+	}
+
+	return flagMismatch ? 2 : 0;
+}
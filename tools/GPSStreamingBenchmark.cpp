@@ -0,0 +1,172 @@
+/*! \file GPSStreamingBenchmark.cpp
+ * 	\brief A command-line utility which runs the class _GPSInterface_ with an emulated Aaronia GPS Logger (the class
+ * 	_EmulatedGPSTransport_), so its streaming can be benchmarked on any Linux machine, without the device.
+ *
+ * 	The GPS interface is initialized and the streaming is enabled, as the main program does, and then the published
+ * 	snapshots are polled during the given time to measure:
+ * 	- The replies per second which are interpreted and the CPU time of the streaming thread per reply. The CPU time of
+ * 	the process minus the one of the polling thread is the one of the streaming thread, which also emulates the logger.
+ * 	- The latency of the publication of the GPRMC replies: the time between the reception of the last byte of a reply
+ * 	and the detection of its snapshot, which is polled every 200 us.
+ * 	- The error of the timestamps of the GPS clock with respect to the true UTC time of the emulated logger, and how
+ * 	many times it was larger than the estimated error.
+ * 	\author Mauro Diamantino
+ */
+
+#include "../src/AntennaPositioning.h"
+
+#include <sys/resource.h> //getrusage(), to measure the CPU time of the process
+
+//! A set of values whose mean, maximum and percentiles are printed.
+struct Statistics
+{
+	std::vector<double> values; //!< The measured values.
+
+	//! This method prints the number of values, their mean, median, 99th percentile and maximum, with the given unit.
+	void Print(const std::string & name, const std::string & unit)
+	{
+		cout << std::setw(26) << std::left << name << std::right;
+		if( values.empty() )
+		{
+			cout << "no samples" << endl;
+			return;
+		}
+		std::sort( values.begin(), values.end() );
+		double sum=0.0;
+		for(const double value : values)
+			sum += value;
+		cout << std::setw(8) << values.size() << " samples, mean " << std::setprecision(3) << sum/values.size() << ' ' << unit;
+		cout << ", median " << values[ values.size()/2 ] << ' ' << unit;
+		cout << ", p99 " << values[ values.size()*99/100 ] << ' ' << unit;
+		cout << ", max " << values.back() << ' ' << unit << endl;
+	}
+};
+
+//! This function returns the time of the given clock, in seconds.
+static double ClockTime(const clockid_t clockID)
+{
+	timespec time;
+	clock_gettime(clockID, &time);
+	return( time.tv_sec + time.tv_nsec * 1e-9 );
+}
+
+//! This function returns the CPU time of the process (user and system), in seconds.
+static double ProcessCPUTime()
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return( usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6 );
+}
+
+//! This function returns the total number of interpreted replies of a snapshot.
+static std::uint64_t CountReplies(const GPSSnapshot & snapshot)
+{
+	std::uint64_t numOfReplies=0;
+	for(unsigned int i=0; i<GPSSentence::UNKNOWN; i++)
+		numOfReplies += snapshot.numOfReplies[i];
+	return numOfReplies;
+}
+
+int main(int argc, char * argv[])
+{
+	if( argc>1 && ( std::string(argv[1])=="--help" || std::string(argv[1])=="-h" ) )
+	{
+		cout << "Usage: gpsstreaming-bench [--rate='Hz'] [--jitter='ms'] [--duration='s'] ['recorded output of the GPS Logger']" << endl;
+		cout << "The emulated GPS Logger sends synthetic replies, or replays the given recording, with the sets of sensor" << endl;
+		cout << "replies at the given rate (the one which is configured by the GPS interface, 4 Hz, by default) and with" << endl;
+		cout << "a random delay of each group of replies up to the given jitter (2 ms by default). The streaming is" << endl;
+		cout << "measured during the given time (30 s by default), after the initialization of the GPS interface." << endl;
+		cout << "The emulated serial line carries about 56 kB/s, so the replies are delayed when the rate exceeds it." << endl;
+		return 1;
+	}
+
+	cout.setf(std::ios::fixed, std::ios::floatfield);
+
+	try
+	{
+		unsigned int dataRate=0;
+		double jitter=0.002, duration=30.0;
+		std::string recordingPath;
+		for(int i=1; i<argc; i++)
+		{
+			std::string arg(argv[i]);
+			if( arg.compare(0, 7, "--rate=")==0 )
+				dataRate = std::stoul( arg.substr(7) );
+			else if( arg.compare(0, 9, "--jitter=")==0 )
+				jitter = std::stod( arg.substr(9) ) * 1e-3;
+			else if( arg.compare(0, 11, "--duration=")==0 )
+				duration = std::stod( arg.substr(11) );
+			else
+				recordingPath = arg;
+		}
+
+		EmulatedGPSTransport transport(dataRate, jitter, recordingPath);
+		GPSInterface gpsInterface(transport);
+		gpsInterface.Initialize();
+		gpsInterface.EnableStreaming();
+
+		cout << "\nMeasuring the streaming during " << std::setprecision(1) << duration << " s..." << endl;
+
+		Statistics latencies, clockErrors, estimatedErrors;
+		unsigned int numOfViolations=0;
+
+		GPSSnapshot snapshot = gpsInterface.GetSnapshot();
+		const std::uint64_t initialReplies = CountReplies(snapshot);
+		const std::uint64_t initialReceivedReplies = transport.GetNumOfReplies();
+		std::uint64_t lastNumOfGPRMC = snapshot.numOfReplies[GPSSentence::GPRMC];
+
+		const double startTime = ClockTime(CLOCK_MONOTONIC);
+		const double startCPUTime = ProcessCPUTime();
+		const double startThreadCPUTime = ClockTime(CLOCK_THREAD_CPUTIME_ID);
+
+		while( ClockTime(CLOCK_MONOTONIC) - startTime < duration && gpsInterface.IsStreamingEnabled() )
+		{
+			usleep(200);
+			snapshot = gpsInterface.GetSnapshot();
+			if( snapshot.numOfReplies[GPSSentence::GPRMC] == lastNumOfGPRMC )
+				continue;
+			lastNumOfGPRMC = snapshot.numOfReplies[GPSSentence::GPRMC];
+
+			const std::int64_t detectionTime = GPSClock::MonotonicTime();
+			const std::int64_t receptionTime = transport.GetLastGPRMCTime(detectionTime);
+			if(receptionTime > 0)
+				latencies.values.push_back( (detectionTime - receptionTime) * 1e-6 );
+
+			//The GPS clock is compared with the true UTC time of the emulated logger once it is synchronized
+			const std::int64_t time = GPSClock::MonotonicTime();
+			const GPSTimestamp timestamp = gpsInterface.GetClock().GetTimestamp(time);
+			if(timestamp.flagSynchronized)
+			{
+				const std::int64_t error = timestamp.utcTime - transport.GetUTCTime(time);
+				clockErrors.values.push_back( std::abs(error) * 1e-6 );
+				estimatedErrors.values.push_back( timestamp.estimatedError * 1e-6 );
+				if( std::abs(error) > timestamp.estimatedError )
+					numOfViolations++;
+			}
+		}
+
+		const double elapsedTime = ClockTime(CLOCK_MONOTONIC) - startTime;
+		const double streamingCPUTime = ( ProcessCPUTime() - startCPUTime ) - ( ClockTime(CLOCK_THREAD_CPUTIME_ID) - startThreadCPUTime );
+		const std::uint64_t numOfReplies = CountReplies( gpsInterface.GetSnapshot() ) - initialReplies;
+		const std::uint64_t numOfReceivedReplies = transport.GetNumOfReplies() - initialReceivedReplies;
+
+		if( !gpsInterface.IsStreamingEnabled() )
+			cerr << "\nWarning: the streaming thread stopped because of the reading errors." << endl;
+
+		cout << "\nReceived replies:         " << numOfReceivedReplies << " (" << std::setprecision(1) << numOfReceivedReplies/elapsedTime << " replies/s)" << endl;
+		cout << "Interpreted replies:      " << numOfReplies << " (" << numOfReplies/elapsedTime << " replies/s)" << endl;
+		cout << "Streaming thread CPU:     " << std::setprecision(2) << 100.0*streamingCPUTime/elapsedTime << " %, ";
+		cout << std::setprecision(2) << ( numOfReplies > 0 ? streamingCPUTime*1e6/numOfReplies : 0.0 ) << " us per reply" << endl;
+		latencies.Print("GPRMC latency:", "ms");
+		clockErrors.Print("GPS clock error:", "ms");
+		estimatedErrors.Print("Estimated clock error:", "ms");
+		cout << "The clock error was larger than the estimated one " << numOfViolations << " time(s)." << endl;
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "gpsstreaming-bench: " << exc.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,137 @@
+/*! \file GPSTrackQuery.cpp
+ * 	\brief A command-line utility which looks up the position and the attitude of the GPS receiver in the file of the
+ * 	class _GPSRecorder_, so the sweeps and the bands can be correlated with them by their timestamps.
+ *
+ * 	The timestamps are given in local time, as the ones of the sweeps, and the records are written in the CSV format.
+ * 	The file can be looked up while the main program is appending records to it.
+ * 	\author Mauro Diamantino
+ */
+
+#include "../src/AntennaPositioning.h"
+
+//! This function converts a local timestamp, DD-MM-YYYYTHH:MM:SS with an optional fraction of the second, to UTC nanoseconds since 01-01-1970T00:00:00.
+static std::int64_t ParseTimestamp(const std::string & timestamp)
+{
+	TimeData timeData;
+	timeData.SetTimestamp(timestamp);
+	std::int64_t nanoseconds=0;
+	const std::size_t pointPos = timestamp.find('.');
+	if( pointPos!=std::string::npos )
+		nanoseconds = std::llround( std::stod( "0" + timestamp.substr(pointPos) ) * 1e9 );
+	if( timeData.month==0 || timeData.month>12 || timeData.day==0 || timeData.day>31 )
+		throw rfims_exception("the timestamp " + timestamp + " is not valid.");
+
+	return( GPSClock::ToUTCTime(timeData.year, timeData.month, timeData.day, timeData.hour, timeData.minute, timeData.second, 0)
+			+ nanoseconds - GPSTimestamp::LOCAL_TIME_OFFSET );
+}
+
+//! This function returns the local timestamp of the given UTC time, with microseconds.
+static std::string FormatTime(const std::int64_t utcTime)
+{
+	const GPSTimestamp timestamp = { utcTime, 0, true };
+	return timestamp.GetTimeData().GetPreciseTimestamp();
+}
+
+//! This function writes a record as a line of the CSV format.
+static void WriteRecord(std::ostream & os, const GPSRecord & record)
+{
+	os << FormatTime(record.utcTime) << ',' << std::setprecision(7) << record.latitude*1e-7 << ',' << record.longitude*1e-7;
+	os << ',' << std::setprecision(1) << record.gpsElevation << ',' << record.pressure << ',' << record.presElevation;
+	os << ',' << record.yaw << ',' << record.pitch << ',' << record.roll;
+	os << ',' << record.yawDeviation << ',' << record.pitchDeviation << ',' << record.rollDeviation;
+	os << ',' << (unsigned int) record.numOfSatellites << ',' << ( record.flagAttitudeValid ? "yes" : "no" ) << "\r\n";
+}
+
+int main(int argc, char * argv[])
+{
+	if( argc>1 && ( std::string(argv[1])=="--help" || std::string(argv[1])=="-h" ) )
+	{
+		cout << "Usage: rfims-gpstrack [--file='path'] [--from='DD-MM-YYYYTHH:MM:SS[.UUUUUU]' --to='DD-MM-YYYYTHH:MM:SS[.UUUUUU]']" << endl;
+		cout << "                      ['DD-MM-YYYYTHH:MM:SS[.UUUUUU]'...]" << endl;
+		cout << "For each given timestamp (local time, as the ones of the sweeps), the last recorded position and attitude" << endl;
+		cout << "which are not later than it are written in the CSV format. With --from and --to, all the records of the" << endl;
+		cout << "interval are written. Without timestamps, a summary of the file is shown. By default, the file is the one" << endl;
+		cout << "which is written by the main program, " << BASE_PATH << "/gps_track.bin." << endl;
+		return 1;
+	}
+
+	cout.setf(std::ios::fixed, std::ios::floatfield);
+
+	try
+	{
+		std::string filePath = BASE_PATH + "/gps_track.bin";
+		std::int64_t startTime=0, stopTime=0;
+		bool flagStartTime=false, flagStopTime=false;
+		std::vector<std::string> timestamps;
+		for(int i=1; i<argc; i++)
+		{
+			std::string arg(argv[i]);
+			if( arg.compare(0, 7, "--file=")==0 )
+				filePath = arg.substr(7);
+			else if( arg.compare(0, 7, "--from=")==0 )
+			{
+				startTime = ParseTimestamp( arg.substr(7) );
+				flagStartTime=true;
+			}
+			else if( arg.compare(0, 5, "--to=")==0 )
+			{
+				stopTime = ParseTimestamp( arg.substr(5) );
+				flagStopTime=true;
+			}
+			else if( arg.compare(0, 2, "--")==0 )
+				throw rfims_exception("the argument " + arg + " is not valid.");
+			else
+				timestamps.push_back(arg);
+		}
+		if( flagStartTime!=flagStopTime )
+			throw rfims_exception("the arguments --from and --to must be given together.");
+
+		const GPSRecorder recorder(filePath);
+		const std::string header("Timestamp,Latitude,Longitude,GPS Elevation,Pressure,Pressure Elevation,Yaw,Pitch,Roll,Yaw Deviation,Pitch Deviation,Roll Deviation,Satellites,Attitude Valid\r\n");
+
+		if( !flagStartTime && timestamps.empty() )
+		{
+			cout << "File:             " << recorder.GetPath() << endl;
+			cout << "Capacity:         " << recorder.GetCapacity() << " records" << endl;
+			cout << "Stored records:   " << recorder.GetNumOfStoredRecords() << endl;
+			GPSRecord firstRecord, lastRecord;
+			if( recorder.GetOldestRecord(firstRecord) && recorder.Find(std::numeric_limits<std::int64_t>::max(), lastRecord) )
+			{
+				cout << "First record:     " << FormatTime(firstRecord.utcTime) << endl;
+				cout << "Last record:      " << FormatTime(lastRecord.utcTime) << endl;
+			}
+			return 0;
+		}
+
+		if(flagStartTime)
+		{
+			std::vector<GPSRecord> records;
+			recorder.GetRecords(startTime, stopTime, records);
+			cout << header;
+			for(const auto & record : records)
+				WriteRecord(cout, record);
+		}
+
+		if( !timestamps.empty() )
+		{
+			cout << "Query," << header;
+			for(const auto & timestamp : timestamps)
+			{
+				GPSRecord record;
+				cout << timestamp << ',';
+				if( recorder.Find(ParseTimestamp(timestamp), record) )
+					WriteRecord(cout, record);
+				else
+					cout << "not recorded\r\n";
+			}
+		}
+		cout.flush();
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "rfims-gpstrack: " << exc.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
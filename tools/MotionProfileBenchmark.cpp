@@ -0,0 +1,154 @@
+/*! \file MotionProfileBenchmark.cpp
+ * 	\brief A command-line utility which runs the azimuth rotations of a measurement cycle with the class _StepperDriver_
+ * 	and a simulated motor and encoder (the class _SimulatedStepperOutput_), on any Linux machine, to compare a motion
+ * 	profile with the constant step rate of its start rate.
+ *
+ * 	The antenna is rotated to each azimuth position and back to the initial one, as the class _AntennaPositioner_ does,
+ * 	first with the constant step rate and then with the given profile, to measure:
+ * 	- The time of each rotation, the time per azimuth step (the rotation between two consecutive positions) and the
+ * 	time which the profile saves in a measurement cycle.
+ * 	- The maximum delay of a step with respect to its instant.
+ * 	- The difference between the counts of the encoder and the ones of the given steps, which must be the steps the
+ * 	simulated motor lost because their rate was higher than its maximum one.
+ * 	\author Mauro Diamantino
+ */
+
+#include "../src/AntennaPositioning.h"
+
+//! The results of the rotations of a measurement cycle.
+struct CycleResults
+{
+	double azimStepTime; //!< The total time of the rotations between consecutive positions, in seconds.
+	double returnTime; //!< The time of the rotation back to the initial position, in seconds.
+	std::int64_t countError; //!< The sum of the differences between the counts of the encoder and the ones of the given steps.
+	std::uint64_t numOfLostSteps; //!< The steps which the simulated motor lost.
+};
+
+//! This function prints the statistics of a rotation.
+static void PrintRotation(const std::string & name, const MoveStatistics & rotation)
+{
+	cout << std::setw(12) << std::left << name << std::right << std::setw(6) << rotation.numOfSteps << " steps (" << rotation.numOfPlannedSteps << " planned), ";
+	cout << std::setprecision(3) << rotation.duration*1e-9 << " s, " << rotation.GetTimePerStep() << " ms/step, max lateness ";
+	cout << std::setprecision(1) << rotation.maxLateness*1e-3 << " us, " << std::setprecision(1) << rotation.degrees << " degrees, count error " << rotation.GetCountError() << endl;
+}
+
+//! This function rotates the antenna to each azimuth position and back to the initial one with the given profile.
+static CycleResults RunCycle(const MotionProfileParameters & profile, const unsigned int numOfPositions, const double maxRate)
+{
+	EncoderCounter counter;
+	SimulatedStepperOutput output(counter, maxRate);
+	StepperDriver driver(output, counter);
+	driver.SetProfile(profile);
+
+	CycleResults results = {};
+	const double azimStep = 360.0 / numOfPositions;
+	for(unsigned int i=1; i<numOfPositions; i++)
+	{
+		const MoveStatistics rotation = driver.Move(azimStep);
+		PrintRotation("Position " + std::to_string(i+1) + ":", rotation);
+		results.azimStepTime += rotation.duration*1e-9;
+		results.countError += rotation.GetCountError();
+	}
+	const MoveStatistics rotation = driver.Move( -azimStep * (numOfPositions-1) );
+	PrintRotation("Return:", rotation);
+	results.returnTime = rotation.duration*1e-9;
+	results.countError += -rotation.GetCountError(); //The counts of the return are negative, so its lost steps give a positive error
+	results.numOfLostSteps = output.GetNumOfLostSteps();
+
+	const EncoderStatistics statistics = counter.GetStatistics();
+	if(statistics.numOfRepeatedEdges > 0)
+		cerr << "Warning: the counter detected " << statistics.numOfRepeatedEdges << " repeated edge(s)." << endl;
+
+	return results;
+}
+
+int main(int argc, char * argv[])
+{
+	if( argc>1 && ( std::string(argv[1])=="--help" || std::string(argv[1])=="-h" ) )
+	{
+		cout << "Usage: motion-bench [--profile='start,cruise,accel,decel'] [--positions='number'] [--max-rate='steps/s']" << endl;
+		cout << "The antenna is rotated to each one of the azimuth positions (6 by default) and back to the initial one, as" << endl;
+		cout << "in a measurement cycle, with a simulated motor and encoder: first at the constant start rate of the profile," << endl;
+		cout << "and then with the given profile (100,300,400,400 by default, the rates in steps/s and the acceleration and" << endl;
+		cout << "deceleration in steps/s^2). Each step rotates one degree. The simulated motor loses the steps which are" << endl;
+		cout << "given at a rate higher than the maximum one, so they are detected by the encoder. By default the maximum" << endl;
+		cout << "rate is 120 steps/s, the fixed rate of the previous versions (100 steps/s) plus a margin for the timing" << endl;
+		cout << "jitter, since it is the only rate which was checked with the real motor: the maximum rate of the real motor" << endl;
+		cout << "should be measured and given with --max-rate before trusting a faster profile. 0 means no limit." << endl;
+		return 1;
+	}
+
+	cout.setf(std::ios::fixed, std::ios::floatfield);
+	cerr.setf(std::ios::fixed, std::ios::floatfield);
+
+	try
+	{
+		MotionProfileParameters profile = {100.0, 300.0, 400.0, 400.0};
+		unsigned int numOfPositions=6;
+		double maxRate=120.0;
+		for(int i=1; i<argc; i++)
+		{
+			std::string arg(argv[i]);
+			if( arg.compare(0, 10, "--profile=")==0 )
+			{
+				std::istringstream iss( arg.substr(10) );
+				char comma1=0, comma2=0, comma3=0;
+				iss >> profile.startRate >> comma1 >> profile.cruiseRate >> comma2 >> profile.acceleration >> comma3 >> profile.deceleration;
+				if( iss.fail() || comma1!=',' || comma2!=',' || comma3!=',' )
+					throw rfims_exception("the argument " + arg + " is not valid.");
+			}
+			else if( arg.compare(0, 12, "--positions=")==0 )
+				numOfPositions = std::stoul( arg.substr(12) );
+			else if( arg.compare(0, 11, "--max-rate=")==0 )
+				maxRate = std::stod( arg.substr(11) );
+			else
+				throw rfims_exception("the argument " + arg + " is not valid.");
+		}
+		if(numOfPositions < 2)
+			throw rfims_exception("the number of positions must be at least 2.");
+		if(maxRate < 0.0)
+			throw rfims_exception("the maximum rate must not be negative.");
+		MotionProfile checkedProfile;
+		checkedProfile.SetParameters(profile);
+
+		const MotionProfileParameters constantProfile = {profile.startRate, profile.startRate, profile.acceleration, profile.deceleration};
+		if(maxRate > 0.0)
+			cout << "\nMaximum rate of the simulated motor: " << std::setprecision(0) << maxRate << " steps/s" << endl;
+		else
+			cout << "\nThe simulated motor has no maximum rate" << endl;
+		cout << "\nConstant rate of " << std::setprecision(0) << profile.startRate << " steps/s:" << endl;
+		const CycleResults constantResults = RunCycle(constantProfile, numOfPositions, maxRate);
+		cout << "\nProfile " << profile.startRate << ',' << profile.cruiseRate << ',' << profile.acceleration << ',' << profile.deceleration << ':' << endl;
+		const CycleResults profileResults = RunCycle(profile, numOfPositions, maxRate);
+
+		const double constantTime = constantResults.azimStepTime + constantResults.returnTime;
+		const double profileTime = profileResults.azimStepTime + profileResults.returnTime;
+		cout << "\nTime per azimuth step:    " << std::setprecision(3) << constantResults.azimStepTime/(numOfPositions-1) << " s with the constant rate, ";
+		cout << profileResults.azimStepTime/(numOfPositions-1) << " s with the profile" << endl;
+		cout << "Return to the initial position: " << constantResults.returnTime << " s with the constant rate, " << profileResults.returnTime << " s with the profile" << endl;
+		cout << "Rotations of a cycle:     " << constantTime << " s with the constant rate, " << profileTime << " s with the profile (";
+		cout << std::setprecision(1) << ( constantTime > 0.0 ? 100.0*(constantTime - profileTime)/constantTime : 0.0 ) << " % less)" << endl;
+		cout << "Lost steps:               " << constantResults.numOfLostSteps << " with the constant rate, " << profileResults.numOfLostSteps << " with the profile" << endl;
+		cout << "Count error:              " << constantResults.countError << " with the constant rate, " << profileResults.countError << " with the profile" << endl;
+		if(constantResults.numOfLostSteps > 0)
+			cerr << "\nWarning: the constant rate lost steps too, so the timing jitter of this computer is too high for a maximum rate of " << std::setprecision(0) << maxRate << " steps/s." << endl;
+		if(profileResults.numOfLostSteps > constantResults.numOfLostSteps)
+			cerr << "\nWarning: the profile is too fast for a motor whose maximum rate is " << std::setprecision(0) << maxRate << " steps/s." << endl;
+
+		//Each lost step is a rotation of one degree which the encoder did not count, so the count error must match them
+		const std::int64_t countsPerStep = EncoderCounter::COUNTS_PER_DEGREE;
+		if( constantResults.countError != -countsPerStep * std::int64_t(constantResults.numOfLostSteps) ||
+				profileResults.countError != -countsPerStep * std::int64_t(profileResults.numOfLostSteps) )
+		{
+			cerr << "motion-bench: the count errors do not match the lost steps." << endl;
+			return 1;
+		}
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "motion-bench: " << exc.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,138 @@
+/*! \file OccupancyQuery.cpp
+ * 	\brief A command-line utility which queries the spectrum occupancy statistics of the checkpoint file of the class
+ * 	_OccupancyStatistics_, without reading the raw files of the measurements.
+ *
+ * 	The statistics are written in the CSV format: either the curves of the mean power, the max-hold power or the duty
+ * 	cycle versus frequency, one per azimuth position and polarization, or all the statistics of the given frequencies.
+ * 	The checkpoint file is replaced atomically at the end of each measurement cycle, so it can be queried while the main
+ * 	program is running.
+ * 	\author Mauro Diamantino
+ */
+
+#include "../src/SweepProcessing.h"
+
+int main(int argc, char * argv[])
+{
+	if( argc>1 && ( std::string(argv[1])=="--help" || std::string(argv[1])=="-h" ) )
+	{
+		cout << "Usage: rfims-occupancy [--file='path'] [--azimuth='index'] [--polarization='horizontal|vertical']" << endl;
+		cout << "                       [--curve='mean|maxhold|dutycycle'] ['frequency in MHz'...]" << endl;
+		cout << "With --curve, the curve of the mean power (dBm), the max-hold power (dBm) or the duty cycle (between 0 and" << endl;
+		cout << "1) versus frequency is written in the CSV format, one line per azimuth position and polarization. For each" << endl;
+		cout << "given frequency, the statistics of the nearest bin are written: number of samples, mean power, standard" << endl;
+		cout << "deviation, max-hold power and duty cycle. The azimuth positions (indexes starting at zero) and the" << endl;
+		cout << "polarizations can be restricted with --azimuth and --polarization. Without --curve and frequencies, a" << endl;
+		cout << "summary of the file is shown. By default, the file is the one which is written by the main program at the" << endl;
+		cout << "end of each measurement cycle, " << BASE_PATH << "/statistics/occupancy.bin." << endl;
+		return 1;
+	}
+
+	cout.setf(std::ios::fixed, std::ios::floatfield);
+
+	try
+	{
+		std::string filePath = BASE_PATH + "/statistics/occupancy.bin";
+		std::string curveName, polarization;
+		int azimPosIndex=-1;
+		std::vector<std::uint_least64_t> freqs;
+		for(int i=1; i<argc; i++)
+		{
+			std::string arg(argv[i]);
+			if( arg.compare(0, 7, "--file=")==0 )
+				filePath = arg.substr(7);
+			else if( arg.compare(0, 10, "--azimuth=")==0 )
+			{
+				azimPosIndex = std::stoi( arg.substr(10) );
+				if(azimPosIndex < 0)
+					throw rfims_exception("the azimuth position index must not be negative.");
+			}
+			else if( arg.compare(0, 15, "--polarization=")==0 )
+				polarization = arg.substr(15);
+			else if( arg.compare(0, 8, "--curve=")==0 )
+				curveName = arg.substr(8);
+			else if( arg.compare(0, 2, "--")==0 )
+				throw rfims_exception("the argument " + arg + " is not valid.");
+			else
+				freqs.push_back( std::llround( std::stod(arg)*1e6 ) );
+		}
+		if( !curveName.empty() && curveName!="mean" && curveName!="maxhold" && curveName!="dutycycle" )
+			throw rfims_exception("the curve " + curveName + " is not valid.");
+		if( !polarization.empty() && polarization!="horizontal" && polarization!="vertical" )
+			throw rfims_exception("the polarization " + polarization + " is not valid.");
+
+		const OccupancyStatistics occupancyStats(filePath);
+		const std::vector<std::uint_least64_t> & frequencies = occupancyStats.GetFrequencies();
+		if( azimPosIndex >= int( occupancyStats.GetNumOfAzimPos() ) )
+			throw rfims_exception("the azimuth position index is out of range, the file has " + std::to_string( occupancyStats.GetNumOfAzimPos() ) + " positions.");
+
+		if( curveName.empty() && freqs.empty() )
+		{
+			cout << "File:               " << filePath << endl;
+			cout << "Sweeps:             " << occupancyStats.GetNumOfSweeps() << endl;
+			if( !occupancyStats.Empty() )
+			{
+				cout << "First sweep:        " << occupancyStats.GetFirstSweepTime().GetTimestamp() << endl;
+				cout << "Last sweep:         " << occupancyStats.GetLastSweepTime().GetTimestamp() << endl;
+			}
+			cout << "Azimuth positions:  " << occupancyStats.GetNumOfAzimPos() << endl;
+			cout << "Frequency bins:     " << frequencies.size() << ", from " << std::setprecision(3) << frequencies.front()/1e6;
+			cout << " MHz to " << frequencies.back()/1e6 << " MHz" << endl;
+			return 0;
+		}
+
+		const unsigned int firstPos = ( azimPosIndex < 0 ? 0 : azimPosIndex );
+		const unsigned int lastPos = ( azimPosIndex < 0 ? occupancyStats.GetNumOfAzimPos()-1 : azimPosIndex );
+		std::vector<std::string> polarizations;
+		if( polarization.empty() )
+			polarizations = { "horizontal", "vertical" };
+		else
+			polarizations.push_back(polarization);
+
+		if( !curveName.empty() )
+		{
+			cout << "Azimuth Position,Polarization" << std::setprecision(3);
+			for(const auto & frequency : frequencies)
+				cout << ',' << frequency/1e6;
+			cout << "\r\n";
+
+			for(unsigned int pos=firstPos; pos<=lastPos; pos++)
+				for(const auto & pol : polarizations)
+				{
+					FreqValues curve;
+					if(curveName=="mean")
+						curve = occupancyStats.GetMeanCurve(pos, pol);
+					else if(curveName=="maxhold")
+						curve = occupancyStats.GetMaxHoldCurve(pos, pol);
+					else
+						curve = occupancyStats.GetDutyCycleCurve(pos, pol);
+
+					cout << pos << ',' << pol << std::setprecision( curveName=="dutycycle" ? 3 : 1 );
+					for(const auto value : curve.values)
+						cout << ',' << value;
+					cout << "\r\n";
+				}
+		}
+
+		if( !freqs.empty() )
+		{
+			cout << "Frequency,Azimuth Position,Polarization,Samples,Mean Power,Standard Deviation,Max-Hold Power,Duty Cycle\r\n";
+			for(const auto & freq : freqs)
+				for(unsigned int pos=firstPos; pos<=lastPos; pos++)
+					for(const auto & pol : polarizations)
+					{
+						const OccupancyStatistics::BinStatistics & bin = occupancyStats.GetBinStatistics(freq, pos, pol);
+						cout << std::setprecision(3) << freq/1e6 << ',' << pos << ',' << pol << ',' << bin.numOfSamples;
+						cout << ',' << std::setprecision(1) << bin.mean << ',' << sqrt( bin.Variance() ) << ',' << bin.maxHold;
+						cout << ',' << std::setprecision(3) << bin.DutyCycle() << "\r\n";
+					}
+		}
+		cout.flush();
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "rfims-occupancy: " << exc.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,173 @@
+/*! \file QueryMeasurements.cpp
+ * 	\brief A command-line utility which queries the sweeps of the measurement cycles by time, azimuth angle, polarization,
+ * 	frequency and presence of RFI, using the class _MeasurementIndex_, and writes the matching values in the CSV format.
+ * 	The index is updated before each query, so only the files which are new or have changed are read completely.
+ * 	\author Mauro Diamantino
+ */
+
+#include "../src/DataStorage.h"
+
+//! This function parses a frequency, or a range of frequencies "min:max", given in MHz.
+static void ParseFrequencies(const std::string & text, std::uint64_t & startFreq, std::uint64_t & stopFreq)
+{
+	const std::size_t colonPos = text.find(':');
+	startFreq = std::llround( std::stod( text.substr(0, colonPos) )*1e6 );
+	stopFreq = ( colonPos==std::string::npos ) ? startFreq : std::llround( std::stod( text.substr(colonPos+1) )*1e6 );
+	if(stopFreq < startFreq)
+		throw rfims_exception("the frequency range is not valid.");
+}
+
+//! This function writes the records of a query result in the CSV format, preceded by a header if the frequencies changed.
+static void WriteResult(std::ostream & os, const QueryResult & result, std::vector<std::uint64_t> & lastFrequencies, CSVFormatter & formatter)
+{
+	formatter.Clear();
+	if( result.frequencies!=lastFrequencies )
+	{
+		formatter.Append("Timestamp,Azimuthal Angle,Polarization,RFI Bands");
+		for(const auto & frequency : result.frequencies)
+		{
+			formatter.Append(',');
+			formatter.AppendFrequency(frequency);
+		}
+		formatter.Append("\r\n");
+		lastFrequencies = result.frequencies;
+	}
+
+	for(const auto & record : result.records)
+	{
+		formatter.Append( record.timeData.GetTimestamp() );
+		formatter.Append(',');
+		formatter.AppendOneDecimal(record.azimuthAngle);
+		formatter.Append(',');
+		formatter.Append(record.polarization);
+		formatter.Append(',');
+
+		//The bands with RFI are written as their indexes, separated by spaces
+		bool flagFirstBand=true;
+		for(unsigned int b=0; b<64; b++)
+			if( record.rfiBands & (std::uint64_t(1) << b) )
+			{
+				if(!flagFirstBand)
+					formatter.Append(' ');
+				formatter.AppendUnsigned(b);
+				flagFirstBand=false;
+			}
+
+		for(const auto value : record.values)
+		{
+			formatter.Append(',');
+			formatter.AppendOneDecimal(value);
+		}
+		formatter.Append("\r\n");
+	}
+
+	os.write( formatter.Data(), formatter.Size() );
+}
+
+int main(int argc, char * argv[])
+{
+	if( argc>1 && ( std::string(argv[1])=="--help" || std::string(argv[1])=="-h" ) )
+	{
+		cout << "Usage: rfims-query [--from='DD-MM-YYYYTHH:MM:SS'] [--to='DD-MM-YYYYTHH:MM:SS'] [--azimuth='degrees[:tolerance]']" << endl;
+		cout << "                   [--polarization='horizontal|vertical'] [--freq='MHz' | --freq='MHz:MHz'] [--rfi-only]" << endl;
+		cout << "                   [--threads='number'] [--measurements='folder'] [--index='file'] [--output='file (.csv)']" << endl;
+		cout << "The sweeps which meet all the given conditions are written in the CSV format, with the values of the given" << endl;
+		cout << "frequency, the nearest one, or of the given range. The default azimuth tolerance is 1 degree. With --rfi-only," << endl;
+		cout << "only the sweeps with RFI in the bands of the frequency range are written. The column \"RFI Bands\" has the" << endl;
+		cout << "indexes of the bands where RFI was detected. The index of the sweeps stores is updated before the query." << endl;
+		return 1;
+	}
+
+	MeasurementQuery query;
+	std::string measurementsPath("/home/pi/RFIMS-CART/measurements"), indexPath("/home/pi/RFIMS-CART/query_index.txt"), outputPath;
+	unsigned int numOfThreads=0;
+	try
+	{
+		for(int i=1; i<argc; i++)
+		{
+			std::string arg(argv[i]);
+			if( arg.compare(0, 7, "--from=")==0 )
+				query.startTime.SetTimestamp( arg.substr(7) );
+			else if( arg.compare(0, 5, "--to=")==0 )
+				query.stopTime.SetTimestamp( arg.substr(5) );
+			else if( arg.compare(0, 10, "--azimuth=")==0 )
+			{
+				const std::size_t colonPos = arg.find(':');
+				query.flagAzimuth=true;
+				query.azimuthAngle = std::stof( arg.substr(10, colonPos-10) );
+				if( colonPos!=std::string::npos )
+					query.azimuthTolerance = std::stof( arg.substr(colonPos+1) );
+			}
+			else if( arg.compare(0, 15, "--polarization=")==0 )
+				query.polarization = arg.substr(15);
+			else if( arg.compare(0, 7, "--freq=")==0 )
+				ParseFrequencies( arg.substr(7), query.startFreq, query.stopFreq );
+			else if( arg=="--rfi-only" )
+				query.flagOnlyRFI=true;
+			else if( arg.compare(0, 10, "--threads=")==0 )
+				numOfThreads = std::stoul( arg.substr(10) );
+			else if( arg.compare(0, 15, "--measurements=")==0 )
+				measurementsPath = arg.substr(15);
+			else if( arg.compare(0, 8, "--index=")==0 )
+				indexPath = arg.substr(8);
+			else if( arg.compare(0, 9, "--output=")==0 )
+				outputPath = arg.substr(9);
+			else
+				throw rfims_exception("the argument " + arg + " is not valid.");
+		}
+
+		if( !query.polarization.empty() && query.polarization!="horizontal" && query.polarization!="vertical" )
+			throw rfims_exception("the polarization must be \"horizontal\" or \"vertical\".");
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "rfims-query: " << exc.what() << endl;
+		return 1;
+	}
+
+	try
+	{
+		MeasurementIndex index;
+		if(numOfThreads > 0)
+			index.SetNumOfThreads(numOfThreads);
+		index.Open(measurementsPath, indexPath);
+
+		auto startTime = std::chrono::steady_clock::now();
+		const std::size_t numOfIndexedFiles = index.Update();
+		const double indexingTime = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count();
+
+		startTime = std::chrono::steady_clock::now();
+		const std::vector<QueryResult> results = index.Query(query);
+		const double queryTime = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count();
+
+		std::ofstream ofs;
+		if( !outputPath.empty() )
+		{
+			ofs.open(outputPath, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+			if( !ofs.is_open() )
+				throw rfims_exception("the output file " + outputPath + " could not be created.");
+		}
+		std::ostream & os = outputPath.empty() ? cout : ofs;
+
+		CSVFormatter formatter;
+		std::vector<std::uint64_t> lastFrequencies;
+		std::size_t numOfRecords=0;
+		for(const auto & result : results)
+		{
+			WriteResult(os, result, lastFrequencies, formatter);
+			numOfRecords += result.records.size();
+		}
+		os.flush();
+
+		cerr << std::fixed << std::setprecision(1);
+		cerr << "Indexed files: " << numOfIndexedFiles << " of " << index.GetFiles().size() << " in " << indexingTime << " ms" << endl;
+		cerr << "Matching sweeps: " << numOfRecords << " of " << results.size() << " measurement cycle(s) in " << queryTime << " ms" << endl;
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "rfims-query: " << exc.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
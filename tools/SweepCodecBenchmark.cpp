@@ -0,0 +1,199 @@
+/*! \file SweepCodecBenchmark.cpp
+ * 	\brief A command-line utility which compares the compressed size and the encoding time of the sweeps files
+ * 	(sweeps_DD-MM-YYYYTHH:MM:SS.csv) when they are compressed as CSV text with LZMA and when they are encoded with the
+ * 	class _SweepCodec_, alone and followed by LZMA. The decoded sweeps are converted back to CSV text and compared with
+ * 	the original file, to verify the encoding is lossless with respect to the CSV files.
+ * 	\author Mauro Diamantino
+ */
+
+#include "../src/DataStorage.h"
+
+//! The sweeps of a CSV file, with their power values as they are given to the logging path.
+struct CSVSweeps
+{
+	std::vector<std::uint64_t> frequencies; //!< The frequency values, in Hz.
+	std::vector<std::string> timestamps; //!< The timestamps of the sweeps.
+	std::vector<float> azimuthAngles; //!< The azimuth angles of the sweeps.
+	std::vector<std::string> polarizations; //!< The polarizations of the sweeps.
+	std::vector<float> values; //!< The power values of all the sweeps, one sweep after the other.
+};
+
+//! This function splits a CSV line in its fields, removing the line ending.
+static void SplitCSVLine(std::string line, std::vector<std::string> & fields)
+{
+	if( !line.empty() && line.back()=='\r' )
+		line.pop_back();
+
+	fields.clear();
+	std::size_t start=0, comma;
+	while( (comma = line.find(',', start))!=std::string::npos )
+	{
+		fields.push_back( line.substr(start, comma-start) );
+		start = comma + 1;
+	}
+	fields.push_back( line.substr(start) );
+}
+
+//! This function loads a sweeps CSV file, which must have the layout of the files which are generated by the software.
+static void LoadCSV(const std::string & text, CSVSweeps & sweeps)
+{
+	std::istringstream iss(text);
+	std::string line;
+	std::vector<std::string> fields;
+
+	if( !std::getline(iss, line) )
+		throw rfims_exception("the CSV file is empty.");
+	SplitCSVLine(line, fields);
+	if( fields.size()<4 || fields[0]!="Timestamp" )
+		throw rfims_exception("the CSV file does not have the header of a sweeps file.");
+	for(std::size_t i=3; i<fields.size(); i++)
+		sweeps.frequencies.push_back( std::llround( std::stod(fields[i])*1e6 ) );
+
+	const std::size_t numOfPoints = sweeps.frequencies.size();
+	while( std::getline(iss, line) )
+	{
+		SplitCSVLine(line, fields);
+		if( fields.size()!=numOfPoints+3 )
+			throw rfims_exception("a row of the CSV file does not have the same number of points as the header.");
+		sweeps.timestamps.push_back( fields[0] );
+		sweeps.azimuthAngles.push_back( std::stof(fields[1]) );
+		sweeps.polarizations.push_back( fields[2] );
+		for(std::size_t i=3; i<fields.size(); i++)
+			sweeps.values.push_back( std::strtof(fields[i].c_str(), nullptr) );
+	}
+}
+
+//! This function compresses a buffer with LZMA (.lzma format), as the archives were compressed before, and returns the compressed size.
+static std::size_t CompressLZMA(const std::string & input, const std::uint32_t preset)
+{
+	std::vector<std::uint8_t> output( lzma_stream_buffer_bound( input.size() ) );
+	lzma_options_lzma options;
+	if( lzma_lzma_preset(&options, preset) )
+		throw rfims_exception("the compression preset is not supported by liblzma.");
+
+	lzma_stream stream = LZMA_STREAM_INIT;
+	if( lzma_alone_encoder(&stream, &options)!=LZMA_OK )
+		throw rfims_exception("the LZMA encoder could not be initialized.");
+	stream.next_in = (const std::uint8_t*) input.data();
+	stream.avail_in = input.size();
+	stream.next_out = output.data();
+	stream.avail_out = output.size();
+	lzma_ret ret = lzma_code(&stream, LZMA_FINISH);
+	std::size_t outputSize = output.size() - stream.avail_out;
+	lzma_end(&stream);
+	if(ret!=LZMA_STREAM_END)
+		throw rfims_exception("the LZMA compression failed.");
+
+	return outputSize;
+}
+
+//! This function returns the milliseconds which have elapsed since the given time point.
+static double ElapsedTime(const std::chrono::steady_clock::time_point & startTime)
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count();
+}
+
+//! This function prints a line of the results table.
+static void PrintResult(const std::string & method, const std::size_t size, const std::size_t csvSize, const double time)
+{
+	cout << std::setw(26) << method << std::setw(12) << size << std::setw(10) << std::setprecision(2) << 100.0*size/csvSize << " %";
+	cout << std::setw(12) << std::setprecision(1) << time << " ms" << endl;
+}
+
+int main(int argc, char * argv[])
+{
+	if(argc<2)
+	{
+		cout << "Usage: sweepcodec-bench 'sweeps file (.csv)' ['sweeps file (.csv)'...]" << endl;
+		return 1;
+	}
+
+	cout.setf(std::ios::fixed, std::ios::floatfield);
+	cout.setf(std::ios::right, std::ios::adjustfield);
+
+	bool flagMismatch=false;
+	for(int f=1; f<argc; f++)
+	{
+		try
+		{
+			std::ifstream ifs(argv[f], std::ios::binary);
+			if(!ifs)
+				throw rfims_exception("the file could not be opened.");
+			std::string csvText( (std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>() );
+
+			CSVSweeps sweeps;
+			LoadCSV(csvText, sweeps);
+			const std::size_t numOfPoints = sweeps.frequencies.size();
+			const std::size_t numOfSweeps = sweeps.timestamps.size();
+
+			cout << '\n' << argv[f] << ": " << numOfSweeps << " sweeps of " << numOfPoints << " points" << endl;
+			cout << std::setw(26) << "Method" << std::setw(12) << "Size (B)" << std::setw(12) << "Ratio" << std::setw(15) << "Time" << endl;
+			PrintResult("CSV", csvText.size(), csvText.size(), 0.0);
+
+			for(const std::uint32_t preset : {6, 9})
+			{
+				auto startTime = std::chrono::steady_clock::now();
+				std::size_t size = CompressLZMA(csvText, preset);
+				PrintResult("CSV+LZMA (preset " + std::to_string(preset) + ")", size, csvText.size(), ElapsedTime(startTime));
+			}
+
+			SweepCodec encoder;
+			std::string encoded;
+			std::vector<std::size_t> sweepSizes;
+			auto startTime = std::chrono::steady_clock::now();
+			for(std::size_t s=0; s<numOfSweeps; s++)
+			{
+				std::size_t previousSize = encoded.size();
+				encoder.Encode(sweeps.values.data() + s*numOfPoints, numOfPoints, encoded);
+				sweepSizes.push_back( encoded.size() - previousSize );
+			}
+			PrintResult("Delta", encoded.size(), csvText.size(), ElapsedTime(startTime));
+
+			for(const std::uint32_t preset : {0, 6})
+			{
+				startTime = std::chrono::steady_clock::now();
+				SweepCodec codec;
+				std::string encodedAgain;
+				for(std::size_t s=0; s<numOfSweeps; s++)
+					codec.Encode(sweeps.values.data() + s*numOfPoints, numOfPoints, encodedAgain);
+				std::size_t size = CompressLZMA(encodedAgain, preset);
+				PrintResult("Delta+LZMA (preset " + std::to_string(preset) + ")", size, csvText.size(), ElapsedTime(startTime));
+			}
+
+			SweepCodec decoder;
+			std::vector<float> decodedValues(numOfSweeps*numOfPoints);
+			std::size_t offset=0;
+			startTime = std::chrono::steady_clock::now();
+			for(std::size_t s=0; s<numOfSweeps; s++)
+			{
+				std::size_t size = decoder.Decode(encoded.data() + offset, encoded.size() - offset, decodedValues.data() + s*numOfPoints, numOfPoints);
+				if( size!=sweepSizes[s] )
+					throw rfims_exception("the decoder did not read the same number of bytes which were encoded.");
+				offset += size;
+			}
+			cout << std::setw(26) << "Delta decoding" << std::setw(34) << std::setprecision(1) << ElapsedTime(startTime) << " ms" << endl;
+
+			//The decoded sweeps are converted to CSV text, which must be identical to the original file
+			CSVFormatter formatter;
+			SweepStoreReader::WriteCSVHeader(formatter, sweeps.frequencies.data(), numOfPoints);
+			for(std::size_t s=0; s<numOfSweeps; s++)
+				SweepStoreReader::WriteCSVRow(formatter, sweeps.timestamps[s], sweeps.azimuthAngles[s], sweeps.polarizations[s],
+						decodedValues.data() + s*numOfPoints, numOfPoints);
+
+			if( formatter.Str()==csvText )
+				cout << "The decoded sweeps give the same CSV text, byte by byte." << endl;
+			else
+			{
+				cout << "The decoded sweeps do NOT give the same CSV text." << endl;
+				flagMismatch=true;
+			}
+		}
+		catch(std::exception & exc)
+		{
+			cerr << "sweepcodec-bench: " << argv[f] << ": " << exc.what() << endl;
+			return 1;
+		}
+	}
+
+	return flagMismatch ? 2 : 0;
+}
@@ -0,0 +1,38 @@
+/*! \file SweepStoreToCSV.cpp
+ * 	\brief A command-line utility which converts a binary sweeps store file (sweeps_DD-MM-YYYYTHH:MM:SS.bin) to the CSV
+ * 	format which was used before, byte by byte.
+ * 	\author Mauro Diamantino
+ */
+
+#include "../src/DataStorage.h"
+
+int main(int argc, char * argv[])
+{
+	if( argc<2 || argc>3 )
+	{
+		cout << "Usage: sweepstore2csv 'input file (.bin)' ['output file (.csv)']" << endl;
+		cout << "If the output file is not given, the CSV text is written to the standard output." << endl;
+		return 1;
+	}
+
+	try
+	{
+		SweepStoreReader reader;
+		reader.Open( argv[1] );
+
+		if(argc==3)
+			reader.ExportCSV( std::string(argv[2]) );
+		else
+		{
+			reader.ExportCSV(cout);
+			cout.flush();
+		}
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "sweepstore2csv: " << exc.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
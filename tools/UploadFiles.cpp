@@ -0,0 +1,82 @@
+/*! \file UploadFiles.cpp
+ * 	\brief A command-line utility which uploads the archives of an uploads folder to an upload server, using the class
+ * 	_DataUploader_ as the software does, and shows the throughput. It is intended to be used with the utility
+ * 	"rfims-upload-server" to test the uploading without the real remote server.
+ * 	\author Mauro Diamantino
+ */
+
+#include "../src/DataUploading.h"
+
+int main(int argc, char * argv[])
+{
+	if(argc<3)
+	{
+		cout << "Usage: rfims-upload 'host:port' 'folder' [--threads='number'] [--chunk='KiB'] [--attempts='number'] [--keep] ['file'...]" << endl;
+		cout << "The archives of the folder which are in its upload queue, or which are not in the queue but have the name" << endl;
+		cout << "rfims_data_*.tar.xz or rfims_data_*.tar.lzma, are uploaded, as well as the given files of the folder. The" << endl;
+		cout << "uploaded files are removed, unless the argument --keep is given." << endl;
+		return 1;
+	}
+
+	const std::string server(argv[1]);
+	const std::size_t colonPos = server.rfind(':');
+	if( colonPos==std::string::npos )
+	{
+		cerr << "rfims-upload: the server must be given as 'host:port'." << endl;
+		return 1;
+	}
+
+	unsigned int numOfThreads=2, numOfAttempts=3;
+	std::size_t chunkSize=262144;
+	bool flagKeep=false;
+	std::vector<std::string> filenames;
+	for(int i=3; i<argc; i++)
+	{
+		std::string arg(argv[i]);
+		if( arg.compare(0, 10, "--threads=")==0 )
+			numOfThreads = std::stoul( arg.substr(10) );
+		else if( arg.compare(0, 8, "--chunk=")==0 )
+			chunkSize = std::stoul( arg.substr(8) )*1024;
+		else if( arg.compare(0, 11, "--attempts=")==0 )
+			numOfAttempts = std::stoul( arg.substr(11) );
+		else if( arg=="--keep" )
+			flagKeep=true;
+		else
+			filenames.push_back(arg);
+	}
+
+	try
+	{
+		DataUploader uploader;
+		uploader.SetServer( server.substr(0, colonPos), std::stoul( server.substr(colonPos+1) ) );
+		uploader.SetTransferParameters(chunkSize, numOfThreads, 30);
+		uploader.SetRetryParameters(numOfAttempts, 1, 60);
+		uploader.SetRemoveUploaded(!flagKeep);
+		uploader.Open( argv[2] );
+		for(const auto & filename : filenames)
+			uploader.Enqueue(filename);
+
+		cout << "Uploading " << uploader.GetPendingFiles().size() << " file(s)..." << endl;
+		try
+		{
+			uploader.UploadPending();
+		}
+		catch(std::exception & exc)
+		{
+			cerr << "rfims-upload: " << exc.what() << endl;
+		}
+
+		const UploadStatistics & stats = uploader.GetStatistics();
+		cout << std::fixed << std::setprecision(1);
+		cout << "Uploaded files: " << stats.numOfFiles << ", failed attempts: " << stats.numOfFailures << ", resumed transfers: " << stats.numOfResumes << endl;
+		cout << "Sent bytes: " << stats.numOfBytes << " in " << stats.elapsedTime << " ms (" << stats.GetThroughput()/1048576.0 << " MiB/s)" << endl;
+		cout << "Pending files: " << uploader.GetPendingFiles().size() << endl;
+
+		return( uploader.GetPendingFiles().empty() ? 0 : 2 );
+	}
+	catch(std::exception & exc)
+	{
+		cerr << "rfims-upload: " << exc.what() << endl;
+		return 1;
+	}
+}
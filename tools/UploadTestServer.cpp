@@ -0,0 +1,223 @@
+/*! \file UploadTestServer.cpp
+ * 	\brief A command-line utility which implements the server side of the upload protocol (see DataUploading.h), to
+ * 	test the uploading of the archives without the real remote server. It can limit the transfer rate of each
+ * 	connection and close the connections after a number of bytes, to test the throughput and the resuming of transfers.
+ * 	\author Mauro Diamantino
+ */
+
+#include "../src/DataUploading.h"
+#include <arpa/inet.h>
+#include <thread>
+
+//! The parameters of the server, which are shared by all the connections.
+struct ServerParameters
+{
+	std::string folder; //!< The folder where the received files are saved.
+	double rate; //!< The maximum transfer rate of each connection, in bytes per second, or 0 if there is no limit.
+	std::uint64_t dropAfter; //!< The number of bytes after which each connection is closed, or 0 if the connections are not closed.
+	std::string onComplete; //!< A command which is executed with the path of each file which is received completely.
+	pthread_mutex_t mutex; //!< The mutex which serializes the operations over the files.
+} params;
+
+//! This function checks the name of a file does not have a path, so the files can only be written in the server folder.
+static bool IsValidName(const std::string & name)
+{
+	return( !name.empty() && name.front()!='.' && name.find('/')==std::string::npos );
+}
+
+//! This function returns the size of a file or -1 if it does not exist.
+static long long GetFileSize(const std::string & path)
+{
+	struct stat fileStatus;
+	return( stat(path.c_str(), &fileStatus)==0 ? (long long) fileStatus.st_size : -1 );
+}
+
+//! This function replies to the command STAT.
+static std::string Stat(const std::string & name, const std::uint64_t size)
+{
+	const std::string path = params.folder + '/' + name;
+	if( GetFileSize(path)==(long long) size )
+		return "OK " + std::to_string(size);
+
+	long long partSize = GetFileSize(path + ".part");
+	if( partSize > (long long) size )
+	{
+		//The partial file belongs to another file with the same name, so it is discarded
+		truncate( (path + ".part").c_str(), 0 );
+		partSize=0;
+	}
+	return "OK " + std::to_string( partSize>0 ? partSize : 0 );
+}
+
+//! This function writes a chunk, which was received with the command PUT, in the partial file.
+static std::string Put(const std::string & name, const std::uint64_t offset, const std::vector<char> & data, const std::uint32_t crc)
+{
+	if( lzma_crc32( (const std::uint8_t*) data.data(), data.size(), 0 )!=crc )
+		return "ERR the CRC32 of the chunk is not correct";
+
+	const std::string partPath = params.folder + '/' + name + ".part";
+	long long partSize = GetFileSize(partPath);
+	if( offset > (std::uint64_t) std::max(partSize, 0LL) )
+		return "ERR the offset is beyond the end of the partial file";
+
+	int fd = open(partPath.c_str(), O_WRONLY | O_CREAT, 0644);
+	if(fd < 0)
+		return "ERR the partial file could not be opened";
+	bool flagOk = pwrite(fd, data.data(), data.size(), offset)==(ssize_t) data.size() &&
+			ftruncate(fd, offset + data.size())==0 && fdatasync(fd)==0;
+	close(fd);
+
+	return( flagOk ? "OK " + std::to_string( offset + data.size() ) : "ERR the chunk could not be written" );
+}
+
+//! This function makes visible a file which was received completely, with the command DONE.
+static std::string Done(const std::string & name, const std::uint64_t size)
+{
+	const std::string path = params.folder + '/' + name;
+	if( GetFileSize(path)==(long long) size )
+		return "OK " + std::to_string(size);
+
+	if( GetFileSize(path + ".part")!=(long long) size )
+		return "ERR the size of the partial file is not the given one";
+	if( std::rename( (path + ".part").c_str(), path.c_str() )!=0 )
+		return "ERR the partial file could not be renamed";
+
+	cout << "Received " << name << " (" << size << " bytes)" << endl;
+	if( !params.onComplete.empty() && system( (params.onComplete + " '" + path + "'").c_str() )!=0 )
+		cerr << "Warning: the command which is executed when a file is received failed." << endl;
+
+	return "OK " + std::to_string(size);
+}
+
+//! The function which is executed by the thread which serves a connection.
+void *ConnectionThreadFunc(void *arg)
+{
+	UploadConnection connection( (int)(intptr_t) arg );
+	std::uint64_t receivedBytes=0;
+	auto startTime = std::chrono::steady_clock::now();
+
+	try
+	{
+		while(true)
+		{
+			std::istringstream iss( connection.ReceiveLine() );
+			std::string command, name, reply;
+			std::uint64_t offset, length;
+			iss >> command >> name;
+			if( !IsValidName(name) )
+				reply = "ERR invalid file name";
+			else if( command=="STAT" && iss >> length )
+			{
+				pthread_mutex_lock(&params.mutex);
+				reply = Stat(name, length);
+				pthread_mutex_unlock(&params.mutex);
+			}
+			else if( command=="PUT" && iss >> offset >> length )
+			{
+				std::uint32_t crc=0;
+				iss >> std::hex >> crc;
+				if( length > 67108864 )
+				{
+					connection.SendLine("ERR the chunk is too big");
+					break;
+				}
+				std::vector<char> data(length);
+				if( params.dropAfter>0 && receivedBytes + length > params.dropAfter )
+				{
+					//The connection is closed in the middle of the chunk, as it happens when the link falls
+					connection.Receive( data.data(), params.dropAfter - receivedBytes );
+					cout << "Connection dropped after " << params.dropAfter << " bytes while " << name << " was received" << endl;
+					break;
+				}
+				connection.Receive( data.data(), length );
+				receivedBytes += length;
+
+				if(params.rate > 0.0)
+				{
+					auto targetTime = startTime + std::chrono::duration<double>(receivedBytes/params.rate);
+					std::this_thread::sleep_until( std::chrono::time_point_cast<std::chrono::steady_clock::duration>(targetTime) );
+				}
+
+				pthread_mutex_lock(&params.mutex);
+				reply = Put(name, offset, data, crc);
+				pthread_mutex_unlock(&params.mutex);
+			}
+			else if( command=="DONE" && iss >> length )
+			{
+				pthread_mutex_lock(&params.mutex);
+				reply = Done(name, length);
+				pthread_mutex_unlock(&params.mutex);
+			}
+			else
+				reply = "ERR unknown command";
+
+			connection.SendLine(reply);
+		}
+	}
+	catch(std::exception & exc) {}	//The client closed the connection
+
+	return NULL;
+}
+
+int main(int argc, char * argv[])
+{
+	if(argc<3)
+	{
+		cout << "Usage: rfims-upload-server 'port' 'folder' [--rate='KiB/s'] [--drop-after='bytes'] [--on-complete='command']" << endl;
+		cout << "The received files are saved in the folder. The argument --rate limits the transfer rate of each connection," << endl;
+		cout << "--drop-after closes each connection after the given number of bytes, to test the resuming of transfers, and" << endl;
+		cout << "--on-complete executes a command with the path of each file which is received completely." << endl;
+		return 1;
+	}
+
+	const int port = std::atoi(argv[1]);
+	params.folder = argv[2];
+	params.rate=0.0;
+	params.dropAfter=0;
+	for(int i=3; i<argc; i++)
+	{
+		std::string arg(argv[i]);
+		if( arg.compare(0, 7, "--rate=")==0 )
+			params.rate = std::stod( arg.substr(7) )*1024.0;
+		else if( arg.compare(0, 13, "--drop-after=")==0 )
+			params.dropAfter = std::stoull( arg.substr(13) );
+		else if( arg.compare(0, 14, "--on-complete=")==0 )
+			params.onComplete = arg.substr(14);
+		else
+		{
+			cerr << "rfims-upload-server: unrecognized argument '" << arg << '\'' << endl;
+			return 1;
+		}
+	}
+	pthread_mutex_init(&params.mutex, NULL);
+
+	int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+	int optValue=1;
+	setsockopt( listenFd, SOL_SOCKET, SO_REUSEADDR, &optValue, sizeof(optValue) );
+	struct sockaddr_in addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+	if( listenFd<0 || bind(listenFd, (struct sockaddr*) &addr, sizeof(addr))!=0 || listen(listenFd, 16)!=0 )
+	{
+		cerr << "rfims-upload-server: the port " << port << " could not be listened: " << strerror(errno) << endl;
+		return 1;
+	}
+	cout << "Listening on the port " << port << ", saving the files in " << params.folder << endl;
+
+	while(true)
+	{
+		int connFd = accept(listenFd, nullptr, nullptr);
+		if(connFd < 0)
+			continue;
+
+		pthread_t thread;
+		if( pthread_create(&thread, NULL, ConnectionThreadFunc, (void*)(intptr_t) connFd)==0 )
+			pthread_detach(thread);
+		else
+			close(connFd);
+	}
+
+	return 0;
+}